@@ -24,9 +24,12 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 
 @@Counter
 @@CheckpointInputPipelineHook
+@@ColumnarDataset
 @@CsvDataset
+@@IndexedTFRecordDataset
 @@LMDBDataset
 @@Optional
+@@ParallelCsvDataset
 @@RandomDataset
 @@Reducer
 @@SqlDataset
@@ -36,6 +39,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@batch_and_drop_remainder
 @@bucket_by_sequence_length
 @@choose_from_datasets
+@@compressed_cache
 @@copy_to_device
 @@dense_to_sparse_batch
 @@enumerate_dataset
@@ -62,6 +66,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@shuffle_and_repeat
 @@sliding_window_batch
 @@sloppy_interleave
+@@spilling_shuffle
 @@StatsAggregator
 @@unbatch
 @@unique
@@ -81,6 +86,7 @@ from tensorflow.contrib.data.python.ops.batching import dense_to_sparse_batch
 from tensorflow.contrib.data.python.ops.batching import map_and_batch
 from tensorflow.contrib.data.python.ops.batching import padded_batch_and_drop_remainder
 from tensorflow.contrib.data.python.ops.batching import unbatch
+from tensorflow.contrib.data.python.ops.caching import compressed_cache
 from tensorflow.contrib.data.python.ops.counter import Counter
 from tensorflow.contrib.data.python.ops.enumerate_ops import enumerate_dataset
 from tensorflow.contrib.data.python.ops.error_ops import ignore_errors
@@ -100,8 +106,11 @@ from tensorflow.contrib.data.python.ops.parsing_ops import parse_example_dataset
 from tensorflow.contrib.data.python.ops.prefetching_ops import copy_to_device
 from tensorflow.contrib.data.python.ops.prefetching_ops import prefetch_to_device
 from tensorflow.contrib.data.python.ops.random_ops import RandomDataset
+from tensorflow.contrib.data.python.ops.readers import ColumnarDataset
 from tensorflow.contrib.data.python.ops.readers import CsvDataset
+from tensorflow.contrib.data.python.ops.readers import IndexedTFRecordDataset
 from tensorflow.contrib.data.python.ops.readers import LMDBDataset
+from tensorflow.contrib.data.python.ops.readers import ParallelCsvDataset
 from tensorflow.contrib.data.python.ops.readers import make_batched_features_dataset
 from tensorflow.contrib.data.python.ops.readers import make_csv_dataset
 from tensorflow.contrib.data.python.ops.readers import read_batch_features
@@ -109,6 +118,7 @@ from tensorflow.contrib.data.python.ops.readers import SqlDataset
 from tensorflow.contrib.data.python.ops.resampling import rejection_resample
 from tensorflow.contrib.data.python.ops.scan_ops import scan
 from tensorflow.contrib.data.python.ops.shuffle_ops import shuffle_and_repeat
+from tensorflow.contrib.data.python.ops.shuffle_ops import spilling_shuffle
 from tensorflow.contrib.data.python.ops.sliding import sliding_window_batch
 from tensorflow.contrib.data.python.ops.unique import unique
 from tensorflow.contrib.data.python.ops.writers import TFRecordWriter
@@ -0,0 +1,128 @@
+#  Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compressed caching with CacheDatasetOp."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import shutil
+import tempfile
+
+from tensorflow.contrib.data.python.ops import caching
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+def _build_dataset(num_elements):
+  return dataset_ops.Dataset.range(num_elements).map(
+      lambda x: (array_ops.fill([x % 5], x), string_ops.as_string(x)))
+
+
+class CompressedCacheDatasetTest(test_base.DatasetTestBase):
+
+  def setUp(self):
+    self.tmp_dir = tempfile.mkdtemp()
+    self.cache_prefix = os.path.join(self.tmp_dir, "cache")
+
+  def tearDown(self):
+    shutil.rmtree(self.tmp_dir, ignore_errors=True)
+
+  def _read(self, dataset, sess):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    elements = []
+    while True:
+      try:
+        elements.append(sess.run(get_next))
+      except errors.OutOfRangeError:
+        return elements
+
+  def _assertElementsEqual(self, expected, actual):
+    self.assertEqual(len(expected), len(actual))
+    for (expected_x, expected_s), (x, s) in zip(expected, actual):
+      self.assertAllEqual(expected_x, x)
+      self.assertEqual(expected_s, s)
+
+  def testMemoryCache(self):
+    dataset = _build_dataset(20).apply(caching.compressed_cache()).repeat(3)
+    with self.cached_session() as sess:
+      elements = self._read(dataset, sess)
+      self._assertElementsEqual(elements[:20], elements[20:40])
+      self._assertElementsEqual(elements[:20], elements[40:])
+      self._assertElementsEqual(
+          self._read(_build_dataset(20), sess), elements[:20])
+
+  def testFileCache(self):
+    with self.cached_session() as sess:
+      expected = self._read(_build_dataset(20), sess)
+      # The first pass writes the cache and the second one reads it.
+      for _ in range(2):
+        self._assertElementsEqual(
+            expected,
+            self._read(
+                _build_dataset(20).apply(
+                    caching.compressed_cache(self.cache_prefix)), sess))
+      # The cache is used even though the input has changed.
+      self._assertElementsEqual(
+          expected,
+          self._read(
+              _build_dataset(0).apply(
+                  caching.compressed_cache(self.cache_prefix)), sess))
+
+  def testConcurrentFileCacheReaders(self):
+    with self.cached_session() as sess:
+      for cache in [
+          caching.compressed_cache(self.cache_prefix),
+          lambda dataset: dataset.cache(self.cache_prefix + "_uncompressed")
+      ]:
+        expected = self._read(_build_dataset(20).apply(cache), sess)
+        get_next_1 = _build_dataset(20).apply(
+            cache).make_one_shot_iterator().get_next()
+        get_next_2 = _build_dataset(20).apply(
+            cache).make_one_shot_iterator().get_next()
+        for expected_element in expected:
+          self._assertElementsEqual([expected_element] * 2,
+                                    sess.run([get_next_1, get_next_2]))
+
+  def testCompressionMismatch(self):
+    with self.cached_session() as sess:
+      self._read(_build_dataset(5).cache(self.cache_prefix), sess)
+      get_next = _build_dataset(5).apply(caching.compressed_cache(
+          self.cache_prefix)).make_one_shot_iterator().get_next()
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "different compression"):
+        sess.run(get_next)
+
+  def testCorruptedFileCache(self):
+    with self.cached_session() as sess:
+      self._read(_build_dataset(20).cache(self.cache_prefix), sess)
+      data_file = self.cache_prefix + ".data-00000-of-00001"
+      with open(data_file, "rb") as f:
+        data = bytearray(f.read())
+      data[len(data) // 2] ^= 0xff
+      with open(data_file, "wb") as f:
+        f.write(data)
+      with self.assertRaisesRegexp(errors.DataLossError,
+                                   "Checksum does not match"):
+        self._read(_build_dataset(20).cache(self.cache_prefix), sess)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,109 @@
+#  Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for IndexedTFRecordDatasetOp."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from tensorflow.contrib.data.python.ops import readers
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.framework import errors
+from tensorflow.python.lib.io import python_io
+from tensorflow.python.platform import test
+from tensorflow.python.util import compat
+
+
+class IndexedTFRecordDatasetTest(test_base.DatasetTestBase):
+
+  def setUp(self):
+    super(IndexedTFRecordDatasetTest, self).setUp()
+    self._num_files = 3
+    self._num_records = 7
+    self._filenames = []
+    for i in range(self._num_files):
+      fn = os.path.join(self.get_temp_dir(), "tf_record.%d.txt" % i)
+      self._filenames.append(fn)
+      with python_io.TFRecordWriter(fn, write_index=True) as writer:
+        for j in range(self._num_records):
+          writer.write(self._record(i, j))
+
+  def _record(self, f, r):
+    return compat.as_bytes("Record %d of file %d" % (r, f))
+
+  def _all_records(self):
+    return [
+        self._record(i, j)
+        for i in range(self._num_files)
+        for j in range(self._num_records)
+    ]
+
+  def _read(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    records = []
+    with self.cached_session() as sess:
+      while True:
+        try:
+          records.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          return records
+
+  def testReadAll(self):
+    dataset = readers.IndexedTFRecordDataset(self._filenames)
+    self.assertEqual(self._all_records(), self._read(dataset))
+
+  def testReadRangeAcrossFiles(self):
+    dataset = readers.IndexedTFRecordDataset(self._filenames, start=5, stop=16)
+    self.assertEqual(self._all_records()[5:16], self._read(dataset))
+
+  def testShardsCoverAllRecords(self):
+    num_shards = 4
+    total = self._num_files * self._num_records
+    records = []
+    for shard in range(num_shards):
+      dataset = readers.IndexedTFRecordDataset(
+          self._filenames,
+          start=total * shard // num_shards,
+          stop=total * (shard + 1) // num_shards)
+      records.extend(self._read(dataset))
+    self.assertEqual(self._all_records(), records)
+
+  def testShuffle(self):
+    dataset = readers.IndexedTFRecordDataset(
+        self._filenames, start=3, stop=19, shuffle=True, seed=42)
+    records = self._read(dataset)
+    self.assertItemsEqual(self._all_records()[3:19], records)
+    self.assertNotEqual(self._all_records()[3:19], records)
+    # The same seed gives the same order.
+    self.assertEqual(records, self._read(dataset))
+
+  def testInvalidRange(self):
+    dataset = readers.IndexedTFRecordDataset(self._filenames, start=3, stop=100)
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(dataset)
+
+  def testMissingIndex(self):
+    fn = os.path.join(self.get_temp_dir(), "unindexed.txt")
+    with python_io.TFRecordWriter(fn) as writer:
+      writer.write(b"abc")
+    dataset = readers.IndexedTFRecordDataset([fn])
+    with self.assertRaises(errors.NotFoundError):
+      self._read(dataset)
+
+
+if __name__ == "__main__":
+  test.main()
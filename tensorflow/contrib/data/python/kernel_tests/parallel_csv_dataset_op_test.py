@@ -0,0 +1,143 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for ParallelCSVDatasetOp."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import gzip
+import os
+
+from tensorflow.contrib.data.python.ops import readers
+from tensorflow.python.data.experimental.kernel_tests.serialization import dataset_serialization_test_base
+from tensorflow.python.data.experimental.ops import readers as experimental_readers
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+def _lines(num_lines):
+  # Quoted fields with line breaks make some records span several lines.
+  return [
+      '%d,%s,"%s"' % (i, i * 0.5, "a\nb" if i % 7 == 0 else "c,d")
+      for i in range(num_lines)
+  ]
+
+
+_RECORD_DEFAULTS = [dtypes.int64, dtypes.float32, dtypes.string]
+
+
+class ParallelCsvDatasetTest(test_base.DatasetTestBase):
+
+  def _write_file(self, name, lines, compression_type=None, header=False):
+    fn = os.path.join(self.get_temp_dir(), name)
+    contents = "\n".join((["x,y,z"] if header else []) + lines).encode()
+    if compression_type == "GZIP":
+      with gzip.GzipFile(fn, "wb") as f:
+        f.write(contents)
+    else:
+      with open(fn, "wb") as f:
+        f.write(contents)
+    return fn
+
+  def _read(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    batches = []
+    with self.cached_session() as sess:
+      while True:
+        try:
+          batches.append([column.tolist() for column in sess.run(get_next)])
+        except errors.OutOfRangeError:
+          return batches
+
+  def _assertReadsLikeBatchedCsv(self, filenames, batch_size, **kwargs):
+    expected = self._read(
+        experimental_readers.CsvDataset(filenames, _RECORD_DEFAULTS,
+                                        **kwargs).batch(batch_size))
+    for num_parallel_calls in [1, 4]:
+      dataset = readers.ParallelCsvDataset(
+          filenames,
+          _RECORD_DEFAULTS,
+          batch_size,
+          num_parallel_calls=num_parallel_calls,
+          **kwargs)
+      self.assertEqual(expected, self._read(dataset))
+
+  def testReadsBatches(self):
+    filenames = [
+        self._write_file("a.csv", _lines(50)),
+        self._write_file("b.csv", _lines(23)),
+        self._write_file("empty.csv", []),
+    ]
+    for buffer_size in [7, 64, 1 << 20]:
+      for batch_size in [1, 10, 100]:
+        self._assertReadsLikeBatchedCsv(
+            filenames, batch_size, buffer_size=buffer_size)
+
+  def testHeaderAndCompression(self):
+    filenames = [
+        self._write_file(
+            "a.csv.gz", _lines(40), compression_type="GZIP", header=True),
+        self._write_file(
+            "b.csv.gz", _lines(5), compression_type="GZIP", header=True),
+    ]
+    self._assertReadsLikeBatchedCsv(
+        filenames, 8, buffer_size=16, header=True, compression_type="GZIP")
+
+  def testMalformedRecordFailsBatch(self):
+    lines = _lines(20)
+    lines[5] = "x,1,y"
+    fn = self._write_file("a.csv", lines)
+    dataset = readers.ParallelCsvDataset(
+        [fn], _RECORD_DEFAULTS, 4, buffer_size=16)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.cached_session() as sess:
+      self.assertEqual([0, 1, 2, 3], sess.run(get_next)[0].tolist())
+      with self.assertRaisesOpError("not a valid int64"):
+        sess.run(get_next)
+      self.assertEqual([6, 7, 8, 9], sess.run(get_next)[0].tolist())
+
+  def testInvalidArguments(self):
+    fn = self._write_file("a.csv", _lines(3))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(readers.ParallelCsvDataset([fn], _RECORD_DEFAULTS, 0))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(
+          readers.ParallelCsvDataset(
+              [fn], _RECORD_DEFAULTS, 2, num_parallel_calls=0))
+
+
+class ParallelCsvDatasetSerializationTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def testCore(self):
+    filenames = []
+    for i, num_lines in enumerate([30, 17]):
+      fn = os.path.join(self.get_temp_dir(), "%d.csv" % i)
+      with open(fn, "w") as f:
+        f.write("\n".join(["x,y,z"] + _lines(num_lines)))
+      filenames.append(fn)
+    self.run_core_tests(
+        lambda: readers.ParallelCsvDataset(
+            filenames, _RECORD_DEFAULTS, 4, buffer_size=32, header=True),
+        lambda: readers.ParallelCsvDataset(
+            filenames, _RECORD_DEFAULTS, 3, buffer_size=32, header=True),
+        12)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,154 @@
+#  Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for SpillingShuffleDatasetOp."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from tensorflow.contrib.data.python.ops import shuffle_ops
+from tensorflow.python.data.experimental.kernel_tests.serialization import dataset_serialization_test_base
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+def _build_dataset(num_elements, buffer_size, memory_limit, spill_directory,
+                   compression_type=None, seed=None):
+  return dataset_ops.Dataset.range(num_elements).map(
+      lambda x: (x, string_ops.as_string(x))).apply(
+          shuffle_ops.spilling_shuffle(
+              buffer_size,
+              memory_limit,
+              spill_directory,
+              compression_type=compression_type,
+              seed=seed))
+
+
+class SpillingShuffleDatasetTest(test_base.DatasetTestBase):
+
+  def setUp(self):
+    super(SpillingShuffleDatasetTest, self).setUp()
+    self._spill_directory = os.path.join(self.get_temp_dir(), "spill")
+
+  def _read(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    elements = []
+    with self.cached_session() as sess:
+      while True:
+        try:
+          x, s = sess.run(get_next)
+        except errors.OutOfRangeError:
+          return elements
+        self.assertEqual(str(x).encode(), s)
+        elements.append(x)
+
+  def testShuffleInMemory(self):
+    dataset = _build_dataset(100, 100, 1 << 20, self._spill_directory, seed=7)
+    elements = self._read(dataset)
+    self.assertItemsEqual(range(100), elements)
+    self.assertNotEqual(list(range(100)), elements)
+    self.assertEqual([], os.listdir(self._spill_directory))
+
+  def testShuffleWithSpilling(self):
+    for compression_type in [None, "ZLIB", "GZIP", "SNAPPY"]:
+      # Each element takes more than 16 bytes, so the elements are spilled in
+      # runs of one element.
+      dataset = _build_dataset(
+          100, 100, 16, self._spill_directory, compression_type, seed=7)
+      elements = self._read(dataset)
+      self.assertItemsEqual(range(100), elements)
+      self.assertNotEqual(list(range(100)), elements)
+      # The runs are deleted once they have been read.
+      self.assertEqual([], os.listdir(self._spill_directory))
+
+  def testWindows(self):
+    dataset = _build_dataset(95, 10, 100, self._spill_directory, seed=7)
+    elements = self._read(dataset)
+    for i in range(0, 95, 10):
+      self.assertItemsEqual(range(i, min(i + 10, 95)), elements[i:i + 10])
+
+  def testSeed(self):
+    elements = self._read(
+        _build_dataset(50, 50, 100, self._spill_directory, seed=7))
+    self.assertEqual(
+        elements,
+        self._read(_build_dataset(50, 50, 100, self._spill_directory, seed=7)))
+    self.assertNotEqual(
+        elements,
+        self._read(_build_dataset(50, 50, 100, self._spill_directory, seed=8)))
+
+  def testInvalidArguments(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(_build_dataset(10, 0, 100, self._spill_directory))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(_build_dataset(10, 10, 0, self._spill_directory))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._read(
+          _build_dataset(10, 10, 100, self._spill_directory, "BZIP2"))
+
+
+class SpillingShuffleDatasetSerializationTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def testCore(self):
+    spill_directory = os.path.join(self.get_temp_dir(), "spill")
+    for memory_limit in [1 << 20, 64]:
+      # pylint: disable=cell-var-from-loop
+      self.run_core_tests(
+          lambda: _build_dataset(
+              20, 8, memory_limit, spill_directory, seed=55),
+          lambda: _build_dataset(
+              20, 8, memory_limit, spill_directory, seed=10),
+          20)
+      # pylint: enable=cell-var-from-loop
+
+  def testSpillFilesOfEarlierCheckpointsAreDeleted(self):
+    # The checkpoint saved after 3 elements refers to the runs of the first
+    # window. Saving the exhausted iterator deletes them, and the restored
+    # iterator deletes the runs it writes itself once they have been read.
+    spill_directory = os.path.join(self.get_temp_dir(), "restored_spill")
+    outputs = self.gen_outputs(
+        lambda: _build_dataset(20, 8, 64, spill_directory, seed=55), [3], 20,
+        verify_exhausted=True)
+    self.assertEqual(20, len(outputs))
+    self.assertEqual([], os.listdir(spill_directory))
+
+  def testRestoreCheckpointTwice(self):
+    # The spill files are kept for as long as the checkpoint refers to them.
+    spill_directory = os.path.join(self.get_temp_dir(), "restored_twice")
+
+    def ds_fn():
+      return _build_dataset(20, 8, 64, spill_directory, seed=55)
+
+    expected = self.gen_outputs(ds_fn, [], 20, verify_exhausted=False)
+    self.gen_outputs(ds_fn, [], 3, verify_exhausted=False)
+    self.assertNotEqual([], os.listdir(spill_directory))
+    for _ in range(2):
+      actual = self.gen_outputs(
+          ds_fn, [],
+          17,
+          ckpt_saved=True,
+          verify_exhausted=True,
+          save_checkpoint_at_end=False)
+      self.match(expected[3:], actual)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,52 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Caching dataset transformations."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+
+
+def compressed_cache(filename=""):
+  """Caches the elements of a `Dataset`, compressed with snappy.
+
+  Like `tf.data.Dataset.cache`, the first iteration over the dataset stores
+  its elements in memory, or in files if `filename` is given, and later
+  iterations read them back from the cache. Each element is compressed before
+  it is cached, which trades some CPU time for a smaller cache:
+
+  ```python
+  dataset = dataset.apply(tf.contrib.data.compressed_cache())
+  ```
+
+  A cache file written with `compressed_cache()` can only be read with
+  `compressed_cache()`, and a cache file written with `tf.data.Dataset.cache`
+  can only be read with `tf.data.Dataset.cache`.
+
+  Args:
+    filename: (Optional.) A `tf.string` scalar `tf.Tensor`, representing the
+      name of a directory on the filesystem to use for caching. If not
+      provided, the dataset is cached in memory.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return dataset_ops.CacheDataset(dataset, filename, compression="SNAPPY")
+
+  return _apply_fn
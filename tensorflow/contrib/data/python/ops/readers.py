@@ -22,10 +22,13 @@ from tensorflow.python.data.experimental.ops import readers
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import random_seed
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import gen_experimental_dataset_ops
+from tensorflow.python.ops import parsing_ops
 from tensorflow.python.util import deprecation
 
 
@@ -369,6 +372,235 @@ class SqlDataset(readers.SqlDataset):
         driver_name, data_source_name, query, output_types)
 
 
+class IndexedTFRecordDataset(dataset_ops.DatasetSource):
+  """A `Dataset` reading a range of records from indexed TFRecord files.
+
+  Indexed TFRecord files are uncompressed TFRecord files written with
+  `tf.python_io.TFRecordWriter(path, write_index=True)`, which stores the
+  offset of every record in `path + ".index"`. The records are numbered
+  consecutively across all the files, and any range of them can be read
+  without reading the records before it, so that several readers can share
+  the same files:
+
+  ```python
+  # Each worker reads its own contiguous shard of the records.
+  dataset = tf.contrib.data.IndexedTFRecordDataset(
+      filenames, start=worker_index * shard_size,
+      stop=(worker_index + 1) * shard_size)
+  ```
+
+  With `shuffle=True` the records of the range are produced in a uniformly
+  random order, which shuffles them globally without a shuffle buffer.
+  """
+
+  def __init__(self, filenames, start=0, stop=-1, shuffle=False, seed=None):
+    """Creates an `IndexedTFRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      start: (Optional.) A `tf.int64` scalar, the number of the first record
+        to read.
+      stop: (Optional.) A `tf.int64` scalar, the number of the record after
+        the last record to read, or -1 to read until the end of the last file.
+      shuffle: (Optional.) A `tf.bool` scalar, whether to produce the records
+        in a random order.
+      seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+        random seed that will be used to create the order. See
+        `tf.set_random_seed` for behavior.
+    """
+    super(IndexedTFRecordDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._start = ops.convert_to_tensor(start, dtype=dtypes.int64, name="start")
+    self._stop = ops.convert_to_tensor(stop, dtype=dtypes.int64, name="stop")
+    self._shuffle = ops.convert_to_tensor(
+        shuffle, dtype=dtypes.bool, name="shuffle")
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+
+  def _as_variant_tensor(self):
+    return gen_experimental_dataset_ops.experimental_indexed_tf_record_dataset(
+        self._filenames, self._start, self._stop, self._shuffle, self._seed,
+        self._seed2)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.TensorShape([])
+
+  @property
+  def output_types(self):
+    return dtypes.string
+
+
+class ColumnarDataset(dataset_ops.DatasetSource):
+  """A `Dataset` reading batches of rows from column files.
+
+  A column file stores each column of a table separately, in row groups of
+  up to a fixed number of rows. Only the columns named in `features` are
+  read, and numeric columns are read into the batches without decoding.
+
+  Each element is a dictionary mapping the keys of `features` to a batch of
+  the values of the corresponding columns:
+
+  * A `tf.FixedLenFeature` reads a column with a value of the given shape in
+    each row, as a `tf.Tensor` of shape `[batch] + shape`.
+  * A `tf.VarLenFeature` reads a column with a vector of any length in each
+    row, as a `tf.SparseTensor` of shape `[batch, max length]`.
+
+  Batches do not span row groups, so the last batch of a row group may have
+  fewer than `batch_size` rows.
+  """
+
+  def __init__(self, filenames, features, batch_size):
+    """Creates a `ColumnarDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      features: A `dict` mapping column names to `FixedLenFeature` or
+        `VarLenFeature` values. The `default_value` of a `FixedLenFeature` is
+        ignored.
+      batch_size: A `tf.int64` scalar, the maximum number of rows of each
+        batch.
+    """
+    super(ColumnarDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._dense_keys = []
+    self._dense_types = []
+    self._dense_shapes = []
+    self._sparse_keys = []
+    self._sparse_types = []
+    self._output_classes = {}
+    self._output_types = {}
+    self._output_shapes = {}
+    for key in sorted(features):
+      feature = features[key]
+      if isinstance(feature, parsing_ops.FixedLenFeature):
+        shape = tensor_shape.as_shape(feature.shape)
+        self._dense_keys.append(key)
+        self._dense_types.append(feature.dtype)
+        self._dense_shapes.append(shape)
+        self._output_classes[key] = ops.Tensor
+        self._output_shapes[key] = tensor_shape.vector(None).concatenate(shape)
+      elif isinstance(feature, parsing_ops.VarLenFeature):
+        self._sparse_keys.append(key)
+        self._sparse_types.append(feature.dtype)
+        self._output_classes[key] = sparse_tensor.SparseTensor
+        self._output_shapes[key] = tensor_shape.matrix(None, None)
+      else:
+        raise ValueError("Unsupported feature for column %s: %s" %
+                         (key, feature))
+      self._output_types[key] = feature.dtype
+
+  def _as_variant_tensor(self):
+    return gen_experimental_dataset_ops.experimental_columnar_dataset(
+        self._filenames,
+        self._batch_size,
+        dense_keys=self._dense_keys,
+        dense_types=self._dense_types,
+        dense_shapes=self._dense_shapes,
+        sparse_keys=self._sparse_keys,
+        sparse_types=self._sparse_types,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._output_classes
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
+class ParallelCsvDataset(readers.CsvDataset):
+  """A `Dataset` reading batches of records from CSV files in parallel.
+
+  The files are read in blocks of `buffer_size` bytes, which are cut after
+  their last complete record and parsed by up to `num_parallel_calls` threads.
+
+  Each element is a tuple with a vector of up to `batch_size` values for each
+  column, in the order of the records in the files; the last batch may have
+  fewer rows. The records and the errors are the same as for
+  `CsvDataset(...).batch(batch_size)`: a malformed record fails the batch that
+  contains it, and the next batch starts after it.
+  """
+
+  def __init__(self,
+               filenames,
+               record_defaults,
+               batch_size,
+               compression_type=None,
+               buffer_size=None,
+               header=False,
+               field_delim=",",
+               use_quote_delim=True,
+               na_value="",
+               select_cols=None,
+               num_parallel_calls=optimization.AUTOTUNE):
+    """Creates a `ParallelCsvDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      record_defaults: The default values of the CSV fields, as for
+        `CsvDataset`.
+      batch_size: A `tf.int64` scalar, the maximum number of records of each
+        batch.
+      compression_type: (Optional.) A `tf.string` scalar evaluating to one of
+        `""` (no compression), `"ZLIB"`, or `"GZIP"`. Defaults to no
+        compression.
+      buffer_size: (Optional.) A `tf.int64` scalar, the number of bytes of the
+        blocks read from the files. Defaults to 4MB.
+      header: (Optional.) A `tf.bool` scalar indicating whether the CSV file(s)
+        have header line(s) that should be skipped when parsing. Defaults to
+        `False`.
+      field_delim: (Optional.) A `tf.string` scalar containing the delimiter
+        character that separates fields in a record. Defaults to `","`.
+      use_quote_delim: (Optional.) A `tf.bool` scalar. If `False`, treats
+        double quotation marks as regular characters inside of string fields.
+        Defaults to `True`.
+      na_value: (Optional.) A `tf.string` scalar indicating a value that will
+        be treated as NA/NaN.
+      select_cols: (Optional.) A sorted list of column indices to select from
+        the input data. Defaults to parsing all columns.
+      num_parallel_calls: (Optional.) A `tf.int64` scalar, the number of
+        blocks to parse in parallel. Defaults to `tf.contrib.data.AUTOTUNE`,
+        which uses the number of schedulable CPUs.
+    """
+    super(ParallelCsvDataset, self).__init__(
+        filenames, record_defaults, compression_type, buffer_size, header,
+        field_delim, use_quote_delim, na_value, select_cols)
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._num_parallel_calls = ops.convert_to_tensor(
+        num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
+    self._output_shapes = tuple(
+        tensor_shape.vector(None) for _ in self._output_types)
+
+  def _as_variant_tensor(self):
+    return gen_experimental_dataset_ops.experimental_parallel_csv_dataset(
+        filenames=self._filenames,
+        record_defaults=self._record_defaults,
+        buffer_size=self._buffer_size,
+        header=self._header,
+        output_shapes=self._output_shapes,
+        field_delim=self._field_delim,
+        use_quote_delim=self._use_quote_delim,
+        na_value=self._na_value,
+        select_cols=self._select_cols,
+        compression_type=self._compression_type,
+        batch_size=self._batch_size,
+        num_parallel_calls=self._num_parallel_calls)
+
+
 class LMDBDataset(dataset_ops.DatasetSource):
   """A LMDB Dataset that reads the lmdb file."""
 
@@ -18,6 +18,11 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import random_seed
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util import deprecation
 
 
@@ -52,3 +57,101 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     `tf.data.Dataset.apply`.
   """
   return shuffle_ops.shuffle_and_repeat(buffer_size, count, seed)
+
+
+def spilling_shuffle(buffer_size,
+                     memory_limit,
+                     spill_directory,
+                     compression_type=None,
+                     seed=None):
+  """Shuffles a `Dataset` with a buffer that can be larger than memory.
+
+  The input is shuffled in windows of `buffer_size` consecutive elements, and
+  the elements of each window are produced in a uniformly random order. Only
+  up to about `memory_limit` bytes of elements are kept in memory: the others
+  are written to files in `spill_directory`, and read back sequentially.
+
+  ```python
+  dataset = dataset.apply(tf.contrib.data.spilling_shuffle(
+      buffer_size=10000000, memory_limit=8 << 30,
+      spill_directory="/tmp/shuffle"))
+  ```
+
+  Unlike `tf.data.Dataset.shuffle`, elements are not shuffled across windows,
+  and the first element of a window is only produced after the whole window
+  has been read. Each iterator of the dataset produces a different order.
+
+  The files are deleted once they have been read or the iterator is destroyed,
+  except for the files that the latest saved checkpoint of the iterator refers
+  to. These are kept until the iterator saves a checkpoint that no longer
+  refers to them, so only the latest checkpoint of an iterator can be restored,
+  and only on the same machine.
+
+  Args:
+    buffer_size: A `tf.int64` scalar `tf.Tensor`, the number of consecutive
+      elements that are shuffled together.
+    memory_limit: A `tf.int64` scalar `tf.Tensor`, the number of bytes of
+      elements to keep in memory before writing them to `spill_directory`.
+    spill_directory: A `tf.string` scalar `tf.Tensor`, a directory on local
+      disk.
+    compression_type: (Optional.) A `tf.string` scalar evaluating to one of
+      `""` (no compression), `"ZLIB"`, `"GZIP"` or `"SNAPPY"`, the compression
+      of the files written to `spill_directory`.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      random seed that will be used to create the distribution. See
+      `tf.set_random_seed` for behavior.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return _SpillingShuffleDataset(dataset, buffer_size, memory_limit,
+                                   spill_directory, compression_type, seed)
+
+  return _apply_fn
+
+
+class _SpillingShuffleDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that shuffles its input, spilling it to disk as needed."""
+
+  def __init__(self, input_dataset, buffer_size, memory_limit,
+               spill_directory, compression_type, seed):
+    """See `spilling_shuffle()` for details."""
+    super(_SpillingShuffleDataset, self).__init__(input_dataset)
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+    self._memory_limit = ops.convert_to_tensor(
+        memory_limit, dtype=dtypes.int64, name="memory_limit")
+    self._spill_directory = ops.convert_to_tensor(
+        spill_directory, dtype=dtypes.string, name="spill_directory")
+    self._compression_type = ops.convert_to_tensor(
+        "" if compression_type is None else compression_type,
+        dtype=dtypes.string,
+        name="compression_type")
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+
+  def _as_variant_tensor(self):
+    return gen_experimental_dataset_ops.experimental_spilling_shuffle_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        self._buffer_size,
+        self._memory_limit,
+        self._spill_directory,
+        self._compression_type,
+        self._seed,
+        self._seed2,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
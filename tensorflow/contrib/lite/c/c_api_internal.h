@@ -98,6 +98,30 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src);
 // Free memory of array `v`.
 void TfLiteIntArrayFree(TfLiteIntArray* v);
 
+// Fixed size list of floats. Used for per-channel quantization.
+typedef struct {
+  int size;
+// gcc 6.1+ have a bug where flexible members aren't properly handled
+// https://github.com/google/re2/commit/b94b7cd42e9f02673cd748c1ac1d16db4052514c
+#if !defined(__clang__) && defined(__GNUC__) && __GNUC__ == 6 && \
+    __GNUC_MINOR__ >= 1
+  float data[0];
+#else
+  float data[];
+#endif
+} TfLiteFloatArray;
+
+// Given the size (number of elements) in a TfLiteFloatArray, calculate its
+// size in bytes.
+int TfLiteFloatArrayGetSizeInBytes(int size);
+
+// Create a array of a given `size` (uninitialized entries).
+// This returns a pointer, that you must free using TfLiteFloatArrayFree().
+TfLiteFloatArray* TfLiteFloatArrayCreate(int size);
+
+// Free memory of array `a`.
+void TfLiteFloatArrayFree(TfLiteFloatArray* a);
+
 // Since we must not depend on any libraries, define a minimal subset of
 // error macros while avoiding names that have pre-conceived meanings like
 // assert and check.
@@ -176,6 +200,35 @@ typedef struct {
   int32_t zero_point;
 } TfLiteQuantizationParams;
 
+// Supported quantization schemes for the `quantization` field of a tensor.
+typedef enum {
+  // No quantization beyond what is described by `params`.
+  kTfLiteNoQuantization = 0,
+  // Affine quantization with one (scale, zero_point) pair per slice along
+  // `quantized_dimension`. The `params` member of TfLiteQuantization points to
+  // a TfLiteAffineQuantization.
+  kTfLiteAffineQuantization = 1,
+} TfLiteQuantizationType;
+
+// Parameters for per-axis (per-channel) asymmetric quantization. Slice `i`
+// along `quantized_dimension` is converted back to float using:
+//    real_value = scale->data[i] * (quantized_value - zero_point->data[i]);
+typedef struct {
+  TfLiteFloatArray* scale;
+  TfLiteIntArray* zero_point;
+  int32_t quantized_dimension;
+} TfLiteAffineQuantization;
+
+// Structured quantization information. The memory pointed to by `params` is
+// owned by the tensor and released by TfLiteQuantizationFree().
+typedef struct {
+  TfLiteQuantizationType type;
+  void* params;
+} TfLiteQuantization;
+
+// Free memory held by `quantization` and reset it to kTfLiteNoQuantization.
+void TfLiteQuantizationFree(TfLiteQuantization* quantization);
+
 // A union of pointers that points to memory for a given tensor.
 typedef union {
   int* i32;
@@ -256,6 +309,12 @@ typedef struct {
 
   // True if the tensor is a variable.
   bool is_variable;
+
+  // Per-channel quantization information. When its type is
+  // kTfLiteNoQuantization, `params` above fully describes the quantization.
+  // Otherwise `params` mirrors the parameters of the first channel, for
+  // kernels that don't support per-channel quantization.
+  TfLiteQuantization quantization;
 } TfLiteTensor;
 
 // Free data memory of tensor `t`;
@@ -264,7 +323,9 @@ void TfLiteTensorDataFree(TfLiteTensor* t);
 // Free memory of tensor `t`;
 void TfLiteTensorFree(TfLiteTensor* t);
 
-// Set all of a tensor's fields (and free any previously allocated data).
+// Set all of a tensor's fields (and free any previously allocated data and
+// dims). The per-channel `quantization` is not among them and is kept; it is
+// released by TfLiteTensorFree() or TfLiteQuantizationFree().
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
                        TfLiteQuantizationParams quantization, char* buffer,
                        size_t size, TfLiteAllocationType allocation_type,
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/contrib/lite/c/c_api_internal.h"
+#include <stdlib.h>
 #include <gtest/gtest.h>
 
 namespace tflite {
@@ -65,6 +66,52 @@ TEST(IntArray, TestIntArrayEqual) {
   TfLiteIntArrayFree(d);
 }
 
+TEST(FloatArray, TestFloatArrayCreate) {
+  TfLiteFloatArray* a = TfLiteFloatArrayCreate(0);
+  TfLiteFloatArray* b = TfLiteFloatArrayCreate(3);
+  ASSERT_EQ(a->size, 0);
+  ASSERT_EQ(b->size, 3);
+  TfLiteFloatArrayFree(a);
+  TfLiteFloatArrayFree(b);
+}
+
+TEST(Quantization, TestQuantizationFree) {
+  TfLiteAffineQuantization* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(
+          malloc(sizeof(TfLiteAffineQuantization)));
+  affine_quantization->scale = TfLiteFloatArrayCreate(2);
+  affine_quantization->zero_point = TfLiteIntArrayCreate(2);
+  affine_quantization->quantized_dimension = 0;
+
+  TfLiteTensor tensor = {};
+  tensor.quantization.type = kTfLiteAffineQuantization;
+  tensor.quantization.params = affine_quantization;
+  TfLiteTensorFree(&tensor);
+  EXPECT_EQ(tensor.quantization.type, kTfLiteNoQuantization);
+  EXPECT_EQ(tensor.quantization.params, nullptr);
+}
+
+TEST(Quantization, TestTensorResetKeepsQuantization) {
+  TfLiteAffineQuantization* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(
+          malloc(sizeof(TfLiteAffineQuantization)));
+  affine_quantization->scale = TfLiteFloatArrayCreate(2);
+  affine_quantization->zero_point = TfLiteIntArrayCreate(2);
+  affine_quantization->quantized_dimension = 0;
+
+  TfLiteTensor tensor = {};
+  tensor.dims = TfLiteIntArrayCreate(1);
+  tensor.quantization.type = kTfLiteAffineQuantization;
+  tensor.quantization.params = affine_quantization;
+  TfLiteTensorReset(kTfLiteUInt8, "", TfLiteIntArrayCreate(2),
+                    TfLiteQuantizationParams(), nullptr, 0, kTfLiteArenaRw,
+                    nullptr, false, &tensor);
+  EXPECT_EQ(tensor.dims->size, 2);
+  EXPECT_EQ(tensor.quantization.type, kTfLiteAffineQuantization);
+  EXPECT_EQ(tensor.quantization.params, affine_quantization);
+  TfLiteTensorFree(&tensor);
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
@@ -67,6 +67,22 @@ constexpr int32_t kMinSdkVersionForNNAPI = 27;
 constexpr int32_t kMinSdkVersionForNNAPI11 = 28;
 static const int32_t kAndroidSdkVersion = GetAndroidSdkVersion();
 
+// Returns true if an input or output of `node` is quantized per channel. NN API
+// tensors have a single scale and zero point, so such nodes are left to the
+// TF Lite kernels.
+bool HasPerChannelQuantizedTensor(const TfLiteContext* context,
+                                  const TfLiteNode* node) {
+  for (const TfLiteIntArray* tensors : {node->inputs, node->outputs}) {
+    for (int tensor_index : TfLiteIntArrayView(tensors)) {
+      if (tensor_index != kOptionalTensor &&
+          IsPerChannelQuantized(&context->tensors[tensor_index])) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 // RAII NN API Model Destructor for use with std::unique_ptr
@@ -262,6 +278,11 @@ class NNAPIOpBuilder {
     float scale = 0.0f;
     int32_t zeroPoint = 0;
     TfLiteTensor* tensor = &context_->tensors[tensor_index];
+    if (IsPerChannelQuantized(tensor)) {
+      context_->ReportError(
+          context_, "NN API doesn't support per-channel quantized tensors.\n");
+      return kTfLiteError;
+    }
     switch (tensor->type) {
       case kTfLiteNoType:
         // Tensors added during initialization of Ops don't have a type yet and
@@ -1163,7 +1184,8 @@ TfLiteDelegate* NnApiDelegate() {
           TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
               context, node_index, &node, &registration));
           NNAPIDelegateKernel dummy_kernel;
-          if (dummy_kernel.Map(context, registration->builtin_code,
+          if (!HasPerChannelQuantizedTensor(context, node) &&
+              dummy_kernel.Map(context, registration->builtin_code,
                                registration->version, node)) {
             supported_nodes.push_back(node_index);
           }
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/delegates/nnapi/nnapi_delegate.h"
+#include <algorithm>
+#include <cmath>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/interpreter.h"
 #include "tensorflow/contrib/lite/kernels/test_util.h"
@@ -354,6 +356,102 @@ TEST(NNAPIDelegate, Conv2DWithNoActivation) {
                              }));
 }
 
+// A quantized convolution whose constant filter and bias are quantized per
+// output channel, which NN API can't represent.
+class PerChannelQuantizedConvolutionOpModel : public SingleOpModelWithNNAPI {
+ public:
+  PerChannelQuantizedConvolutionOpModel(const TensorData& input,
+                                        const std::vector<int>& filter_shape,
+                                        const std::vector<float>& filter,
+                                        const std::vector<float>& bias,
+                                        const TensorData& output) {
+    input_ = AddInput(input);
+
+    const int num_channels = filter_shape[0];
+    const int channel_size = filter.size() / num_channels;
+    std::vector<float> filter_scales(num_channels);
+    std::vector<int64_t> filter_zero_points(num_channels);
+    std::vector<uint8_t> quantized_filter(filter.size());
+    std::vector<float> bias_scales(num_channels);
+    std::vector<int64_t> bias_zero_points(num_channels, 0);
+    std::vector<int32_t> quantized_bias(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      auto begin = filter.begin() + c * channel_size;
+      auto end = begin + channel_size;
+      const float f_min = std::min(*std::min_element(begin, end), 0.0f);
+      const float f_max = std::max(*std::max_element(begin, end), 0.0f);
+      filter_scales[c] = (f_max - f_min) / 255.0f;
+      filter_zero_points[c] = std::round(-f_min / filter_scales[c]);
+      for (int i = c * channel_size; i < (c + 1) * channel_size; ++i) {
+        quantized_filter[i] = static_cast<uint8_t>(
+            std::round(filter[i] / filter_scales[c]) + filter_zero_points[c]);
+      }
+      bias_scales[c] = GetScale(input_) * filter_scales[c];
+      quantized_bias[c] = std::round(bias[c] / bias_scales[c]);
+    }
+
+    AddPerChannelQuantizedConstInput(TensorType_UINT8, filter_shape,
+                                     /*quantized_dimension=*/0, filter_scales,
+                                     filter_zero_points, quantized_filter);
+    AddPerChannelQuantizedConstInput(TensorType_INT32, {num_channels},
+                                     /*quantized_dimension=*/0, bias_scales,
+                                     bias_zero_points, quantized_bias);
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, 2, 2,
+                                     ActivationFunctionType_NONE)
+                     .Union());
+    BuildInterpreter({GetShape(input_), {}, {}});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<uint8_t>(input_, data);
+  }
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int input_;
+  int output_;
+};
+
+// The convolution stays on the TF Lite kernels. With the scale of the first
+// channel, the third filter would be clamped to [0, 4].
+TEST(NNAPIDelegate, Conv2DPerChannelQuantized) {
+  PerChannelQuantizedConvolutionOpModel m(
+      {TensorType_UINT8, {2, 2, 4, 1}, -63.5, 64}, {3, 2, 2, 1},
+      {
+          1, 2, 3, 4,                // first 2x2 filter
+          -0.01, 0.01, -0.01, 0.01,  // second 2x2 filter
+          -10, -10, 10, 10,          // third 2x2 filter
+      },
+      {1, 0.02, 3}, {TensorType_UINT8, {}, -63.5, 64});
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      18, 0.02, 23,  // first batch, left
+                      18, 0.02, 23,  // first batch, right
+                      17, 0.04, 3,   // second batch, left
+                      37, 0.04, 3,   // second batch, right
+                  },
+                  0.5)));
+}
+
 class DepthwiseConvolutionOpModel : public SingleOpModelWithNNAPI {
  public:
   DepthwiseConvolutionOpModel(const TensorData& input, const TensorData& filter,
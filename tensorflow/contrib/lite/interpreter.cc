@@ -886,6 +886,7 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TfLiteQuantizationFree(&tensor.quantization);
   if (type == tensor.type &&
       EqualArrayAndTfLiteIntArray(tensor.dims, rank, dims)) {
     // Fast path which does not invalidate the invokable property.
@@ -941,10 +942,25 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
     allocation_type = kTfLiteArenaRwPersistent;
   }
 
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TfLiteQuantizationFree(&tensor.quantization);
   TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(rank, dims),
                     quantization,
                     /*buffer=*/nullptr, required_bytes, allocation_type,
-                    nullptr, is_variable, &context_.tensors[tensor_index]);
+                    nullptr, is_variable, &tensor);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetTensorQuantization(
+    int tensor_index, TfLiteQuantization quantization) {
+  if (tensor_index < 0 || tensor_index >= context_.tensors_size) {
+    TfLiteQuantizationFree(&quantization);
+    ReportError(&context_, "Invalid tensor index %d.", tensor_index);
+    return kTfLiteError;
+  }
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TfLiteQuantizationFree(&tensor.quantization);
+  tensor.quantization = quantization;
   return kTfLiteOk;
 }
 
@@ -162,7 +162,8 @@ class Interpreter {
   // Set description of inputs/outputs/data/fptrs for node `node_index`.
   // This variant assumes an external buffer has been allocated of size
   // bytes. The lifetime of buffer must be ensured to be greater or equal
-  // to Interpreter.
+  // to Interpreter. Any per-channel quantization of the tensor is released,
+  // and can be set again with SetTensorQuantization().
   inline TfLiteStatus SetTensorParametersReadOnly(
       int tensor_index, TfLiteType type, const char* name,
       const std::vector<int>& dims, TfLiteQuantizationParams quantization,
@@ -181,7 +182,8 @@ class Interpreter {
   // Set description of inputs/outputs/data/fptrs for node `node_index`.
   // This variant assumes an external buffer has been allocated of size
   // bytes. The lifetime of buffer must be ensured to be greater or equal
-  // to Interpreter.
+  // to Interpreter. Any per-channel quantization of the tensor is released,
+  // and can be set again with SetTensorQuantization().
   inline TfLiteStatus SetTensorParametersReadWrite(
       int tensor_index, TfLiteType type, const char* name,
       const std::vector<int>& dims, TfLiteQuantizationParams quantization,
@@ -194,6 +196,12 @@ class Interpreter {
       const int* dims, TfLiteQuantizationParams quantization,
       bool is_variable = false);
 
+  // Set the per-channel quantization of tensor `tensor_index`, releasing any
+  // previously set one. The tensor takes ownership of the malloc'ed memory in
+  // `quantization` (see TfLiteQuantizationFree()), also when this fails.
+  TfLiteStatus SetTensorQuantization(int tensor_index,
+                                     TfLiteQuantization quantization);
+
   // Functions to access tensor data
 
   // Read only access to list of inputs.
@@ -292,6 +292,36 @@ TEST(BasicInterpreter, BufferAccess) {
   ASSERT_EQ(interpreter.typed_tensor<float>(0), interpreter.tensor(0)->data.f);
 }
 
+// Redefining a tensor with a single set of quantization parameters drops its
+// per-channel quantization, whether or not its type and shape change.
+TEST(BasicInterpreter, SetTensorParametersReleasesPerChannelQuantization) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  const char buffer[3] = {};
+  for (const std::vector<int>& dims :
+       std::vector<std::vector<int>>{{2}, {2}, {3}}) {
+    TfLiteAffineQuantization* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            malloc(sizeof(TfLiteAffineQuantization)));
+    affine_quantization->scale = TfLiteFloatArrayCreate(2);
+    affine_quantization->zero_point = TfLiteIntArrayCreate(2);
+    affine_quantization->quantized_dimension = 0;
+    TfLiteQuantization quantization;
+    quantization.type = kTfLiteAffineQuantization;
+    quantization.params = affine_quantization;
+    ASSERT_EQ(interpreter.SetTensorQuantization(0, quantization), kTfLiteOk);
+    EXPECT_EQ(interpreter.tensor(0)->quantization.type,
+              kTfLiteAffineQuantization);
+
+    ASSERT_EQ(interpreter.SetTensorParametersReadOnly(
+                  0, kTfLiteUInt8, "", dims, TfLiteQuantizationParams(),
+                  buffer, dims[0]),
+              kTfLiteOk);
+    EXPECT_EQ(interpreter.tensor(0)->quantization.type, kTfLiteNoQuantization);
+    EXPECT_EQ(interpreter.tensor(0)->quantization.params, nullptr);
+  }
+}
+
 TEST(BasicInterpreter, NoOpInterpreter) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
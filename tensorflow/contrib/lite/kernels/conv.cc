@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/c/builtin_op_data.h"
 #include "tensorflow/contrib/lite/c/c_api_internal.h"
@@ -63,12 +64,19 @@ struct OpData {
   int hwcn_weights_id = kTensorNotAllocated;
   int input_quantized_id = kTensorNotAllocated;
   int scaling_factors_id = kTensorNotAllocated;
+  int accum_scratch_id = kTensorNotAllocated;
 
   TfLitePaddingValues padding;
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // When the filter is quantized per output channel, the same quantities
+  // for each channel, along with the channel's filter offset. The shifts are
+  // left shifts, i.e. negative values shift right.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int32_t> per_channel_output_shift;
+  std::vector<int32_t> per_channel_filter_offset;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -79,9 +87,11 @@ struct OpData {
   int32_t hwcn_weights_index;
   int32_t input_quantized_index;
   int32_t scaling_factors_index;
+  int32_t accum_scratch_index;
   bool need_hwcn_weights;
   bool have_weights_been_transposed;
   bool need_im2col;
+  bool need_accum_scratch;
 
   bool run_multithreaded_kernel;
 };
@@ -130,7 +140,8 @@ void TransposeFloatTensor(TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
-// Allocate temporary tensors (`im2col`, `hwcn_weights` if necessary).
+// Allocate temporary tensors (`im2col`, `hwcn_weights`, `accum_scratch` if
+// necessary).
 // Note: `context->AddTensors` might invalidate pointers to existing tensors.
 // Therefore the logic to add tensors are isolated into this function.
 static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
@@ -167,6 +178,11 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // we're running with that data type.
   data->need_hwcn_weights = (input->type == kTfLiteFloat32 &&
                              data->run_multithreaded_kernel && !is_hybrid);
+  // Filters quantized per output channel are multiplied into int32
+  // accumulators with the shape of the output, which are then requantized
+  // channel by channel.
+  data->need_accum_scratch = (input->type == kTfLiteUInt8 &&
+                              GetAffineQuantization(filter) != nullptr);
 
   int temporaries_count = 0;
   if (data->need_im2col) {
@@ -183,6 +199,14 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     }
     ++temporaries_count;
   }
+  if (data->need_accum_scratch) {
+    data->accum_scratch_index = temporaries_count;
+    if (data->accum_scratch_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(
+          context, context->AddTensors(context, 1, &data->accum_scratch_id));
+    }
+    ++temporaries_count;
+  }
 
   if (is_hybrid) {
     // Allocate tensor to store the on-the-fly quantized inputs.
@@ -253,6 +277,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const bool is_hybrid =
       (input->type == kTfLiteFloat32 && filter->type == kTfLiteUInt8);
 
+  // Hybrid kernels don't support per-channel quantized filters yet.
+  TF_LITE_ENSURE(context, !is_hybrid || !GetAffineQuantization(filter));
+
   data->run_multithreaded_kernel = context->recommended_num_threads != 1;
   // Hybrid kernels don't support multithreading yet.
   if (is_hybrid) {
@@ -299,6 +326,25 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Note that full fixed-point inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (input_type != kTfLiteFloat32) {
+    if (GetAffineQuantization(filter)) {
+      std::vector<double> real_multipliers;
+      TF_LITE_ENSURE_STATUS(GetPerChannelQuantizedConvolutionMultipliers(
+          context, input, filter, bias, output, /*filter_channel_dim=*/0,
+          &real_multipliers, &data->per_channel_filter_offset));
+      data->per_channel_output_multiplier.resize(channels_out);
+      data->per_channel_output_shift.resize(channels_out);
+      for (int c = 0; c < channels_out; ++c) {
+        int exponent;
+        QuantizeMultiplier(real_multipliers[c],
+                           &data->per_channel_output_multiplier[c], &exponent);
+        data->per_channel_output_shift[c] = exponent;
+      }
+    } else {
+      data->per_channel_output_multiplier.clear();
+      data->per_channel_output_shift.clear();
+      data->per_channel_filter_offset.clear();
+    }
+
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -368,6 +414,20 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     data->have_weights_been_transposed = false;
   }
 
+  if (data->need_accum_scratch) {
+    node->temporaries->data[data->accum_scratch_index] =
+        data->accum_scratch_id;
+    TfLiteTensor* accum_scratch =
+        GetTemporary(context, node, data->accum_scratch_index);
+    accum_scratch->type = kTfLiteInt32;
+    accum_scratch->allocation_type = kTfLiteArenaRw;
+    if (!TfLiteIntArrayEqual(accum_scratch->dims, output_size)) {
+      TfLiteIntArray* accum_scratch_size = TfLiteIntArrayCopy(output_size);
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, accum_scratch,
+                                                       accum_scratch_size));
+    }
+  }
+
   if (is_hybrid) {
     node->temporaries->data[data->input_quantized_index] =
         data->input_quantized_id;
@@ -425,6 +485,45 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
     effective_kernel_type = kernel_type;
   }
 
+  if (!data->per_channel_output_multiplier.empty()) {
+    TfLiteTensor* accum_scratch =
+        GetTemporary(context, node, data->accum_scratch_index);
+    ConvParams op_params;
+    op_params.padding_type = PaddingType::kSame;
+    op_params.padding_values.width = data->padding.width;
+    op_params.padding_values.height = data->padding.height;
+    op_params.stride_width = params->stride_width;
+    op_params.stride_height = params->stride_height;
+    op_params.dilation_width_factor = params->dilation_width_factor;
+    op_params.dilation_height_factor = params->dilation_height_factor;
+    op_params.input_offset = input_offset;
+    op_params.output_offset = output_offset;
+    op_params.quantized_activation_min = data->output_activation_min;
+    op_params.quantized_activation_max = data->output_activation_max;
+    if (effective_kernel_type == kReference) {
+      reference_ops::ConvPerChannel(
+          op_params, data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(),
+          data->per_channel_filter_offset.data(), GetTensorShape(input),
+          GetTensorData<uint8_t>(input), GetTensorShape(filter),
+          GetTensorData<uint8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<uint8_t>(output));
+    } else {
+      optimized_ops::ConvPerChannel(
+          op_params, data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(),
+          data->per_channel_filter_offset.data(), GetTensorShape(input),
+          GetTensorData<uint8_t>(input), GetTensorShape(filter),
+          GetTensorData<uint8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<uint8_t>(output), GetTensorShape(im2col),
+          GetTensorData<uint8_t>(im2col), GetTensorShape(accum_scratch),
+          GetTensorData<int32_t>(accum_scratch), gemm_context);
+    }
+    return;
+  }
+
   switch (effective_kernel_type) {
     case kReference: {
       ConvParams op_params;
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
 
 #include <gtest/gtest.h>
@@ -746,6 +748,157 @@ TEST_P(ConvolutionOpTest, SimpleTestQuantizedWithDilation) {
               ElementsAreArray({5, 5, 5, 5, 5, 5, 5, 5, 5}));
 }
 
+// Returns the asymmetric uint8 (scale, zero_point) covering [f_min, f_max].
+std::pair<float, int64_t> ChannelQuantizationParams(float f_min, float f_max) {
+  f_min = std::min(f_min, 0.0f);
+  f_max = std::max(f_max, 0.0f);
+  const float scale = (f_max - f_min) / 255.0f;
+  const int64_t zero_point = std::min<int64_t>(
+      255, std::max<int64_t>(0, std::round(-f_min / scale)));
+  return {scale, zero_point};
+}
+
+// A quantized convolution whose constant filter and bias are quantized per
+// output channel.
+class PerChannelQuantizedConvolutionOpModel : public SingleOpModel {
+ public:
+  PerChannelQuantizedConvolutionOpModel(
+      TfLiteRegistration* registration, const TensorData& input,
+      const std::vector<int>& filter_shape, const std::vector<float>& filter,
+      const std::vector<float>& bias, const TensorData& output,
+      int stride_width = 2, int stride_height = 2) {
+    input_ = AddInput(input);
+
+    const int num_channels = filter_shape[0];
+    const int channel_size = filter.size() / num_channels;
+    std::vector<float> filter_scales(num_channels);
+    std::vector<int64_t> filter_zero_points(num_channels);
+    std::vector<uint8_t> quantized_filter(filter.size());
+    std::vector<float> bias_scales(num_channels);
+    std::vector<int64_t> bias_zero_points(num_channels, 0);
+    std::vector<int32_t> quantized_bias(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      auto begin = filter.begin() + c * channel_size;
+      auto end = begin + channel_size;
+      std::tie(filter_scales[c], filter_zero_points[c]) =
+          ChannelQuantizationParams(*std::min_element(begin, end),
+                                    *std::max_element(begin, end));
+      for (int i = c * channel_size; i < (c + 1) * channel_size; ++i) {
+        quantized_filter[i] = static_cast<uint8_t>(
+            std::round(filter[i] / filter_scales[c]) + filter_zero_points[c]);
+      }
+      bias_scales[c] = GetScale(input_) * filter_scales[c];
+      quantized_bias[c] = std::round(bias[c] / bias_scales[c]);
+    }
+
+    filter_ = AddPerChannelQuantizedConstInput(
+        TensorType_UINT8, filter_shape, /*quantized_dimension=*/0,
+        filter_scales, filter_zero_points, quantized_filter);
+    bias_ = AddPerChannelQuantizedConstInput(
+        TensorType_INT32, {num_channels}, /*quantized_dimension=*/0,
+        bias_scales, bias_zero_points, quantized_bias);
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, stride_width,
+                                     stride_height, ActivationFunctionType_NONE)
+                     .Union());
+
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), {}, {}});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<uint8_t>(input_, data);
+  }
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+// The filter channels have very different ranges, so that a single scale for
+// the whole filter would round the second channel to zero.
+TEST_P(ConvolutionOpTest, SimpleTestPerChannelQuantized) {
+  std::initializer_list<float> input = {
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  };
+  std::initializer_list<float> filter = {
+      1,     2,    3,     4,     // first 2x2 filter
+      -0.01, 0.01, -0.01, 0.01,  // second 2x2 filter
+      -10,   -10,  10,    10,    // third 2x2 filter
+  };
+  std::initializer_list<float> bias = {1, 0.02, 3};
+
+  PerChannelQuantizedConvolutionOpModel quant_op(
+      GetRegistration(), {TensorType_UINT8, {2, 2, 4, 1}, -63.5, 64},
+      {3, 2, 2, 1}, filter, bias, {TensorType_UINT8, {}, -63.5, 64});
+  ConvolutionOpModel float_op(
+      GetRegistration(), {TensorType_FLOAT32, {2, 2, 4, 1}},
+      {TensorType_FLOAT32, {3, 2, 2, 1}}, {TensorType_FLOAT32, {}});
+
+  quant_op.SetInput(input);
+  quant_op.Invoke();
+
+  float_op.SetInput(input);
+  float_op.SetFilter(filter);
+  float_op.SetBias(bias);
+  float_op.Invoke();
+
+  // The quantized result is within one output quantization step of the float
+  // result.
+  EXPECT_THAT(quant_op.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 0.5)));
+}
+
+// A 1x1 filter with unit strides multiplies the input directly, without an
+// im2col buffer.
+TEST_P(ConvolutionOpTest, PointwiseTestPerChannelQuantized) {
+  std::initializer_list<float> input = {
+      1, 2,  3,  -4,  // row = 1
+      5, -6, -7, 8,   // row = 2
+  };
+  std::initializer_list<float> filter = {
+      1,     -2,     // first 1x1 filter
+      -0.01, 0.02,   // second 1x1 filter
+      10,    -10,    // third 1x1 filter
+  };
+  std::initializer_list<float> bias = {1, 0.02, 3};
+
+  PerChannelQuantizedConvolutionOpModel quant_op(
+      GetRegistration(), {TensorType_UINT8, {1, 2, 2, 2}, -63.5, 64},
+      {3, 1, 1, 2}, filter, bias, {TensorType_UINT8, {}, -254, 256},
+      /*stride_width=*/1, /*stride_height=*/1);
+  ConvolutionOpModel float_op(
+      GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 2}},
+      {TensorType_FLOAT32, {3, 1, 1, 2}}, {TensorType_FLOAT32, {}},
+      /*stride_width=*/1, /*stride_height=*/1);
+
+  quant_op.SetInput(input);
+  quant_op.Invoke();
+
+  float_op.SetInput(input);
+  float_op.SetFilter(filter);
+  float_op.SetBias(bias);
+  float_op.Invoke();
+
+  EXPECT_THAT(quant_op.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 2)));
+}
+
 class HybridConvolutionOpModel : public BaseConvolutionOpModel {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/c/builtin_op_data.h"
 #include "tensorflow/contrib/lite/c/c_api_internal.h"
@@ -54,6 +55,12 @@ struct OpData {
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // When the filter is quantized per output channel, the same quantities
+  // for each channel, along with the channel's filter offset. The shifts are
+  // left shifts, i.e. negative values shift right.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int32_t> per_channel_output_shift;
+  std::vector<int32_t> per_channel_filter_offset;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -152,6 +159,25 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (data_type != kTfLiteFloat32) {
+    if (GetAffineQuantization(filter)) {
+      std::vector<double> real_multipliers;
+      TF_LITE_ENSURE_STATUS(GetPerChannelQuantizedConvolutionMultipliers(
+          context, input, filter, bias, output, /*filter_channel_dim=*/3,
+          &real_multipliers, &data->per_channel_filter_offset));
+      data->per_channel_output_multiplier.resize(channels_out);
+      data->per_channel_output_shift.resize(channels_out);
+      for (int c = 0; c < channels_out; ++c) {
+        int exponent;
+        QuantizeMultiplier(real_multipliers[c],
+                           &data->per_channel_output_multiplier[c], &exponent);
+        data->per_channel_output_shift[c] = exponent;
+      }
+    } else {
+      data->per_channel_output_multiplier.clear();
+      data->per_channel_output_shift.clear();
+      data->per_channel_filter_offset.clear();
+    }
+
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -243,6 +269,26 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.output_shift = -data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  if (!data->per_channel_output_multiplier.empty()) {
+    void (*depthwise_conv_per_channel)(
+        const DepthwiseParams&, const int32*, const int32*, const int32*,
+        const RuntimeShape&, const uint8*, const RuntimeShape&, const uint8*,
+        const RuntimeShape&, const int32*, const RuntimeShape&, uint8*);
+    if (kernel_type == kReference) {
+      depthwise_conv_per_channel = &reference_ops::DepthwiseConvPerChannel;
+    } else {
+      depthwise_conv_per_channel = &optimized_ops::DepthwiseConvPerChannel;
+    }
+    depthwise_conv_per_channel(
+        op_params, data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(),
+        data->per_channel_filter_offset.data(), GetTensorShape(input),
+        GetTensorData<uint8_t>(input), GetTensorShape(filter),
+        GetTensorData<uint8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<uint8_t>(output));
+    return;
+  }
   depthwise_conv(op_params, GetTensorShape(input),
                  GetTensorData<uint8_t>(input), GetTensorShape(filter),
                  GetTensorData<uint8_t>(filter), GetTensorShape(bias),
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
@@ -256,6 +258,84 @@ class QuantizedDepthwiseConvolutionOpModel
   }
 };
 
+// A quantized depthwise convolution whose constant filter and bias are
+// quantized per output channel.
+class PerChannelQuantizedDepthwiseConvolutionOpModel : public SingleOpModel {
+ public:
+  PerChannelQuantizedDepthwiseConvolutionOpModel(
+      TfLiteRegistration* registration, const TensorData& input,
+      const std::vector<int>& filter_shape, const std::vector<float>& filter,
+      const std::vector<float>& bias, const TensorData& output,
+      Padding padding_type = Padding_VALID) {
+    input_ = AddInput(input);
+
+    // Filters are [1, height, width, output_channels], so the elements of
+    // channel c are those with index % num_channels == c.
+    const int num_channels = filter_shape[3];
+    std::vector<float> channel_min(num_channels, 0.0f);
+    std::vector<float> channel_max(num_channels, 0.0f);
+    for (int i = 0; i < filter.size(); ++i) {
+      const int c = i % num_channels;
+      channel_min[c] = std::min(channel_min[c], filter[i]);
+      channel_max[c] = std::max(channel_max[c], filter[i]);
+    }
+    std::vector<float> filter_scales(num_channels);
+    std::vector<int64_t> filter_zero_points(num_channels);
+    std::vector<float> bias_scales(num_channels);
+    std::vector<int64_t> bias_zero_points(num_channels, 0);
+    std::vector<int32_t> quantized_bias(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      filter_scales[c] = (channel_max[c] - channel_min[c]) / 255.0f;
+      filter_zero_points[c] = std::min<int64_t>(
+          255,
+          std::max<int64_t>(0, std::round(-channel_min[c] / filter_scales[c])));
+      bias_scales[c] = GetScale(input_) * filter_scales[c];
+      quantized_bias[c] = std::round(bias[c] / bias_scales[c]);
+    }
+    std::vector<uint8_t> quantized_filter(filter.size());
+    for (int i = 0; i < filter.size(); ++i) {
+      const int c = i % num_channels;
+      quantized_filter[i] = static_cast<uint8_t>(
+          std::round(filter[i] / filter_scales[c]) + filter_zero_points[c]);
+    }
+
+    filter_ = AddPerChannelQuantizedConstInput(
+        TensorType_UINT8, filter_shape, /*quantized_dimension=*/3,
+        filter_scales, filter_zero_points, quantized_filter);
+    bias_ = AddPerChannelQuantizedConstInput(
+        TensorType_INT32, {num_channels}, /*quantized_dimension=*/0,
+        bias_scales, bias_zero_points, quantized_bias);
+    output_ = AddOutput(output);
+
+    const int depth_mul = num_channels / GetShape(input_)[3];
+    SetBuiltinOp(BuiltinOperator_DEPTHWISE_CONV_2D,
+                 BuiltinOptions_DepthwiseConv2DOptions,
+                 CreateDepthwiseConv2DOptions(builder_, padding_type, 1, 1,
+                                              depth_mul,
+                                              ActivationFunctionType_NONE)
+                     .Union());
+
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_DEPTHWISE_CONV_2D, registration);
+    BuildInterpreter({GetShape(input_), {}, {}});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<uint8_t>(input_, data);
+  }
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
 class QuantizedDepthwiseConvolutionOpTest : public SingleOpTest {
  protected:
   const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
@@ -263,6 +343,83 @@ class QuantizedDepthwiseConvolutionOpTest : public SingleOpTest {
   }
 };
 
+// The second filter channel is two orders of magnitude smaller than the
+// others, so a single scale for the whole filter would round it to zero.
+TEST_P(QuantizedDepthwiseConvolutionOpTest, SimpleTestPerChannelQuantized) {
+  std::initializer_list<float> input = {
+      1, 2, 7, 8,    // column 1
+      3, 4, 9, 10,   // column 2
+      5, 6, 11, 12,  // column 3
+  };
+  std::initializer_list<float> filter = {
+      1,  0.02,  3,   4,    //
+      -9, -0.01, -11, 12,   //
+      5,  0.03,  7,   8,    //
+      13, -0.04, 15,  -16,  //
+  };
+  std::initializer_list<float> bias = {1, 0.02, 3, 4};
+
+  PerChannelQuantizedDepthwiseConvolutionOpModel quant_op(
+      GetRegistration(), {TensorType_UINT8, {1, 3, 2, 2}, -63.5, 64},
+      {1, 2, 2, 4}, filter, bias, {TensorType_UINT8, {}, -127, 128});
+  DepthwiseConvolutionOpModel float_op(
+      GetRegistration(), {TensorType_FLOAT32, {1, 3, 2, 2}},
+      {TensorType_FLOAT32, {1, 2, 2, 4}}, {TensorType_FLOAT32, {}},
+      Padding_VALID);
+
+  quant_op.SetInput(input);
+  quant_op.Invoke();
+
+  float_op.SetInput(input);
+  float_op.SetFilter(filter);
+  float_op.SetBias(bias);
+  float_op.Invoke();
+
+  // The quantized result is within one output quantization step of the float
+  // result.
+  EXPECT_THAT(quant_op.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 1)));
+}
+
+// With a depth multiplier of 1 and SAME padding, the per-channel kernels
+// take their contiguous inner loop and skip the filter taps that fall into the
+// padding.
+TEST_P(QuantizedDepthwiseConvolutionOpTest,
+       SimpleTestPerChannelQuantizedDepthMultiplierOne) {
+  std::initializer_list<float> input = {
+      1, 2, 7,  8,  -1, 0.5, 3,  -2,  // column 1
+      3, 4, 9,  10, -3, 1.5, 5,  -4,  // column 2
+      5, 6, 11, 12, -5, 2.5, 7,  -6,  // column 3
+  };
+  std::initializer_list<float> filter = {
+      1,  0.02,  3,   4,    //
+      -9, -0.01, -11, 12,   //
+      5,  0.03,  7,   8,    //
+      13, -0.04, 15,  -16,  //
+  };
+  std::initializer_list<float> bias = {1, 0.02, 3, 4};
+
+  PerChannelQuantizedDepthwiseConvolutionOpModel quant_op(
+      GetRegistration(), {TensorType_UINT8, {1, 3, 2, 4}, -63.5, 64},
+      {1, 2, 2, 4}, filter, bias, {TensorType_UINT8, {}, -255, 256},
+      Padding_SAME);
+  DepthwiseConvolutionOpModel float_op(
+      GetRegistration(), {TensorType_FLOAT32, {1, 3, 2, 4}},
+      {TensorType_FLOAT32, {1, 2, 2, 4}}, {TensorType_FLOAT32, {}},
+      Padding_SAME);
+
+  quant_op.SetInput(input);
+  quant_op.Invoke();
+
+  float_op.SetInput(input);
+  float_op.SetFilter(filter);
+  float_op.SetBias(bias);
+  float_op.Invoke();
+
+  EXPECT_THAT(quant_op.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 2)));
+}
+
 // In this test we set the input and output scales so that the results match
 // exactly the 'non-quantized' version.
 TEST_P(QuantizedDepthwiseConvolutionOpTest, SimpleTestQuantized) {
@@ -77,13 +77,26 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteOk;
   }
 
-  tflite::DequantizationParams op_params;
-  op_params.zero_point = op_context.input->params.zero_point;
-  op_params.scale = op_context.input->params.scale;
-  optimized_ops::Dequantize(op_params, GetTensorShape(op_context.input),
-                            GetTensorData<uint8_t>(op_context.input),
-                            GetTensorShape(op_context.output),
-                            GetTensorData<float>(op_context.output));
+  const TfLiteAffineQuantization* per_channel_quantization =
+      GetAffineQuantization(op_context.input);
+  if (per_channel_quantization) {
+    reference_ops::DequantizePerChannel(
+        per_channel_quantization->quantized_dimension,
+        per_channel_quantization->scale->data,
+        per_channel_quantization->zero_point->data,
+        GetTensorShape(op_context.input),
+        GetTensorData<uint8_t>(op_context.input),
+        GetTensorShape(op_context.output),
+        GetTensorData<float>(op_context.output));
+  } else {
+    tflite::DequantizationParams op_params;
+    op_params.zero_point = op_context.input->params.zero_point;
+    op_params.scale = op_context.input->params.scale;
+    optimized_ops::Dequantize(op_params, GetTensorShape(op_context.input),
+                              GetTensorData<uint8_t>(op_context.input),
+                              GetTensorShape(op_context.output),
+                              GetTensorData<float>(op_context.output));
+  }
 
   if (IsConstantTensor(op_context.input)) {
     op_data->float_dequantized_weights_initialized = true;
@@ -1993,6 +1993,158 @@ inline void DepthwiseConv(
   }
 }
 
+// Accumulates the effect of one row of a filter that is quantized per output
+// channel, like QuantizedDepthwiseConvAccumRowGeneric does for a filter with a
+// single offset. With a depth multiplier of 1, the input values, filter values,
+// filter offsets and accumulators of an output pixel are all contiguous, and
+// the inner loop is a plain multiply-accumulate over the channels.
+inline void QuantizedDepthwiseConvAccumRowPerChannel(
+    int stride, int dilation_factor, int input_depth, int input_width,
+    const uint8* input_data, int32 input_offset, int pad_width,
+    int depth_multiplier, int filter_width, const uint8* filter_data,
+    const int32* filter_offset, int out_x_buffer_start, int out_x_buffer_end,
+    int output_depth, int32* acc_buffer) {
+  const uint8* filter_base_ptr = filter_data;
+  for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+    const int out_x_loop_start = std::max(
+        out_x_buffer_start,
+        (pad_width - dilation_factor * filter_x + stride - 1) / stride);
+    const int out_x_loop_end = std::min(
+        out_x_buffer_end,
+        (pad_width + input_width - dilation_factor * filter_x + stride - 1) /
+            stride);
+
+    int32* acc_buffer_ptr =
+        acc_buffer + (out_x_loop_start - out_x_buffer_start) * output_depth;
+    const int in_x_origin =
+        (out_x_loop_start * stride) - pad_width + dilation_factor * filter_x;
+    const uint8* input_ptr = input_data + in_x_origin * input_depth;
+    const int input_ptr_increment = stride * input_depth;
+    for (int out_x = out_x_loop_start; out_x < out_x_loop_end; out_x++) {
+      if (depth_multiplier == 1) {
+        for (int c = 0; c < input_depth; ++c) {
+          acc_buffer_ptr[c] += (filter_base_ptr[c] + filter_offset[c]) *
+                               (input_ptr[c] + input_offset);
+        }
+      } else {
+        const uint8* filter_ptr = filter_base_ptr;
+        const int32* filter_offset_ptr = filter_offset;
+        int32* acc_ptr = acc_buffer_ptr;
+        for (int ic = 0; ic < input_depth; ++ic) {
+          const int32 input_val = input_ptr[ic] + input_offset;
+          for (int m = 0; m < depth_multiplier; m++) {
+            *acc_ptr++ += (*filter_ptr++ + *filter_offset_ptr++) * input_val;
+          }
+        }
+      }
+      acc_buffer_ptr += output_depth;
+      input_ptr += input_ptr_increment;
+    }
+    filter_base_ptr += output_depth;
+  }
+}
+
+// Quantized depthwise convolution whose filter is quantized per output
+// channel, see reference_ops::DepthwiseConvPerChannel. It accumulates blocks
+// of output pixels in the same way as DepthwiseConv, and down-quantizes every
+// channel with its own multiplier and shift.
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const int32* filter_offset,
+    const RuntimeShape& input_shape, const uint8* input_data,
+    const RuntimeShape& filter_shape, const uint8* filter_data,
+    const RuntimeShape& bias_shape, const int32* bias_data,
+    const RuntimeShape& output_shape, uint8* output_data) {
+  gemmlowp::ScopedProfilingLabel label("DepthwiseConvPerChannel/8bit");
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  const int32 input_offset = params.input_offset;
+  const int32 output_offset = params.output_offset;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  TFLITE_DCHECK_GE(dilation_width_factor, 1);
+  TFLITE_DCHECK_GE(dilation_height_factor, 1);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK(!bias_data || bias_shape.FlatSize() == output_depth);
+
+  static const int kAccBufferMaxSize = 2048;
+  int32 acc_buffer[kAccBufferMaxSize];
+  TFLITE_DCHECK_GE(kAccBufferMaxSize, output_depth);
+  const int kOutputPixelsInAccBuffer = kAccBufferMaxSize / output_depth;
+  TFLITE_DCHECK_GE(kOutputPixelsInAccBuffer, 1);
+
+  const int input_height_stride = input_shape.Dims(3) * input_shape.Dims(2);
+  const int input_batch_stride = input_height_stride * input_shape.Dims(1);
+  const int filter_height_stride = filter_shape.Dims(3) * filter_shape.Dims(2);
+
+  uint8* output_ptr = output_data;
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      const int filter_y_start =
+          std::max(0, (-in_y_origin + dilation_height_factor - 1) /
+                          dilation_height_factor);
+      const int filter_y_end =
+          std::min(filter_height,
+                   (input_height - in_y_origin + dilation_height_factor - 1) /
+                       dilation_height_factor);
+      for (int out_x_buffer_start = 0; out_x_buffer_start < output_width;
+           out_x_buffer_start += kOutputPixelsInAccBuffer) {
+        const int out_x_buffer_end = std::min(
+            output_width, out_x_buffer_start + kOutputPixelsInAccBuffer);
+        const int num_output_pixels = out_x_buffer_end - out_x_buffer_start;
+        if (bias_data) {
+          DepthwiseConvInitAccBuffer(num_output_pixels, output_depth,
+                                     bias_data, acc_buffer);
+        } else {
+          std::fill(acc_buffer, acc_buffer + num_output_pixels * output_depth,
+                    0);
+        }
+        for (int filter_y = filter_y_start; filter_y < filter_y_end;
+             ++filter_y) {
+          const int in_y = in_y_origin + dilation_height_factor * filter_y;
+          QuantizedDepthwiseConvAccumRowPerChannel(
+              stride_width, dilation_width_factor, input_depth, input_width,
+              input_data + in_y * input_height_stride + b * input_batch_stride,
+              input_offset, pad_width, depth_multiplier, filter_width,
+              filter_data + filter_y * filter_height_stride, filter_offset,
+              out_x_buffer_start, out_x_buffer_end, output_depth, acc_buffer);
+        }
+        gemmlowp::ScopedProfilingLabel label("downquantize+store");
+        const int32* acc_ptr = acc_buffer;
+        for (int pixel = 0; pixel < num_output_pixels; ++pixel) {
+          for (int oc = 0; oc < output_depth; ++oc) {
+            int32 acc = MultiplyByQuantizedMultiplier(
+                *acc_ptr++, output_multiplier[oc], output_shift[oc]);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            *output_ptr++ = static_cast<uint8>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 
@@ -2051,6 +2051,116 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
       input_offset, output_pipeline);
 }
 
+// Quantized convolution whose filter is quantized per output channel, see
+// reference_ops::ConvPerChannel. gemmlowp only supports a single LHS offset,
+// so a single GEMM runs with a zero filter offset into the int32 accumulators
+// in accum_data, which has the shape of the output, and the per-channel
+// offsets are folded in afterwards using the column sums of the (offset)
+// input:
+//   sum_k (w[c][k] + w_off[c]) * (x[k] + x_off)
+//     = sum_k w[c][k] * (x[k] + x_off) + w_off[c] * sum_k (x[k] + x_off).
+inline void ConvPerChannel(
+    const ConvParams& params, const int32* output_multiplier,
+    const int32* output_shift, const int32* filter_offset,
+    const RuntimeShape& input_shape, const uint8* input_data,
+    const RuntimeShape& filter_shape, const uint8* filter_data,
+    const RuntimeShape& bias_shape, const int32* bias_data,
+    const RuntimeShape& output_shape, uint8* output_data,
+    const RuntimeShape& im2col_shape, uint8* im2col_data,
+    const RuntimeShape& accum_shape, int32* accum_data,
+    gemmlowp::GemmContext* gemm_context) {
+  gemmlowp::ScopedProfilingLabel label("ConvPerChannel/8bit");
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int32 input_offset = params.input_offset;
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  const uint8* gemm_input_data = nullptr;
+  const RuntimeShape* gemm_input_shape = nullptr;
+  const int filter_width = filter_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const bool need_dilated_im2col =
+      dilation_width_factor != 1 || dilation_height_factor != 1;
+  const bool need_im2col = stride_width != 1 || stride_height != 1 ||
+                           filter_width != 1 || filter_height != 1;
+  if (need_dilated_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    const int input_zero_point = -input_offset;
+    TFLITE_DCHECK_GE(input_zero_point, 0);
+    TFLITE_DCHECK_LE(input_zero_point, 255);
+    DilatedIm2col(params, input_zero_point, input_shape, input_data,
+                  filter_shape, output_shape, im2col_data);
+    gemm_input_data = im2col_data;
+    gemm_input_shape = &im2col_shape;
+  } else if (need_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    const int input_zero_point = -input_offset;
+    TFLITE_DCHECK_GE(input_zero_point, 0);
+    TFLITE_DCHECK_LE(input_zero_point, 255);
+    Im2col(params, filter_height, filter_width, input_zero_point, input_shape,
+           input_data, im2col_shape, im2col_data);
+    gemm_input_data = im2col_data;
+    gemm_input_shape = &im2col_shape;
+  } else {
+    TFLITE_DCHECK(!im2col_data);
+    gemm_input_data = input_data;
+    gemm_input_shape = &input_shape;
+  }
+
+  const int gemm_input_rows = gemm_input_shape->Dims(3);
+  // See b/79927784.
+  const int gemm_input_cols = gemm_input_shape->Dims(0) *
+                              gemm_input_shape->Dims(1) *
+                              gemm_input_shape->Dims(2);
+  const int filter_cols =
+      filter_shape.Dims(1) * filter_shape.Dims(2) * filter_shape.Dims(3);
+  const int output_rows = output_shape.Dims(3);
+  const int output_cols =
+      output_shape.Dims(0) * output_shape.Dims(1) * output_shape.Dims(2);
+  const int filter_rows = filter_shape.Dims(0);
+  TFLITE_DCHECK_EQ(output_rows, filter_rows);
+  TFLITE_DCHECK_EQ(output_cols, gemm_input_cols);
+  TFLITE_DCHECK_EQ(filter_cols, gemm_input_rows);
+  TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_rows);
+  TFLITE_DCHECK_EQ(accum_shape.FlatSize(), output_shape.FlatSize());
+  gemmlowp::MatrixMap<const uint8, gemmlowp::MapOrder::RowMajor> filter_matrix(
+      filter_data, filter_rows, filter_cols);
+  gemmlowp::MatrixMap<const uint8, gemmlowp::MapOrder::ColMajor> input_matrix(
+      gemm_input_data, gemm_input_rows, gemm_input_cols);
+  gemmlowp::MatrixMap<int32, gemmlowp::MapOrder::ColMajor> accum_matrix(
+      accum_data, output_rows, output_cols);
+  gemmlowp::GemmWithOutputPipeline<uint8, int32,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      gemm_context, filter_matrix, input_matrix, &accum_matrix,
+      /*lhs_offset=*/0, input_offset, std::make_tuple());
+
+  for (int col = 0; col < output_cols; ++col) {
+    const uint8* input_col = gemm_input_data + col * gemm_input_rows;
+    int32 input_sum = gemm_input_rows * input_offset;
+    for (int k = 0; k < gemm_input_rows; ++k) {
+      input_sum += input_col[k];
+    }
+    const int32* accum_col = accum_data + col * output_rows;
+    uint8* output_col = output_data + col * output_rows;
+    for (int c = 0; c < output_rows; ++c) {
+      int32 acc = accum_col[c] + filter_offset[c] * input_sum + bias_data[c];
+      acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[c],
+                                          output_shift[c]);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      output_col[c] = static_cast<uint8>(acc);
+    }
+  }
+}
+
 template <typename T>
 inline void DepthToSpace(const tflite::DepthToSpaceParams& op_params,
                          const RuntimeShape& unextended_input_shape,
@@ -314,6 +314,88 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
   }
 }
 
+// Quantized convolution whose filter is quantized per output channel. Each
+// channel c has its own filter offset, fixed-point output multiplier and
+// shift, which replace params.weights_offset, params.output_multiplier and
+// params.output_shift.
+inline void ConvPerChannel(
+    const ConvParams& params, const int32* output_multiplier,
+    const int32* output_shift, const int32* filter_offset,
+    const RuntimeShape& input_shape, const uint8* input_data,
+    const RuntimeShape& filter_shape, const uint8* filter_data,
+    const RuntimeShape& bias_shape, const int32* bias_data,
+    const RuntimeShape& output_shape, uint8* output_data) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int32 input_offset = params.input_offset;
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          const int in_x_origin = (out_x * stride_width) - pad_width;
+          const int in_y_origin = (out_y * stride_height) - pad_height;
+          int32 acc = 0;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                const int in_y =
+                    in_y_origin + dilation_height_factor * filter_y;
+                // If the location is outside the bounds of the input image,
+                // use zero as a default value.
+                if ((in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height)) {
+                  int32 input_val = input_data[Offset(input_shape, batch, in_y,
+                                                      in_x, in_channel)];
+                  int32 filter_val =
+                      filter_data[Offset(filter_shape, out_channel, filter_y,
+                                         filter_x, in_channel)];
+                  acc += (filter_val + filter_offset[out_channel]) *
+                         (input_val + input_offset);
+                }
+              }
+            }
+          }
+          if (bias_data) {
+            acc += bias_data[out_channel];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+              static_cast<uint8>(acc);
+        }
+      }
+    }
+  }
+}
+
 template <typename T>
 inline void DepthToSpace(const tflite::DepthToSpaceParams& op_params,
                          const RuntimeShape& unextended_input_shape,
@@ -2897,6 +2979,40 @@ inline void Dequantize(const tflite::DequantizationParams& op_params,
   }
 }
 
+// Dequantizes a tensor quantized per slice along `quantized_dimension`, with
+// one scale and zero point per slice.
+inline void DequantizePerChannel(int quantized_dimension, const float* scales,
+                                 const int32* zero_points,
+                                 const RuntimeShape& input_shape,
+                                 const uint8* input_data,
+                                 const RuntimeShape& output_shape,
+                                 float* output_data) {
+  const int num_channels = input_shape.Dims(quantized_dimension);
+  int outer_size = 1;
+  for (int i = 0; i < quantized_dimension; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int inner_size = 1;
+  for (int i = quantized_dimension + 1; i < input_shape.DimensionsCount();
+       ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+  TFLITE_DCHECK_EQ(MatchingFlatSize(input_shape, output_shape),
+                   outer_size * num_channels * inner_size);
+
+  for (int outer = 0; outer < outer_size; ++outer) {
+    for (int c = 0; c < num_channels; ++c) {
+      const int32 zero_point = zero_points[c];
+      const double scale = scales[c];
+      const int offset = (outer * num_channels + c) * inner_size;
+      for (int i = offset; i < offset + inner_size; ++i) {
+        const int32 val = input_data[i];
+        output_data[i] = static_cast<float>(scale * (val - zero_point));
+      }
+    }
+  }
+}
+
 inline void FakeQuant(const tflite::FakeQuantParams& op_params,
                       const RuntimeShape& input_shape, const float* input_data,
                       const RuntimeShape& output_shape, float* output_data) {
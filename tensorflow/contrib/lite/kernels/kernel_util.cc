@@ -43,6 +43,47 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus GetPerChannelQuantizedConvolutionMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int filter_channel_dim, std::vector<double>* multipliers,
+    std::vector<int32_t>* filter_offsets) {
+  const TfLiteAffineQuantization* filter_quantization =
+      GetAffineQuantization(filter);
+  TF_LITE_ENSURE(context, filter_quantization != nullptr);
+  TF_LITE_ENSURE_EQ(context, filter_quantization->quantized_dimension,
+                    filter_channel_dim);
+  const int num_channels = SizeOfDimension(filter, filter_channel_dim);
+  TF_LITE_ENSURE_EQ(context, filter_quantization->scale->size, num_channels);
+  TF_LITE_ENSURE_EQ(context, filter_quantization->zero_point->size,
+                    num_channels);
+
+  // The bias is either quantized per channel along its only dimension, or
+  // with a single scale that must then match every channel.
+  const TfLiteAffineQuantization* bias_quantization =
+      GetAffineQuantization(bias);
+  if (bias_quantization) {
+    TF_LITE_ENSURE_EQ(context, bias_quantization->scale->size, num_channels);
+  }
+
+  multipliers->resize(num_channels);
+  filter_offsets->resize(num_channels);
+  for (int c = 0; c < num_channels; ++c) {
+    const double input_product_scale = static_cast<double>(input->params.scale) *
+                                       filter_quantization->scale->data[c];
+    const double bias_scale = bias_quantization
+                                  ? bias_quantization->scale->data[c]
+                                  : bias->params.scale;
+    TF_LITE_ENSURE(context,
+                   std::abs(input_product_scale - bias_scale) <=
+                       1e-6 * std::min(input_product_scale, bias_scale));
+    TF_LITE_ENSURE(context, input_product_scale >= 0);
+    (*multipliers)[c] = input_product_scale / output->params.scale;
+    (*filter_offsets)[c] = -filter_quantization->zero_point->data[c];
+  }
+  return kTfLiteOk;
+}
+
 namespace {
 void CalculateActivationRangeQuantizedImpl(TfLiteFusedActivation activation,
                                            int32_t qmin, int32_t qmax,
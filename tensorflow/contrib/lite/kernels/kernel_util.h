@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/c/builtin_op_data.h"
 #include "tensorflow/contrib/lite/c/c_api_internal.h"
@@ -94,6 +95,35 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
                                               TfLiteTensor* output,
                                               double* multiplier);
 
+// Returns the per-channel quantization parameters of `t`, or nullptr if it is
+// quantized with a single scale and zero point.
+inline const TfLiteAffineQuantization* GetAffineQuantization(
+    const TfLiteTensor* t) {
+  if (t->quantization.type != kTfLiteAffineQuantization) return nullptr;
+  return reinterpret_cast<const TfLiteAffineQuantization*>(
+      t->quantization.params);
+}
+
+// Returns true if `t` has more than one scale and zero point. The legacy
+// `params` of such a tensor only describe its first channel, so code that
+// reads nothing else, such as the NN API delegates, must not handle it.
+inline bool IsPerChannelQuantized(const TfLiteTensor* t) {
+  const TfLiteAffineQuantization* affine = GetAffineQuantization(t);
+  return affine != nullptr && affine->scale != nullptr &&
+         affine->scale->size > 1;
+}
+
+// Calculates one multiplication factor per output channel for a quantized
+// convolution whose filter is quantized per channel along
+// `filter_channel_dim`. Also returns the filter offset (the negated zero point)
+// of each channel. Returns an error if the scales of the tensors are not
+// compatible.
+TfLiteStatus GetPerChannelQuantizedConvolutionMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int filter_channel_dim, std::vector<double>* multipliers,
+    std::vector<int32_t>* filter_offsets);
+
 // Calculates the useful quantized range of an activation layer given its
 // activation tensor.
 TfLiteStatus CalculateActivationRangeQuantized(TfLiteContext* context,
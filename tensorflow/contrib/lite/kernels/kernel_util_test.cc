@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 
+#include <cstdlib>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/testing/util.h"
@@ -32,6 +34,8 @@ class KernelUtilTest : public ::testing::Test {
     tensor2_.dims = nullptr;
     tensor1_.allocation_type = kTfLiteMmapRo;
     tensor2_.allocation_type = kTfLiteMmapRo;
+    tensor1_.quantization.type = kTfLiteNoQuantization;
+    tensor2_.quantization.type = kTfLiteNoQuantization;
   }
   ~KernelUtilTest() override {
     TfLiteTensorFree(&tensor1_);
@@ -142,6 +146,26 @@ TEST_F(KernelUtilTest, BroadcastShapeDifferentSizes) {
   TfLiteIntArrayFree(output);
 }
 
+TEST_F(KernelUtilTest, IsPerChannelQuantized) {
+  EXPECT_FALSE(IsPerChannelQuantized(&tensor1_));
+
+  auto* affine = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  affine->scale = TfLiteFloatArrayCreate(1);
+  affine->zero_point = TfLiteIntArrayCreate(1);
+  affine->quantized_dimension = 0;
+  tensor1_.quantization.type = kTfLiteAffineQuantization;
+  tensor1_.quantization.params = affine;
+  // A single scale is the same as the legacy per-tensor parameters.
+  EXPECT_FALSE(IsPerChannelQuantized(&tensor1_));
+
+  TfLiteFloatArrayFree(affine->scale);
+  TfLiteIntArrayFree(affine->zero_point);
+  affine->scale = TfLiteFloatArrayCreate(3);
+  affine->zero_point = TfLiteIntArrayCreate(3);
+  EXPECT_TRUE(IsPerChannelQuantized(&tensor1_));
+}
+
 }  // namespace
 }  // namespace tflite
 
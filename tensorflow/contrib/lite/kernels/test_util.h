@@ -140,6 +140,35 @@ class SingleOpModel {
     return id;
   }
 
+  // Add a constant input quantized per slice along `quantized_dimension`,
+  // with one scale and zero point per slice, and return its index.
+  template <typename T>
+  int AddPerChannelQuantizedConstInput(TensorType type,
+                                       const std::vector<int>& shape,
+                                       int quantized_dimension,
+                                       const std::vector<float>& scales,
+                                       const std::vector<int64_t>& zero_points,
+                                       const std::vector<T>& data) {
+    int id = tensors_.size();
+    if (buffers_.empty()) {
+      buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector({})));
+    }
+    int buffer_id = buffers_.size();
+    buffers_.push_back(CreateBuffer(
+        builder_,
+        builder_.CreateVector(reinterpret_cast<const uint8_t*>(data.data()),
+                              sizeof(T) * data.size())));
+    auto q_params = CreateQuantizationParameters(
+        builder_, /*min=*/0, /*max=*/0, builder_.CreateVector<float>(scales),
+        builder_.CreateVector<int64_t>(zero_points), quantized_dimension);
+    tensors_.push_back(CreateTensor(builder_, builder_.CreateVector<int>(shape),
+                                    type, buffer_id, /*name=*/0, q_params));
+    tensor_data_[id] = TensorData{type, shape, 0, 0, scales[0],
+                                  static_cast<int32_t>(zero_points[0])};
+    inputs_.push_back(id);
+    return id;
+  }
+
   // Add a null input tensor (optional input) and return kOptionalTensor.
   int AddNullInput();
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
 
 #include "tensorflow/contrib/lite/allocation.h"
 #include "tensorflow/contrib/lite/c/builtin_op_data.h"
@@ -254,6 +255,67 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::ParseQuantization(
+    const QuantizationParameters* src_quantization,
+    const std::vector<int>& dims, TfLiteQuantizationParams* quantization,
+    TfLiteQuantization* per_channel_quantization) {
+  quantization->scale = 0;
+  quantization->zero_point = 0;
+  per_channel_quantization->type = kTfLiteNoQuantization;
+  per_channel_quantization->params = nullptr;
+  if (!src_quantization) return kTfLiteOk;
+
+  // TODO(aselle): This breaks as well if these are nullptr's.
+  const auto* scale = src_quantization->scale();
+  const auto* zero_point = src_quantization->zero_point();
+  const int num_scales = scale ? scale->size() : 0;
+  const int num_zero_points = zero_point ? zero_point->size() : 0;
+  if (num_scales > 0 && num_zero_points > 0 && num_scales != num_zero_points) {
+    error_reporter_->Report(
+        "QuantizationParam has %d scale values and %d zero_point values.",
+        num_scales, num_zero_points);
+    return kTfLiteError;
+  }
+
+  // The legacy per-tensor parameters always describe the first channel, so
+  // that kernels without per-channel support keep their current behavior.
+  if (num_scales > 0) quantization->scale = scale->Get(0);
+  if (num_zero_points > 0) quantization->zero_point = zero_point->Get(0);
+  if (num_scales <= 1 && num_zero_points <= 1) return kTfLiteOk;
+
+  const int quantized_dimension = src_quantization->quantized_dimension();
+  if (quantized_dimension < 0 ||
+      quantized_dimension >= static_cast<int>(dims.size())) {
+    error_reporter_->Report(
+        "QuantizationParam quantized_dimension %d is out of range for a "
+        "tensor of rank %d.",
+        quantized_dimension, static_cast<int>(dims.size()));
+    return kTfLiteError;
+  }
+  const int num_channels = std::max(num_scales, num_zero_points);
+  if (dims[quantized_dimension] != num_channels) {
+    error_reporter_->Report(
+        "QuantizationParam has %d values but dimension %d has size %d.",
+        num_channels, quantized_dimension, dims[quantized_dimension]);
+    return kTfLiteError;
+  }
+
+  auto* affine_quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  affine_quantization->scale = TfLiteFloatArrayCreate(num_channels);
+  affine_quantization->zero_point = TfLiteIntArrayCreate(num_channels);
+  affine_quantization->quantized_dimension = quantized_dimension;
+  for (int c = 0; c < num_channels; ++c) {
+    affine_quantization->scale->data[c] =
+        num_scales > 1 ? scale->Get(c) : quantization->scale;
+    affine_quantization->zero_point->data[c] =
+        num_zero_points > 1 ? zero_point->Get(c) : quantization->zero_point;
+  }
+  per_channel_quantization->type = kTfLiteAffineQuantization;
+  per_channel_quantization->params = affine_quantization;
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ParseTensors(
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
     const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
@@ -273,36 +335,10 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     std::vector<int> dims = FlatBufferIntArrayToVector(tensor->shape());
 
     TfLiteQuantizationParams quantization;
-    quantization.scale = 0;
-    quantization.zero_point = 0;
-    auto* q_params = tensor->quantization();
-    if (q_params) {
-      // Note that the schema could hold per-channel quantization parameters
-      // but we really only support one value for the whole tensor.
-      // TODO(aselle): This breaks as well if these are nullptr's.
-      // TODO(aselle): This assumes non per-channel quantization.
-
-      if (q_params->scale()) {
-        if (q_params->scale()->size() != 1) {
-          error_reporter_->Report(
-              "QuantizationParam has %d scale values (only 1 is supported).",
-              q_params->scale()->size());
-          return kTfLiteError;
-        }
-        quantization.scale = q_params->scale()->Get(0);
-      }
-
-      if (q_params->zero_point()) {
-        if (q_params->zero_point()->size() != 1) {
-          error_reporter_->Report(
-              "QuantizationParam has %d zero_point values"
-              " (only 1 is supported).",
-              q_params->zero_point()->size());
-          return kTfLiteError;
-        }
-        quantization.zero_point = q_params->zero_point()->Get(0);
-      }
-    }
+    TfLiteQuantization per_channel_quantization;
+    TF_LITE_ENSURE_STATUS(ParseQuantization(tensor->quantization(), dims,
+                                            &quantization,
+                                            &per_channel_quantization));
 
     TfLiteType type;
     if (ConvertTensorType(tensor->type(), &type, error_reporter_) !=
@@ -363,6 +399,14 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
         status = kTfLiteError;
       }
     }
+
+    // The interpreter takes ownership of the per-channel parameters, even if
+    // setting them fails.
+    if (interpreter->SetTensorQuantization(i, per_channel_quantization) !=
+        kTfLiteOk) {
+      error_reporter_->Report("Tensor %d has invalid quantization.\n", i);
+      status = kTfLiteError;
+    }
   }
 
   return status;
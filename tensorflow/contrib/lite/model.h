@@ -169,6 +169,13 @@ class InterpreterBuilder {
   TfLiteStatus ParseNodes(
       const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
       Interpreter* interpreter);
+  // Converts the flatbuffer quantization of a tensor with shape `dims` into
+  // the legacy per-tensor `quantization` and, when the parameters hold more
+  // than one channel, a heap-allocated `per_channel_quantization`.
+  TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
+                                 const std::vector<int>& dims,
+                                 TfLiteQuantizationParams* quantization,
+                                 TfLiteQuantization* per_channel_quantization);
   TfLiteStatus ParseTensors(
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
@@ -20,6 +20,7 @@ limitations under the License.
 #include <sys/types.h>
 #include "tensorflow/contrib/lite/c/builtin_op_data.h"
 #include "tensorflow/contrib/lite/core/api/error_reporter.h"
+#include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/nnapi/NeuralNetworksShim.h"
 
@@ -157,6 +158,15 @@ TfLiteStatus addTensorOperands(tflite::Interpreter* interpreter,
     float scale = 0.0f;
     int32_t zeroPoint = 0;
     TfLiteTensor* tensor = interpreter->tensor(i);
+    // NNAPI takes a single scale and zero point per tensor, which would
+    // quantize every channel with the parameters of the first one.
+    if (IsPerChannelQuantized(tensor)) {
+      logError(
+          "NNAPI doesn't support per-channel quantized tensors (index %d name "
+          "%s)",
+          i, tensor->name);
+      return kTfLiteError;
+    }
     switch (tensor->type) {
       case kTfLiteNoType:
         // Tensors added during initialization of Ops don't have a type yet and
@@ -45,6 +45,11 @@ class ProfileSummarizer {
     return stats_calculator_->GetShortSummary();
   }
 
+  // Returns the accumulated per-operator statistics.
+  const tensorflow::StatsCalculator& stats_calculator() const {
+    return *stats_calculator_;
+  }
+
  private:
   std::unique_ptr<tensorflow::StatsCalculator> stats_calculator_;
 };
@@ -12,7 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -42,9 +45,18 @@ BenchmarkParams CreateParams() {
   params.AddParam("input_layer", BenchmarkParam::Create<std::string>(""));
   params.AddParam("input_layer_shape", BenchmarkParam::Create<std::string>(""));
   params.AddParam("use_nnapi", BenchmarkParam::Create<bool>(false));
+  params.AddParam("num_interpreters", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("target_qps", BenchmarkParam::Create<float>(-1.0f));
+  params.AddParam("output_format", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("output_file", BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
+std::string TempPath(const std::string& name) {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  return std::string(tmpdir ? tmpdir : "/tmp") + "/" + name;
+}
+
 TEST(BenchmarkTest, DoesntCrash) {
   ASSERT_THAT(g_model_path, testing::NotNull());
 
@@ -52,6 +64,53 @@ TEST(BenchmarkTest, DoesntCrash) {
   benchmark.Run();
 }
 
+TEST(BenchmarkTest, LoadGeneratorClosedLoop) {
+  ASSERT_THAT(g_model_path, testing::NotNull());
+
+  BenchmarkParams params = CreateParams();
+  params.Set<int32_t>("num_interpreters", 3);
+  params.Set<int32_t>("num_runs", 5);
+  BenchmarkTfLiteModel benchmark(std::move(params));
+  ASSERT_TRUE(benchmark.ValidateParams());
+  LoadTestResults results = benchmark.RunLoadTest();
+  EXPECT_EQ(3, results.warmup_latency_us.count());
+  EXPECT_EQ(15, results.latency_us.count());
+  EXPECT_LE(results.latency_us.Percentile(50),
+            results.latency_us.Percentile(99.9));
+  EXPECT_GT(results.peak_arena_bytes, 0);
+  EXPECT_GT(results.achieved_qps, 0);
+}
+
+TEST(BenchmarkTest, LoadGeneratorOpenLoopWritesJson) {
+  ASSERT_THAT(g_model_path, testing::NotNull());
+
+  const std::string output_file = TempPath("benchmark_results.json");
+  BenchmarkParams params = CreateParams();
+  params.Set<int32_t>("num_interpreters", 2);
+  params.Set<float>("target_qps", 200.0f);
+  params.Set<std::string>("output_format", "json");
+  params.Set<std::string>("output_file", output_file);
+  BenchmarkTfLiteModel benchmark(std::move(params));
+  benchmark.Run();
+
+  std::ifstream file(output_file);
+  ASSERT_TRUE(file.good());
+  std::stringstream contents;
+  contents << file.rdbuf();
+  EXPECT_THAT(contents.str(), testing::HasSubstr("\"steady_state\": {"));
+  EXPECT_THAT(contents.str(), testing::HasSubstr("\"p999_us\""));
+  EXPECT_THAT(contents.str(), testing::HasSubstr("\"peak_arena_bytes\""));
+}
+
+TEST(BenchmarkTest, RejectsUnknownOutputFormat) {
+  ASSERT_THAT(g_model_path, testing::NotNull());
+
+  BenchmarkParams params = CreateParams();
+  params.Set<std::string>("output_format", "xml");
+  BenchmarkTfLiteModel benchmark(std::move(params));
+  EXPECT_FALSE(benchmark.ValidateParams());
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
@@ -15,11 +15,21 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -29,6 +39,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/op_resolver.h"
+#include "tensorflow/contrib/lite/profiling/time.h"
 #include "tensorflow/contrib/lite/string_util.h"
 #include "tensorflow/contrib/lite/tools/benchmark/logging.h"
 
@@ -38,6 +49,7 @@ void RegisterSelectedOps(::tflite::MutableOpResolver* resolver);
 
 namespace tflite {
 namespace benchmark {
+using tensorflow::Stat;
 
 void ProfilingListener::SetInterpreter(tflite::Interpreter* interpreter) {
   TFLITE_BENCHMARK_CHECK(interpreter);
@@ -173,9 +185,208 @@ BenchmarkParams GetDefaultParams() {
   default_params.AddParam("input_layer_shape",
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("use_nnapi", BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("num_interpreters",
+                          BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("target_qps", BenchmarkParam::Create<float>(-1.0f));
+  default_params.AddParam("output_format",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("output_file",
+                          BenchmarkParam::Create<std::string>(""));
   return default_params;
 }
 
+// Returns the extent of the memory arena holding tensors of the given
+// allocation type. The interpreter does not expose its arenas, so this is
+// derived from where the planner placed the tensors.
+size_t GetArenaBytes(const tflite::Interpreter& interpreter,
+                     TfLiteAllocationType allocation_type) {
+  uintptr_t begin = std::numeric_limits<uintptr_t>::max();
+  uintptr_t end = 0;
+  for (int i = 0; i < static_cast<int>(interpreter.tensors_size()); ++i) {
+    const TfLiteTensor* t = interpreter.tensor(i);
+    if (t->allocation_type != allocation_type || t->data.raw == nullptr ||
+        t->bytes == 0) {
+      continue;
+    }
+    const uintptr_t data = reinterpret_cast<uintptr_t>(t->data.raw);
+    begin = std::min(begin, data);
+    end = std::max(end, data + t->bytes);
+  }
+  return end > begin ? end - begin : 0;
+}
+
+// Blocks threads until all of them have arrived, then releases them at once.
+class StartBarrier {
+ public:
+  explicit StartBarrier(int num_threads)
+      : remaining_(num_threads), release_us_(0) {}
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) {
+      release_us_ = profiling::time::NowMicros();
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [this] { return remaining_ == 0; });
+    }
+  }
+
+  // Time at which the last thread arrived. Only valid after Wait() returns.
+  int64_t release_us() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return release_us_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int remaining_;
+  int64_t release_us_;
+};
+
+// State owned by a single load generator thread.
+struct LoadTestWorker {
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  profiling::Profiler profiler;
+  profiling::ProfileSummarizer summarizer;
+  LatencyHistogram warmup_latency_us;
+  LatencyHistogram latency_us;
+  int64_t end_us = 0;
+  size_t arena_bytes = 0;
+  size_t persistent_arena_bytes = 0;
+};
+
+struct LoadTestOptions {
+  int num_workers;
+  int warmup_runs;
+  int num_runs;
+  // Aggregate request rate over all workers; non-positive means closed loop.
+  double target_qps;
+  float run_delay;
+};
+
+void InvokeOrDie(tflite::Interpreter* interpreter) {
+  if (interpreter->Invoke() != kTfLiteOk) {
+    TFLITE_LOG(FATAL) << "Failed to invoke!";
+  }
+}
+
+void RunLoadTestWorker(const LoadTestOptions& options, int worker_index,
+                       StartBarrier* barrier, LoadTestWorker* worker) {
+  tflite::Interpreter* interpreter = worker->interpreter.get();
+  for (int run = 0; run < options.warmup_runs; ++run) {
+    int64_t start_us = profiling::time::NowMicros();
+    InvokeOrDie(interpreter);
+    worker->warmup_latency_us.Record(profiling::time::NowMicros() - start_us);
+  }
+
+  // The steady state starts once every interpreter has finished warming up.
+  barrier->Wait();
+  const int64_t steady_start_us = barrier->release_us();
+
+  // In open-loop mode, requests of the different workers are interleaved so
+  // that together they arrive at a uniform rate.
+  const double interval_us =
+      options.target_qps > 0 ? 1e6 * options.num_workers / options.target_qps
+                             : 0.0;
+  const double offset_us = interval_us * worker_index / options.num_workers;
+
+  interpreter->SetProfiler(&worker->profiler);
+  for (int run = 0; run < options.num_runs; ++run) {
+    int64_t scheduled_us = profiling::time::NowMicros();
+    if (interval_us > 0) {
+      scheduled_us = steady_start_us +
+                     static_cast<int64_t>(offset_us + run * interval_us);
+      const int64_t now_us = profiling::time::NowMicros();
+      if (scheduled_us > now_us) {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds(scheduled_us - now_us));
+      }
+    }
+    worker->profiler.Reset();
+    worker->profiler.StartProfiling();
+    InvokeOrDie(interpreter);
+    const int64_t end_us = profiling::time::NowMicros();
+    worker->profiler.StopProfiling();
+    worker->latency_us.Record(end_us - scheduled_us);
+
+    worker->summarizer.ProcessProfiles(worker->profiler.GetProfileEvents(),
+                                       *interpreter);
+    // Dynamic tensors may grow the arena after the first invocation.
+    worker->arena_bytes = std::max(
+        worker->arena_bytes, GetArenaBytes(*interpreter, kTfLiteArenaRw));
+    worker->persistent_arena_bytes =
+        std::max(worker->persistent_arena_bytes,
+                 GetArenaBytes(*interpreter, kTfLiteArenaRwPersistent));
+    if (interval_us <= 0 && options.run_delay > 0) {
+      std::this_thread::sleep_for(
+          std::chrono::duration<float>(options.run_delay));
+    }
+  }
+  interpreter->SetProfiler(nullptr);
+  worker->end_us = profiling::time::NowMicros();
+}
+
+std::string JsonEscape(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string CsvEscape(const std::string& str) {
+  if (str.find_first_of(",\"\n") == std::string::npos) {
+    return str;
+  }
+  std::string escaped = "\"";
+  for (char c : str) {
+    if (c == '"') escaped += '"';
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+void WriteJsonLatency(const LatencyHistogram& histogram, std::ostream* out) {
+  *out << "{\"count\": " << histogram.count()
+       << ", \"min_us\": " << histogram.min()
+       << ", \"avg_us\": " << histogram.avg()
+       << ", \"p50_us\": " << histogram.Percentile(50)
+       << ", \"p90_us\": " << histogram.Percentile(90)
+       << ", \"p99_us\": " << histogram.Percentile(99)
+       << ", \"p999_us\": " << histogram.Percentile(99.9)
+       << ", \"max_us\": " << histogram.max() << ", \"log2_buckets\": [";
+  const std::vector<int64_t> buckets = histogram.Log2Buckets();
+  for (int i = 0; i < buckets.size(); ++i) {
+    *out << (i ? ", " : "") << buckets[i];
+  }
+  *out << "]}";
+}
+
+void WriteCsvLatency(const std::string& phase,
+                     const LatencyHistogram& histogram, std::ostream* out) {
+  *out << "latency," << phase << "," << histogram.count() << ","
+       << histogram.min() << "," << histogram.avg() << ","
+       << histogram.Percentile(50) << "," << histogram.Percentile(90) << ","
+       << histogram.Percentile(99) << "," << histogram.Percentile(99.9) << ","
+       << histogram.max() << ",\n";
+}
+
 }  // namespace
 
 BenchmarkTfLiteModel::BenchmarkTfLiteModel()
@@ -195,7 +406,17 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<std::string>("input_layer", &params_, "input layer names"),
       CreateFlag<std::string>("input_layer_shape", &params_,
                               "input layer shape"),
-      CreateFlag<bool>("use_nnapi", &params_, "use nnapi api")};
+      CreateFlag<bool>("use_nnapi", &params_, "use nnapi api"),
+      CreateFlag<int32_t>("num_interpreters", &params_,
+                          "number of interpreters, each run on its own thread"),
+      CreateFlag<float>("target_qps", &params_,
+                        "aggregate requests per second over all interpreters; "
+                        "non-positive values run closed loop"),
+      CreateFlag<std::string>("output_format", &params_,
+                              "machine readable output format: json or csv"),
+      CreateFlag<std::string>("output_file", &params_,
+                              "file to write machine readable output to, "
+                              "stdout if empty")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
   return flags;
@@ -209,6 +430,14 @@ void BenchmarkTfLiteModel::LogParams() {
   TFLITE_LOG(INFO) << "Input shapes: ["
                    << params_.Get<std::string>("input_layer_shape") << "]";
   TFLITE_LOG(INFO) << "Use nnapi : [" << params_.Get<bool>("use_nnapi") << "]";
+  TFLITE_LOG(INFO) << "Num interpreters: ["
+                   << params_.Get<int32_t>("num_interpreters") << "]";
+  TFLITE_LOG(INFO) << "Target QPS: [" << params_.Get<float>("target_qps")
+                   << "]";
+  TFLITE_LOG(INFO) << "Output format: ["
+                   << params_.Get<std::string>("output_format") << "]";
+  TFLITE_LOG(INFO) << "Output file: ["
+                   << params_.Get<std::string>("output_file") << "]";
 }
 
 bool BenchmarkTfLiteModel::ValidateParams() {
@@ -217,6 +446,17 @@ bool BenchmarkTfLiteModel::ValidateParams() {
         << "Please specify the name of your TF Lite input file with --graph";
     return false;
   }
+  if (params_.Get<int32_t>("num_interpreters") < 1) {
+    TFLITE_LOG(ERROR) << "--num_interpreters must be at least 1";
+    return false;
+  }
+  const std::string output_format = params_.Get<std::string>("output_format");
+  if (!output_format.empty() && output_format != "json" &&
+      output_format != "csv") {
+    TFLITE_LOG(ERROR) << "Unknown --output_format " << output_format
+                      << ", expected json or csv";
+    return false;
+  }
   return PopulateInputLayerInfo(params_.Get<std::string>("input_layer"),
                                 params_.Get<std::string>("input_layer_shape"),
                                 &inputs);
@@ -233,6 +473,10 @@ uint64_t BenchmarkTfLiteModel::ComputeInputBytes() {
 }
 
 void BenchmarkTfLiteModel::PrepareInputsAndOutputs() {
+  FillInputs(interpreter.get());
+}
+
+void BenchmarkTfLiteModel::FillInputs(tflite::Interpreter* interpreter) {
   auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors.
   for (int j = 0; j < inputs.size(); ++j) {
@@ -264,7 +508,7 @@ void BenchmarkTfLiteModel::PrepareInputsAndOutputs() {
       FillRandomString(&buffer, sizes, []() {
         return "we're have some friends over saturday to hang out in the yard";
       });
-      buffer.WriteToTensor(interpreter->tensor(i));
+      buffer.WriteToTensor(t);
     } else {
       TFLITE_LOG(FATAL) << "Don't know how to populate tensor " << t->name
                         << " of type " << t->type;
@@ -272,7 +516,7 @@ void BenchmarkTfLiteModel::PrepareInputsAndOutputs() {
   }
 }
 
-void BenchmarkTfLiteModel::Init() {
+void BenchmarkTfLiteModel::LoadModel() {
   std::string graph = params_.Get<std::string>("graph");
   model = tflite::FlatBufferModel::BuildFromFile(graph.c_str());
   if (!model) {
@@ -281,7 +525,9 @@ void BenchmarkTfLiteModel::Init() {
   TFLITE_LOG(INFO) << "Loaded model " << graph;
   model->error_reporter();
   TFLITE_LOG(INFO) << "resolved reporter";
+}
 
+std::unique_ptr<tflite::Interpreter> BenchmarkTfLiteModel::BuildInterpreter() {
 #ifdef TFLITE_CUSTOM_OPS_HEADER
   tflite::MutableOpResolver resolver;
   RegisterSelectedOps(&resolver);
@@ -289,11 +535,11 @@ void BenchmarkTfLiteModel::Init() {
   tflite::ops::builtin::BuiltinOpResolver resolver;
 #endif
 
+  std::unique_ptr<tflite::Interpreter> interpreter;
   tflite::InterpreterBuilder(*model, resolver)(&interpreter);
   if (!interpreter) {
     TFLITE_LOG(FATAL) << "Failed to construct interpreter";
   }
-  profiling_listener_.SetInterpreter(interpreter.get());
 
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
 
@@ -307,10 +553,11 @@ void BenchmarkTfLiteModel::Init() {
 
 #ifdef TFLITE_FLEX
   TFLITE_LOG(INFO) << "Instantiating Flex Delegate";
-  delegate_ = FlexDelegate::Create();
-  if (delegate_) {
-    interpreter->ModifyGraphWithDelegate(delegate_.get(),
+  std::unique_ptr<FlexDelegate> delegate = FlexDelegate::Create();
+  if (delegate) {
+    interpreter->ModifyGraphWithDelegate(delegate.get(),
                                          /*allow_dynamic_tensors=*/true);
+    delegates_.push_back(std::move(delegate));
   }
 #endif  // TFLITE_FLEX
 
@@ -345,6 +592,201 @@ void BenchmarkTfLiteModel::Init() {
   if (interpreter->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(FATAL) << "Failed to allocate tensors!";
   }
+  return interpreter;
+}
+
+void BenchmarkTfLiteModel::Init() {
+  LoadModel();
+  interpreter = BuildInterpreter();
+  profiling_listener_.SetInterpreter(interpreter.get());
+}
+
+bool BenchmarkTfLiteModel::UseLoadGenerator() const {
+  return params_.Get<int32_t>("num_interpreters") > 1 ||
+         params_.Get<float>("target_qps") > 0 ||
+         !params_.Get<std::string>("output_format").empty();
+}
+
+void BenchmarkTfLiteModel::Run() {
+  if (!UseLoadGenerator()) {
+    BenchmarkModel::Run();
+    return;
+  }
+  if (!ValidateParams()) {
+    return;
+  }
+  LogParams();
+
+  listeners_.OnBenchmarkStart(params_);
+  LoadTestResults results = RunLoadTest();
+  LogLoadTestResults(results);
+  WriteLoadTestResults(results);
+
+  Stat<int64_t> warmup_time_us;
+  for (int64_t sample : results.warmup_latency_us.samples()) {
+    warmup_time_us.UpdateStat(sample);
+  }
+  Stat<int64_t> inference_time_us;
+  for (int64_t sample : results.latency_us.samples()) {
+    inference_time_us.UpdateStat(sample);
+  }
+  listeners_.OnBenchmarkEnd({results.startup_latency_us, ComputeInputBytes(),
+                             warmup_time_us, inference_time_us});
+}
+
+LoadTestResults BenchmarkTfLiteModel::RunLoadTest() {
+  LoadTestOptions options;
+  options.num_workers = params_.Get<int32_t>("num_interpreters");
+  options.warmup_runs = params_.Get<int32_t>("warmup_runs");
+  options.num_runs = params_.Get<int32_t>("num_runs");
+  options.target_qps = params_.Get<float>("target_qps");
+  options.run_delay = params_.Get<float>("run_delay");
+
+  LoadTestResults results;
+  std::vector<LoadTestWorker> workers(options.num_workers);
+  // Interpreters from an earlier Init() must not outlive the model.
+  interpreter.reset();
+  const int64_t init_start_us = profiling::time::NowMicros();
+  LoadModel();
+  for (LoadTestWorker& worker : workers) {
+    worker.interpreter = BuildInterpreter();
+    // rand() is not thread safe, so inputs are filled before starting.
+    FillInputs(worker.interpreter.get());
+  }
+  results.startup_latency_us = profiling::time::NowMicros() - init_start_us;
+  TFLITE_LOG(INFO) << "Initialized " << options.num_workers
+                   << " interpreters in " << results.startup_latency_us / 1e3
+                   << "ms";
+
+  StartBarrier barrier(options.num_workers);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.num_workers; ++i) {
+    threads.emplace_back(RunLoadTestWorker, std::cref(options), i, &barrier,
+                         &workers[i]);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  int64_t steady_end_us = 0;
+  std::map<std::string, LoadTestResults::OpStats> op_stats;
+  for (const LoadTestWorker& worker : workers) {
+    results.warmup_latency_us.Merge(worker.warmup_latency_us);
+    results.latency_us.Merge(worker.latency_us);
+    steady_end_us = std::max(steady_end_us, worker.end_us);
+    results.peak_arena_bytes =
+        std::max(results.peak_arena_bytes, worker.arena_bytes);
+    results.peak_persistent_arena_bytes = std::max(
+        results.peak_persistent_arena_bytes, worker.persistent_arena_bytes);
+    for (const auto& it : worker.summarizer.stats_calculator().GetDetails()) {
+      const auto& detail = it.second;
+      LoadTestResults::OpStats& stats = op_stats[it.first];
+      stats.name = detail.name;
+      stats.type = detail.type;
+      stats.run_order = detail.run_order;
+      stats.count += detail.rel_end_us.count();
+      stats.sum_us += detail.rel_end_us.sum();
+    }
+  }
+  results.steady_state_wall_us = steady_end_us - barrier.release_us();
+  if (results.steady_state_wall_us > 0) {
+    results.achieved_qps =
+        1e6 * results.latency_us.count() / results.steady_state_wall_us;
+  }
+  for (const auto& it : op_stats) {
+    results.op_stats.push_back(it.second);
+  }
+  std::sort(results.op_stats.begin(), results.op_stats.end(),
+            [](const LoadTestResults::OpStats& a,
+               const LoadTestResults::OpStats& b) {
+              return a.run_order < b.run_order;
+            });
+
+  // Keep one interpreter around for ComputeInputBytes().
+  interpreter = std::move(workers[0].interpreter);
+  return results;
+}
+
+void BenchmarkTfLiteModel::LogLoadTestResults(const LoadTestResults& results) {
+  TFLITE_LOG(INFO) << "Warmup latency (us): "
+                   << results.warmup_latency_us.ToString();
+  TFLITE_LOG(INFO) << "Steady state latency (us): "
+                   << results.latency_us.ToString();
+  TFLITE_LOG(INFO) << "Achieved QPS: " << results.achieved_qps << " over "
+                   << results.steady_state_wall_us / 1e6 << "s";
+  TFLITE_LOG(INFO) << "Peak arena bytes per interpreter: "
+                   << results.peak_arena_bytes
+                   << " (persistent: " << results.peak_persistent_arena_bytes
+                   << ")";
+  for (const auto& op : results.op_stats) {
+    TFLITE_LOG(INFO) << "Op " << op.type << " " << op.name
+                     << " avg_us=" << (op.count ? op.sum_us / op.count : 0)
+                     << " count=" << op.count;
+  }
+}
+
+void BenchmarkTfLiteModel::WriteLoadTestResults(
+    const LoadTestResults& results) {
+  const std::string format = params_.Get<std::string>("output_format");
+  if (format.empty()) {
+    return;
+  }
+  const std::string output_file = params_.Get<std::string>("output_file");
+  std::ofstream file_stream;
+  std::ostream* out = &std::cout;
+  if (!output_file.empty()) {
+    file_stream.open(output_file);
+    if (!file_stream) {
+      TFLITE_LOG(ERROR) << "Failed to open " << output_file;
+      return;
+    }
+    out = &file_stream;
+  }
+
+  if (format == "json") {
+    *out << "{\"benchmark_name\": \""
+         << JsonEscape(params_.Get<std::string>("benchmark_name")) << "\""
+         << ", \"num_interpreters\": "
+         << params_.Get<int32_t>("num_interpreters")
+         << ", \"num_threads\": " << params_.Get<int32_t>("num_threads")
+         << ", \"target_qps\": " << params_.Get<float>("target_qps")
+         << ", \"achieved_qps\": " << results.achieved_qps
+         << ", \"startup_latency_us\": " << results.startup_latency_us
+         << ", \"steady_state_wall_us\": " << results.steady_state_wall_us
+         << ", \"peak_arena_bytes\": " << results.peak_arena_bytes
+         << ", \"peak_persistent_arena_bytes\": "
+         << results.peak_persistent_arena_bytes << ", \"warmup\": ";
+    WriteJsonLatency(results.warmup_latency_us, out);
+    *out << ", \"steady_state\": ";
+    WriteJsonLatency(results.latency_us, out);
+    *out << ", \"ops\": [";
+    for (int i = 0; i < results.op_stats.size(); ++i) {
+      const auto& op = results.op_stats[i];
+      *out << (i ? ", " : "") << "{\"name\": \"" << JsonEscape(op.name)
+           << "\", \"type\": \"" << JsonEscape(op.type)
+           << "\", \"count\": " << op.count
+           << ", \"sum_us\": " << op.sum_us << "}";
+    }
+    *out << "]}\n";
+  } else {
+    // One row per latency phase and per operator. Columns that do not apply
+    // to a row are left empty.
+    *out << "section,name,count,min_us,avg_us,p50_us,p90_us,p99_us,p999_us,"
+            "max_us,value\n";
+    WriteCsvLatency("warmup", results.warmup_latency_us, out);
+    WriteCsvLatency("steady_state", results.latency_us, out);
+    for (const auto& op : results.op_stats) {
+      *out << "op," << CsvEscape(op.type + " " + op.name) << "," << op.count
+           << ",,"
+           << (op.count ? static_cast<double>(op.sum_us) / op.count : 0.0)
+           << ",,,,,,\n";
+    }
+    *out << "summary,achieved_qps,,,,,,,,," << results.achieved_qps << "\n";
+    *out << "summary,peak_arena_bytes,,,,,,,,," << results.peak_arena_bytes
+         << "\n";
+    *out << "summary,peak_persistent_arena_bytes,,,,,,,,,"
+         << results.peak_persistent_arena_bytes << "\n";
+  }
 }
 
 void BenchmarkTfLiteModel::RunImpl() {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_BENCHMARK_TFLITE_MODEL_H_
 #define TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_BENCHMARK_TFLITE_MODEL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/profiling/profile_summarizer.h"
 #include "tensorflow/contrib/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/contrib/lite/tools/benchmark/latency_histogram.h"
 
 namespace tflite {
 namespace benchmark {
@@ -50,13 +52,50 @@ class ProfilingListener : public BenchmarkListener {
   bool has_profiles_;
 };
 
+// Aggregated results of a multi-interpreter load test.
+struct LoadTestResults {
+  int64_t startup_latency_us = 0;
+  // Latencies of the warmup runs, which are excluded from the steady state.
+  LatencyHistogram warmup_latency_us;
+  // Latencies of the steady state runs. In open-loop mode (--target_qps) a
+  // run's latency is measured from its scheduled start time, so time spent
+  // queued behind a slow run is included.
+  LatencyHistogram latency_us;
+  // Wall time of the steady state phase across all interpreters.
+  int64_t steady_state_wall_us = 0;
+  double achieved_qps = 0.0;
+  // Largest arena extent observed on any interpreter.
+  size_t peak_arena_bytes = 0;
+  size_t peak_persistent_arena_bytes = 0;
+
+  // Per-operator execution time, summed over all interpreters.
+  struct OpStats {
+    std::string name;
+    std::string type;
+    int64_t run_order = 0;
+    int64_t count = 0;
+    int64_t sum_us = 0;
+  };
+  std::vector<OpStats> op_stats;
+};
+
 // Benchmarks a TFLite model by running tflite interpreter.
+//
+// By default a single interpreter is run in a loop on the calling thread. When
+// --num_interpreters is greater than one, --target_qps is set or
+// --output_format is given, the model is instead run as a load generator: each
+// interpreter gets its own thread and either issues requests back to back
+// (closed loop, concurrency equals the number of interpreters) or at a fixed
+// aggregate rate (open loop).
 class BenchmarkTfLiteModel : public BenchmarkModel {
  public:
   BenchmarkTfLiteModel();
   BenchmarkTfLiteModel(BenchmarkParams params);
   virtual ~BenchmarkTfLiteModel() {}
 
+  using BenchmarkModel::Run;
+  void Run() override;
+
   std::vector<Flag> GetFlags() override;
   void LogParams() override;
   bool ValidateParams() override;
@@ -69,12 +108,23 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
     std::vector<int> shape;
   };
 
+  // Runs the multi-interpreter load test. Only valid after ValidateParams().
+  LoadTestResults RunLoadTest();
+
  protected:
   void PrepareInputsAndOutputs() override;
 
  private:
+  bool UseLoadGenerator() const;
+  void LoadModel();
+  std::unique_ptr<tflite::Interpreter> BuildInterpreter();
+  void FillInputs(tflite::Interpreter* interpreter);
+  void LogLoadTestResults(const LoadTestResults& results);
+  void WriteLoadTestResults(const LoadTestResults& results);
+
 #ifdef TFLITE_FLEX
-  std::unique_ptr<FlexDelegate> delegate_;
+  // One delegate per interpreter built by this benchmark.
+  std::vector<std::unique_ptr<FlexDelegate>> delegates_;
 #endif  // TFLITE_FLEX
   std::unique_ptr<tflite::FlatBufferModel> model;
   std::unique_ptr<tflite::Interpreter> interpreter;
@@ -0,0 +1,106 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/lite/tools/benchmark/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace tflite {
+namespace benchmark {
+
+void LatencyHistogram::Record(int64_t latency_us) {
+  if (!samples_.empty() && latency_us < samples_.back()) {
+    sorted_ = false;
+  }
+  samples_.push_back(latency_us);
+  sum_us_ += latency_us;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  if (other.samples_.empty()) {
+    return;
+  }
+  samples_.insert(samples_.end(), other.samples_.begin(),
+                  other.samples_.end());
+  sum_us_ += other.sum_us_;
+  sorted_ = false;
+}
+
+void LatencyHistogram::SortIfNeeded() const {
+  if (!sorted_) {
+    std::sort(samples_.begin(), samples_.end());
+    sorted_ = true;
+  }
+}
+
+int64_t LatencyHistogram::min() const {
+  if (samples_.empty()) return 0;
+  SortIfNeeded();
+  return samples_.front();
+}
+
+int64_t LatencyHistogram::max() const {
+  if (samples_.empty()) return 0;
+  SortIfNeeded();
+  return samples_.back();
+}
+
+double LatencyHistogram::avg() const {
+  if (samples_.empty()) return 0.0;
+  return static_cast<double>(sum_us_) / samples_.size();
+}
+
+int64_t LatencyHistogram::Percentile(double percentile) const {
+  if (samples_.empty()) return 0;
+  SortIfNeeded();
+  percentile = std::max(0.0, std::min(100.0, percentile));
+  // Nearest-rank: the smallest sample such that at least |percentile| percent
+  // of the samples are less than or equal to it. The epsilon keeps e.g. the
+  // 99.9th percentile of 1000 samples at rank 999 despite rounding error.
+  int64_t rank = static_cast<int64_t>(std::ceil(
+      percentile / 100.0 * static_cast<double>(samples_.size()) - 1e-9));
+  rank = std::max<int64_t>(rank, 1);
+  return samples_[rank - 1];
+}
+
+std::vector<int64_t> LatencyHistogram::Log2Buckets() const {
+  std::vector<int64_t> buckets;
+  for (int64_t sample : samples_) {
+    size_t bucket = 0;
+    while (sample > 0) {
+      sample >>= 1;
+      ++bucket;
+    }
+    if (bucket >= buckets.size()) {
+      buckets.resize(bucket + 1, 0);
+    }
+    ++buckets[bucket];
+  }
+  return buckets;
+}
+
+std::string LatencyHistogram::ToString() const {
+  std::stringstream stream;
+  stream << "count=" << count() << " min=" << min() << " avg=" << avg()
+         << " p50=" << Percentile(50) << " p90=" << Percentile(90)
+         << " p99=" << Percentile(99) << " p999=" << Percentile(99.9)
+         << " max=" << max();
+  return stream.str();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
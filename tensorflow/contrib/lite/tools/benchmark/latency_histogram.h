@@ -0,0 +1,73 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_LATENCY_HISTOGRAM_H_
+#define TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+// Records latency samples (in microseconds) and reports order statistics.
+//
+// All samples are retained so that percentiles are exact; a benchmark records
+// at most a few hundred thousand samples, which is cheap to keep around.
+// Instances are not thread-safe: each load generator thread records into its
+// own histogram and the results are combined with Merge() afterwards.
+class LatencyHistogram {
+ public:
+  void Record(int64_t latency_us);
+
+  // Appends all samples recorded in |other| to this histogram.
+  void Merge(const LatencyHistogram& other);
+
+  int64_t count() const { return samples_.size(); }
+  bool empty() const { return samples_.empty(); }
+  int64_t sum() const { return sum_us_; }
+  int64_t min() const;
+  int64_t max() const;
+  double avg() const;
+
+  // Returns the recorded samples, in no particular order.
+  const std::vector<int64_t>& samples() const { return samples_; }
+
+  // Returns the sample at the given percentile, in [0, 100], using the
+  // nearest-rank method. Returns 0 if the histogram is empty.
+  int64_t Percentile(double percentile) const;
+
+  // Returns bucket counts where bucket i holds samples in [2^(i-1), 2^i) us
+  // (bucket 0 holds samples below 1us). Trailing empty buckets are dropped.
+  std::vector<int64_t> Log2Buckets() const;
+
+  // Returns a one line human readable summary, e.g.
+  // "count=100 min=10 avg=12.5 p50=12 p90=14 p99=20 p999=21 max=21".
+  std::string ToString() const;
+
+ private:
+  void SortIfNeeded() const;
+
+  // Sorted lazily on the first order statistic query.
+  mutable std::vector<int64_t> samples_;
+  mutable bool sorted_ = true;
+  int64_t sum_us_ = 0;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,90 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/lite/tools/benchmark/latency_histogram.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_TRUE(histogram.empty());
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.min());
+  EXPECT_EQ(0, histogram.max());
+  EXPECT_EQ(0, histogram.Percentile(50));
+  EXPECT_DOUBLE_EQ(0.0, histogram.avg());
+  EXPECT_TRUE(histogram.Log2Buckets().empty());
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  // Record 1..1000 in reverse so the lazy sort is exercised.
+  for (int i = 1000; i >= 1; --i) {
+    histogram.Record(i);
+  }
+  EXPECT_EQ(1000, histogram.count());
+  EXPECT_EQ(1, histogram.min());
+  EXPECT_EQ(1000, histogram.max());
+  EXPECT_DOUBLE_EQ(500.5, histogram.avg());
+  EXPECT_EQ(1, histogram.Percentile(0));
+  EXPECT_EQ(500, histogram.Percentile(50));
+  EXPECT_EQ(900, histogram.Percentile(90));
+  EXPECT_EQ(990, histogram.Percentile(99));
+  EXPECT_EQ(999, histogram.Percentile(99.9));
+  EXPECT_EQ(1000, histogram.Percentile(100));
+}
+
+TEST(LatencyHistogramTest, Merge) {
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.Record(10);
+  a.Record(30);
+  b.Record(20);
+  b.Record(40);
+  a.Merge(b);
+  EXPECT_EQ(4, a.count());
+  EXPECT_EQ(100, a.sum());
+  EXPECT_EQ(20, a.Percentile(50));
+  EXPECT_EQ(40, a.max());
+  EXPECT_EQ(2, b.count());
+}
+
+TEST(LatencyHistogramTest, Log2Buckets) {
+  LatencyHistogram histogram;
+  histogram.Record(0);
+  histogram.Record(1);
+  histogram.Record(3);
+  histogram.Record(4);
+  histogram.Record(7);
+  EXPECT_THAT(histogram.Log2Buckets(), ElementsAre(1, 1, 1, 2));
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/tools/optimize/quantize_weights.h"
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,6 +41,9 @@ typedef struct {
   int32_t op_input_idx;
   // True if the tensor supports hybrid evaluation.
   bool eval_hybrid;
+  // The dimension along which the tensor is quantized per channel, or -1 to
+  // quantize it with a single scale and zero point.
+  int32_t quantized_dimension;
 } TensorInfo;
 
 // The default minimum number of elements a weights array must have to be
@@ -133,6 +137,21 @@ std::vector<int32_t> GetWeightInputIndices(const BuiltinOperator& op_code) {
   return {};
 }
 
+// Returns the dimension of the weights input `op_input_idx` of the provided op
+// that holds its output channels, or -1 if it has no such dimension.
+int32_t GetWeightChannelDimension(const BuiltinOperator& op_code,
+                                  int32_t op_input_idx) {
+  if (op_input_idx != 1) return -1;
+  if (op_code == BuiltinOperator_CONV_2D) {
+    // Filters are [output_channels, height, width, input_channels].
+    return 0;
+  } else if (op_code == BuiltinOperator_DEPTHWISE_CONV_2D) {
+    // Filters are [1, height, width, output_channels].
+    return 3;
+  }
+  return -1;
+}
+
 // Returns true if the operator supports hybrid evaluation.
 bool IsHybridEvaluationOp(const OperatorT* op, const BuiltinOperator& op_code) {
   // Operations that support hybrid evaluation.
@@ -160,7 +179,7 @@ bool IsHybridEvaluationOp(const OperatorT* op, const BuiltinOperator& op_code) {
 // quantized.
 std::vector<TensorInfo> GetQuantizableTensorsFromOperator(
     const ModelT* model, const OperatorT* op, uint64_t weights_min_num_elements,
-    bool use_hybrid_evaluation) {
+    bool use_hybrid_evaluation, bool use_per_channel_quantization) {
   SubGraphT* subgraph = model->subgraphs.at(0).get();
   const BuiltinOperator op_code =
       model->operator_codes[op->opcode_index]->builtin_code;
@@ -170,6 +189,16 @@ std::vector<TensorInfo> GetQuantizableTensorsFromOperator(
   bool eval_hybrid = use_hybrid_evaluation && IsHybridEvaluationOp(op, op_code);
 
   std::vector<int32_t> op_input_indices = GetWeightInputIndices(op_code);
+  // Hybrid kernels only support a single scale per tensor, so the ops with
+  // weights that can be quantized per channel are evaluated with Dequantize
+  // operations instead.
+  if (use_per_channel_quantization) {
+    for (const int32_t op_input_idx : op_input_indices) {
+      if (GetWeightChannelDimension(op_code, op_input_idx) >= 0) {
+        eval_hybrid = false;
+      }
+    }
+  }
   for (const int32_t op_input_idx : op_input_indices) {
     int32_t tensor_idx = op->inputs[op_input_idx];
 
@@ -219,6 +248,10 @@ std::vector<TensorInfo> GetQuantizableTensorsFromOperator(
     tensor_info.op_input_idx = op_input_idx;
     tensor_info.tensor_idx = tensor_idx;
     tensor_info.tensor = tensor;
+    tensor_info.quantized_dimension =
+        use_per_channel_quantization && !eval_hybrid
+            ? GetWeightChannelDimension(op_code, op_input_idx)
+            : -1;
 
     tensor_infos.push_back(tensor_info);
   }
@@ -228,38 +261,85 @@ std::vector<TensorInfo> GetQuantizableTensorsFromOperator(
 
 // Quantizes tensor using asymmetric quantization with the min and max elements
 // of the tensor. This is needed to pass to Dequantize operations.
-TfLiteStatus AsymmetricQuantizeTensor(ModelT* model, TensorT* tensor) {
+// If quantized_dimension is not -1, each slice of the tensor along that
+// dimension is quantized with its own min and max.
+TfLiteStatus AsymmetricQuantizeTensor(ModelT* model, TensorT* tensor,
+                                      int32_t quantized_dimension) {
   BufferT* buffer = model->buffers[tensor->buffer].get();
   float* float_data = reinterpret_cast<float*>(buffer->data.data());
   const uint64_t num_elements = NumElements(tensor);
   LOG(INFO) << "Quantizing tensor " << tensor->name << " with " << num_elements
             << " elements for float evaluation.";
 
+  // Elements of channel c are at (outer * num_channels + c) * inner_size + i.
+  uint64_t num_channels = 1;
+  uint64_t inner_size = num_elements;
+  if (quantized_dimension >= 0) {
+    if (quantized_dimension >= tensor->shape.size()) {
+      LOG(ERROR) << "Cannot quantize tensor " << tensor->name
+                 << " along dimension " << quantized_dimension << ".";
+      return kTfLiteError;
+    }
+    num_channels = tensor->shape[quantized_dimension];
+    inner_size = 1;
+    for (int d = quantized_dimension + 1; d < tensor->shape.size(); ++d) {
+      inner_size *= tensor->shape[d];
+    }
+  }
+  const uint64_t outer_size = num_elements / (num_channels * inner_size);
+
   // Compute the quantization params.
-  float min_value = *std::min_element(float_data, float_data + num_elements);
-  float max_value = *std::max_element(float_data, float_data + num_elements);
+  std::vector<float> min_values(num_channels,
+                                std::numeric_limits<float>::max());
+  std::vector<float> max_values(num_channels,
+                                std::numeric_limits<float>::lowest());
+  for (uint64_t outer = 0; outer < outer_size; ++outer) {
+    for (uint64_t c = 0; c < num_channels; ++c) {
+      const float* slice =
+          float_data + (outer * num_channels + c) * inner_size;
+      min_values[c] =
+          std::min(min_values[c], *std::min_element(slice, slice + inner_size));
+      max_values[c] =
+          std::max(max_values[c], *std::max_element(slice, slice + inner_size));
+    }
+  }
 
   if (tensor->quantization == nullptr) {
     tensor->quantization = absl::make_unique<QuantizationParametersT>();
   }
-  GetAsymmetricQuantizationParams(min_value, max_value, 0, 255,
-                                  tensor->quantization.get());
+  std::vector<float> scales(num_channels);
+  std::vector<int64_t> zero_points(num_channels);
+  for (uint64_t c = 0; c < num_channels; ++c) {
+    QuantizationParametersT channel_params;
+    GetAsymmetricQuantizationParams(min_values[c], max_values[c], 0, 255,
+                                    &channel_params);
+    scales[c] = channel_params.scale[0];
+    zero_points[c] = channel_params.zero_point[0];
+  }
+  tensor->quantization->scale = scales;
+  tensor->quantization->zero_point = zero_points;
+  tensor->quantization->quantized_dimension =
+      quantized_dimension >= 0 ? quantized_dimension : 0;
 
   // Quantize the buffer.
   std::vector<uint8_t> quantized_buffer;
   quantized_buffer.resize(num_elements);
-  const double inverse_scale = 1. / tensor->quantization->scale[0];
-  for (std::size_t i = 0; i < num_elements; i++) {
-    const float src_val = float_data[i];
-    double scaled_val;
-    if (tensor->quantization->scale[0] == 0) {
-      scaled_val = tensor->quantization->zero_point[0];
-    } else {
-      scaled_val =
-          tensor->quantization->zero_point[0] + inverse_scale * src_val;
+  for (uint64_t outer = 0; outer < outer_size; ++outer) {
+    for (uint64_t c = 0; c < num_channels; ++c) {
+      const uint64_t offset = (outer * num_channels + c) * inner_size;
+      const double inverse_scale = 1. / scales[c];
+      for (uint64_t i = offset; i < offset + inner_size; i++) {
+        const float src_val = float_data[i];
+        double scaled_val;
+        if (scales[c] == 0) {
+          scaled_val = zero_points[c];
+        } else {
+          scaled_val = zero_points[c] + inverse_scale * src_val;
+        }
+        uint8_t integer_val = static_cast<uint8_t>(std::round(scaled_val));
+        quantized_buffer[i] = integer_val;
+      }
     }
-    uint8_t integer_val = static_cast<uint8_t>(std::round(scaled_val));
-    quantized_buffer[i] = integer_val;
   }
   model->buffers[tensor->buffer]->data = quantized_buffer;
 
@@ -344,7 +424,8 @@ void MakeTensor(const string& name, const std::vector<int32_t>& shape,
 TfLiteStatus QuantizeWeightsInternal(flatbuffers::FlatBufferBuilder* builder,
                                      const Model* input_model,
                                      bool use_hybrid_evaluation,
-                                     uint64_t weights_min_num_elements) {
+                                     uint64_t weights_min_num_elements,
+                                     bool use_per_channel_quantization) {
   std::unique_ptr<ModelT> model;
   model.reset(input_model->UnPack());
 
@@ -362,7 +443,8 @@ TfLiteStatus QuantizeWeightsInternal(flatbuffers::FlatBufferBuilder* builder,
     OperatorT* op = subgraph->operators[i].get();
 
     std::vector<TensorInfo> tensor_infos = GetQuantizableTensorsFromOperator(
-        model.get(), op, weights_min_num_elements, use_hybrid_evaluation);
+        model.get(), op, weights_min_num_elements, use_hybrid_evaluation,
+        use_per_channel_quantization);
 
     for (const TensorInfo& tensor_info : tensor_infos) {
       if (tensor_info.eval_hybrid) {
@@ -371,8 +453,8 @@ TfLiteStatus QuantizeWeightsInternal(flatbuffers::FlatBufferBuilder* builder,
             SymmetricQuantizeTensor(model.get(), tensor_info.tensor));
       } else {
         // Quantize the tensor.
-        TF_LITE_ENSURE_STATUS(
-            AsymmetricQuantizeTensor(model.get(), tensor_info.tensor));
+        TF_LITE_ENSURE_STATUS(AsymmetricQuantizeTensor(
+            model.get(), tensor_info.tensor, tensor_info.quantized_dimension));
 
         // Create a new tensor to be the output of the dequantize op.
         std::unique_ptr<TensorT> dequantize_output;
@@ -417,7 +499,8 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
   // By default we require that only weights with more than
   // kWeightsMinSizeDefault elements are quantized.
   return QuantizeWeightsInternal(builder, input_model, use_hybrid_evaluation,
-                                 kWeightsMinNumElementsDefault);
+                                 kWeightsMinNumElementsDefault,
+                                 /*use_per_channel_quantization=*/false);
 }
 }  // namespace internal
 
@@ -425,7 +508,17 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
                              const Model* input_model,
                              uint64_t weights_min_num_elements) {
   return QuantizeWeightsInternal(builder, input_model, true,
-                                 weights_min_num_elements);
+                                 weights_min_num_elements,
+                                 /*use_per_channel_quantization=*/false);
+}
+
+TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
+                             const Model* input_model,
+                             uint64_t weights_min_num_elements,
+                             bool use_per_channel_quantization) {
+  return QuantizeWeightsInternal(builder, input_model, true,
+                                 weights_min_num_elements,
+                                 use_per_channel_quantization);
 }
 
 TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
@@ -433,7 +526,8 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
   // By default we require that only weights with more than
   // kWeightsMinSizeDefault elements are quantized.
   return QuantizeWeightsInternal(builder, input_model, true,
-                                 kWeightsMinNumElementsDefault);
+                                 kWeightsMinNumElementsDefault,
+                                 /*use_per_channel_quantization=*/false);
 }
 
 }  // namespace optimize
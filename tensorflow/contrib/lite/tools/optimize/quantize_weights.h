@@ -40,6 +40,15 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
                              const Model* input_model,
                              uint64_t weights_min_num_elements);
 
+// Same as above, but if use_per_channel_quantization is true, the filters of
+// CONV_2D and DEPTHWISE_CONV_2D are quantized with one scale and zero point
+// per output channel. As hybrid kernels only support one scale per tensor,
+// these convolutions are then evaluated in float after Dequantize operations.
+TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
+                             const Model* input_model,
+                             uint64_t weights_min_num_elements,
+                             bool use_per_channel_quantization);
+
 namespace internal {
 // If use_hybrid_evaluation is false, will disable using hybrid eval for
 // operations that support it.
@@ -213,6 +213,78 @@ TEST_F(QuantizeWeightsTest, SimpleTestWithWeightsMinNumElements) {
   CheckWeights(input_model, output_model, true, kWeightsMinNumElements);
 }
 
+TEST_F(QuantizeWeightsTest, SimpleTestWithPerChannel) {
+  string model_path =
+      "third_party/tensorflow/contrib/lite/tools/optimize/testdata/"
+      "mobilenet_v1_0.25_128.tflite";
+  std::unique_ptr<FlatBufferModel> input_fb =
+      FlatBufferModel::BuildFromFile(model_path.data());
+  const Model* input_model = input_fb->GetModel();
+
+  flatbuffers::FlatBufferBuilder builder;
+  EXPECT_EQ(QuantizeWeights(&builder, input_model, /*weights_min_num_elements=*/
+                            1024, /*use_per_channel_quantization=*/true),
+            kTfLiteOk);
+
+  const uint8_t* buffer = builder.GetBufferPointer();
+  const Model* output_model = GetModel(buffer);
+  std::unique_ptr<ModelT> input_model_t(input_model->UnPack());
+  std::unique_ptr<ModelT> output_model_t(output_model->UnPack());
+  const SubGraphT* subgraph = output_model_t->subgraphs.at(0).get();
+
+  int num_conv_tensors = 0;
+  int num_depthwise_conv_tensors = 0;
+  for (int i = 0; i < subgraph->operators.size(); ++i) {
+    const OperatorT* op = subgraph->operators[i].get();
+    const BuiltinOperator op_code =
+        output_model_t->operator_codes[op->opcode_index]->builtin_code;
+    if (op_code != BuiltinOperator_CONV_2D &&
+        op_code != BuiltinOperator_DEPTHWISE_CONV_2D) {
+      continue;
+    }
+
+    // The filters of both convolutions are dequantized, even though CONV_2D
+    // supports hybrid evaluation.
+    const OperatorT* preceding_op = GetOpWithOutput(subgraph, op->inputs[1]);
+    if (preceding_op == nullptr) continue;  // Too small to be quantized.
+    const TensorT* quantized_tensor =
+        subgraph->tensors[preceding_op->inputs[0]].get();
+    ASSERT_TRUE(quantized_tensor->type == TensorType_UINT8);
+
+    // Conv filters are [output_channels, height, width, input_channels], and
+    // depthwise filters are [1, height, width, output_channels].
+    const int quantized_dimension = op_code == BuiltinOperator_CONV_2D ? 0 : 3;
+    const QuantizationParametersT* quantization =
+        quantized_tensor->quantization.get();
+    const int num_channels = quantized_tensor->shape[quantized_dimension];
+    ASSERT_EQ(quantization->quantized_dimension, quantized_dimension);
+    ASSERT_EQ(quantization->scale.size(), num_channels);
+    ASSERT_EQ(quantization->zero_point.size(), num_channels);
+
+    const float* input_data = reinterpret_cast<const float*>(
+        input_model_t->buffers[quantized_tensor->buffer]->data.data());
+    const uint8_t* output_data =
+        output_model_t->buffers[quantized_tensor->buffer]->data.data();
+    const int num_elements = GetElementsNum(quantized_tensor);
+    const int channel_size = num_elements / num_channels;
+    for (int j = 0; j < num_elements; ++j) {
+      const int c = op_code == BuiltinOperator_CONV_2D ? j / channel_size
+                                                        : j % num_channels;
+      const float scale = quantization->scale[c];
+      const float diff = input_data[j] -
+                         (output_data[j] - quantization->zero_point[c]) * scale;
+      ASSERT_LE(std::abs(diff), scale);
+    }
+    if (op_code == BuiltinOperator_CONV_2D) {
+      ++num_conv_tensors;
+    } else {
+      ++num_depthwise_conv_tensors;
+    }
+  }
+  EXPECT_GT(num_conv_tensors, 0);
+  EXPECT_GT(num_depthwise_conv_tensors, 0);
+}
+
 // TODO(suharshs): Add tests that run the resulting model.
 
 }  // namespace
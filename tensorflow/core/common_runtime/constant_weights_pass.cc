@@ -0,0 +1,78 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_weights_pass.h"
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns true if `n` has weights, as its input 1, that its kernel can pack
+// once when they are constant.
+bool HasPackedWeights(const Node* n) {
+  const string& op = n->type_string();
+  return op == "MatMul" || op == "Conv2D" || op == "QuantizedMatMul" ||
+         op == "QuantizedConv2D";
+}
+
+// Returns true if the output of `src` is the output of a Const. The values of
+// a Const never change: ConstantOp holds on to its tensor, so no kernel can
+// forward it to an output that it then writes.
+bool IsConstantOutput(const Node* src) {
+  while (!src->IsConstant()) {
+    bool is_constant_enter = false;
+    if (src->IsEnter()) {
+      if (!GetNodeAttr(src->attrs(), "is_constant", &is_constant_enter).ok()) {
+        return false;
+      }
+    }
+    if (!src->IsIdentity() && !is_constant_enter) return false;
+    const Edge* edge;
+    if (!src->input_edge(0, &edge).ok()) return false;
+    src = edge->src();
+  }
+  return true;
+}
+
+}  // namespace
+
+Status ConstantWeightsPass::Run(const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr) {
+    return Status::OK();
+  }
+  Graph* g = options.graph->get();
+  if (g == nullptr) {
+    return errors::Internal(
+        "Constant weights should be marked before partitioning and a graph "
+        "should be available.");
+  }
+  for (Node* n : g->op_nodes()) {
+    if (!HasPackedWeights(n)) continue;
+    const Edge* weights;
+    if (n->input_edge(1, &weights).ok() && IsConstantOutput(weights->src())) {
+      n->AddAttr(kConstantWeightsAttrName, true);
+    }
+  }
+  return Status::OK();
+}
+
+// After grappler, whose constant folding may turn more weights into Consts.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 0,
+                      ConstantWeightsPass);
+
+}  // namespace tensorflow
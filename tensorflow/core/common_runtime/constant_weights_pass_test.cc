@@ -0,0 +1,109 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_weights_pass.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/control_flow_ops_internal.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ConstantWeightsPassTest : public ::testing::Test {
+ protected:
+  ConstantWeightsPassTest() : root_(Scope::NewRootScope().ExitOnError()) {}
+
+  // Adds a QuantizedMatMul named `name` by the weights `b`.
+  void AddQuantizedMatMul(const string& name, Input b) {
+    auto min = ops::Const(root_, 0.0f);
+    auto max = ops::Const(root_, 1.0f);
+    auto a = ops::Placeholder(root_, DT_QUINT8);
+    ops::QuantizedMatMul(root_.WithOpName(name), a, b, min, max, min, max);
+  }
+
+  // Runs the pass, and returns the nodes that it marked.
+  std::vector<string> MarkedNodes() {
+    std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+    TF_CHECK_OK(root_.ToGraph(graph.get()));
+    GraphOptimizationPassOptions options;
+    options.graph = &graph;
+    ConstantWeightsPass pass;
+    TF_CHECK_OK(pass.Run(options));
+    std::vector<string> marked;
+    for (const Node* n : graph->op_nodes()) {
+      bool constant_weights;
+      if (GetNodeAttr(n->attrs(), kConstantWeightsAttrName, &constant_weights)
+              .ok()) {
+        EXPECT_TRUE(constant_weights);
+        marked.push_back(n->name());
+      }
+    }
+    std::sort(marked.begin(), marked.end());
+    return marked;
+  }
+
+  Scope root_;
+};
+
+TEST_F(ConstantWeightsPassTest, MarksConstantWeights) {
+  Tensor weights(DT_QUINT8, TensorShape({2, 2}));
+  weights.flat<quint8>().setZero();
+  auto constant = ops::Const(root_.WithOpName("weights"), weights);
+  AddQuantizedMatMul("const", constant);
+  AddQuantizedMatMul("identity",
+                     ops::Identity(root_, ops::Identity(root_, constant)));
+  AddQuantizedMatMul(
+      "constant_enter",
+      ops::internal::Enter(root_, constant, "frame",
+                           ops::internal::Enter::IsConstant(true)));
+
+  AddQuantizedMatMul("placeholder", ops::Placeholder(root_, DT_QUINT8));
+  AddQuantizedMatMul("enter", ops::internal::Enter(root_, constant, "frame"));
+  auto variable = ops::Variable(root_, TensorShape({2, 2}), DT_QUINT8);
+  AddQuantizedMatMul("variable", ops::Identity(root_, variable));
+
+  EXPECT_EQ(std::vector<string>({"const", "constant_enter", "identity"}),
+            MarkedNodes());
+}
+
+TEST_F(ConstantWeightsPassTest, MarksFloatProducts) {
+  auto weights = ops::Const(root_, {{1.0f, 2.0f}, {3.0f, 4.0f}});
+  auto input = ops::Placeholder(root_, DT_FLOAT);
+  ops::MatMul(root_.WithOpName("matmul"), input, weights);
+  // A Reshape is only followed once grappler has folded it into a Const.
+  ops::Conv2D(root_.WithOpName("conv_by_reshape"), input,
+              ops::Reshape(root_, weights, {1, 1, 2, 2}), {1, 1, 1, 1},
+              "VALID");
+  ops::Conv2D(root_.WithOpName("conv_by_const"), input,
+              ops::Const(root_, 1.0f, TensorShape({1, 1, 2, 2})),
+              {1, 1, 1, 1}, "VALID");
+  auto variable = ops::Variable(root_, TensorShape({2, 2}), DT_FLOAT);
+  ops::MatMul(root_.WithOpName("matmul_by_variable"), input, variable);
+  // Ops that don't pack their input 1 are left alone.
+  ops::Add(root_.WithOpName("add"), input, weights);
+
+  EXPECT_EQ(std::vector<string>({"conv_by_const", "matmul"}), MarkedNodes());
+}
+
+}  // namespace
+}  // namespace tensorflow
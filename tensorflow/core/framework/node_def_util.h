@@ -44,6 +44,12 @@ extern const char* const kColocationAttrName;
 // String prefix applied to the operation name for colocation constraints.
 extern const char* const kColocationGroupPrefix;
 
+// Name of the bool attribute that marks the nodes whose weights, their input
+// 1, are the output of a Const and so never change. It is set by
+// ConstantWeightsPass, and lets kernels keep the weights in a layout of their
+// own across steps.
+extern const char* const kConstantWeightsAttrName;
+
 // Produce a human-readable version of a Node or NodeDef that is more concise
 // than a text-format proto.
 string SummarizeNode(const Node& node);
@@ -20,10 +20,12 @@ limitations under the License.
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/op_cost_calibrator.h"
 #include "tensorflow/core/grappler/costs/robust_stats.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/public/session.h"
 
@@ -100,6 +102,10 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
       const double time = (finish - start).count() * 1e3;
       times[step] = time;
     }
+    if (op_cost_calibrator_ && !running_simulation) {
+      op_cost_calibrator_->AddCostGraph(metadata.cost_graph(),
+                                        optimized_graph);
+    }
     if (cost_graph && (step + 1 == measurement_steps_)) {
       metadata.mutable_cost_graph()->Swap(cost_graph);
     }
@@ -144,5 +150,24 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
 
   return Status::OK();
 }
+
+Status CalibrateOpCosts(Cluster* cluster, const std::vector<GrapplerItem>& items,
+                        int measurement_steps, OpCostCalibrator* calibrator) {
+  if (!cluster->DetailedStatsEnabled()) {
+    return errors::FailedPrecondition(
+        "Calibration requires a cluster that collects detailed stats");
+  }
+  for (const GrapplerItem& item : items) {
+    VLOG(1) << "Calibrating with " << item.id;
+    MeasuringCostEstimator estimator(cluster, measurement_steps,
+                                     /*measurement_threads=*/0);
+    estimator.set_op_cost_calibrator(calibrator);
+    TF_RETURN_IF_ERROR(estimator.Initialize(item));
+    Costs costs;
+    TF_RETURN_IF_ERROR(estimator.PredictCosts(item.graph, nullptr, &costs));
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -36,6 +36,7 @@ namespace grappler {
 
 class Cluster;
 struct GrapplerItem;
+class OpCostCalibrator;
 
 // Estimate the cost of running a Grappler item by actually running the
 // corresponding TensorFlow graph on the specified cluster and measuring the
@@ -61,6 +62,13 @@ class MeasuringCostEstimator : public CostEstimator {
   Status PredictCosts(const GraphDef& optimized_graph, CostGraphDef* cost_graph,
                       Costs* overall_cost) const override;
 
+  // When set, the per-op execution times of every measurement step are
+  // recorded into the calibrator. This requires the cluster to collect
+  // detailed stats. Does not take ownership of calibrator.
+  void set_op_cost_calibrator(OpCostCalibrator* calibrator) {
+    op_cost_calibrator_ = calibrator;
+  }
+
  private:
   Cluster* cluster_;  // Not owned.
   int measurement_steps_;
@@ -68,8 +76,15 @@ class MeasuringCostEstimator : public CostEstimator {
   std::vector<std::pair<string, Tensor>> feed_;
   std::vector<string> fetch_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  OpCostCalibrator* op_cost_calibrator_ = nullptr;  // Not owned.
 };
 
+// Measures every item on the cluster, recording the per-op execution times
+// into calibrator. Typically used with CreateCalibrationMicrobenchmarks() to
+// calibrate the analytical cost model for the machine the cluster runs on.
+Status CalibrateOpCosts(Cluster* cluster, const std::vector<GrapplerItem>& items,
+                        int measurement_steps, OpCostCalibrator* calibrator);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
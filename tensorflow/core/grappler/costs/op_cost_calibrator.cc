@@ -0,0 +1,199 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibrator.h"
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+OpCostCalibrator::OpCostCalibrator() {
+  // Calibration factors are relative to the analytical model, so the
+  // estimator must not pick up a profile from the environment.
+  estimator_.SetCalibrationProfile(OpCostCalibrationProfile());
+}
+
+void OpCostCalibrator::AddMeasurement(const OpInfo& op_info,
+                                      Costs::Duration measured_time) {
+  if (measured_time.count() <= 0) {
+    return;
+  }
+  OpContext op_context;
+  op_context.op_info = op_info;
+  const Costs predicted = estimator_.PredictUncalibratedCosts(op_context);
+  if (predicted.execution_time.count() <= 0) {
+    return;
+  }
+  const int size_class = estimator_.CalibrationSizeClass(op_info);
+
+  mutex_lock l(mu_);
+  auto accumulate = [&](int key_size_class) {
+    Accumulator& accumulator = accumulators_[std::make_tuple(
+        op_info.device().type(), op_info.op(), key_size_class)];
+    ++accumulator.num_samples;
+    accumulator.measured_time_ns += measured_time.count();
+    accumulator.predicted_time_ns += predicted.execution_time.count();
+  };
+  // Ops of unknown size only contribute to the entry covering all sizes.
+  if (size_class >= 0) {
+    accumulate(size_class);
+  }
+  accumulate(-1);
+}
+
+void OpCostCalibrator::AddCostGraph(const CostGraphDef& cost_graph,
+                                    const GraphDef& graph) {
+  const OpPerformanceList performance =
+      CostGraphToOpPerformanceData(cost_graph, graph);
+  for (const auto& op_performance : performance.op_performance()) {
+    AddMeasurement(op_performance.op(),
+                   Costs::NanoSeconds(op_performance.compute_cost()));
+  }
+}
+
+OpCostCalibrationProfile OpCostCalibrator::GetProfile() const {
+  OpCostCalibrationProfile profile;
+  mutex_lock l(mu_);
+  for (const auto& it : accumulators_) {
+    OpCostCalibration* calibration = profile.add_calibration();
+    calibration->set_device_type(std::get<0>(it.first));
+    calibration->set_op(std::get<1>(it.first));
+    calibration->set_size_class(std::get<2>(it.first));
+    calibration->set_num_samples(it.second.num_samples);
+    calibration->set_measured_time_ns(it.second.measured_time_ns);
+    calibration->set_predicted_time_ns(it.second.predicted_time_ns);
+  }
+  return profile;
+}
+
+Status OpCostCalibrator::WriteProfile(Env* env, const string& fname) const {
+  const OpCostCalibrationProfile profile = GetProfile();
+  if (str_util::EndsWith(fname, ".pbtxt")) {
+    return WriteTextProto(env, fname, profile);
+  }
+  return WriteBinaryProto(env, fname, profile);
+}
+
+namespace {
+
+NodeDef* AddPlaceholder(const string& name, const TensorShape& shape,
+                        GrapplerItem* item) {
+  NodeDef* node = item->graph.add_node();
+  node->set_name(name);
+  node->set_op("Placeholder");
+  AddNodeAttr("dtype", DT_FLOAT, node);
+  AddNodeAttr("shape", PartialTensorShape(shape.dim_sizes()), node);
+
+  Tensor value(DT_FLOAT, shape);
+  value.flat<float>().setRandom();
+  item->feed.emplace_back(name, value);
+  return node;
+}
+
+NodeDef* AddOp(const string& op, const std::vector<string>& inputs,
+               GrapplerItem* item) {
+  NodeDef* node = item->graph.add_node();
+  node->set_name(op);
+  node->set_op(op);
+  for (const string& input : inputs) {
+    node->add_input(input);
+  }
+  AddNodeAttr("T", DT_FLOAT, node);
+  item->fetch.push_back(node->name());
+  return node;
+}
+
+GrapplerItem CreateCwiseItem(const string& op, int num_inputs,
+                             int64 num_elements) {
+  GrapplerItem item;
+  item.id = strings::StrCat("calibration/", op, "/", num_elements);
+  std::vector<string> inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    inputs.push_back(strings::StrCat("x", i));
+    AddPlaceholder(inputs.back(), TensorShape({num_elements}), &item);
+  }
+  AddOp(op, inputs, &item);
+  return item;
+}
+
+GrapplerItem CreateMatMulItem(int64 m, int64 k, int64 n) {
+  GrapplerItem item;
+  item.id = strings::StrCat("calibration/MatMul/", m, "x", k, "x", n);
+  AddPlaceholder("a", TensorShape({m, k}), &item);
+  AddPlaceholder("b", TensorShape({k, n}), &item);
+  NodeDef* node = AddOp("MatMul", {"a", "b"}, &item);
+  AddNodeAttr("transpose_a", false, node);
+  AddNodeAttr("transpose_b", false, node);
+  return item;
+}
+
+GrapplerItem CreateConv2DItem(int64 batch, int64 size, int64 in_depth,
+                              int64 out_depth, int64 kernel_size) {
+  GrapplerItem item;
+  item.id = strings::StrCat("calibration/Conv2D/", batch, "x", size, "x", size,
+                            "x", in_depth, "_", kernel_size, "x", kernel_size,
+                            "x", out_depth);
+  AddPlaceholder("input", TensorShape({batch, size, size, in_depth}), &item);
+  AddPlaceholder("filter",
+                 TensorShape({kernel_size, kernel_size, in_depth, out_depth}),
+                 &item);
+  NodeDef* node = AddOp("Conv2D", {"input", "filter"}, &item);
+  AddNodeAttr("strides", std::vector<int>({1, 1, 1, 1}), node);
+  AddNodeAttr("dilations", std::vector<int>({1, 1, 1, 1}), node);
+  AddNodeAttr("padding", "SAME", node);
+  AddNodeAttr("data_format", "NHWC", node);
+  AddNodeAttr("use_cudnn_on_gpu", true, node);
+  return item;
+}
+
+}  // namespace
+
+std::vector<GrapplerItem> CreateCalibrationMicrobenchmarks() {
+  std::vector<GrapplerItem> items;
+  // Element-wise ops from 4KB to 16MB of float data, two size classes apart.
+  for (int64 num_elements = 1 << 10; num_elements <= (1 << 22);
+       num_elements <<= 2) {
+    for (const char* op : {"Relu", "Tanh", "Sigmoid", "Exp"}) {
+      items.push_back(CreateCwiseItem(op, 1, num_elements));
+    }
+    for (const char* op : {"Add", "Mul", "Maximum"}) {
+      items.push_back(CreateCwiseItem(op, 2, num_elements));
+    }
+  }
+  for (int64 size = 32; size <= 1024; size *= 2) {
+    items.push_back(CreateMatMulItem(size, size, size));
+  }
+  // Skinny products as seen in fully connected layers at small batch sizes.
+  for (int64 batch : {1, 8, 32}) {
+    items.push_back(CreateMatMulItem(batch, 1024, 1024));
+  }
+  items.push_back(CreateConv2DItem(1, 56, 64, 64, 3));
+  items.push_back(CreateConv2DItem(1, 28, 128, 128, 3));
+  items.push_back(CreateConv2DItem(1, 14, 256, 256, 3));
+  items.push_back(CreateConv2DItem(1, 56, 64, 256, 1));
+  items.push_back(CreateConv2DItem(8, 28, 128, 128, 3));
+  return items;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
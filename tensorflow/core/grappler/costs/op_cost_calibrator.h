@@ -0,0 +1,83 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATOR_H_
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Accumulates measured op execution times and compares them against the
+// predictions of the uncalibrated OpLevelCostEstimator to build an
+// OpCostCalibrationProfile. This class is thread-safe.
+class OpCostCalibrator {
+ public:
+  OpCostCalibrator();
+
+  // Records one execution of the op described by op_info that took
+  // measured_time. Ops whose analytical cost is zero, or that did not take
+  // any measurable time, are ignored.
+  void AddMeasurement(const OpInfo& op_info, Costs::Duration measured_time);
+
+  // Records the measured execution time of every node of the cost graph,
+  // which is typically taken from the RunMetadata of a step of graph.
+  void AddCostGraph(const CostGraphDef& cost_graph, const GraphDef& graph);
+
+  // Returns a profile with an entry per (device type, op type, size class)
+  // as well as an entry per (device type, op type) covering all sizes.
+  OpCostCalibrationProfile GetProfile() const;
+
+  // Writes the profile as a binary proto, or as a text proto if the file name
+  // ends in .pbtxt.
+  Status WriteProfile(Env* env, const string& fname) const;
+
+ private:
+  struct Accumulator {
+    int64 num_samples = 0;
+    double measured_time_ns = 0;
+    double predicted_time_ns = 0;
+  };
+
+  OpLevelCostEstimator estimator_;
+  mutable mutex mu_;
+  // Keyed by (device type, op type, size class).
+  std::map<std::tuple<string, string, int>, Accumulator> accumulators_
+      GUARDED_BY(mu_);
+};
+
+// Returns single-op graphs that exercise common op types over a range of
+// shape classes. Running them through a MeasuringCostEstimator with an
+// OpCostCalibrator attached calibrates the cost model for the local machine.
+std::vector<GrapplerItem> CreateCalibrationMicrobenchmarks();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATOR_H_
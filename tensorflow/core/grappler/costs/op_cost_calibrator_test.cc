@@ -0,0 +1,165 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibrator.h"
+
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void DescribeMatrix(int rows, int columns, OpInfo* op_info) {
+  auto input = op_info->add_inputs();
+  input->set_dtype(DT_FLOAT);
+  auto shape = input->mutable_shape();
+  shape->add_dim()->set_size(rows);
+  shape->add_dim()->set_size(columns);
+}
+
+OpContext DescribeMatMul(int m, int n, int k) {
+  OpContext op_context;
+  auto device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);  // 10000000 KB/s = 10 GB/s
+  device->set_frequency(1000);      // 1000 Mhz = 1 GHz
+  op_context.op_info.set_op("MatMul");
+  DescribeMatrix(m, k, &op_context.op_info);
+  DescribeMatrix(k, n, &op_context.op_info);
+  return op_context;
+}
+
+class OpCostCalibratorTest : public ::testing::Test {
+ protected:
+  // Records a measurement that took `factor` times the analytical estimate.
+  void AddScaledMeasurement(const OpContext& op_context, double factor) {
+    const Costs predicted = estimator_.PredictUncalibratedCosts(op_context);
+    calibrator_.AddMeasurement(
+        op_context.op_info,
+        Costs::NanoSeconds(predicted.execution_time.count() * factor));
+  }
+
+  OpLevelCostEstimator estimator_;
+  OpCostCalibrator calibrator_;
+};
+
+TEST_F(OpCostCalibratorTest, ProfileHasSizeClassAndOpEntries) {
+  const OpContext op_context = DescribeMatMul(256, 256, 256);
+  AddScaledMeasurement(op_context, 2.0);
+  AddScaledMeasurement(op_context, 4.0);
+
+  const OpCostCalibrationProfile profile = calibrator_.GetProfile();
+  ASSERT_EQ(2, profile.calibration_size());
+  const int size_class = estimator_.CalibrationSizeClass(op_context.op_info);
+  // 2 inputs of 256x256 floats.
+  EXPECT_EQ(19, size_class);
+  bool found_size_class = false;
+  bool found_all_sizes = false;
+  for (const auto& calibration : profile.calibration()) {
+    EXPECT_EQ("MatMul", calibration.op());
+    EXPECT_EQ("CPU", calibration.device_type());
+    EXPECT_EQ(2, calibration.num_samples());
+    EXPECT_NEAR(3.0,
+                calibration.measured_time_ns() /
+                    calibration.predicted_time_ns(),
+                1e-2);
+    found_size_class |= calibration.size_class() == size_class;
+    found_all_sizes |= calibration.size_class() == -1;
+  }
+  EXPECT_TRUE(found_size_class);
+  EXPECT_TRUE(found_all_sizes);
+}
+
+TEST_F(OpCostCalibratorTest, IgnoresZeroMeasurements) {
+  calibrator_.AddMeasurement(DescribeMatMul(16, 16, 16).op_info,
+                             Costs::NanoSeconds(0));
+  EXPECT_EQ(0, calibrator_.GetProfile().calibration_size());
+}
+
+TEST_F(OpCostCalibratorTest, EstimatorAppliesProfile) {
+  const OpContext small = DescribeMatMul(64, 64, 64);
+  const OpContext large = DescribeMatMul(1024, 1024, 1024);
+  const OpContext other_size = DescribeMatMul(128, 128, 128);
+  AddScaledMeasurement(small, 4.0);
+  AddScaledMeasurement(large, 2.0);
+
+  EXPECT_FALSE(estimator_.HasCalibrationProfile());
+  const Costs uncalibrated_small = estimator_.PredictCosts(small);
+  const Costs uncalibrated_large = estimator_.PredictCosts(large);
+  const Costs uncalibrated_other = estimator_.PredictCosts(other_size);
+
+  estimator_.SetCalibrationProfile(calibrator_.GetProfile());
+  EXPECT_TRUE(estimator_.HasCalibrationProfile());
+  EXPECT_NEAR(4.0 * uncalibrated_small.execution_time.count(),
+              estimator_.PredictCosts(small).execution_time.count(), 4);
+  EXPECT_NEAR(2.0 * uncalibrated_large.execution_time.count(),
+              estimator_.PredictCosts(large).execution_time.count(), 4);
+
+  // Sizes without an entry of their own use the ratio over all sizes, which
+  // is dominated by the large, long running op.
+  const double factor =
+      static_cast<double>(
+          estimator_.PredictCosts(other_size).execution_time.count()) /
+      uncalibrated_other.execution_time.count();
+  EXPECT_GT(factor, 2.0);
+  EXPECT_LT(factor, 4.0);
+
+  // Ops without any calibration entry keep their analytical cost.
+  OpContext batch_mat_mul = small;
+  batch_mat_mul.op_info.set_op("BatchMatMul");
+  EXPECT_EQ(
+      estimator_.PredictUncalibratedCosts(batch_mat_mul).execution_time.count(),
+      estimator_.PredictCosts(batch_mat_mul).execution_time.count());
+
+  estimator_.SetCalibrationProfile(OpCostCalibrationProfile());
+  EXPECT_FALSE(estimator_.HasCalibrationProfile());
+  EXPECT_EQ(uncalibrated_small.execution_time.count(),
+            estimator_.PredictCosts(small).execution_time.count());
+}
+
+TEST_F(OpCostCalibratorTest, WriteProfile) {
+  AddScaledMeasurement(DescribeMatMul(64, 64, 64), 2.0);
+  const OpCostCalibrationProfile expected = calibrator_.GetProfile();
+  for (const char* fname : {"profile.pb", "profile.pbtxt"}) {
+    const string path = io::JoinPath(testing::TmpDir(), fname);
+    TF_ASSERT_OK(calibrator_.WriteProfile(Env::Default(), path));
+    OpCostCalibrationProfile profile;
+    if (str_util::EndsWith(path, ".pbtxt")) {
+      TF_ASSERT_OK(ReadTextProto(Env::Default(), path, &profile));
+    } else {
+      TF_ASSERT_OK(ReadBinaryProto(Env::Default(), path, &profile));
+    }
+    EXPECT_EQ(expected.DebugString(), profile.DebugString());
+  }
+}
+
+TEST_F(OpCostCalibratorTest, Microbenchmarks) {
+  const std::vector<GrapplerItem> items = CreateCalibrationMicrobenchmarks();
+  EXPECT_FALSE(items.empty());
+  for (const GrapplerItem& item : items) {
+    EXPECT_FALSE(item.id.empty());
+    ASSERT_EQ(1, item.fetch.size()) << item.id;
+    EXPECT_EQ(item.graph.node_size(), item.feed.size() + 1) << item.id;
+  }
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -22,6 +22,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -169,6 +172,35 @@ int64 CwiseOutputElementCount(const TensorShapeProto& input_shape_1,
   return count;
 }
 
+// Returns the calibration profile named by the TF_GRAPPLER_OP_COST_PROFILE
+// environment variable, or null if there is none. The file is read once per
+// process, as estimators are created for every cost model and optimizer run.
+// The profile is a binary OpCostCalibrationProfile, or a text one if the file
+// name ends in .pbtxt.
+const OpCostCalibrationProfile* EnvCalibrationProfile() {
+  static const OpCostCalibrationProfile* const kProfile = [] {
+    string profile_path;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_OP_COST_PROFILE", "",
+                                     &profile_path));
+    if (profile_path.empty()) {
+      return static_cast<OpCostCalibrationProfile*>(nullptr);
+    }
+    auto* profile = new OpCostCalibrationProfile;
+    const Status s =
+        str_util::EndsWith(profile_path, ".pbtxt")
+            ? ReadTextProto(Env::Default(), profile_path, profile)
+            : ReadBinaryProto(Env::Default(), profile_path, profile);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to load op cost calibration profile "
+                   << profile_path << ": " << s;
+      delete profile;
+      return static_cast<OpCostCalibrationProfile*>(nullptr);
+    }
+    return profile;
+  }();
+  return kProfile;
+}
+
 }  // namespace
 
 // Return a minimum shape if the shape is unknown. If known, return the original
@@ -350,9 +382,76 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+
+  const OpCostCalibrationProfile* profile = EnvCalibrationProfile();
+  if (profile != nullptr) {
+    SetCalibrationProfile(*profile);
+  }
+}
+
+void OpLevelCostEstimator::SetCalibrationProfile(
+    const OpCostCalibrationProfile& profile) {
+  calibration_factors_.clear();
+  for (const auto& calibration : profile.calibration()) {
+    if (calibration.num_samples() <= 0 ||
+        calibration.measured_time_ns() <= 0 ||
+        calibration.predicted_time_ns() <= 0) {
+      continue;
+    }
+    calibration_factors_[std::make_tuple(calibration.device_type(),
+                                         calibration.op(),
+                                         calibration.size_class())] =
+        calibration.measured_time_ns() / calibration.predicted_time_ns();
+  }
+  VLOG(1) << "Loaded " << calibration_factors_.size()
+          << " op cost calibration entries";
+}
+
+int OpLevelCostEstimator::CalibrationSizeClass(const OpInfo& op_info) const {
+  bool found_unknown_shapes = false;
+  const int64 total_bytes = CalculateInputSize(op_info, &found_unknown_shapes) +
+                            CalculateOutputSize(op_info, &found_unknown_shapes);
+  if (found_unknown_shapes || total_bytes <= 0) {
+    return -1;
+  }
+  int size_class = 0;
+  for (int64 bytes = total_bytes; bytes > 1; bytes >>= 1) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+void OpLevelCostEstimator::ApplyCalibration(const OpInfo& op_info,
+                                            Costs* costs) const {
+  if (calibration_factors_.empty()) {
+    return;
+  }
+  const string& device_type = op_info.device().type();
+  auto it = calibration_factors_.find(std::make_tuple(
+      device_type, op_info.op(), CalibrationSizeClass(op_info)));
+  if (it == calibration_factors_.end()) {
+    it = calibration_factors_.find(
+        std::make_tuple(device_type, op_info.op(), -1));
+  }
+  if (it == calibration_factors_.end()) {
+    return;
+  }
+  const double factor = it->second;
+  costs->compute_time =
+      Costs::NanoSeconds(costs->compute_time.count() * factor);
+  costs->memory_time = Costs::NanoSeconds(costs->memory_time.count() * factor);
+  costs->execution_time =
+      Costs::NanoSeconds(costs->execution_time.count() * factor);
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  Costs costs = PredictUncalibratedCosts(op_context);
+  ApplyCalibration(op_context.op_info, &costs);
+  return costs;
+}
+
+Costs OpLevelCostEstimator::PredictUncalibratedCosts(
+    const OpContext& op_context) const {
   const auto& op_features = op_context.op_info;
   auto it = device_cost_impl_.find(op_features.op());
   if (it == device_cost_impl_.end()) {
@@ -1294,7 +1393,8 @@ Costs OpLevelCostEstimator::PredictFusedOp(
   fused_cost.compute_time = 0;
   fused_cost.inaccurate = false;
   for (auto& fused_op : fused_op_contexts) {
-    auto op_cost = PredictCosts(fused_op);
+    // The fused op as a whole is calibrated, not its components.
+    auto op_cost = PredictUncalibratedCosts(fused_op);
     fused_cost.compute_time += op_cost.compute_time;
     fused_cost.inaccurate |= op_cost.inaccurate;
   }
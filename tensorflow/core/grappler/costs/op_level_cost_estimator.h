@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <string>
+#include <tuple>
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
@@ -38,8 +39,26 @@ class OpLevelCostEstimator {
   OpLevelCostEstimator();
   virtual ~OpLevelCostEstimator() {}
 
+  // Predicts the cost of the op. If a calibration profile is set, the
+  // analytical estimate is scaled by the measured-to-predicted ratio recorded
+  // for the op type and size class (or the op type alone if there is no entry
+  // for the size class).
   virtual Costs PredictCosts(const OpContext& op_context) const;
 
+  // Predicts the cost of the op using the analytical model only.
+  Costs PredictUncalibratedCosts(const OpContext& op_context) const;
+
+  // Replaces the calibration profile. An empty profile disables calibration.
+  // At construction, the profile is set to the file named by the
+  // TF_GRAPPLER_OP_COST_PROFILE environment variable, if set, which is read
+  // once per process.
+  void SetCalibrationProfile(const OpCostCalibrationProfile& profile);
+  bool HasCalibrationProfile() const { return !calibration_factors_.empty(); }
+
+  // Returns the calibration size class of the op: floor(log2()) of its total
+  // input and output size in bytes, or -1 if the size is unknown.
+  int CalibrationSizeClass(const OpInfo& op_info) const;
+
   // Basic device performance info, sufficient for roofline estimate.
   struct DeviceInfo {
     double gigaops;     // Billions of operations executed per second.
@@ -196,6 +215,9 @@ class OpLevelCostEstimator {
   // already been calculated.
   void CombineCostsAndUpdateExecutionTime(Costs* costs) const;
 
+  // Scales the costs by the calibration factor for the op, if any.
+  void ApplyCalibration(const OpInfo& op_info, Costs* costs) const;
+
  protected:
   std::map<string, int> elementwise_ops_;
   typedef std::function<Costs(const OpContext& op_context)> CostImpl;
@@ -203,6 +225,9 @@ class OpLevelCostEstimator {
   // If true, assume compute and memory overlap; hence, the op cost is max of
   // compute_time and memory_time, insteaf of sum of those two.
   bool compute_memory_overlap_;
+  // Measured-to-predicted execution time ratios, keyed by (device type, op,
+  // size class). A size class of -1 holds the ratio over all sizes.
+  std::map<std::tuple<string, string, int>, double> calibration_factors_;
 
  private:
   friend class OpLevelCostEstimatorTest;
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/graph_rewriter.h"
+#include "tensorflow/core/grappler/optimizers/memory_schedule.h"
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
@@ -694,6 +695,75 @@ bool SchedulingPass(Cluster* cluster, GrapplerItem* item) {
   return updated_graph;
 }
 
+// Minimum relative reduction of the predicted peak memory for which the
+// memory-aware schedule is enforced: the control dependencies it adds restrict
+// the executor's freedom to run independent ops concurrently.
+constexpr double kMinScheduledPeakMemorySavings = 0.1;
+// Only the nodes whose outputs take at least this fraction of the peak memory
+// are ordered. Small allocations barely affect the peak.
+constexpr double kMinScheduledAllocationFraction = 0.01;
+
+// Orders the nodes of graphs running on the CPU to reduce their peak memory
+// usage. The executor runs nodes in the order in which they become ready,
+// which can keep many large intermediate tensors live at once. Compute
+// memory-minimizing orders with a list and a DFS scheduler, and enforce the
+// best one with control dependencies if it reduces the peak enough.
+bool MemoryAwareSchedulingPass(Cluster* cluster, GrapplerItem* item) {
+  for (const auto& device : cluster->GetDevices()) {
+    if (device.second.type() != "CPU") {
+      // Memory on accelerators is handled by the swapping heuristics.
+      return false;
+    }
+  }
+  for (const NodeDef& node : item->graph.node()) {
+    if (IsEnter(node) || IsExit(node) || IsMerge(node) || IsSwitch(node) ||
+        IsNextIteration(node)) {
+      // Control dependencies can't be added across frames, and the nodes of
+      // a loop body run more than once.
+      return false;
+    }
+  }
+
+  GraphProperties properties(*item);
+  Status s = properties.InferStatically(false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes: " << s.error_message();
+    return false;
+  }
+  MemoryScheduler scheduler(*item, properties);
+
+  std::vector<const NodeDef*> schedule;
+  s = scheduler.ComputeSchedule(MemorySchedulerAlgorithm::kReadyOrder,
+                                &schedule);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to schedule graph: " << s.error_message();
+    return false;
+  }
+  const int64 default_peak = scheduler.EstimatePeakMemory(schedule);
+
+  std::vector<const NodeDef*> best_schedule;
+  int64 best_peak = default_peak;
+  for (MemorySchedulerAlgorithm algorithm :
+       {MemorySchedulerAlgorithm::kList, MemorySchedulerAlgorithm::kDfs}) {
+    if (!scheduler.ComputeSchedule(algorithm, &schedule).ok()) {
+      continue;
+    }
+    const int64 peak = scheduler.EstimatePeakMemory(schedule);
+    if (peak < best_peak) {
+      best_peak = peak;
+      best_schedule.swap(schedule);
+    }
+  }
+  VLOG(1) << "Predicted peak memory: " << default_peak << " bytes by default, "
+          << best_peak << " bytes with a memory-aware schedule";
+  if (best_schedule.empty() ||
+      best_peak > default_peak * (1.0 - kMinScheduledPeakMemorySavings)) {
+    return false;
+  }
+  const int64 min_bytes = best_peak * kMinScheduledAllocationFraction;
+  return scheduler.EnforceSchedule(best_schedule, min_bytes, &item->graph) > 0;
+}
+
 Status BuildSwapPair(NodeDef* node, int input_to_swap,
                      const std::unordered_map<string, const NodeDef*>& name_map,
                      GraphDef* graph,
@@ -1331,6 +1401,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  // The control dependencies enforcing a memory-aware schedule restrict the
+  // parallelism of the executor, so the schedule is only enforced when
+  // scheduling heuristics are asked for.
+  if (optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS &&
+      cluster != nullptr) {
+    if (MemoryAwareSchedulingPass(cluster, &optimized_item)) {
+      VLOG(1) << "Enforced a memory-aware schedule";
+    }
+  }
+
   TF_RETURN_IF_ERROR(RelaxAllocatorConstraints(&optimized_item.graph));
 
   optimized_graph->Swap(&optimized_item.graph);
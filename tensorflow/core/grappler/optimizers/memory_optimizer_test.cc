@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -440,6 +441,86 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+class MemoryAwareSchedulingTest : public GrapplerTest {
+ protected:
+  static std::unique_ptr<VirtualCluster> CreateCpuCluster() {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    cpu_device.set_memory_size(1024 * 1024 * 1024);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+
+  // Builds 4 branches, each computing a large tensor and reducing it to a
+  // scalar. By default all the large tensors are live at once.
+  GrapplerItem CreateBranchesItem() const {
+    tensorflow::Scope s =
+        tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape({256, 256}));
+    std::vector<Output> sums;
+    for (int i = 0; i < 4; ++i) {
+      Output exp = ops::Exp(s.WithOpName(strings::StrCat("exp", i)), x);
+      sums.push_back(
+          ops::Sum(s.WithOpName(strings::StrCat("sum", i)), exp, {0, 1}));
+    }
+    Output out = ops::AddN(s.WithOpName("out"), sums);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"out"};
+    item.feed = {
+        {"x", GenerateRandomTensor<DT_FLOAT>(TensorShape({256, 256}))}};
+    return item;
+  }
+
+  static int CountControlInputs(const GraphDef& graph) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      for (const string& input : node.input()) {
+        count += IsControlInput(input);
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(MemoryAwareSchedulingTest, SchedulingHeuristics) {
+  GrapplerItem item = CreateBranchesItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateCpuCluster());
+  MemoryOptimizer optimizer(RewriterConfig::SCHEDULING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  // The branches run one after the other.
+  EXPECT_EQ(0, CountControlInputs(item.graph));
+  EXPECT_LT(0, CountControlInputs(output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-3);
+}
+
+TEST_F(MemoryAwareSchedulingTest, NotEnforcedByOtherLevels) {
+  GrapplerItem item = CreateBranchesItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateCpuCluster());
+  for (RewriterConfig::MemOptType level :
+       {RewriterConfig::DEFAULT_MEM_OPT, RewriterConfig::HEURISTICS,
+        RewriterConfig::SWAPPING_HEURISTICS}) {
+    MemoryOptimizer optimizer(level);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    EXPECT_EQ(0, CountControlInputs(output)) << level;
+  }
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -0,0 +1,400 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/memory_schedule.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_set>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+int64 EstimateSize(const OpInfo::TensorProperties& t) {
+  const int64 size = DataTypeSize(t.dtype());
+  TensorShapeProto shape = t.shape();
+  if (shape.unknown_rank()) {
+    return size;
+  }
+  // If one of the dimensions is unknown statically, assume it's at least one.
+  for (int i = 0; i < shape.dim_size(); ++i) {
+    if (shape.dim(i).size() < 0) {
+      shape.mutable_dim(i)->set_size(1);
+    }
+  }
+  return TensorShape(shape).num_elements() * size;
+}
+
+void AddUnique(int value, std::vector<int>* values) {
+  if (std::find(values->begin(), values->end(), value) == values->end()) {
+    values->push_back(value);
+  }
+}
+
+}  // namespace
+
+MemoryScheduler::MemoryScheduler(const GrapplerItem& item,
+                                 const GraphProperties& properties) {
+  Init(item, properties);
+}
+
+void MemoryScheduler::Init(const GrapplerItem& item,
+                           const GraphProperties& properties) {
+  std::unordered_map<string, int> name_to_index;
+  nodes_.resize(item.graph.node_size());
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    const NodeDef& node = item.graph.node(i);
+    nodes_[i].node = &node;
+    node_index_[&node] = i;
+    name_to_index[node.name()] = i;
+  }
+  std::unordered_set<string> fed;
+  for (const auto& feed : item.feed) {
+    fed.insert(NodeName(feed.first));
+  }
+
+  for (int i = 0; i < nodes_.size(); ++i) {
+    NodeInfo& info = nodes_[i];
+    const NodeDef& node = *info.node;
+    bool has_data_inputs = false;
+    for (const string& input : node.input()) {
+      int port;
+      const string name = ParseNodeName(input, &port);
+      auto it = name_to_index.find(name);
+      if (it == name_to_index.end()) {
+        status_ = errors::InvalidArgument("Node ", node.name(),
+                                          " has an unknown input ", input);
+        return;
+      }
+      const int fanin = it->second;
+      AddUnique(fanin, &info.fanins);
+      AddUnique(i, &nodes_[fanin].fanouts);
+      if (port >= 0) {
+        has_data_inputs = true;
+        const int tensor = GetOrAddTensor(fanin, port);
+        AddUnique(tensor, &info.inputs);
+        AddUnique(i, &tensors_[tensor].consumers);
+      }
+    }
+    // Constants and variables live across steps, and fed tensors are
+    // allocated by the caller.
+    info.persistent = !has_data_inputs || IsConstant(node) ||
+                      IsVariable(node) || fed.count(node.name()) > 0;
+  }
+
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const string& name = nodes_[i].node->name();
+    if (!properties.HasOutputProperties(name)) {
+      continue;
+    }
+    const auto& outputs = properties.GetOutputProperties(name);
+    for (int port = 0; port < outputs.size(); ++port) {
+      const int tensor = GetOrAddTensor(i, port);
+      if (!nodes_[i].persistent) {
+        tensors_[tensor].bytes = EstimateSize(outputs[port]);
+      }
+    }
+  }
+
+  for (const string& fetch : item.fetch) {
+    int port;
+    const string name = ParseNodeName(fetch, &port);
+    auto it = name_to_index.find(name);
+    if (it != name_to_index.end() && port >= 0) {
+      tensors_[GetOrAddTensor(it->second, port)].fetched = true;
+    }
+  }
+}
+
+int MemoryScheduler::GetOrAddTensor(int node, int port) {
+  const int64 key = (static_cast<int64>(node) << 32) | port;
+  auto it = tensor_index_.find(key);
+  if (it != tensor_index_.end()) {
+    return it->second;
+  }
+  const int tensor = tensors_.size();
+  tensors_.emplace_back();
+  tensor_index_[key] = tensor;
+  nodes_[node].outputs.push_back(tensor);
+  return tensor;
+}
+
+int64 MemoryScheduler::AllocatedBytes(const NodeDef& node) const {
+  auto it = node_index_.find(&node);
+  return it == node_index_.end() ? 0 : AllocatedBytes(it->second);
+}
+
+int64 MemoryScheduler::AllocatedBytes(int node) const {
+  int64 bytes = 0;
+  for (int tensor : nodes_[node].outputs) {
+    bytes += tensors_[tensor].bytes;
+  }
+  return bytes;
+}
+
+Status MemoryScheduler::ComputeSchedule(
+    MemorySchedulerAlgorithm algorithm,
+    std::vector<const NodeDef*>* schedule) const {
+  TF_RETURN_IF_ERROR(status_);
+  std::vector<int> order;
+  switch (algorithm) {
+    case MemorySchedulerAlgorithm::kReadyOrder:
+      TF_RETURN_IF_ERROR(ReadyOrderSchedule(&order));
+      break;
+    case MemorySchedulerAlgorithm::kList:
+      TF_RETURN_IF_ERROR(ListSchedule(&order));
+      break;
+    case MemorySchedulerAlgorithm::kDfs:
+      TF_RETURN_IF_ERROR(DfsSchedule(&order));
+      break;
+  }
+  schedule->clear();
+  schedule->reserve(order.size());
+  for (int node : order) {
+    schedule->push_back(nodes_[node].node);
+  }
+  return Status::OK();
+}
+
+Status MemoryScheduler::ReadyOrderSchedule(std::vector<int>* schedule) const {
+  std::vector<int> pending(nodes_.size());
+  std::deque<int> ready;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    pending[i] = nodes_[i].fanins.size();
+    if (pending[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  while (!ready.empty()) {
+    const int node = ready.front();
+    ready.pop_front();
+    schedule->push_back(node);
+    for (int fanout : nodes_[node].fanouts) {
+      if (--pending[fanout] == 0) {
+        ready.push_back(fanout);
+      }
+    }
+  }
+  if (schedule->size() != nodes_.size()) {
+    return errors::InvalidArgument("The graph contains a cycle");
+  }
+  return Status::OK();
+}
+
+Status MemoryScheduler::ListSchedule(std::vector<int>* schedule) const {
+  std::vector<int> pending(nodes_.size());
+  std::vector<bool> scheduled(nodes_.size(), false);
+  std::vector<int> remaining_uses(tensors_.size());
+  for (int i = 0; i < tensors_.size(); ++i) {
+    remaining_uses[i] = tensors_[i].consumers.size();
+  }
+
+  // Memory freed by running the node, net of the memory it allocates.
+  auto priority = [&](int node) {
+    int64 freed = 0;
+    for (int tensor : nodes_[node].inputs) {
+      if (remaining_uses[tensor] == 1 && !tensors_[tensor].fetched) {
+        freed += tensors_[tensor].bytes;
+      }
+    }
+    return freed - AllocatedBytes(node);
+  };
+
+  // Ordered by decreasing priority, then by position in the graph.
+  std::set<std::pair<int64, int>> ready;
+  std::vector<int64> ready_priority(nodes_.size());
+  auto add_ready = [&](int node) {
+    ready_priority[node] = priority(node);
+    ready.emplace(-ready_priority[node], node);
+  };
+  for (int i = 0; i < nodes_.size(); ++i) {
+    pending[i] = nodes_[i].fanins.size();
+    if (pending[i] == 0) {
+      add_ready(i);
+    }
+  }
+
+  while (!ready.empty()) {
+    const int node = ready.begin()->second;
+    ready.erase(ready.begin());
+    scheduled[node] = true;
+    schedule->push_back(node);
+
+    for (int tensor : nodes_[node].inputs) {
+      if (--remaining_uses[tensor] != 1) {
+        continue;
+      }
+      // Running the last consumer of the tensor now frees it.
+      for (int consumer : tensors_[tensor].consumers) {
+        if (!scheduled[consumer] && pending[consumer] == 0) {
+          ready.erase(std::make_pair(-ready_priority[consumer], consumer));
+          add_ready(consumer);
+        }
+      }
+    }
+    for (int fanout : nodes_[node].fanouts) {
+      if (--pending[fanout] == 0) {
+        add_ready(fanout);
+      }
+    }
+  }
+  if (schedule->size() != nodes_.size()) {
+    return errors::InvalidArgument("The graph contains a cycle");
+  }
+  return Status::OK();
+}
+
+Status MemoryScheduler::DfsSchedule(std::vector<int>* schedule) const {
+  std::vector<int> topo_order;
+  TF_RETURN_IF_ERROR(ReadyOrderSchedule(&topo_order));
+
+  // Memory allocated by a node and its transitive fanin. Shared fanins are
+  // counted once per path, which is good enough to rank the inputs.
+  const int64 kMaxBytes = kint64max / 4;
+  std::vector<int64> total_bytes(nodes_.size());
+  for (int node : topo_order) {
+    int64 total = AllocatedBytes(node);
+    for (int fanin : nodes_[node].fanins) {
+      total = std::min(kMaxBytes, total + total_bytes[fanin]);
+    }
+    total_bytes[node] = total;
+  }
+
+  enum State { kNotVisited, kVisiting, kVisited };
+  std::vector<State> state(nodes_.size(), kNotVisited);
+  // Stack of (node, sorted fanins, index of the next fanin to visit).
+  struct Frame {
+    int node;
+    std::vector<int> fanins;
+    int next;
+  };
+  std::vector<Frame> stack;
+  auto push = [&](int node) {
+    Frame frame{node, nodes_[node].fanins, 0};
+    std::stable_sort(frame.fanins.begin(), frame.fanins.end(),
+                     [&](int a, int b) {
+                       if (total_bytes[a] != total_bytes[b]) {
+                         return total_bytes[a] > total_bytes[b];
+                       }
+                       return a < b;
+                     });
+    state[node] = kVisiting;
+    stack.push_back(std::move(frame));
+  };
+
+  for (int root = 0; root < nodes_.size(); ++root) {
+    if (!nodes_[root].fanouts.empty() || state[root] != kNotVisited) {
+      continue;
+    }
+    push(root);
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      if (frame.next == frame.fanins.size()) {
+        state[frame.node] = kVisited;
+        schedule->push_back(frame.node);
+        stack.pop_back();
+        continue;
+      }
+      const int fanin = frame.fanins[frame.next++];
+      if (state[fanin] == kVisiting) {
+        return errors::InvalidArgument("The graph contains a cycle");
+      }
+      if (state[fanin] == kNotVisited) {
+        push(fanin);
+      }
+    }
+  }
+  if (schedule->size() != nodes_.size()) {
+    return errors::InvalidArgument("The graph contains a cycle");
+  }
+  return Status::OK();
+}
+
+int64 MemoryScheduler::EstimatePeakMemory(
+    const std::vector<const NodeDef*>& schedule) const {
+  std::vector<int> remaining_uses(tensors_.size());
+  for (int i = 0; i < tensors_.size(); ++i) {
+    remaining_uses[i] = tensors_[i].consumers.size();
+  }
+  int64 live = 0;
+  int64 peak = 0;
+  for (const NodeDef* node_def : schedule) {
+    auto it = node_index_.find(node_def);
+    if (it == node_index_.end()) {
+      continue;
+    }
+    const NodeInfo& node = nodes_[it->second];
+    live += AllocatedBytes(it->second);
+    peak = std::max(peak, live);
+    for (int tensor : node.outputs) {
+      if (tensors_[tensor].consumers.empty() && !tensors_[tensor].fetched) {
+        live -= tensors_[tensor].bytes;
+      }
+    }
+    for (int tensor : node.inputs) {
+      if (--remaining_uses[tensor] == 0 && !tensors_[tensor].fetched) {
+        live -= tensors_[tensor].bytes;
+      }
+    }
+  }
+  return peak;
+}
+
+int MemoryScheduler::EnforceSchedule(
+    const std::vector<const NodeDef*>& schedule, int64 min_bytes,
+    GraphDef* graph) const {
+  int num_added = 0;
+  // Nodes scheduled since the last large allocation.
+  std::vector<int> segment;
+  for (const NodeDef* node_def : schedule) {
+    auto it = node_index_.find(node_def);
+    if (it == node_index_.end()) {
+      continue;
+    }
+    const int node = it->second;
+    if (AllocatedBytes(node) >= std::max<int64>(min_bytes, 1)) {
+      const std::vector<int>& fanins = nodes_[node].fanins;
+      NodeDef* mutable_node = graph->mutable_node(node);
+      for (int previous : segment) {
+        if (std::find(fanins.begin(), fanins.end(), previous) ==
+            fanins.end()) {
+          *mutable_node->add_input() =
+              AsControlDependency(nodes_[previous].node->name());
+          ++num_added;
+        }
+      }
+      segment.clear();
+    }
+    // Persistent tensors don't need to be released before the allocation.
+    if (!nodes_[node].persistent) {
+      segment.push_back(node);
+    }
+  }
+  return num_added;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULE_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Algorithms used to compute a topological order of the nodes of a graph.
+enum class MemorySchedulerAlgorithm {
+  // Runs the nodes in the order in which they become ready, which is how the
+  // executor runs them when there is no contention for threads.
+  kReadyOrder,
+  // Greedy list scheduler: among the ready nodes, runs the one that frees the
+  // most memory net of what it allocates.
+  kList,
+  // Post-order depth first traversal from the sinks of the graph that visits
+  // the inputs requiring the most memory first, so that their results can be
+  // consumed and freed early.
+  kDfs,
+};
+
+// Computes schedules of a graph that run one node at a time, and estimates
+// the peak memory they require based on the statically inferred sizes of the
+// tensors. Only the transient tensors computed by the graph are accounted
+// for: constants, variables and fed tensors are considered persistent.
+class MemoryScheduler {
+ public:
+  // The properties of the item must have been inferred.
+  MemoryScheduler(const GrapplerItem& item, const GraphProperties& properties);
+
+  // Computes a schedule of all the nodes of the graph. Fails if the graph has
+  // a cycle or refers to unknown nodes.
+  Status ComputeSchedule(MemorySchedulerAlgorithm algorithm,
+                         std::vector<const NodeDef*>* schedule) const;
+
+  // Estimates the peak size of the live tensors when the nodes run in the
+  // order of the schedule. The inputs of a node are released after it runs,
+  // once all their consumers have run. Fetched tensors are kept live until the
+  // end of the step.
+  int64 EstimatePeakMemory(const std::vector<const NodeDef*>& schedule) const;
+
+  // Number of bytes of transient memory allocated for the outputs of node.
+  int64 AllocatedBytes(const NodeDef& node) const;
+
+  // Adds control dependencies to the graph so that every node allocating at
+  // least min_bytes runs after all the nodes that precede it in the schedule.
+  // Tensors the schedule frees before a large allocation are thus released by
+  // the time it happens, while the small nodes in between keep some freedom.
+  // The graph must be the graph of the item, or a copy of it with nodes in the
+  // same order. Returns the number of control dependencies added.
+  int EnforceSchedule(const std::vector<const NodeDef*>& schedule,
+                      int64 min_bytes, GraphDef* graph) const;
+
+ private:
+  struct NodeInfo {
+    const NodeDef* node = nullptr;
+    // Distinct nodes this node depends on, through data or control edges.
+    std::vector<int> fanins;
+    std::vector<int> fanouts;
+    // Distinct tensors consumed and produced by this node.
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+    // Whether the outputs of this node are persistent.
+    bool persistent = false;
+  };
+
+  struct TensorInfo {
+    int64 bytes = 0;
+    // Distinct nodes consuming the tensor.
+    std::vector<int> consumers;
+    bool fetched = false;
+  };
+
+  void Init(const GrapplerItem& item, const GraphProperties& properties);
+  int GetOrAddTensor(int node, int port);
+  int64 AllocatedBytes(int node) const;
+
+  Status ReadyOrderSchedule(std::vector<int>* schedule) const;
+  Status ListSchedule(std::vector<int>* schedule) const;
+  Status DfsSchedule(std::vector<int>* schedule) const;
+
+  Status status_;
+  std::vector<NodeInfo> nodes_;
+  std::vector<TensorInfo> tensors_;
+  std::unordered_map<const NodeDef*, int> node_index_;
+  // Maps (node, output port) to the index of the tensor.
+  std::unordered_map<int64, int> tensor_index_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_SCHEDULE_H_
@@ -0,0 +1,152 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/memory_schedule.h"
+
+#include <unordered_set>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Size of the output of every Exp node.
+constexpr int64 kExpBytes = 256 * 256 * sizeof(float);
+
+class MemoryScheduleTest : public ::testing::Test {
+ protected:
+  // Builds 4 branches, each computing a large tensor and reducing it to a
+  // scalar. Running the branches one after the other only keeps one of the
+  // large tensors live at a time.
+  GrapplerItem CreateBranchesItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape({256, 256}));
+    std::vector<Output> sums;
+    for (int i = 0; i < 4; ++i) {
+      Output exp = ops::Exp(s.WithOpName(strings::StrCat("exp", i)), x);
+      sums.push_back(
+          ops::Sum(s.WithOpName(strings::StrCat("sum", i)), exp, {0, 1}));
+    }
+    Output out = ops::AddN(s.WithOpName("out"), sums);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"out"};
+    return item;
+  }
+
+  void ExpectTopologicalOrder(const std::vector<const NodeDef*>& schedule,
+                              const GraphDef& graph) {
+    EXPECT_EQ(graph.node_size(), schedule.size());
+    std::unordered_set<string> scheduled;
+    for (const NodeDef* node : schedule) {
+      for (const string& input : node->input()) {
+        EXPECT_EQ(1, scheduled.count(NodeName(input)))
+            << node->name() << " runs before its input " << input;
+      }
+      scheduled.insert(node->name());
+    }
+  }
+};
+
+TEST_F(MemoryScheduleTest, ReducesPeakMemory) {
+  GrapplerItem item = CreateBranchesItem();
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  MemoryScheduler scheduler(item, properties);
+
+  std::vector<const NodeDef*> schedule;
+  TF_ASSERT_OK(scheduler.ComputeSchedule(MemorySchedulerAlgorithm::kReadyOrder,
+                                         &schedule));
+  ExpectTopologicalOrder(schedule, item.graph);
+  // All the Exp nodes become ready at once.
+  EXPECT_EQ(4 * kExpBytes, scheduler.EstimatePeakMemory(schedule));
+
+  for (MemorySchedulerAlgorithm algorithm :
+       {MemorySchedulerAlgorithm::kList, MemorySchedulerAlgorithm::kDfs}) {
+    TF_ASSERT_OK(scheduler.ComputeSchedule(algorithm, &schedule));
+    ExpectTopologicalOrder(schedule, item.graph);
+    // One Exp output plus a few scalars.
+    const int64 peak = scheduler.EstimatePeakMemory(schedule);
+    EXPECT_LE(kExpBytes, peak);
+    EXPECT_GE(kExpBytes + 64, peak);
+  }
+}
+
+TEST_F(MemoryScheduleTest, EnforceSchedule) {
+  GrapplerItem item = CreateBranchesItem();
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  MemoryScheduler scheduler(item, properties);
+  std::vector<const NodeDef*> schedule;
+  TF_ASSERT_OK(
+      scheduler.ComputeSchedule(MemorySchedulerAlgorithm::kList, &schedule));
+
+  GraphDef graph = item.graph;
+  // Each Exp but the first waits for the previous branch.
+  EXPECT_EQ(6, scheduler.EnforceSchedule(schedule, kExpBytes, &graph));
+
+  GrapplerItem scheduled_item(item, std::move(graph));
+  GraphProperties scheduled_properties(scheduled_item);
+  TF_ASSERT_OK(scheduled_properties.InferStatically(false));
+  MemoryScheduler scheduled(scheduled_item, scheduled_properties);
+  TF_ASSERT_OK(scheduled.ComputeSchedule(MemorySchedulerAlgorithm::kReadyOrder,
+                                         &schedule));
+  ExpectTopologicalOrder(schedule, scheduled_item.graph);
+  EXPECT_GE(kExpBytes + 64, scheduled.EstimatePeakMemory(schedule));
+}
+
+TEST_F(MemoryScheduleTest, PersistentTensors) {
+  GrapplerItem item = CreateBranchesItem();
+  item.feed.emplace_back("x", Tensor(DT_FLOAT, TensorShape({256, 256})));
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  MemoryScheduler scheduler(item, properties);
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() == "Exp") {
+      EXPECT_EQ(kExpBytes, scheduler.AllocatedBytes(node));
+    } else if (node.op() == "Sum" || node.op() == "AddN") {
+      EXPECT_EQ(4, scheduler.AllocatedBytes(node));
+    } else {
+      // Placeholders and constants.
+      EXPECT_EQ(0, scheduler.AllocatedBytes(node)) << node.name();
+    }
+  }
+}
+
+TEST_F(MemoryScheduleTest, UnknownInput) {
+  GrapplerItem item;
+  NodeDef* node = item.graph.add_node();
+  node->set_name("a");
+  node->set_op("Identity");
+  node->add_input("missing");
+  GraphProperties properties(item);
+  MemoryScheduler scheduler(item, properties);
+  std::vector<const NodeDef*> schedule;
+  EXPECT_FALSE(
+      scheduler.ComputeSchedule(MemorySchedulerAlgorithm::kList, &schedule)
+          .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
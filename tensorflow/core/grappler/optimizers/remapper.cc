@@ -15,6 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -22,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -165,16 +175,526 @@ void AddBatchNormNodes(GraphDef* optimized_graph, const NodeDef& fused_node) {
   *r->add_input() = c->name();
 }
 
+namespace {
+
+// Returns the number of inputs of the element-wise ops _FusedElementwise can
+// evaluate, or 0 if the op can't be fused. Keep in sync with
+// kernels/fused_elementwise_op.cc.
+int FusibleCwiseOpArity(const string& op) {
+  static const auto* const kArity = new std::unordered_map<string, int>({
+      {"Abs", 1},
+      {"Exp", 1},
+      {"Inv", 1},
+      {"Log", 1},
+      {"Neg", 1},
+      {"Reciprocal", 1},
+      {"Relu", 1},
+      {"Relu6", 1},
+      {"Rsqrt", 1},
+      {"Sigmoid", 1},
+      {"Sqrt", 1},
+      {"Square", 1},
+      {"Tanh", 1},
+      {"Add", 2},
+      {"Div", 2},
+      {"Maximum", 2},
+      {"Minimum", 2},
+      {"Mul", 2},
+      {"RealDiv", 2},
+      {"SquaredDifference", 2},
+      {"Sub", 2},
+  });
+  auto it = kArity->find(op);
+  return it == kArity->end() ? 0 : it->second;
+}
+
+// _FusedElementwise and _FusedEmbeddingLookupSparse are only defined for CPU.
+bool NodeIsOnCpu(const NodeDef& node) {
+  string task;
+  string device;
+  return DeviceNameUtils::SplitDeviceName(node.device(), &task, &device) &&
+         str_util::StartsWith(device, DEVICE_CPU);
+}
+
+bool MaybeFusibleCwiseOp(const NodeDef& node) {
+  if (FusibleCwiseOpArity(node.op()) == 0 || !NodeIsOnCpu(node)) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE;
+}
+
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  return node.op() == "SparseSegmentSum" || node.op() == "SparseSegmentMean" ||
+         node.op() == "SparseSegmentSqrtN";
+}
+
+// Finds trees of element-wise ops in which every op but the root only feeds
+// its consumer in the tree, and replaces each tree with a single
+// _FusedElementwise node. The fused kernel evaluates the whole tree one cache
+// sized block at a time, so the intermediate results are never written out
+// to memory as full tensors. The nodes in `excluded`, which are fused by
+// another rewrite, are left out of the trees.
+class ElementwiseFusion {
+ public:
+  ElementwiseFusion(const GrapplerItem& item, const GraphView& graph,
+                    const GraphProperties& properties,
+                    const std::unordered_set<const NodeDef*>& excluded)
+      : graph_(graph),
+        properties_(properties),
+        nodes_to_preserve_(item.NodesToPreserve()),
+        excluded_(excluded) {
+    for (const NodeDef& node : item.graph.node()) {
+      if (!IsCandidate(node)) {
+        continue;
+      }
+      for (GraphView::Edge edge : graph_.GetFanoutEdges(node, true)) {
+        const NodeDef* consumer = edge.tgt.node;
+        if (CanAbsorb(node, *consumer)) {
+          consumer_of_[&node] = consumer;
+        }
+        break;
+      }
+    }
+    for (const auto& it : consumer_of_) {
+      const NodeDef* root = it.second;
+      while (consumer_of_.count(root) > 0) {
+        root = consumer_of_.at(root);
+      }
+      roots_.insert(root);
+    }
+  }
+
+  // Whether the node is evaluated as part of the fused node of a consumer.
+  bool IsAbsorbed(const NodeDef& node) const {
+    return consumer_of_.count(&node) > 0;
+  }
+
+  // Whether the node is replaced with a fused node of the same name.
+  bool IsRoot(const NodeDef& node) const { return roots_.count(&node) > 0; }
+
+  void AddFusedNode(const NodeDef& root, GraphDef* optimized_graph) const {
+    FusedChain chain;
+    AddStep(root, &chain);
+
+    NodeDef* fused = optimized_graph->add_node();
+    fused->set_name(root.name());
+    fused->set_op("_FusedElementwise");
+    fused->set_device(root.device());
+    for (const string& input : chain.inputs) {
+      *fused->add_input() = input;
+    }
+    std::unordered_set<string> control_inputs;
+    for (const NodeDef* node : chain.nodes) {
+      for (const string& input : node->input()) {
+        if (IsControlInput(input) && control_inputs.insert(input).second) {
+          *fused->add_input() = input;
+        }
+      }
+    }
+    auto* attr = fused->mutable_attr();
+    (*attr)["T"] = root.attr().at("T");
+    SetAttrValue(static_cast<int64>(chain.inputs.size()), &(*attr)["N"]);
+    SetAttrValue(chain.ops, &(*attr)["ops"]);
+    SetAttrValue(chain.operands, &(*attr)["operands"]);
+    VLOG(2) << "Fused element-wise ops into " << root.name() << ": ["
+            << str_util::Join(chain.ops, ", ") << "]";
+  }
+
+ private:
+  struct FusedChain {
+    std::vector<const NodeDef*> nodes;
+    std::vector<string> ops;
+    std::vector<int> operands;
+    std::vector<string> inputs;
+    std::unordered_map<string, int> input_index;
+    std::unordered_map<const NodeDef*, int> step_index;
+  };
+
+  // Adds the ops of the tree rooted at node to the chain in evaluation order
+  // and returns the index of the step evaluating node.
+  int AddStep(const NodeDef& node, FusedChain* chain) const {
+    const int arity = FusibleCwiseOpArity(node.op());
+    std::vector<int> operands;
+    for (int i = 0; i < arity; ++i) {
+      const string& input = node.input(i);
+      const NodeDef* producer = graph_.GetNode(NodeName(input));
+      auto consumer = consumer_of_.find(producer);
+      if (consumer != consumer_of_.end() && consumer->second == &node) {
+        auto step = chain->step_index.find(producer);
+        const int step_index = step != chain->step_index.end()
+                                   ? step->second
+                                   : AddStep(*producer, chain);
+        operands.push_back(-(step_index + 1));
+        continue;
+      }
+      auto index = chain->input_index.find(input);
+      if (index == chain->input_index.end()) {
+        index = chain->input_index.emplace(input, chain->inputs.size()).first;
+        chain->inputs.push_back(input);
+      }
+      operands.push_back(index->second);
+    }
+    const int step_index = chain->ops.size();
+    chain->step_index[&node] = step_index;
+    chain->nodes.push_back(&node);
+    chain->ops.push_back(node.op());
+    chain->operands.insert(chain->operands.end(), operands.begin(),
+                           operands.end());
+    return step_index;
+  }
+
+  // Whether the node can be evaluated by the fused kernel: the output shape
+  // must be known, and the inputs must have the same shape or be scalars.
+  bool IsCandidate(const NodeDef& node) const {
+    if (!MaybeFusibleCwiseOp(node) || excluded_.count(&node) > 0 ||
+        !properties_.HasOutputProperties(node.name())) {
+      return false;
+    }
+    const auto& outputs = properties_.GetOutputProperties(node.name());
+    const auto& inputs = properties_.GetInputProperties(node.name());
+    const int arity = FusibleCwiseOpArity(node.op());
+    if (outputs.size() != 1 || inputs.size() != arity) {
+      return false;
+    }
+    const PartialTensorShape shape(outputs[0].shape());
+    if (!shape.IsFullyDefined()) {
+      return false;
+    }
+    const DataType dtype = node.attr().at("T").type();
+    for (const auto& input : inputs) {
+      const PartialTensorShape input_shape(input.shape());
+      if (input.dtype() != dtype ||
+          !(input_shape.dims() == 0 || input_shape.IsIdenticalTo(shape))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether the producer can be evaluated as part of the fused node of its
+  // only consumer.
+  bool CanAbsorb(const NodeDef& producer, const NodeDef& consumer) const {
+    if (nodes_to_preserve_.count(producer.name()) > 0 ||
+        !IsCandidate(consumer) || producer.device() != consumer.device() ||
+        producer.attr().at("T").type() != consumer.attr().at("T").type()) {
+      return false;
+    }
+    // Intermediate results are never broadcast.
+    const PartialTensorShape producer_shape(
+        properties_.GetOutputProperties(producer.name())[0].shape());
+    const PartialTensorShape consumer_shape(
+        properties_.GetOutputProperties(consumer.name())[0].shape());
+    if (!producer_shape.IsIdenticalTo(consumer_shape)) {
+      return false;
+    }
+    for (const string& input : producer.input()) {
+      if (IsControlInput(input)) {
+        return false;
+      }
+    }
+    // The consumer may use the output of the producer more than once, but
+    // nothing else may depend on the producer.
+    for (GraphView::Edge edge : graph_.GetFanoutEdges(producer, true)) {
+      if (edge.tgt.node != &consumer || edge.tgt.port_id < 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const GraphView& graph_;
+  const GraphProperties& properties_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  const std::unordered_set<const NodeDef*> excluded_;
+  // Maps every node absorbed into a fused node to its consumer.
+  std::unordered_map<const NodeDef*, const NodeDef*> consumer_of_;
+  std::unordered_set<const NodeDef*> roots_;
+};
+
+// Finds SparseSegmentSum, SparseSegmentMean and SparseSegmentSqrtN nodes on
+// the CPU whose data is a Gather of embedding rows, optionally scaled by one
+// weight per row for SparseSegmentSum, and replaces each with a single
+// _FusedEmbeddingLookupSparse node. The fused kernel adds the embedding rows
+// straight into their output rows, so the gathered rows, which can be much
+// larger than the params and the output, are never materialized.
+class EmbeddingLookupFusion {
+ public:
+  EmbeddingLookupFusion(const GrapplerItem& item, const GraphView& graph,
+                        const GraphProperties& properties)
+      : graph_(graph),
+        properties_(properties),
+        nodes_to_preserve_(item.NodesToPreserve()) {
+    for (const NodeDef& node : item.graph.node()) {
+      Lookup lookup;
+      if (FindLookup(node, &lookup)) {
+        absorbed_.insert(lookup.gather);
+        if (lookup.mul != nullptr) {
+          absorbed_.insert(lookup.mul);
+        }
+        lookups_[&node] = lookup;
+      }
+    }
+  }
+
+  // Whether the node is evaluated as part of a fused lookup.
+  bool IsAbsorbed(const NodeDef& node) const {
+    return absorbed_.count(&node) > 0;
+  }
+
+  // The nodes evaluated as part of a fused lookup.
+  const std::unordered_set<const NodeDef*>& absorbed() const {
+    return absorbed_;
+  }
+
+  // Whether the node is replaced with a fused lookup of the same name.
+  bool IsRoot(const NodeDef& node) const { return lookups_.count(&node) > 0; }
+
+  void AddFusedNode(const NodeDef& root, GraphDef* optimized_graph) const {
+    const Lookup& lookup = lookups_.at(&root);
+    NodeDef* fused = optimized_graph->add_node();
+    fused->set_name(root.name());
+    fused->set_op("_FusedEmbeddingLookupSparse");
+    fused->set_device(root.device());
+    *fused->add_input() = lookup.gather->input(0);
+    *fused->add_input() = lookup.gather->input(1);
+    *fused->add_input() = root.input(1);
+    *fused->add_input() = root.input(2);
+    if (!lookup.weights.empty()) {
+      *fused->add_input() = lookup.weights;
+    }
+    std::unordered_set<string> control_inputs;
+    for (const NodeDef* node : {&root, lookup.mul, lookup.gather}) {
+      if (node == nullptr) {
+        continue;
+      }
+      for (const string& input : node->input()) {
+        if (IsControlInput(input) && control_inputs.insert(input).second) {
+          *fused->add_input() = input;
+        }
+      }
+    }
+    auto* attr = fused->mutable_attr();
+    (*attr)["T"] = root.attr().at("T");
+    (*attr)["Tids"] = lookup.gather->attr().at("Tindices");
+    if (root.attr().count("Tidx") > 0) {
+      (*attr)["Tidx"] = root.attr().at("Tidx");
+    } else {
+      SetAttrValue(DT_INT32, &(*attr)["Tidx"]);
+    }
+    SetAttrValue(lookup.weights.empty() ? 0 : 1, &(*attr)["num_weights"]);
+    SetAttrValue(lookup.combiner, &(*attr)["combiner"]);
+    VLOG(2) << "Fused embedding lookup " << lookup.gather->name() << " into "
+            << root.name();
+  }
+
+ private:
+  struct Lookup {
+    const NodeDef* gather = nullptr;
+    // The Mul scaling the gathered rows, if any.
+    const NodeDef* mul = nullptr;
+    string weights;
+    string combiner;
+  };
+
+  bool FindLookup(const NodeDef& node, Lookup* lookup) const {
+    if (!IsSparseSegmentReduction(node) || !NodeIsOnCpu(node)) {
+      return false;
+    }
+    if (node.op() == "SparseSegmentSum") {
+      lookup->combiner = "sum";
+    } else if (node.op() == "SparseSegmentMean") {
+      lookup->combiner = "mean";
+    } else {
+      lookup->combiner = "sqrtn";
+    }
+    const DataType dtype = GetDataTypeFromAttr(node, "T");
+    if (dtype != DT_FLOAT && dtype != DT_DOUBLE) {
+      return false;
+    }
+    const NodeDef* data = DataProducer(node);
+    if (data == nullptr) {
+      return false;
+    }
+    // A weighted sum is a sum of scaled rows. The weighted mean and sqrtn of
+    // embedding_lookup_sparse normalize by the weights in separate ops.
+    if (data->op() == "Mul" && lookup->combiner == "sum") {
+      if (data->device() != node.device() || !CanAbsorb(*data, node)) {
+        return false;
+      }
+      for (int i = 0; i < 2; ++i) {
+        const NodeDef* gather = graph_.GetNode(NodeName(data->input(i)));
+        if (gather != nullptr && IsEmbeddingGather(*gather, node) &&
+            NodeName(data->input(1 - i)) != gather->name() &&
+            HasRowWeights(*data, i, 1 - i) && CanAbsorb(*gather, *data)) {
+          lookup->mul = data;
+          lookup->gather = gather;
+          lookup->weights = data->input(1 - i);
+          return true;
+        }
+      }
+      return false;
+    }
+    if (!IsEmbeddingGather(*data, node)) {
+      return false;
+    }
+    lookup->gather = data;
+    return CanAbsorb(*data, node);
+  }
+
+  // Returns the node producing the data input of the node from its first
+  // output, if any.
+  const NodeDef* DataProducer(const NodeDef& node) const {
+    if (node.input_size() == 0 || IsControlInput(node.input(0))) {
+      return nullptr;
+    }
+    int position;
+    const string name = ParseNodeName(node.input(0), &position);
+    return position == 0 ? graph_.GetNode(name) : nullptr;
+  }
+
+  // Whether the node gathers rows of params for the reduction: a Gather, or a
+  // GatherV2 along axis 0, on the same device and of the same type.
+  bool IsEmbeddingGather(const NodeDef& gather,
+                         const NodeDef& reduction) const {
+    if (gather.op() != "Gather" && gather.op() != "GatherV2") {
+      return false;
+    }
+    if (gather.device() != reduction.device() ||
+        GetDataTypeFromAttr(gather, "Tparams") !=
+            GetDataTypeFromAttr(reduction, "T")) {
+      return false;
+    }
+    const DataType index_type = GetDataTypeFromAttr(gather, "Tindices");
+    if (index_type != DT_INT32 && index_type != DT_INT64) {
+      return false;
+    }
+    if (gather.op() == "GatherV2") {
+      const auto& inputs = properties_.GetInputProperties(gather.name());
+      if (inputs.size() != 3 || !inputs[2].has_value()) {
+        return false;
+      }
+      Tensor axis;
+      if (!axis.FromProto(inputs[2].value()) || axis.NumElements() != 1) {
+        return false;
+      }
+      const int64 axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64>()(0);
+      if (axis_value != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether input `weights` of the Mul holds one weight per row of the
+  // gathered matrix at input `rows`, i.e. has shape [n, 1] for rows of shape
+  // [n, d].
+  bool HasRowWeights(const NodeDef& mul, int rows, int weights) const {
+    const auto& inputs = properties_.GetInputProperties(mul.name());
+    if (inputs.size() != 2) {
+      return false;
+    }
+    const TensorShapeProto& rows_shape = inputs[rows].shape();
+    const TensorShapeProto& weights_shape = inputs[weights].shape();
+    if (rows_shape.unknown_rank() || rows_shape.dim_size() != 2 ||
+        weights_shape.unknown_rank() || weights_shape.dim_size() != 2) {
+      return false;
+    }
+    const int64 num_rows = rows_shape.dim(0).size();
+    return weights_shape.dim(1).size() == 1 &&
+           (num_rows >= 0 || num_rows < -1) &&
+           weights_shape.dim(0).size() == num_rows;
+  }
+
+  // Whether the producer only feeds the consumer, so that it can be
+  // evaluated as part of the fused node.
+  bool CanAbsorb(const NodeDef& producer, const NodeDef& consumer) const {
+    if (nodes_to_preserve_.count(producer.name()) > 0) {
+      return false;
+    }
+    for (GraphView::Edge edge : graph_.GetFanoutEdges(producer, true)) {
+      if (edge.tgt.node != &consumer || edge.tgt.port_id < 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const GraphView& graph_;
+  const GraphProperties& properties_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  // Maps every fused reduction to its lookup.
+  std::unordered_map<const NodeDef*, Lookup> lookups_;
+  std::unordered_set<const NodeDef*> absorbed_;
+};
+
+}  // namespace
+
 Status Remapper::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
                           GraphDef* optimized_graph) {
   GraphProperties properties(item);
   bool inferred_properties = false;
   GraphView graph(const_cast<GraphDef*>(&item.graph));
 
+  // Embedding lookups on the CPU are combined by a single fused kernel, which
+  // saves materializing the gathered embedding rows.
+  std::unique_ptr<EmbeddingLookupFusion> embedding_lookup_fusion;
+  for (const NodeDef& node : item.graph.node()) {
+    if (IsSparseSegmentReduction(node) && NodeIsOnCpu(node)) {
+      TF_RETURN_IF_ERROR(properties.InferStatically(false));
+      inferred_properties = true;
+      embedding_lookup_fusion.reset(
+          new EmbeddingLookupFusion(item, graph, properties));
+      break;
+    }
+  }
+
+  // Chains of element-wise ops on the CPU are evaluated by a single fused
+  // kernel, which saves the memory traffic of the intermediate results. The
+  // lookups are matched first: a Mul scaling the gathered rows belongs to its
+  // lookup, even when it could also be fused with the ops computing the
+  // weights.
+  std::unique_ptr<ElementwiseFusion> elementwise_fusion;
+  int num_fusible_ops = 0;
+  for (const NodeDef& node : item.graph.node()) {
+    num_fusible_ops += MaybeFusibleCwiseOp(node);
+  }
+  if (num_fusible_ops >= 2) {
+    if (!inferred_properties) {
+      TF_RETURN_IF_ERROR(properties.InferStatically(false));
+      inferred_properties = true;
+    }
+    elementwise_fusion.reset(new ElementwiseFusion(
+        item, graph, properties,
+        embedding_lookup_fusion != nullptr
+            ? embedding_lookup_fusion->absorbed()
+            : std::unordered_set<const NodeDef*>()));
+  }
+
   // During inference, most of the inputs to FusedBatchNorm are constant, and we
   // can therefore replace the op with a much cheaper set of primitives.
   optimized_graph->mutable_node()->Reserve(item.graph.node_size());
   for (const NodeDef& node : item.graph.node()) {
+    if (embedding_lookup_fusion != nullptr) {
+      if (embedding_lookup_fusion->IsAbsorbed(node)) {
+        continue;
+      }
+      if (embedding_lookup_fusion->IsRoot(node)) {
+        embedding_lookup_fusion->AddFusedNode(node, optimized_graph);
+        continue;
+      }
+    }
+    if (elementwise_fusion != nullptr) {
+      if (elementwise_fusion->IsAbsorbed(node)) {
+        continue;
+      }
+      if (elementwise_fusion->IsRoot(node)) {
+        elementwise_fusion->AddFusedNode(node, optimized_graph);
+        continue;
+      }
+    }
     if (node.op() == "FusedBatchNorm" || node.op() == "FusedBatchNormV2") {
       bool optimizable = (node.attr().count("T") == 0 ||
                           node.attr().at("T").type() == DT_FLOAT);
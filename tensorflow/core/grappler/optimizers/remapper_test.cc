@@ -91,5 +91,293 @@ TEST_F(RemapperTest, FusedBatchNormNCHW) {
   }
 }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 32}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 32}));
+  Output w = ops::Placeholder(s.WithOpName("w"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 32}));
+  Output bias = ops::Const(s.WithOpName("bias"), 0.5f, {});
+  Output mul = ops::Mul(s.WithOpName("mul"), x, y);
+  Output add = ops::Add(s.WithOpName("add"), mul, bias);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  Output out = ops::Mul(s.WithOpName("out"), tanh, w);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"out"};
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 32}));
+  auto y_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 32}));
+  auto w_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 32}));
+  item.feed = {{"x", x_t}, {"y", y_t}, {"w", w_t}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // x, y, w, bias and the fused node.
+  EXPECT_EQ(5, output.node_size());
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "out") {
+      EXPECT_EQ("_FusedElementwise", node.op());
+      ASSERT_EQ(4, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ("y", node.input(1));
+      EXPECT_EQ("bias", node.input(2));
+      EXPECT_EQ("w", node.input(3));
+      const auto& ops = node.attr().at("ops").list().s();
+      ASSERT_EQ(4, ops.size());
+      EXPECT_EQ("Mul", ops.Get(0));
+      EXPECT_EQ("Add", ops.Get(1));
+      EXPECT_EQ("Tanh", ops.Get(2));
+      EXPECT_EQ("Mul", ops.Get(3));
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DontFuseSharedOrFetchedResults) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  // exp has two consumers, so it must stay a separate node.
+  Output exp = ops::Exp(s.WithOpName("exp"), x);
+  Output sub = ops::Sub(s.WithOpName("sub"), exp, y);
+  Output relu = ops::Relu(s.WithOpName("relu"), sub);
+  Output mul = ops::Mul(s.WithOpName("mul"), exp, exp);
+  // fetched is fetched, so it can't be absorbed into its consumer.
+  Output fetched = ops::Sqrt(s.WithOpName("fetched"), mul);
+  Output neg = ops::Neg(s.WithOpName("neg"), fetched);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu", "fetched", "neg"};
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({16}));
+  auto y_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({16}));
+  item.feed = {{"x", x_t}, {"y", y_t}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("sub", node.name());
+    EXPECT_NE("mul", node.name());
+    if (node.name() == "exp") {
+      EXPECT_EQ("Exp", node.op());
+    } else if (node.name() == "neg") {
+      EXPECT_EQ("Neg", node.op());
+    } else if (node.name() == "relu" || node.name() == "fetched") {
+      EXPECT_EQ("_FusedElementwise", node.op());
+    }
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  EXPECT_EQ(3, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  EXPECT_EQ(3, tensors.size());
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorNear<float>(tensors_expected[i], tensors[i], 1e-6);
+  }
+}
+
+TEST_F(RemapperTest, FuseEmbeddingLookup) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                   ops::Placeholder::Shape({10, 4}));
+  Output ids = ops::Const(s.WithOpName("ids"), {7, 2, 9, 0, 2}, {5});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 2, 3, 4, 1}, {6});
+  Output segment_ids =
+      ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 3, 3, 3}, {6});
+  Output axis = ops::Const(s.WithOpName("axis"), 0, {});
+  Output gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+  Output mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather, idx,
+                                       segment_ids);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"mean"};
+  auto params_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({10, 4}));
+  item.feed = {{"params", params_t}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("gather", node.name());
+    if (node.name() == "mean") {
+      EXPECT_EQ("_FusedEmbeddingLookupSparse", node.op());
+      ASSERT_EQ(4, node.input_size());
+      EXPECT_EQ("params", node.input(0));
+      EXPECT_EQ("ids", node.input(1));
+      EXPECT_EQ("idx", node.input(2));
+      EXPECT_EQ("segment_ids", node.input(3));
+      EXPECT_EQ("mean", node.attr().at("combiner").s());
+      EXPECT_EQ(0, node.attr().at("num_weights").i());
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseWeightedEmbeddingLookup) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                   ops::Placeholder::Shape({10, 4}));
+  Output weights = ops::Placeholder(s.WithOpName("weights"), DT_FLOAT,
+                                    ops::Placeholder::Shape({5, 1}));
+  Output ids = ops::Const(s.WithOpName("ids"), {7, 2, 9, 0, 2}, {5});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 2, 3, 4}, {5});
+  Output segment_ids =
+      ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1, 2}, {5});
+  Output gather = ops::Gather(s.WithOpName("gather"), params, ids);
+  Output weighted = ops::Mul(s.WithOpName("weighted"), weights, gather);
+  Output sum = ops::SparseSegmentSum(s.WithOpName("sum"), weighted, idx,
+                                     segment_ids);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"sum"};
+  auto params_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({10, 4}));
+  auto weights_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({5, 1}));
+  item.feed = {{"params", params_t}, {"weights", weights_t}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("gather", node.name());
+    EXPECT_NE("weighted", node.name());
+    if (node.name() == "sum") {
+      EXPECT_EQ("_FusedEmbeddingLookupSparse", node.op());
+      ASSERT_EQ(5, node.input_size());
+      EXPECT_EQ("weights", node.input(4));
+      EXPECT_EQ("sum", node.attr().at("combiner").s());
+      EXPECT_EQ(1, node.attr().at("num_weights").i());
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseEmbeddingLookupWithElementwiseWeights) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  // With a single embedding column, the gathered rows have the shape of the
+  // weights, so the Mul could also be fused with the Sigmoid. It belongs to
+  // the lookup, and the Sigmoid is left alone.
+  Output params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                   ops::Placeholder::Shape({10, 1}));
+  Output logits = ops::Placeholder(s.WithOpName("logits"), DT_FLOAT,
+                                   ops::Placeholder::Shape({5, 1}));
+  Output ids = ops::Const(s.WithOpName("ids"), {7, 2, 9, 0, 2}, {5});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 2, 3, 4}, {5});
+  Output segment_ids =
+      ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1, 2}, {5});
+  Output weights = ops::Sigmoid(s.WithOpName("weights"), logits);
+  Output gather = ops::Gather(s.WithOpName("gather"), params, ids);
+  Output weighted = ops::Mul(s.WithOpName("weighted"), weights, gather);
+  Output sum = ops::SparseSegmentSum(s.WithOpName("sum"), weighted, idx,
+                                     segment_ids);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"sum"};
+  auto params_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({10, 1}));
+  auto logits_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({5, 1}));
+  item.feed = {{"params", params_t}, {"logits", logits_t}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("gather", node.name());
+    EXPECT_NE("weighted", node.name());
+    EXPECT_NE("_FusedElementwise", node.op()) << node.name();
+    if (node.name() == "weights") {
+      EXPECT_EQ("Sigmoid", node.op());
+      found++;
+    }
+    if (node.name() == "sum") {
+      EXPECT_EQ("_FusedEmbeddingLookupSparse", node.op());
+      ASSERT_EQ(5, node.input_size());
+      EXPECT_EQ("weights", node.input(4));
+      found++;
+    }
+  }
+  EXPECT_EQ(2, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DontFuseSharedEmbeddingLookup) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                   ops::Placeholder::Shape({10, 4}));
+  Output ids = ops::Const(s.WithOpName("ids"), {7, 2, 9}, {3});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 2}, {3});
+  Output segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 1, 1}, {3});
+  Output gather = ops::Gather(s.WithOpName("gather"), params, ids);
+  // The gathered rows are also fetched, so they must be materialized anyway.
+  Output sum =
+      ops::SparseSegmentSum(s.WithOpName("sum"), gather, idx, segment_ids);
+  Output axis = ops::Const(s.WithOpName("axis"), 1, {});
+  // A gather along another axis doesn't look up embeddings.
+  Output columns = ops::GatherV2(s.WithOpName("columns"), params, ids, axis);
+  Output sqrtn = ops::SparseSegmentSqrtN(s.WithOpName("sqrtn"), columns, idx,
+                                         segment_ids);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gather", "sum", "sqrtn"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("_FusedEmbeddingLookupSparse", node.op()) << node.name();
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
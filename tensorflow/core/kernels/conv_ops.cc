@@ -26,8 +26,10 @@ limitations under the License.
 
 #include <string.h>
 #include <map>
+#include <memory>
 #include <vector>
 
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -38,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_2d.h"
 #include "tensorflow/core/kernels/deep_conv2d.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/prepacked_matmul.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -196,6 +199,65 @@ class LaunchDeepConvOp<CPUDevice, float> {
   }
 };
 
+template <typename Device, typename T>
+class LaunchPrepackedConvOp {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DDimensions& dimensions,
+                  Padding padding, PackedWeightsCache* filter_cache,
+                  Tensor* output, TensorFormat data_format) {
+    return false;
+  }
+};
+
+// Runs the convolutions that reduce to a matrix multiplication in
+// LaunchGeneric, when they multiply few enough rows by the filter for its
+// packed copy in `filter_cache` to pay off. There is no cache, and nothing is
+// run, if the filter can change.
+template <>
+class LaunchPrepackedConvOp<CPUDevice, float> {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DDimensions& dimensions,
+                  Padding padding, PackedWeightsCache* filter_cache,
+                  Tensor* output, TensorFormat data_format) {
+    if (filter_cache == nullptr || data_format != FORMAT_NHWC ||
+        dimensions.in_depth != filter.dim_size(2)) {
+      return false;
+    }
+    int64 m;
+    if (dimensions.filter_rows == 1 && dimensions.filter_cols == 1 &&
+        dimensions.stride_rows == 1 && dimensions.stride_cols == 1) {
+      m = dimensions.batch * dimensions.out_rows * dimensions.out_cols;
+    } else if (dimensions.filter_rows == dimensions.input_rows &&
+               dimensions.filter_cols == dimensions.input_cols &&
+               dimensions.dilation_rows == 1 &&
+               dimensions.dilation_cols == 1 && padding == VALID) {
+      m = dimensions.batch;
+    } else {
+      return false;
+    }
+    const int64 k = dimensions.filter_rows * dimensions.filter_cols *
+                    dimensions.in_depth;
+    const int64 n = dimensions.out_depth;
+    if (m < 2 || m > kMaxPrepackedMatMulRows || k == 0) {
+      return false;
+    }
+    std::shared_ptr<const PackedWeights> packed_filter = filter_cache->Get(
+        ctx, false /* transpose */, filter.flat<float>().data(), k, n);
+    if (packed_filter == nullptr) {
+      return false;
+    }
+    const Status status = packed_filter->Multiply(
+        ctx, false /* transpose_in */, input.flat<float>().data(), m,
+        output->flat<float>().data());
+    if (!status.ok()) {
+      ctx->SetStatus(status);
+    }
+    return true;
+  }
+};
+
 #ifdef TENSORFLOW_USE_LIBXSMM_CONVOLUTIONS
 template <typename Device, typename T>
 class LaunchXsmmConvOp {
@@ -421,6 +483,11 @@ class Conv2DOp : public BinaryOp<T> {
     OP_REQUIRES_OK(context, context->GetAttr("use_cudnn_on_gpu", &use_cudnn_));
     use_cudnn_ &= CanUseCudnn();
     cudnn_use_autotune_ = CudnnUseAutotune();
+    bool constant_filter = false;
+    if (context->GetAttr(kConstantWeightsAttrName, &constant_filter).ok() &&
+        constant_filter) {
+      filter_cache_.reset(new PackedWeightsCache);
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -486,6 +553,13 @@ class Conv2DOp : public BinaryOp<T> {
       return;
     }
 
+    if (LaunchPrepackedConvOp<Device, T>::Run(context, input, filter,
+                                              dimensions, params_.padding,
+                                              filter_cache_.get(), output,
+                                              params_.data_format)) {
+      return;
+    }
+
     launcher_(context, use_cudnn_, cudnn_use_autotune_, input, filter,
               dimensions.dilation_rows, dimensions.dilation_cols,
               dimensions.stride_rows, dimensions.stride_cols, params_.padding,
@@ -498,6 +572,8 @@ class Conv2DOp : public BinaryOp<T> {
   bool cudnn_use_autotune_;
 
   LaunchConv2DOp<Device, T> launcher_;
+  // Only set if the graph marks the filter as a constant.
+  std::unique_ptr<PackedWeightsCache> filter_cache_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(Conv2DOp);
 };
@@ -12,24 +12,66 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/compression_utils.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
+// Allocator for a tensor that aliases a memory-mapped cache file. Like
+// `MemmappedTensorAllocator` in ../immutable_constant_op.cc, it owns the
+// mapping and deletes itself (and the mapping) when the tensor is freed.
+class MemmappedCacheAllocator : public Allocator {
+ public:
+  explicit MemmappedCacheAllocator(
+      std::unique_ptr<ReadOnlyMemoryRegion> memory_region)
+      : memory_region_(std::move(memory_region)) {}
+
+  string Name() override { return "MemmappedCacheAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    DCHECK_LE(num_bytes, memory_region_->length());
+    return const_cast<void*>(memory_region_->data());
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr != memory_region_->data()) {
+      LOG(ERROR) << "Deallocating not allocated region for cache file";
+    }
+    delete this;
+  }
+
+ private:
+  std::unique_ptr<ReadOnlyMemoryRegion> memory_region_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemmappedCacheAllocator);
+};
+
 // See documentation in ../ops/dataset_ops.cc for a high-level description of
 // the following op.
 
 class CacheDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit CacheDatasetOp(OpKernelConstruction* ctx)
-      : UnaryDatasetOpKernel(ctx) {}
+      : UnaryDatasetOpKernel(ctx) {
+    string compression;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("compression", &compression));
+    OP_REQUIRES(ctx, compression.empty() || compression == "SNAPPY",
+                errors::InvalidArgument("Unsupported cache compression: ",
+                                        compression));
+    compressed_ = !compression.empty();
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
@@ -39,9 +81,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                    ParseScalarArgument<string>(ctx, "filename", &filename));
 
     if (filename.empty()) {
-      *output = new MemoryDataset(ctx, input);
+      *output = new MemoryDataset(ctx, input, compressed_);
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), compressed_);
     }
   }
 
@@ -49,11 +91,12 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class FileDataset : public DatasetBase {
    public:
     explicit FileDataset(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env)
+                         string filename, Env* env, bool compressed)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           filename_(std::move(filename)),
           env_(env),
+          compressed_(compressed),
           num_tensors_(input->output_dtypes().size()),
           tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
           item_index_padding_size_(StringPaddingSize(kMaxItems)),
@@ -92,7 +135,10 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
       Node* filename = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-      TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+      AttrValue compression;
+      b->BuildAttrValue(string(compressed_ ? "SNAPPY" : ""), &compression);
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                       {{"compression", compression}}, output));
       return Status::OK();
     }
 
@@ -106,6 +152,50 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                              tensor_index);
     }
 
+    // Returns the number of bundle entries per element: one per component, or
+    // a single string holding the compressed element.
+    size_t NumEntries() const { return compressed_ ? 1 : num_tensors_; }
+
+    // Returns the key of the `entry_index`-th bundle entry of an element.
+    // Compressed elements use a tensor index that uncompressed elements never
+    // use, so that a cache cannot be read back with the wrong compression.
+    string EntryName(size_t item_index, size_t entry_index) const {
+      return FormatName(item_index, compressed_ ? num_tensors_ : entry_index);
+    }
+
+    // Returns a DT_UINT8 tensor that aliases the memory-mapped data file
+    // `shard_id` of the completed cache, or an uninitialized tensor if the
+    // file cannot be memory-mapped. The mapping is shared by all iterators
+    // over this dataset. It is read-only, so its buffer is never handed out
+    // to kernels, which may forward it to a mutable output.
+    Tensor MappedDataFile(int32 shard_id, int32 num_shards) const
+        LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      if (mmap_unsupported_ || shard_id < 0 || shard_id >= num_shards) {
+        return Tensor();
+      }
+      if (mapped_data_files_.size() != static_cast<size_t>(num_shards)) {
+        mapped_data_files_.assign(num_shards, Tensor());
+      }
+      Tensor& mapped = mapped_data_files_[shard_id];
+      if (!mapped.IsInitialized()) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = env_->NewReadOnlyMemoryRegionFromFile(
+            DataFilename(filename_, shard_id, num_shards), &region);
+        if (!s.ok()) {
+          VLOG(1) << "Reading cache " << filename_
+                  << " without memory-mapping: " << s;
+          mmap_unsupported_ = true;
+          return Tensor();
+        }
+        if (region->length() == 0) return Tensor();
+        const int64 length = region->length();
+        mapped = Tensor(new MemmappedCacheAllocator(std::move(region)),
+                        DT_UINT8, TensorShape({length}));
+      }
+      return mapped;
+    }
+
     class FileIterator : public DatasetIterator<FileDataset> {
      public:
       explicit FileIterator(const Params& params)
@@ -229,11 +319,19 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                 "Expected ",
                 dataset()->num_tensors_, " got: ", out_tensors->size());
           }
-          size_t tensor_index = 0;
-          for (const Tensor& t : *out_tensors) {
-            DCHECK_LT(tensor_index, dataset()->num_tensors_);
-            string key = dataset()->FormatName(cur_index_, tensor_index++);
-            TF_RETURN_IF_ERROR(writer_->Add(key, t));
+          if (dataset()->compressed_) {
+            Tensor compressed(DT_STRING, TensorShape({}));
+            TF_RETURN_IF_ERROR(
+                CompressElement(*out_tensors, &compressed.scalar<string>()()));
+            TF_RETURN_IF_ERROR(
+                writer_->Add(dataset()->EntryName(cur_index_, 0), compressed));
+          } else {
+            size_t tensor_index = 0;
+            for (const Tensor& t : *out_tensors) {
+              DCHECK_LT(tensor_index, dataset()->num_tensors_);
+              string key = dataset()->EntryName(cur_index_, tensor_index++);
+              TF_RETURN_IF_ERROR(writer_->Add(key, t));
+            }
           }
           if (*end_of_sequence) {
             TF_RETURN_IF_ERROR(Finish());
@@ -426,7 +524,16 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             : DatasetIterator<FileDataset>(params),
               cur_index_(0),
               reader_(dataset()->env_, dataset()->filename_),
-              iterator_restored_(false) {}
+              num_shards_(0),
+              iterator_restored_(false) {
+          // The reader is positioned at the header entry.
+          BundleHeaderProto header;
+          if (reader_.status().ok() && reader_.Valid() &&
+              header.ParseFromArray(reader_.value().data(),
+                                    reader_.value().size())) {
+            num_shards_ = header.num_shards();
+          }
+        }
 
         Status GetNextInternal(IteratorContext* ctx,
                                std::vector<Tensor>* out_tensors,
@@ -443,7 +550,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           out_tensors->clear();
           out_tensors->resize(dataset()->num_tensors_);
 
-          for (size_t i = 0; i < dataset()->num_tensors_; ++i) {
+          for (size_t i = 0; i < dataset()->NumEntries(); ++i) {
             // When the iterator is restored from the checkpoint, `reader_` is
             // already pointing at `key` so we do not need to skip the header
             // entry.
@@ -459,8 +566,28 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
               return Status::OK();
             }
             StringPiece key = reader_.key();
-            DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-            TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+            const string expected_key = dataset()->EntryName(cur_index_, i);
+            if (key != expected_key) {
+              return errors::InvalidArgument(
+                  "Unexpected entry ", key, " in cache ", dataset()->filename_,
+                  " (expected ", expected_key,
+                  "). The cache may have been written with a different "
+                  "compression.");
+            }
+            if (dataset()->compressed_) {
+              Tensor compressed;
+              TF_RETURN_IF_ERROR(reader_.ReadCurrent(&compressed));
+              TF_RETURN_IF_ERROR(UncompressElement(
+                  compressed.scalar<string>()(), out_tensors));
+              if (out_tensors->size() != dataset()->num_tensors_) {
+                return errors::DataLoss("Cache element ", key, " has ",
+                                        out_tensors->size(),
+                                        " components, expected ",
+                                        dataset()->num_tensors_);
+              }
+            } else {
+              TF_RETURN_IF_ERROR(ReadCurrent(&(*out_tensors)[i]));
+            }
             TF_RETURN_IF_ERROR(reader_.status());
           }
           cur_index_++;
@@ -493,15 +620,60 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           if (!reader_.Valid()) {
             return errors::Internal("Error initializing BundleReader.");
           }
-          reader_.Seek(dataset()->FormatName(cur_index_, 0));
+          reader_.Seek(dataset()->EntryName(cur_index_, 0));
           iterator_restored_ = true;
           return Status::OK();
         }
 
        private:
+        // Reads the current entry of `reader_`. Numeric tensors are copied
+        // out of the memory-mapped data files, which saves the buffered reads
+        // of `BundleReader::ReadCurrent()`. Like the latter, this verifies the
+        // checksum of the entry.
+        Status ReadCurrent(Tensor* out) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          BundleEntryProto entry;
+          if (!entry.ParseFromArray(reader_.value().data(),
+                                    reader_.value().size())) {
+            return errors::DataLoss("Unable to parse cache entry ",
+                                    reader_.key(), " in ",
+                                    dataset()->filename_);
+          }
+          if (!DataTypeCanUseMemcpy(entry.dtype()) || entry.slices_size() > 0 ||
+              !TensorShape::IsValid(entry.shape())) {
+            return reader_.ReadCurrent(out);
+          }
+          const TensorShape shape(entry.shape());
+          if (shape.num_elements() * DataTypeSize(entry.dtype()) !=
+                  entry.size() ||
+              entry.size() == 0) {
+            return reader_.ReadCurrent(out);
+          }
+          const Tensor mapped =
+              dataset()->MappedDataFile(entry.shard_id(), num_shards_);
+          if (!mapped.IsInitialized() ||
+              entry.offset() + entry.size() > mapped.NumElements()) {
+            return reader_.ReadCurrent(out);
+          }
+          const char* data = mapped.tensor_data().data() + entry.offset();
+          const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+          if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+            return errors::DataLoss(
+                "Checksum does not match for cache entry ", reader_.key(),
+                " in ", dataset()->filename_, ": stored ",
+                strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+                " vs. calculated ", strings::Printf("%08u", actual_crc32c));
+          }
+          *out = Tensor(entry.dtype(), shape);
+          std::memcpy(const_cast<char*>(out->tensor_data().data()), data,
+                      entry.size());
+          return Status::OK();
+        }
+
         mutex mu_;
         size_t cur_index_ GUARDED_BY(mu_);
         BundleReader reader_ GUARDED_BY(mu_);
+        // The number of data files of the cache.
+        int32 num_shards_ GUARDED_BY(mu_);
         bool iterator_restored_ GUARDED_BY(mu_);
       };  // FileReaderIterator
 
@@ -532,18 +704,26 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     const DatasetBase* const input_;
     const string filename_;
     Env* const env_;
+    const bool compressed_;
     const size_t num_tensors_;
     const size_t tensor_index_padding_size_;
     static const size_t kMaxItems = 10000000;  // 10 million
     const size_t item_index_padding_size_;
     const string tensor_format_string_;
+
+    mutable mutex mu_;
+    // The memory-mapped data files of the completed cache, indexed by shard.
+    mutable std::vector<Tensor> mapped_data_files_ GUARDED_BY(mu_);
+    mutable bool mmap_unsupported_ GUARDED_BY(mu_) = false;
   };  // FileDataset
 
   class MemoryDataset : public DatasetBase {
    public:
-    explicit MemoryDataset(OpKernelContext* ctx, const DatasetBase* input)
+    explicit MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
+                           bool compressed)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
+          compressed_(compressed),
           cache_(new MemoryCache()) {
       input->Ref();
     }
@@ -576,8 +756,10 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
       Node* filename_node = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(string(""), &filename_node));
-      TF_RETURN_IF_ERROR(
-          b->AddDataset(this, {input_node, filename_node}, output));
+      AttrValue compression;
+      b->BuildAttrValue(string(compressed_ ? "SNAPPY" : ""), &compression);
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {input_node, filename_node},
+                                       {{"compression", compression}}, output));
       return Status::OK();
     }
 
@@ -586,7 +768,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     //
     // The expected use is that a single `MemoryWriterIterator` populates the
     // cache with dataset elements. Once all elements are cached, the cache can
-    // be used by one or more `MemoryReaderIterator`s.
+    // be used by one or more `MemoryReaderIterator`s. When the dataset is
+    // compressed, each cached element is a single DT_STRING scalar produced
+    // by `CompressElement()`.
     class MemoryCache {
      public:
       MemoryCache() = default;
@@ -792,7 +976,14 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             cache_->Complete();
             return Status::OK();
           }
-          cache_->emplace_back(*out_tensors);
+          if (dataset()->compressed_) {
+            Tensor compressed(DT_STRING, TensorShape({}));
+            TF_RETURN_IF_ERROR(
+                CompressElement(*out_tensors, &compressed.scalar<string>()()));
+            cache_->emplace_back({std::move(compressed)});
+          } else {
+            cache_->emplace_back(*out_tensors);
+          }
           return Status::OK();
         }
 
@@ -846,8 +1037,13 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           mutex_lock l(mu_);
           if (index_ < cache_->size()) {
             const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-            out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                                cache_tensors.end());
+            if (dataset()->compressed_) {
+              TF_RETURN_IF_ERROR(UncompressElement(
+                  cache_tensors[0].scalar<string>()(), out_tensors));
+            } else {
+              out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                                  cache_tensors.end());
+            }
             index_++;
             *end_of_sequence = false;
             return Status::OK();
@@ -883,9 +1079,12 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     };  // MemoryIterator
 
     const DatasetBase* const input_;
+    const bool compressed_;
     const std::shared_ptr<MemoryCache> cache_;
   };  // MemoryDataset
-};    // CacheDatasetOp
+
+  bool compressed_;
+};  // CacheDatasetOp
 
 REGISTER_KERNEL_BUILDER(Name("CacheDataset").Device(DEVICE_CPU),
                         CacheDatasetOp);
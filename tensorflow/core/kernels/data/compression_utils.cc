@@ -0,0 +1,194 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/compression_utils.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The first byte of a compressed element.
+enum Codec : char {
+  kUncompressed = 0,
+  kSnappy = 1,
+};
+
+// Appends the encoding of `t` to `*out`: its dtype, its shape and its values.
+void EncodeTensor(const Tensor& t, string* out) {
+  core::PutVarint32(out, t.dtype());
+  core::PutVarint32(out, t.dims());
+  for (int d = 0; d < t.dims(); ++d) {
+    core::PutVarint64(out, t.dim_size(d));
+  }
+  if (DataTypeCanUseMemcpy(t.dtype())) {
+    StringPiece data = t.tensor_data();
+    out->append(data.data(), data.size());
+  } else if (t.dtype() == DT_STRING) {
+    const auto strings = t.flat<string>();
+    for (int64 i = 0; i < strings.size(); ++i) {
+      core::PutVarint64(out, strings(i).size());
+      out->append(strings(i));
+    }
+  } else {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    string serialized;
+    proto.SerializeToString(&serialized);
+    core::PutVarint64(out, serialized.size());
+    out->append(serialized);
+  }
+}
+
+Status DecodeTensor(StringPiece* in, Tensor* t) {
+  const auto corrupted = [] {
+    return errors::DataLoss("Corrupted compressed dataset element");
+  };
+  uint32 dtype_value;
+  uint32 dims;
+  if (!core::GetVarint32(in, &dtype_value) || !core::GetVarint32(in, &dims) ||
+      dims > TensorShape::MaxDimensions()) {
+    return corrupted();
+  }
+  const DataType dtype = static_cast<DataType>(dtype_value);
+  gtl::InlinedVector<int64, 4> dim_sizes(dims);
+  for (uint32 d = 0; d < dims; ++d) {
+    uint64 dim_size;
+    if (!core::GetVarint64(in, &dim_size)) return corrupted();
+    dim_sizes[d] = static_cast<int64>(dim_size);
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(dim_sizes, &shape));
+
+  if (DataTypeCanUseMemcpy(dtype)) {
+    const size_t element_size = DataTypeSize(dtype);
+    if (static_cast<uint64>(shape.num_elements()) >
+        in->size() / element_size) {
+      return corrupted();
+    }
+    const size_t num_bytes = shape.num_elements() * element_size;
+    *t = Tensor(dtype, shape);
+    if (num_bytes > 0) {
+      std::memcpy(const_cast<char*>(t->tensor_data().data()), in->data(),
+                  num_bytes);
+    }
+    in->remove_prefix(num_bytes);
+  } else if (dtype == DT_STRING) {
+    // Each string takes at least one byte, for its length.
+    if (static_cast<uint64>(shape.num_elements()) > in->size()) {
+      return corrupted();
+    }
+    *t = Tensor(DT_STRING, shape);
+    auto strings = t->flat<string>();
+    for (int64 i = 0; i < strings.size(); ++i) {
+      uint64 size;
+      if (!core::GetVarint64(in, &size) || size > in->size()) {
+        return corrupted();
+      }
+      strings(i).assign(in->data(), size);
+      in->remove_prefix(size);
+    }
+  } else {
+    uint64 size;
+    TensorProto proto;
+    if (!core::GetVarint64(in, &size) || size > in->size() ||
+        !proto.ParseFromArray(in->data(), size) || proto.dtype() != dtype ||
+        !t->FromProto(proto)) {
+      return corrupted();
+    }
+    in->remove_prefix(size);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element, string* out) {
+  string uncompressed;
+  core::PutVarint64(&uncompressed, element.size());
+  for (const Tensor& t : element) {
+    EncodeTensor(t, &uncompressed);
+  }
+  out->clear();
+  out->push_back(kSnappy);
+  string compressed;
+  if (port::Snappy_Compress(uncompressed.data(), uncompressed.size(),
+                            &compressed)) {
+    out->append(compressed);
+  } else {
+    (*out)[0] = kUncompressed;
+    out->append(uncompressed);
+  }
+  return Status::OK();
+}
+
+Status UncompressElement(StringPiece compressed,
+                         std::vector<Tensor>* element) {
+  if (compressed.empty()) {
+    return errors::DataLoss("Empty compressed dataset element");
+  }
+  const char codec = compressed[0];
+  compressed.remove_prefix(1);
+  string uncompressed;
+  StringPiece in;
+  switch (codec) {
+    case kUncompressed:
+      in = compressed;
+      break;
+    case kSnappy: {
+      size_t size;
+      if (!port::Snappy_GetUncompressedLength(compressed.data(),
+                                              compressed.size(), &size)) {
+        return errors::DataLoss("Corrupted compressed dataset element");
+      }
+      uncompressed.resize(size);
+      if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                   &uncompressed[0])) {
+        return errors::DataLoss("Corrupted compressed dataset element");
+      }
+      in = uncompressed;
+      break;
+    }
+    default:
+      return errors::DataLoss("Unknown compression of dataset element: ",
+                              static_cast<int>(codec));
+  }
+
+  uint64 num_components;
+  if (!core::GetVarint64(&in, &num_components) ||
+      num_components > in.size()) {
+    return errors::DataLoss("Corrupted compressed dataset element");
+  }
+  element->clear();
+  element->resize(num_components);
+  for (Tensor& t : *element) {
+    TF_RETURN_IF_ERROR(DecodeTensor(&in, &t));
+  }
+  if (!in.empty()) {
+    return errors::DataLoss("Corrupted compressed dataset element");
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,40 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_COMPRESSION_UTILS_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_COMPRESSION_UTILS_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// Compresses the components of a dataset element into a single string with
+// snappy, for datasets that hold on to many elements. Numeric components are
+// stored as their raw bytes, strings with their lengths, and other types as
+// serialized `TensorProto`s. If snappy is not available, the element is stored
+// uncompressed in the same format.
+Status CompressElement(const std::vector<Tensor>& element, string* out);
+
+// Decodes an element compressed with `CompressElement()` into new tensors.
+Status UncompressElement(StringPiece compressed, std::vector<Tensor>* element);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_COMPRESSION_UTILS_H_
@@ -0,0 +1,82 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/compression_utils.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(CompressionUtilsTest, RoundTrip) {
+  Tensor zeros(DT_FLOAT, TensorShape({100, 10}));
+  zeros.flat<float>().setZero();
+  const std::vector<Tensor> element = {
+      test::AsScalar<int64>(-7),
+      zeros,
+      test::AsTensor<string>({"a", "", "bcd"}, TensorShape({3, 1})),
+      test::AsTensor<bool>({true, false}),
+      Tensor(DT_DOUBLE, TensorShape({0, 4})),
+  };
+  string compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  string probe;
+  if (port::Snappy_Compress("", 0, &probe)) {
+    // The zeros compress well.
+    EXPECT_LT(compressed.size(), zeros.TotalBytes() / 4);
+  }
+
+  std::vector<Tensor> result;
+  TF_ASSERT_OK(UncompressElement(compressed, &result));
+  ASSERT_EQ(element.size(), result.size());
+  test::ExpectTensorEqual<int64>(element[0], result[0]);
+  test::ExpectTensorEqual<float>(element[1], result[1]);
+  test::ExpectTensorEqual<string>(element[2], result[2]);
+  test::ExpectTensorEqual<bool>(element[3], result[3]);
+  test::ExpectTensorEqual<double>(element[4], result[4]);
+}
+
+TEST(CompressionUtilsTest, EmptyElement) {
+  string compressed;
+  TF_ASSERT_OK(CompressElement({}, &compressed));
+  std::vector<Tensor> result = {test::AsScalar<int32>(1)};
+  TF_ASSERT_OK(UncompressElement(compressed, &result));
+  EXPECT_TRUE(result.empty());
+}
+
+TEST(CompressionUtilsTest, Corrupted) {
+  string compressed;
+  TF_ASSERT_OK(CompressElement(
+      {test::AsTensor<int32>({1, 2, 3}), test::AsScalar<string>("abc")},
+      &compressed));
+  std::vector<Tensor> result;
+  EXPECT_TRUE(errors::IsDataLoss(UncompressElement("", &result)));
+  // Unknown compression.
+  EXPECT_TRUE(errors::IsDataLoss(UncompressElement("\x07", &result)));
+  // Truncated elements.
+  for (size_t size = 1; size < compressed.size(); ++size) {
+    EXPECT_FALSE(
+        UncompressElement(StringPiece(compressed.data(), size), &result).ok())
+        << size;
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,406 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/util/column_file.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads batches of rows of column files (see util/column_file.h). Only the
+// requested columns are read. Dense columns are produced as tensors of shape
+// [batch] + shape, and variable-length columns as sparse tensors of shape
+// [batch, max length].
+//
+// Batches do not span row groups, so a row group whose size is not a
+// multiple of `batch_size` ends with a smaller batch. A batch that is a whole
+// row group is produced without copying its dense columns.
+class ColumnarDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ColumnarDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_keys", &dense_keys_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_types", &dense_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_shapes", &dense_shapes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_keys", &sparse_keys_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_types", &sparse_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES(ctx,
+                dense_keys_.size() == dense_types_.size() &&
+                    dense_keys_.size() == dense_shapes_.size(),
+                errors::InvalidArgument(
+                    "dense_keys, dense_types and dense_shapes must have the "
+                    "same length"));
+    OP_REQUIRES(ctx, sparse_keys_.size() == sparse_types_.size(),
+                errors::InvalidArgument(
+                    "sparse_keys and sparse_types must have the same length"));
+    for (int d = 0; d < dense_shapes_.size(); ++d) {
+      OP_REQUIRES(ctx, dense_shapes_[d].IsFullyDefined(),
+                  errors::InvalidArgument("dense_shapes[", d,
+                                          "] must be fully defined, not ",
+                                          dense_shapes_[d].DebugString()));
+    }
+
+    // Like ParseExampleDataset, the outputs are ordered by key.
+    std::map<string, int> keys;
+    for (int d = 0; d < dense_keys_.size(); ++d) {
+      OP_REQUIRES(ctx, keys.insert({dense_keys_[d], d}).second,
+                  errors::InvalidArgument("Duplicate key not allowed: ",
+                                          dense_keys_[d]));
+    }
+    for (int d = 0; d < sparse_keys_.size(); ++d) {
+      OP_REQUIRES(
+          ctx, keys.insert({sparse_keys_[d], dense_keys_.size() + d}).second,
+          errors::InvalidArgument("Duplicate key not allowed: ",
+                                  sparse_keys_[d]));
+    }
+    OP_REQUIRES(ctx, output_types_.size() == keys.size(),
+                errors::InvalidArgument("Expected ", keys.size(),
+                                        " output types, but got ",
+                                        output_types_.size()));
+    for (const auto& key : keys) {
+      columns_.push_back(key.second);
+    }
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument("batch_size must be positive"));
+
+    *output = new Dataset(ctx, std::move(filenames), batch_size, dense_keys_,
+                          dense_types_, dense_shapes_, sparse_keys_,
+                          sparse_types_, output_types_, output_shapes_,
+                          columns_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            int64 batch_size, std::vector<string> dense_keys,
+            DataTypeVector dense_types,
+            std::vector<PartialTensorShape> dense_shapes,
+            std::vector<string> sparse_keys, DataTypeVector sparse_types,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes,
+            std::vector<int> columns)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          batch_size_(batch_size),
+          dense_keys_(std::move(dense_keys)),
+          dense_types_(std::move(dense_types)),
+          dense_shapes_(std::move(dense_shapes)),
+          sparse_keys_(std::move(sparse_keys)),
+          sparse_types_(std::move(sparse_types)),
+          output_types_(output_types),
+          output_shapes_(output_shapes),
+          columns_(std::move(columns)) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Columnar")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ColumnarDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* batch_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+
+      AttrValue dense_keys_attr;
+      AttrValue dense_types_attr;
+      AttrValue dense_shapes_attr;
+      AttrValue sparse_keys_attr;
+      AttrValue sparse_types_attr;
+      b->BuildAttrValue(dense_keys_, &dense_keys_attr);
+      b->BuildAttrValue(dense_types_, &dense_types_attr);
+      b->BuildAttrValue(dense_shapes_, &dense_shapes_attr);
+      b->BuildAttrValue(sparse_keys_, &sparse_keys_attr);
+      b->BuildAttrValue(sparse_types_, &sparse_types_attr);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {{0, filenames}, {1, batch_size}}, {},
+          {{"dense_keys", dense_keys_attr},
+           {"dense_types", dense_types_attr},
+           {"dense_shapes", dense_shapes_attr},
+           {"sparse_keys", sparse_keys_attr},
+           {"sparse_types", sparse_types_attr}},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        while (true) {
+          if (reader_) {
+            if (group_ < reader_->num_groups()) {
+              if (group_values_.empty()) {
+                TF_RETURN_IF_ERROR(ReadGroupLocked());
+              }
+              const int64 num_rows = reader_->num_rows_in_group(group_);
+              if (row_ < num_rows) {
+                const int64 end = std::min(row_ + dataset()->batch_size_,
+                                           num_rows);
+                MakeBatchLocked(row_, end, out_tensors);
+                row_ = end;
+                *end_of_sequence = false;
+                return Status::OK();
+              }
+              ++group_;
+              row_ = 0;
+              group_values_.clear();
+              group_row_offsets_.clear();
+              continue;
+            }
+            reader_.reset();
+            ++current_file_index_;
+            group_ = 0;
+          }
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+        }
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("group"), group_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("row"), row_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        reader_.reset();
+        group_values_.clear();
+        group_row_offsets_.clear();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("group"), &group_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("row"), &row_));
+        // The row group is read again on the next call to GetNext().
+        if (current_file_index_ < dataset()->filenames_.size()) {
+          TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Opens the current file, and finds the requested columns in it.
+      Status OpenFileLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const string& filename = dataset()->filenames_[current_file_index_];
+        TF_RETURN_IF_ERROR(
+            columnar::ColumnFileReader::Open(env, filename, &reader_));
+        file_columns_.clear();
+        for (int c : dataset()->columns_) {
+          const bool dense = c < dataset()->dense_keys_.size();
+          const int d = dense ? c : c - dataset()->dense_keys_.size();
+          const string& key = dense ? dataset()->dense_keys_[d]
+                                    : dataset()->sparse_keys_[d];
+          const DataType dtype = dense ? dataset()->dense_types_[d]
+                                       : dataset()->sparse_types_[d];
+          const int column = reader_->FindColumn(key);
+          if (column < 0) {
+            return errors::InvalidArgument("File ", filename,
+                                           " has no column ", key);
+          }
+          const columnar::ColumnSpec& spec = reader_->columns()[column];
+          if (spec.dtype != dtype) {
+            return errors::InvalidArgument(
+                "Column ", key, " of file ", filename, " has type ",
+                DataTypeString(spec.dtype), " instead of ",
+                DataTypeString(dtype));
+          }
+          if (dense ? !spec.shape.IsIdenticalTo(dataset()->dense_shapes_[d])
+                    : !spec.variable_length()) {
+            return errors::InvalidArgument(
+                "Column ", key, " of file ", filename, " has shape ",
+                spec.shape.DebugString(), " instead of ",
+                dense ? dataset()->dense_shapes_[d].DebugString() : "[?]");
+          }
+          file_columns_.push_back(column);
+        }
+        return Status::OK();
+      }
+
+      // Reads the requested columns of the current row group.
+      Status ReadGroupLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        group_values_.resize(file_columns_.size());
+        group_row_offsets_.resize(file_columns_.size());
+        for (size_t i = 0; i < file_columns_.size(); ++i) {
+          Tensor row_lengths;
+          TF_RETURN_IF_ERROR(reader_->ReadColumn(
+              group_, file_columns_[i], &group_values_[i], &row_lengths));
+          std::vector<int64>& offsets = group_row_offsets_[i];
+          offsets.clear();
+          if (reader_->columns()[file_columns_[i]].variable_length()) {
+            auto lengths = row_lengths.vec<int64>();
+            offsets.resize(lengths.size() + 1);
+            offsets[0] = 0;
+            for (int64 r = 0; r < lengths.size(); ++r) {
+              offsets[r + 1] = offsets[r] + lengths(r);
+            }
+          }
+        }
+        return Status::OK();
+      }
+
+      // Produces the rows [start, end) of the current row group.
+      void MakeBatchLocked(int64 start, int64 end,
+                           std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        for (size_t i = 0; i < file_columns_.size(); ++i) {
+          const Tensor& values = group_values_[i];
+          const std::vector<int64>& offsets = group_row_offsets_[i];
+          if (offsets.empty()) {
+            out_tensors->push_back(Slice(values, start, end));
+            continue;
+          }
+          const int64 num_values = offsets[end] - offsets[start];
+          Tensor indices(DT_INT64, TensorShape({num_values, 2}));
+          auto indices_t = indices.matrix<int64>();
+          int64 max_length = 0;
+          for (int64 r = start, n = 0; r < end; ++r) {
+            const int64 length = offsets[r + 1] - offsets[r];
+            max_length = std::max(max_length, length);
+            for (int64 j = 0; j < length; ++j, ++n) {
+              indices_t(n, 0) = r - start;
+              indices_t(n, 1) = j;
+            }
+          }
+          Tensor dense_shape(DT_INT64, TensorShape({2}));
+          dense_shape.vec<int64>()(0) = end - start;
+          dense_shape.vec<int64>()(1) = max_length;
+
+          Tensor serialized_sparse(DT_VARIANT, TensorShape({3}));
+          auto serialized_sparse_t = serialized_sparse.vec<Variant>();
+          serialized_sparse_t(0) = std::move(indices);
+          serialized_sparse_t(1) =
+              Slice(values, offsets[start], offsets[end]);
+          serialized_sparse_t(2) = std::move(dense_shape);
+          out_tensors->push_back(std::move(serialized_sparse));
+        }
+      }
+
+      // Returns the elements [start, end) of `values` along its first
+      // dimension, sharing its buffer when the result is suitably aligned.
+      static Tensor Slice(const Tensor& values, int64 start, int64 end) {
+        if (start == 0 && end == values.dim_size(0)) return values;
+        Tensor slice = values.Slice(start, end);
+        if (!slice.IsAligned()) return tensor::DeepCopy(slice);
+        return slice;
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<columnar::ColumnFileReader> reader_ GUARDED_BY(mu_);
+      // `file_columns_[i]` is the column of the current file holding output
+      // `i`.
+      std::vector<int> file_columns_ GUARDED_BY(mu_);
+      int64 group_ GUARDED_BY(mu_) = 0;
+      int64 row_ GUARDED_BY(mu_) = 0;
+      // The requested columns of the current row group, and for each
+      // variable-length column the offset of each row in its values.
+      std::vector<Tensor> group_values_ GUARDED_BY(mu_);
+      std::vector<std::vector<int64>> group_row_offsets_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const int64 batch_size_;
+    const std::vector<string> dense_keys_;
+    const DataTypeVector dense_types_;
+    const std::vector<PartialTensorShape> dense_shapes_;
+    const std::vector<string> sparse_keys_;
+    const DataTypeVector sparse_types_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+    // The outputs in order: indices into the dense keys, followed by the
+    // sparse keys.
+    const std::vector<int> columns_;
+  };
+
+  std::vector<string> dense_keys_;
+  DataTypeVector dense_types_;
+  std::vector<PartialTensorShape> dense_shapes_;
+  std::vector<string> sparse_keys_;
+  DataTypeVector sparse_types_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  // The outputs in order: indices into the dense keys, followed by the
+  // sparse keys.
+  std::vector<int> columns_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ExperimentalColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
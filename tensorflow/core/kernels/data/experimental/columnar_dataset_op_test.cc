@@ -0,0 +1,287 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/column_file.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64 kRowsPerFile = 6;
+constexpr int64 kRowsPerGroup = 4;
+constexpr int64 kBatchSize = 3;
+
+// The batches of two files, as [begin, end) ranges of the global row index
+// file * kRowsPerFile + row. Batches end at the row group boundaries.
+const std::vector<std::pair<int64, int64>>& ExpectedBatches() {
+  static const auto* batches = new std::vector<std::pair<int64, int64>>(
+      {{0, 3}, {3, 4}, {4, 6}, {6, 9}, {9, 10}, {10, 12}});
+  return *batches;
+}
+
+// The variable-length column of `row` has row % 3 values.
+Tensor Ids(int64 row) {
+  Tensor ids(DT_INT64, TensorShape({row % 3}));
+  for (int64 j = 0; j < row % 3; ++j) {
+    ids.vec<int64>()(j) = row * 10 + j;
+  }
+  return ids;
+}
+
+class ColumnarDatasetOpTest : public ::testing::Test {
+ protected:
+  // Writes two column files with a dense scalar "label", a dense vector
+  // "weights", a variable-length "ids" and a string "name" column.
+  void SetUp() override {
+    for (int file = 0; file < 2; ++file) {
+      const string filename = io::JoinPath(
+          testing::TmpDir(), strings::StrCat("columnar_dataset_", file));
+      std::unique_ptr<WritableFile> writable;
+      TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &writable));
+      columnar::ColumnFileWriter::Options options;
+      options.rows_per_group = kRowsPerGroup;
+      columnar::ColumnFileWriter writer(
+          {{"label", DT_INT64, PartialTensorShape({})},
+           {"weights", DT_FLOAT, PartialTensorShape({2})},
+           {"ids", DT_INT64, PartialTensorShape({-1})},
+           {"name", DT_STRING, PartialTensorShape({})}},
+          writable.get(), options);
+      for (int64 r = 0; r < kRowsPerFile; ++r) {
+        const int64 row = file * kRowsPerFile + r;
+        TF_ASSERT_OK(writer.AppendRow(
+            {test::AsScalar<int64>(row),
+             test::AsTensor<float>({row * 0.5f, -1.0f * row}),
+             Ids(row), test::AsScalar<string>(strings::StrCat("row", row))}));
+      }
+      TF_ASSERT_OK(writer.Close());
+      TF_ASSERT_OK(writable->Close());
+      filenames_.push_back(filename);
+    }
+  }
+
+  // Creates a session iterating over a ColumnarDataset of the files, which
+  // reads the given dense columns and, if `read_ids`, the "ids" column.
+  std::unique_ptr<Session> MakeSession(const std::vector<string>& dense_keys,
+                                       bool read_ids) {
+    static const auto* dense_columns =
+        new std::map<string, std::pair<DataType, PartialTensorShape>>(
+            {{"label", {DT_INT64, PartialTensorShape({})}},
+             {"weights", {DT_FLOAT, PartialTensorShape({2})}}});
+    DataTypeVector dense_types;
+    std::vector<PartialTensorShape> dense_shapes;
+    // The outputs are ordered by key, and "ids" comes first.
+    DataTypeVector output_types;
+    std::vector<PartialTensorShape> output_shapes;
+    if (read_ids) {
+      output_types.push_back(DT_VARIANT);
+      output_shapes.push_back(PartialTensorShape({3}));
+    }
+    for (const string& key : dense_keys) {
+      const auto& column = dense_columns->at(key);
+      dense_types.push_back(column.first);
+      dense_shapes.push_back(column.second);
+      output_types.push_back(column.first);
+      output_shapes.push_back(PartialTensorShape({-1}).Concatenate(
+          column.second));
+    }
+    const std::vector<string> sparse_keys =
+        read_ids ? std::vector<string>({"ids"}) : std::vector<string>();
+    const DataTypeVector sparse_types =
+        read_ids ? DataTypeVector({DT_INT64}) : DataTypeVector();
+    num_outputs_ = output_types.size();
+
+    Graph graph(OpRegistry::Global());
+    Tensor filenames(DT_STRING, TensorShape({2}));
+    filenames.vec<string>()(0) = filenames_[0];
+    filenames.vec<string>()(1) = filenames_[1];
+    Node* dataset;
+    TF_CHECK_OK(
+        NodeBuilder("dataset", "ExperimentalColumnarDataset")
+            .Input(test::graph::Constant(&graph, filenames))
+            .Input(test::graph::Constant(&graph,
+                                         test::AsScalar<int64>(kBatchSize)))
+            .Attr("dense_keys", dense_keys)
+            .Attr("dense_types", dense_types)
+            .Attr("dense_shapes", dense_shapes)
+            .Attr("sparse_keys", sparse_keys)
+            .Attr("sparse_types", sparse_types)
+            .Attr("output_types", output_types)
+            .Attr("output_shapes", output_shapes)
+            .Finalize(&graph, &dataset));
+    Node* iterator;
+    TF_CHECK_OK(NodeBuilder("iterator", "Iterator")
+                    .Attr("shared_name", "iterator")
+                    .Attr("container", "")
+                    .Attr("output_types", output_types)
+                    .Attr("output_shapes", output_shapes)
+                    .Finalize(&graph, &iterator));
+    TF_CHECK_OK(NodeBuilder("make_iterator", "MakeIterator")
+                    .Input(dataset)
+                    .Input(iterator)
+                    .Finalize(&graph, nullptr));
+    TF_CHECK_OK(NodeBuilder("get_next", "IteratorGetNext")
+                    .Input(iterator)
+                    .Attr("output_types", output_types)
+                    .Attr("output_shapes", output_shapes)
+                    .Finalize(&graph, nullptr));
+    TF_CHECK_OK(NodeBuilder("serialize", "SerializeIterator")
+                    .Input(iterator)
+                    .Finalize(&graph, nullptr));
+    Node* state;
+    TF_CHECK_OK(NodeBuilder("state", "Placeholder")
+                    .Attr("dtype", DT_VARIANT)
+                    .Finalize(&graph, &state));
+    TF_CHECK_OK(NodeBuilder("deserialize", "DeserializeIterator")
+                    .Input(iterator)
+                    .Input(state)
+                    .Finalize(&graph, nullptr));
+
+    GraphDef graph_def;
+    graph.ToGraphDef(&graph_def);
+    std::unique_ptr<Session> session(NewSession(SessionOptions()));
+    TF_CHECK_OK(session->Create(graph_def));
+    TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+    return session;
+  }
+
+  Status GetNext(Session* session, std::vector<Tensor>* outputs) {
+    std::vector<string> output_names;
+    for (int i = 0; i < num_outputs_; ++i) {
+      output_names.push_back(strings::StrCat("get_next:", i));
+    }
+    return session->Run({}, output_names, {}, outputs);
+  }
+
+  // Checks the batches of all the columns against ExpectedBatches(), from
+  // batch `first` on, and then the end of the sequence.
+  void ExpectBatches(Session* session, int first) {
+    for (int b = first; b < ExpectedBatches().size(); ++b) {
+      const int64 begin = ExpectedBatches()[b].first;
+      const int64 end = ExpectedBatches()[b].second;
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(GetNext(session, &outputs));
+      ASSERT_EQ(3, outputs.size());
+
+      // "ids" is a sparse tensor of shape [batch, max length].
+      const auto sparse = outputs[0].vec<Variant>();
+      ASSERT_EQ(3, sparse.size());
+      std::vector<int64> indices;
+      std::vector<int64> values;
+      int64 max_length = 0;
+      for (int64 row = begin; row < end; ++row) {
+        const Tensor ids = Ids(row);
+        max_length = std::max(max_length, ids.NumElements());
+        for (int64 j = 0; j < ids.NumElements(); ++j) {
+          indices.push_back(row - begin);
+          indices.push_back(j);
+          values.push_back(ids.vec<int64>()(j));
+        }
+      }
+      test::ExpectTensorEqual<int64>(
+          test::AsTensor<int64>(
+              indices, TensorShape({static_cast<int64>(values.size()), 2})),
+          *sparse(0).get<Tensor>());
+      test::ExpectTensorEqual<int64>(test::AsTensor<int64>(values),
+                                     *sparse(1).get<Tensor>());
+      test::ExpectTensorEqual<int64>(
+          test::AsTensor<int64>({end - begin, max_length}),
+          *sparse(2).get<Tensor>());
+
+      std::vector<int64> labels;
+      std::vector<float> weights;
+      for (int64 row = begin; row < end; ++row) {
+        labels.push_back(row);
+        weights.push_back(row * 0.5f);
+        weights.push_back(-1.0f * row);
+      }
+      test::ExpectTensorEqual<int64>(test::AsTensor<int64>(labels),
+                                     outputs[1]);
+      test::ExpectTensorEqual<float>(
+          test::AsTensor<float>(weights, TensorShape({end - begin, 2})),
+          outputs[2]);
+    }
+    std::vector<Tensor> outputs;
+    EXPECT_TRUE(errors::IsOutOfRange(GetNext(session, &outputs)));
+  }
+
+  std::vector<string> filenames_;
+  int num_outputs_ = 0;
+};
+
+TEST_F(ColumnarDatasetOpTest, DenseAndSparseColumns) {
+  std::unique_ptr<Session> session = MakeSession({"label", "weights"}, true);
+  ExpectBatches(session.get(), 0);
+}
+
+TEST_F(ColumnarDatasetOpTest, Projection) {
+  // Only "label" is read: the other columns are neither produced nor
+  // checked against the attrs.
+  std::unique_ptr<Session> session = MakeSession({"label"}, false);
+  for (const auto& batch : ExpectedBatches()) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(GetNext(session.get(), &outputs));
+    ASSERT_EQ(1, outputs.size());
+    std::vector<int64> labels;
+    for (int64 row = batch.first; row < batch.second; ++row) {
+      labels.push_back(row);
+    }
+    test::ExpectTensorEqual<int64>(test::AsTensor<int64>(labels), outputs[0]);
+  }
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsOutOfRange(GetNext(session.get(), &outputs)));
+}
+
+TEST_F(ColumnarDatasetOpTest, SaveAndRestore) {
+  // Saves the iterator in the middle of each file and at the end of the
+  // first one, and restores it in a new session.
+  for (int saved_batches : {1, 3, 4}) {
+    std::unique_ptr<Session> session = MakeSession({"label", "weights"}, true);
+    for (int b = 0; b < saved_batches; ++b) {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(GetNext(session.get(), &outputs));
+    }
+    std::vector<Tensor> state;
+    TF_ASSERT_OK(session->Run({}, {"serialize:0"}, {}, &state));
+
+    std::unique_ptr<Session> restored =
+        MakeSession({"label", "weights"}, true);
+    TF_ASSERT_OK(
+        restored->Run({{"state", state[0]}}, {}, {"deserialize"}, nullptr));
+    ExpectBatches(restored.get(), saved_batches);
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,391 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/csv_block_parser.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+
+namespace tensorflow {
+namespace data {
+
+CsvRecordScanner::CsvRecordScanner(char delim, bool use_quote_delim)
+    : delim_(delim), use_quote_delim_(use_quote_delim) {
+  Reset();
+}
+
+void CsvRecordScanner::Reset() {
+  pos_ = 0;
+  skip_until_ = 0;
+  scanned_size_ = 0;
+  quoted_ = false;
+  last_end_ = 0;
+  prev_end_ = 0;
+  num_ends_ = 0;
+  trailing_cr_ = false;
+}
+
+void CsvRecordScanner::Scan(StringPiece data) {
+  const char* const p = data.data();
+  const size_t n = data.size();
+  scanned_size_ = n;
+  size_t i = pos_;
+  bool complete = true;
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; complete && i + 16 <= n; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const uint32 quotes =
+        use_quote_delim_
+            ? static_cast<uint32>(
+                  _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))
+            : 0;
+    // Inside a quoted field, only quotes matter.
+    if (quoted_ && quotes == 0) continue;
+    uint32 special = quotes | static_cast<uint32>(_mm_movemask_epi8(
+                                  _mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+                                               _mm_cmpeq_epi8(
+                                                   chunk, carriage_return))));
+    while (special != 0) {
+      const size_t j = i + __builtin_ctz(special);
+      special &= special - 1;
+      if (!Visit(data, j)) {
+        pos_ = j;
+        complete = false;
+        break;
+      }
+    }
+  }
+#endif
+  for (; complete && i < n; ++i) {
+    const char c = p[i];
+    if (c == '\n' || c == '\r' || (use_quote_delim_ && c == '"')) {
+      if (!Visit(data, i)) {
+        pos_ = i;
+        complete = false;
+      }
+    }
+  }
+  if (complete) pos_ = n;
+  trailing_cr_ = n > 0 && last_end_ == n && p[n - 1] == '\r';
+}
+
+bool CsvRecordScanner::Visit(StringPiece data, size_t i) {
+  if (i < skip_until_) return true;
+  const char* const p = data.data();
+  if (p[i] == '"') {
+    if (!quoted_) {
+      // Only a quote at the start of a field starts a quoted field. The parser
+      // reports any other quote in an unquoted field as an error.
+      quoted_ = i == 0 || p[i - 1] == delim_ || p[i - 1] == '\n' ||
+                p[i - 1] == '\r';
+      return true;
+    }
+    // A quote in a quoted field is either escaped by the next quote or ends
+    // the field.
+    if (i + 1 == data.size()) return false;
+    const char next = p[i + 1];
+    skip_until_ = i + 2;
+    if (next == delim_) {
+      quoted_ = false;
+    } else if (next == '\n' || next == '\r') {
+      quoted_ = false;
+      prev_end_ = last_end_;
+      last_end_ = i + 2;
+      ++num_ends_;
+    }
+    // Any other character is a malformed field, which stays quoted as in the
+    // parser.
+    return true;
+  }
+  if (quoted_) return true;
+  if (p[i] == '\n' && last_end_ == i && i > 0 && p[i - 1] == '\r') {
+    // The '\n' of a "\r\n" line break.
+    prev_end_ = last_end_;
+    last_end_ = i + 1;
+    return true;
+  }
+  prev_end_ = last_end_;
+  last_end_ = i + 1;
+  ++num_ends_;
+  return true;
+}
+
+namespace {
+
+inline bool IsLineBreak(char c) { return c == '\n' || c == '\r'; }
+
+bool ParseValue(StringPiece s, int32* value) {
+  return strings::safe_strto32(s, value);
+}
+
+bool ParseValue(StringPiece s, int64* value) {
+  return strings::safe_strto64(s, value);
+}
+
+bool ParseValue(StringPiece s, float* value) {
+  return strings::safe_strtof(s, value);
+}
+
+bool ParseValue(StringPiece s, double* value) {
+  return strings::safe_strtod(s, value);
+}
+
+bool ParseValue(StringPiece s, string* value) {
+  value->assign(s.data(), s.size());
+  return true;
+}
+
+// Sets the value of `row` in `column` from a field, or from its default if
+// the field is missing.
+template <typename T>
+Status SetValue(StringPiece field, bool missing, const Tensor& default_value,
+                int64 index, int64 row, Tensor* column) {
+  T* value = &column->flat<T>()(row);
+  if (missing) {
+    *value = default_value.flat<T>()(0);
+    return Status::OK();
+  }
+  if (!ParseValue(field, value)) {
+    return errors::InvalidArgument("Field ", index, " in record is not a valid ",
+                                   DataTypeString(DataTypeToEnum<T>::value),
+                                   ": ", field);
+  }
+  return Status::OK();
+}
+
+// Parses records from a block of CSV data into the columns of a `CsvBlock`.
+class RecordParser {
+ public:
+  RecordParser(const CsvParseOptions& options, StringPiece data,
+               CsvBlock* block)
+      : options_(options), data_(data), block_(block) {}
+
+  // Parses the record at `*pos` into `row` of the columns, or checks it
+  // without output if `row` is negative, and advances `*pos` to the next
+  // record. Returns the first error of the record.
+  Status ParseRecord(size_t* pos, int64 row) {
+    const bool select_all = options_.select_cols.empty();
+    const std::vector<int64>& selected = options_.select_cols;
+    Status result;
+    int64 num_parsed = 0;
+    int64 num_included = 0;
+    size_t num_selected_parsed = 0;
+    bool end_of_record = false;
+    while (!end_of_record) {
+      const bool include =
+          row >= 0 &&
+          (select_all || (num_selected_parsed < selected.size() &&
+                          selected[num_selected_parsed] == num_parsed));
+      StringPiece field;
+      bool output = include;
+      Status s;
+      if (options_.use_quote_delim && *pos < data_.size() &&
+          data_[*pos] == '"') {
+        s = ParseQuotedField(pos, &field, &end_of_record, &output);
+      } else {
+        s = ParseUnquotedField(pos, &field, &end_of_record);
+      }
+      result.Update(s);
+      if (output) {
+        result.Update(FieldToOutput(field, num_included, row));
+      }
+      ++num_parsed;
+      if (include) {
+        ++num_selected_parsed;
+        ++num_included;
+      }
+    }
+    if (result.ok() && num_included != options_.output_types.size() &&
+        row >= 0) {
+      return errors::InvalidArgument("Expect ", options_.output_types.size(),
+                                     " fields but have ", num_included,
+                                     " in record");
+    }
+    return result;
+  }
+
+ private:
+  // Parses an unquoted field, which ends at a delimiter, a line break or the
+  // end of the data.
+  Status ParseUnquotedField(size_t* pos, StringPiece* field,
+                            bool* end_of_record) {
+    const char* const p = data_.data();
+    const size_t n = data_.size();
+    const char delim = options_.delim;
+    const size_t start = *pos;
+    size_t i = start;
+    bool has_quote = false;
+    while (i < n && p[i] != delim && !IsLineBreak(p[i])) {
+      has_quote |= p[i] == '"';
+      ++i;
+    }
+    *field = StringPiece(p + start, i - start);
+    FinishField(i, pos, end_of_record);
+    if (options_.use_quote_delim && has_quote) {
+      return errors::InvalidArgument(
+          "Unquoted fields cannot have quotes inside");
+    }
+    return Status::OK();
+  }
+
+  // Parses a quoted field and removes its quotes, unescaping any escaped
+  // quotes inside. Clears `*output` if the field is malformed.
+  Status ParseQuotedField(size_t* pos, StringPiece* field, bool* end_of_record,
+                          bool* output) {
+    const size_t n = data_.size();
+    const size_t start = *pos;
+    bool has_escaped_quotes = false;
+    Status result;
+    size_t i = start + 1;
+    while (true) {
+      const size_t quote = data_.find('"', i);
+      if (quote == StringPiece::npos) {
+        *pos = n;
+        *end_of_record = true;
+        *output = false;
+        return errors::InvalidArgument(
+            "Reached end of file without closing quoted field in record");
+      }
+      i = quote + 1;
+      if (i == n || data_[i] == options_.delim || IsLineBreak(data_[i])) {
+        break;
+      }
+      if (data_[i] != '"') {
+        // Take note of the error, but keep going to the end of the field.
+        *output = false;
+        result.Update(errors::InvalidArgument(
+            "Quote inside a string has to be escaped by another quote"));
+      }
+      has_escaped_quotes = true;
+      ++i;
+    }
+    *field = StringPiece(data_.data() + start + 1, i - start - 2);
+    FinishField(i, pos, end_of_record);
+    if (*output && has_escaped_quotes) {
+      unescaped_.clear();
+      unescaped_.reserve(field->size());
+      for (size_t j = 0; j < field->size(); ++j) {
+        unescaped_.push_back((*field)[j]);
+        // The quotes inside come in pairs, of which only the first is kept.
+        if ((*field)[j] == '"') ++j;
+      }
+      *field = unescaped_;
+    }
+    return result;
+  }
+
+  // Advances `*pos` past the delimiter or line break at `end` of a field.
+  void FinishField(size_t end, size_t* pos, bool* end_of_record) {
+    const size_t n = data_.size();
+    if (end == n) {
+      *pos = n;
+      *end_of_record = true;
+    } else if (data_[end] == options_.delim) {
+      *pos = end + 1;
+    } else {
+      *pos = end + 1;
+      *end_of_record = true;
+      if (data_[end] == '\r' && *pos < n && data_[*pos] == '\n') ++*pos;
+    }
+  }
+
+  Status FieldToOutput(StringPiece field, int64 index, int64 row) {
+    const int64 num_outputs = options_.output_types.size();
+    if (index >= num_outputs) {
+      // We can get here if we're selecting all columns, but the number of
+      // fields exceeds the number of defaults provided.
+      return errors::InvalidArgument("Expect ", num_outputs,
+                                     " fields but have more in record");
+    }
+    const Tensor& default_value = options_.record_defaults[index];
+    const bool missing = field.empty() || field == options_.na_value;
+    if (missing && default_value.NumElements() != 1) {
+      return errors::InvalidArgument("Field ", index,
+                                     " is required but missing in record!");
+    }
+    Tensor* column = &block_->columns[index];
+    switch (column->dtype()) {
+      case DT_INT32:
+        return SetValue<int32>(field, missing, default_value, index, row,
+                               column);
+      case DT_INT64:
+        return SetValue<int64>(field, missing, default_value, index, row,
+                               column);
+      case DT_FLOAT:
+        return SetValue<float>(field, missing, default_value, index, row,
+                               column);
+      case DT_DOUBLE:
+        return SetValue<double>(field, missing, default_value, index, row,
+                                column);
+      case DT_STRING:
+        return SetValue<string>(field, missing, default_value, index, row,
+                                column);
+      default:
+        return errors::InvalidArgument("csv: data type ", column->dtype(),
+                                       " not supported in field ", index);
+    }
+  }
+
+  const CsvParseOptions& options_;
+  const StringPiece data_;
+  CsvBlock* const block_;
+  // Holds a quoted field with escaped quotes removed.
+  string unescaped_;
+};
+
+}  // namespace
+
+Status ParseCsvBlock(const CsvParseOptions& options, StringPiece data,
+                     int64 num_records, bool skip_header, Allocator* allocator,
+                     CsvBlock* block) {
+  const int64 num_rows = num_records - (skip_header ? 1 : 0);
+  block->columns.clear();
+  block->record_ends.clear();
+  block->errors.clear();
+  if (num_rows < 0) return Status::OK();
+  for (const DataType dtype : options.output_types) {
+    block->columns.emplace_back(allocator, dtype, TensorShape({num_rows}));
+  }
+  block->record_ends.reserve(num_rows);
+
+  RecordParser parser(options, data, block);
+  size_t pos = 0;
+  if (skip_header) {
+    if (!parser.ParseRecord(&pos, -1).ok()) {
+      return errors::InvalidArgument("Can't read header of file");
+    }
+  }
+  for (int64 row = 0; row < num_rows; ++row) {
+    if (pos >= data.size()) {
+      return errors::Internal("Expected ", num_records,
+                              " CSV records in a block but found ",
+                              row + (skip_header ? 1 : 0));
+    }
+    Status s = parser.ParseRecord(&pos, row);
+    if (!s.ok()) block->errors.emplace_back(row, std::move(s));
+    block->record_ends.push_back(pos);
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
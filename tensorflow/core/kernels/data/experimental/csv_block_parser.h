@@ -0,0 +1,120 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_BLOCK_PARSER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_BLOCK_PARSER_H_
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// Finds the ends of the CSV records in a stream of bytes without parsing
+// their fields, so that the stream can be cut into blocks of whole records.
+//
+// Records end at a '\n', a '\r' or a "\r\n" outside of quoted fields, as in
+// ExperimentalCSVDataset. Only quotes and line breaks are examined, with SSE2
+// where available, and a chunk of 16 bytes without any is skipped at once.
+class CsvRecordScanner {
+ public:
+  CsvRecordScanner(char delim, bool use_quote_delim);
+
+  // Scans `data`, which must start at the start of a record and extend the
+  // data of the previous call since construction or `Reset()`.
+  void Scan(StringPiece data);
+
+  // Returns the offset after the last complete record of the data scanned so
+  // far, or 0 if there is none. A '\r' that ends the data does not end a
+  // record yet, since it may be the start of a "\r\n" line break.
+  size_t end() const { return trailing_cr_ ? prev_end_ : last_end_; }
+
+  // Returns the number of records before `end()`.
+  int64 num_records() const { return num_ends_ - (trailing_cr_ ? 1 : 0); }
+
+  // Returns the number of records in the data scanned so far if it is the end
+  // of the input, where the last record needs no line break.
+  int64 num_records_at_eof() const {
+    return num_ends_ + (last_end_ < scanned_size_ ? 1 : 0);
+  }
+
+  // Restarts the scanner for data that starts at the start of a record.
+  void Reset();
+
+ private:
+  // Handles the quote or line break at `data[i]`. Returns false if the state
+  // after it depends on data that has not been scanned yet.
+  bool Visit(StringPiece data, size_t i);
+
+  const char delim_;
+  const bool use_quote_delim_;
+
+  // Offset of the next byte to scan.
+  size_t pos_;
+  // Bytes before this offset belong to a quote that was already handled.
+  size_t skip_until_;
+  // Size of the data of the last call to `Scan()`.
+  size_t scanned_size_;
+  bool quoted_;
+  // Offsets after the last and the previous record ends.
+  size_t last_end_;
+  size_t prev_end_;
+  int64 num_ends_;
+  bool trailing_cr_;
+};
+
+// Options for parsing the fields of CSV records, as the inputs of
+// ExperimentalCSVDataset.
+struct CsvParseOptions {
+  char delim = ',';
+  bool use_quote_delim = true;
+  string na_value;
+  DataTypeVector output_types;
+  // One scalar or one empty tensor for each output, for optional and
+  // required fields respectively.
+  std::vector<Tensor> record_defaults;
+  // Strictly increasing indices of the fields to output, or empty to output
+  // every field.
+  std::vector<int64> select_cols;
+};
+
+// The records of a block, parsed into one vector tensor per output.
+struct CsvBlock {
+  std::vector<Tensor> columns;
+  // Offset in the block after each record.
+  std::vector<size_t> record_ends;
+  // The first error of each malformed record, by increasing record index.
+  // The values of malformed records in `columns` are unspecified.
+  std::vector<std::pair<int64, Status>> errors;
+};
+
+// Parses the first `num_records` CSV records of `data` into `*block`, with
+// the same conversions and errors as ExperimentalCSVDataset. If
+// `skip_header`, the first record is a header, which is checked but not
+// output. An error in any other record does not prevent parsing the following
+// records; it is added to `block->errors` instead of being returned.
+Status ParseCsvBlock(const CsvParseOptions& options, StringPiece data,
+                     int64 num_records, bool skip_header, Allocator* allocator,
+                     CsvBlock* block);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_BLOCK_PARSER_H_
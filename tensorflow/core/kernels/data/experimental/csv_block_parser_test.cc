@@ -0,0 +1,191 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/csv_block_parser.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+CsvParseOptions StringOptions(int num_columns) {
+  CsvParseOptions options;
+  for (int i = 0; i < num_columns; ++i) {
+    options.output_types.push_back(DT_STRING);
+    options.record_defaults.push_back(test::AsScalar<string>(""));
+  }
+  return options;
+}
+
+TEST(CsvRecordScannerTest, FindsLastRecordEnd) {
+  CsvRecordScanner scanner(',', true);
+  scanner.Scan("a,b\nc,\"d\ne\"\nf");
+  EXPECT_EQ(12, scanner.end());
+  EXPECT_EQ(2, scanner.num_records());
+  EXPECT_EQ(3, scanner.num_records_at_eof());
+
+  // A trailing '\r' may be followed by a '\n'.
+  scanner.Reset();
+  scanner.Scan("a\r\nb\r");
+  EXPECT_EQ(3, scanner.end());
+  EXPECT_EQ(1, scanner.num_records());
+  EXPECT_EQ(2, scanner.num_records_at_eof());
+  scanner.Scan("a\r\nb\r\nc");
+  EXPECT_EQ(6, scanner.end());
+  EXPECT_EQ(2, scanner.num_records());
+
+  // Without quote handling, quotes do not hide line breaks.
+  CsvRecordScanner unquoted(',', false);
+  unquoted.Scan("\"a\nb\"\n");
+  EXPECT_EQ(6, unquoted.end());
+  EXPECT_EQ(2, unquoted.num_records());
+}
+
+// Cutting the data at the record ends found by the scanner must agree with
+// parsing all of it at once, for any data.
+TEST(CsvRecordScannerTest, AgreesWithParser) {
+  random::PhiloxRandom philox(7, 11);
+  random::SimplePhilox rnd(&philox);
+  const char kAlphabet[] = "ab,\"\n\r";
+  const CsvParseOptions options = StringOptions(1);
+  for (int iteration = 0; iteration < 3000; ++iteration) {
+    string data(rnd.Uniform(50), ' ');
+    for (char& c : data) c = kAlphabet[rnd.Uniform(sizeof(kAlphabet) - 1)];
+    // Long runs without special characters exercise the vectorized scan.
+    if (rnd.OneIn(4)) data.insert(rnd.Uniform(data.size() + 1), 40, 'x');
+
+    CsvRecordScanner full(',', true);
+    full.Scan(data);
+    CsvBlock block;
+    TF_ASSERT_OK(ParseCsvBlock(options, data, full.num_records_at_eof(), false,
+                               cpu_allocator(), &block))
+        << data;
+    if (!data.empty()) {
+      ASSERT_EQ(data.size(), block.record_ends.back()) << data;
+    }
+
+    CsvRecordScanner incremental(',', true);
+    for (size_t size = 0; size <= data.size(); ++size) {
+      const StringPiece prefix(data.data(), size);
+      CsvRecordScanner scanner(',', true);
+      scanner.Scan(prefix);
+      incremental.Scan(prefix);
+      EXPECT_EQ(scanner.end(), incremental.end()) << data << " " << size;
+      EXPECT_EQ(scanner.num_records(), incremental.num_records());
+      if (scanner.num_records() == 0) {
+        EXPECT_EQ(0, scanner.end());
+        continue;
+      }
+      ASSERT_LE(scanner.num_records(), block.record_ends.size()) << data;
+      EXPECT_EQ(block.record_ends[scanner.num_records() - 1], scanner.end())
+          << data << " " << size;
+    }
+  }
+}
+
+TEST(ParseCsvBlockTest, ConvertsFields) {
+  CsvParseOptions options;
+  options.output_types = {DT_INT32, DT_INT64, DT_FLOAT, DT_DOUBLE, DT_STRING};
+  options.record_defaults = {
+      Tensor(DT_INT32, TensorShape({0})), test::AsScalar<int64>(-1),
+      test::AsScalar<float>(0.5), test::AsScalar<double>(2.5),
+      test::AsScalar<string>("default")};
+  options.na_value = "NA";
+  const string data =
+      "1,2,3.5,4.5,five\r\n"
+      "6,,NA,,\"se\"\"v,en\"\n"
+      "8,9,10,11,\"\"\r"
+      "12,13,14,15,sixteen";
+  CsvBlock block;
+  TF_ASSERT_OK(
+      ParseCsvBlock(options, data, 4, false, cpu_allocator(), &block));
+  EXPECT_TRUE(block.errors.empty());
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, 6, 8, 12}),
+                                 block.columns[0]);
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({2, -1, 9, 13}),
+                                 block.columns[1]);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({3.5, 0.5, 10, 14}),
+                                 block.columns[2]);
+  test::ExpectTensorEqual<double>(test::AsTensor<double>({4.5, 2.5, 11, 15}),
+                                  block.columns[3]);
+  test::ExpectTensorEqual<string>(
+      test::AsTensor<string>({"five", "se\"v,en", "default", "sixteen"}),
+      block.columns[4]);
+  EXPECT_EQ(std::vector<size_t>({18, 36, 49, data.size()}),
+            block.record_ends);
+}
+
+TEST(ParseCsvBlockTest, SelectsColumnsAndSkipsHeader) {
+  CsvParseOptions options = StringOptions(2);
+  options.select_cols = {1, 3};
+  const string data = "w,x,y,z\na,b,c,d\ne,f,g,h\n";
+  CsvBlock block;
+  TF_ASSERT_OK(ParseCsvBlock(options, data, 3, true, cpu_allocator(), &block));
+  EXPECT_TRUE(block.errors.empty());
+  test::ExpectTensorEqual<string>(test::AsTensor<string>({"b", "f"}),
+                                  block.columns[0]);
+  test::ExpectTensorEqual<string>(test::AsTensor<string>({"d", "h"}),
+                                  block.columns[1]);
+}
+
+TEST(ParseCsvBlockTest, ReportsMalformedRecords) {
+  CsvParseOptions options;
+  options.output_types = {DT_INT32, DT_STRING};
+  options.record_defaults = {Tensor(DT_INT32, TensorShape({0})),
+                             test::AsScalar<string>("")};
+  const string data =
+      "1,a\n"
+      "x,b\n"
+      ",c\n"
+      "2\n"
+      "3,d,e\n"
+      "4,\"f\"g\"\n"
+      "5,h\"i\n"
+      "6,j\n"
+      "7,\"k";
+  CsvBlock block;
+  TF_ASSERT_OK(ParseCsvBlock(options, data, 9, false, cpu_allocator(), &block));
+  std::vector<std::pair<int64, string>> errors;
+  for (const auto& error : block.errors) {
+    EXPECT_TRUE(errors::IsInvalidArgument(error.second));
+    errors.emplace_back(error.first, error.second.error_message());
+  }
+  EXPECT_EQ(
+      (std::vector<std::pair<int64, string>>{
+          {1, "Field 0 in record is not a valid int32: x"},
+          {2, "Field 0 is required but missing in record!"},
+          {3, "Expect 2 fields but have 1 in record"},
+          {4, "Expect 2 fields but have more in record"},
+          {5, "Quote inside a string has to be escaped by another quote"},
+          {6, "Unquoted fields cannot have quotes inside"},
+          {8, "Reached end of file without closing quoted field in record"}}),
+      errors);
+  EXPECT_EQ(1, block.columns[0].vec<int32>()(0));
+  EXPECT_EQ("j", block.columns[1].vec<string>()(7));
+}
+
+TEST(ParseCsvBlockTest, MalformedHeader) {
+  CsvBlock block;
+  EXPECT_TRUE(errors::IsInvalidArgument(ParseCsvBlock(
+      StringOptions(1), "\"a", 1, true, cpu_allocator(), &block)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
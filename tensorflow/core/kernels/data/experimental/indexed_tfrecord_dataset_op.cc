@@ -0,0 +1,281 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads the records [start, stop) of a sequence of indexed TFRecord files,
+// numbered across all the files. Since every record can be read directly
+// from its offset, many readers can read disjoint ranges of the same files,
+// and the records of the range can be produced in a random order without
+// scanning the files first.
+class IndexedTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  using DatasetOpKernel::DatasetOpKernel;
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    std::vector<std::unique_ptr<io::RecordIndex>> indices(filenames.size());
+    int64 num_records = 0;
+    for (size_t i = 0; i < filenames.size(); ++i) {
+      OP_REQUIRES_OK(ctx, io::RecordIndex::Read(
+                              ctx->env(),
+                              io::RecordIndex::IndexFileName(filenames[i]),
+                              &indices[i]));
+      num_records += indices[i]->num_records();
+    }
+
+    int64 start;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "start", &start));
+    int64 stop;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "stop", &stop));
+    if (stop == -1) {
+      stop = num_records;
+    }
+    OP_REQUIRES(ctx, 0 <= start && start <= stop && stop <= num_records,
+                errors::InvalidArgument(
+                    "The range of records [", start, ", ", stop,
+                    ") is not a valid range of the ", num_records,
+                    " records of the files."));
+
+    bool shuffle;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, "shuffle", &shuffle));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+    // By TensorFlow convention, passing 0 for both seeds indicates
+    // that the shuffling should be seeded non-deterministically.
+    if (shuffle && seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, std::move(filenames), std::move(indices), start,
+                          stop, shuffle, seed, seed2);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<std::unique_ptr<io::RecordIndex>> indices, int64 start,
+            int64 stop, bool shuffle, int64 seed, int64 seed2)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          indices_(std::move(indices)),
+          start_(start),
+          stop_(stop),
+          shuffle_(shuffle),
+          seed_(seed),
+          seed2_(seed2) {
+      first_records_.reserve(indices_.size() + 1);
+      first_records_.push_back(0);
+      for (const auto& index : indices_) {
+        first_records_.push_back(first_records_.back() + index->num_records());
+      }
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::IndexedTFRecord")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() const override {
+      return strings::StrCat("IndexedTFRecordDatasetOp(", start_, ", ", stop_,
+                             ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* start = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(start_, &start));
+      Node* stop = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(stop_, &stop));
+      Node* shuffle = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(shuffle_, &shuffle));
+      Node* seed = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, start, stop, shuffle, seed, seed2}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            files_(params.dataset->filenames_.size()),
+            readers_(params.dataset->filenames_.size()) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        const int64 num_records = dataset()->stop_ - dataset()->start_;
+        if (position_ >= num_records) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (dataset()->shuffle_ && permutation_.empty()) {
+          ComputePermutationLocked();
+        }
+        const int64 record = dataset()->shuffle_
+                                 ? permutation_[position_]
+                                 : dataset()->start_ + position_;
+        Tensor result_tensor(ctx->allocator({}), DT_STRING, {});
+        TF_RETURN_IF_ERROR(ReadRecordLocked(
+            ctx->env(), record, &result_tensor.scalar<string>()()));
+        ++position_;
+        out_tensors->emplace_back(std::move(result_tensor));
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        // The permutation only depends on the seeds of the dataset, so it is
+        // recomputed rather than saved.
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("position"), position_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("position"), &position_));
+        return Status::OK();
+      }
+
+     private:
+      // Computes a uniformly random permutation of the records of the range.
+      void ComputePermutationLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_records = dataset()->stop_ - dataset()->start_;
+        permutation_.resize(num_records);
+        for (int64 i = 0; i < num_records; ++i) {
+          permutation_[i] = dataset()->start_ + i;
+        }
+        random::PhiloxRandom parent_generator(dataset()->seed_,
+                                              dataset()->seed2_);
+        random::SimplePhilox generator(&parent_generator);
+        for (int64 i = num_records - 1; i > 0; --i) {
+          std::swap(permutation_[i], permutation_[generator.Uniform64(i + 1)]);
+        }
+      }
+
+      // Reads the record with the global number `record`, opening the file
+      // containing it if needed.
+      Status ReadRecordLocked(Env* env, int64 record, string* result)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const std::vector<int64>& first_records = dataset()->first_records_;
+        const size_t file_index =
+            std::upper_bound(first_records.begin(), first_records.end(),
+                             record) -
+            first_records.begin() - 1;
+        if (readers_[file_index] == nullptr) {
+          // Records are read in order unless shuffling, so the previous file
+          // will not be needed again.
+          if (!dataset()->shuffle_ && current_file_index_ >= 0) {
+            readers_[current_file_index_].reset();
+            files_[current_file_index_].reset();
+          }
+          TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+              dataset()->filenames_[file_index], &files_[file_index]));
+          readers_[file_index].reset(new io::IndexedRecordReader(
+              files_[file_index].get(), dataset()->indices_[file_index].get()));
+          current_file_index_ = file_index;
+        }
+        return readers_[file_index]->ReadRecord(
+            record - first_records[file_index], result);
+      }
+
+      mutex mu_;
+      // Number of records of the range produced so far.
+      int64 position_ GUARDED_BY(mu_) = 0;
+      std::vector<int64> permutation_ GUARDED_BY(mu_);
+      int64 current_file_index_ GUARDED_BY(mu_) = -1;
+
+      // `readers_[i]` borrows the object that `files_[i]` points to, so it
+      // must be destroyed first.
+      std::vector<std::unique_ptr<RandomAccessFile>> files_ GUARDED_BY(mu_);
+      std::vector<std::unique_ptr<io::IndexedRecordReader>> readers_
+          GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const std::vector<std::unique_ptr<io::RecordIndex>> indices_;
+    // `first_records_[i]` is the number of the first record of file `i`.
+    std::vector<int64> first_records_;
+    const int64 start_;
+    const int64 stop_;
+    const bool shuffle_;
+    const int64 seed_;
+    const int64 seed2_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ExperimentalIndexedTFRecordDataset").Device(DEVICE_CPU),
+    IndexedTFRecordDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
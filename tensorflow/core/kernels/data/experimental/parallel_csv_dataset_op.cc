@@ -0,0 +1,609 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/csv_block_parser.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/cpu_info.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads batches of CSV records, with the same inputs and record format as
+// CSVDatasetOp. Each element has one vector of `batch_size` values per output
+// column; the last batch may be smaller.
+//
+// A reader thread reads each file in blocks of `buffer_size` bytes and cuts
+// them after their last complete record, which only needs a scan for quotes
+// and line breaks. Up to `num_parallel_calls` blocks are then parsed
+// concurrently into column tensors, and batches are copied from the parsed
+// blocks in order.
+//
+// As for a CSVDataset followed by `batch()`, a malformed record fails the
+// batch that contains it, and the following batch starts after it.
+class ParallelCSVDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ParallelCSVDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    string compression_type;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "compression_type",
+                                                    &compression_type));
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(ctx, buffer_size > 0,
+                errors::InvalidArgument("buffer_size should be positive"));
+    io::ZlibCompressionOptions zlib_compression_options =
+        io::ZlibCompressionOptions::DEFAULT();
+    if (compression_type == "GZIP") {
+      zlib_compression_options = io::ZlibCompressionOptions::GZIP();
+    } else {
+      OP_REQUIRES(ctx, compression_type.empty() || compression_type == "ZLIB",
+                  errors::InvalidArgument(
+                      "Unsupported compression_type: ", compression_type, "."));
+    }
+    zlib_compression_options.input_buffer_size = buffer_size;
+
+    bool header;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, "header", &header));
+
+    CsvParseOptions parse_options;
+    string delim;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<string>(ctx, "field_delim", &delim));
+    OP_REQUIRES(ctx, delim.size() == 1,
+                errors::InvalidArgument("field_delim should be only 1 char"));
+    parse_options.delim = delim[0];
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(
+                            ctx, "use_quote_delim",
+                            &parse_options.use_quote_delim));
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "na_value",
+                                                    &parse_options.na_value));
+    parse_options.output_types = output_types_;
+
+    OpInputList record_defaults_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("record_defaults", &record_defaults_list));
+    for (int i = 0; i < record_defaults_list.size(); ++i) {
+      OP_REQUIRES(ctx, record_defaults_list[i].dims() <= 1,
+                  errors::InvalidArgument(
+                      "Each record default should be at most rank 1"));
+      OP_REQUIRES(ctx, record_defaults_list[i].NumElements() < 2,
+                  errors::InvalidArgument(
+                      "There should only be 1 default per field but field ", i,
+                      " has ", record_defaults_list[i].NumElements()));
+      parse_options.record_defaults.push_back(record_defaults_list[i]);
+    }
+
+    const Tensor* select_cols_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("select_cols", &select_cols_tensor));
+    OP_REQUIRES(ctx, select_cols_tensor->dims() == 1,
+                errors::InvalidArgument("`select_cols` must be a vector."));
+    std::vector<int64>& select_cols = parse_options.select_cols;
+    for (int i = 0; i < select_cols_tensor->NumElements(); ++i) {
+      select_cols.push_back(select_cols_tensor->flat<int64>()(i));
+    }
+    OP_REQUIRES(
+        ctx, output_types_.size() == select_cols.size() || select_cols.empty(),
+        errors::InvalidArgument("select_cols should match output size"));
+    for (int i = 1; i < select_cols.size(); i++) {
+      OP_REQUIRES(ctx, select_cols[i - 1] < select_cols[i],
+                  errors::InvalidArgument(
+                      "select_cols should be strictly increasing indices"));
+    }
+    OP_REQUIRES(
+        ctx, select_cols.empty() || select_cols.front() >= 0,
+        errors::InvalidArgument("select_cols should be non-negative indices"));
+
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument("batch_size must be greater than zero."));
+    int64 num_parallel_calls;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "num_parallel_calls",
+                                                   &num_parallel_calls));
+    OP_REQUIRES(ctx, num_parallel_calls > 0 || num_parallel_calls == kAutoTune,
+                errors::InvalidArgument(
+                    "num_parallel_calls must be greater than zero."));
+
+    *output = new Dataset(
+        ctx, std::move(filenames), header, std::move(compression_type),
+        zlib_compression_options, std::move(parse_options), batch_size,
+        num_parallel_calls, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames, bool header,
+            string compression_type, io::ZlibCompressionOptions options,
+            CsvParseOptions parse_options, int64 batch_size,
+            int64 num_parallel_calls, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          header_(header),
+          use_compression_(!compression_type.empty()),
+          compression_type_(std::move(compression_type)),
+          options_(options),
+          parse_options_(std::move(parse_options)),
+          batch_size_(batch_size),
+          num_parallel_calls_(num_parallel_calls),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::ParallelCSV")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ParallelCSVDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      Node* compression_type = nullptr;
+      Node* buffer_size = nullptr;
+      Node* header = nullptr;
+      Node* delim = nullptr;
+      Node* use_quote_delim = nullptr;
+      Node* na_value = nullptr;
+      Node* select_cols = nullptr;
+      Node* batch_size = nullptr;
+      Node* num_parallel_calls = nullptr;
+
+      std::vector<Node*> record_defaults;
+      record_defaults.reserve(parse_options_.record_defaults.size());
+      for (const Tensor& t : parse_options_.record_defaults) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        record_defaults.emplace_back(node);
+      }
+
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(options_.input_buffer_size, &buffer_size));
+      TF_RETURN_IF_ERROR(b->AddScalar(header_, &header));
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(string(1, parse_options_.delim), &delim));
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(parse_options_.use_quote_delim, &use_quote_delim));
+      TF_RETURN_IF_ERROR(b->AddScalar(parse_options_.na_value, &na_value));
+      TF_RETURN_IF_ERROR(
+          b->AddVector(parse_options_.select_cols, &select_cols));
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(num_parallel_calls_, &num_parallel_calls));
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {std::make_pair(0, filenames), std::make_pair(1, compression_type),
+           std::make_pair(2, buffer_size), std::make_pair(3, header),
+           std::make_pair(4, delim), std::make_pair(5, use_quote_delim),
+           std::make_pair(6, na_value), std::make_pair(7, select_cols),
+           std::make_pair(8, batch_size),
+           std::make_pair(9, num_parallel_calls)},  // Single tensor inputs
+          {std::make_pair(10, record_defaults)},    // Tensor list inputs
+          {}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            max_parallel_calls_(dataset()->num_parallel_calls_ == kAutoTune
+                                    ? port::NumSchedulableCPUs()
+                                    : dataset()->num_parallel_calls_) {}
+
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        StopReaderLocked(&l);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureReaderThreadStarted(ctx);
+        struct Rows {
+          std::shared_ptr<Block> block;
+          int64 begin;
+          int64 end;
+        };
+        std::vector<Rows> batch;
+        int64 num_rows = 0;
+        while (num_rows < dataset()->batch_size_) {
+          while (blocks_.empty() ? !end_of_input_ : !blocks_.front()->done) {
+            cond_var_.wait(l);
+          }
+          if (blocks_.empty()) break;
+          std::shared_ptr<Block> block = blocks_.front();
+          if (!block->status.ok()) {
+            PopBlockLocked();
+            return block->status;
+          }
+          const CsvBlock& parsed = block->parsed;
+          const int64 begin = next_record_;
+          const int64 end =
+              std::min<int64>(parsed.record_ends.size(),
+                              begin + dataset()->batch_size_ - num_rows);
+          // A malformed record fails the batch.
+          auto error = std::lower_bound(
+              parsed.errors.begin(), parsed.errors.end(), begin,
+              [](const std::pair<int64, Status>& error, int64 record) {
+                return error.first < record;
+              });
+          if (error != parsed.errors.end() && error->first < end) {
+            next_record_ = error->first + 1;
+            if (next_record_ == parsed.record_ends.size()) PopBlockLocked();
+            return error->second;
+          }
+          batch.push_back({block, begin, end});
+          num_rows += end - begin;
+          next_record_ = end;
+          if (next_record_ == parsed.record_ends.size()) PopBlockLocked();
+        }
+        if (num_rows == 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        out_tensors->reserve(dataset()->output_types_.size());
+        for (int i = 0; i < dataset()->output_types_.size(); ++i) {
+          out_tensors->emplace_back(ctx->allocator({}),
+                                    dataset()->output_types_[i],
+                                    TensorShape({num_rows}));
+          int64 offset = 0;
+          for (const Rows& rows : batch) {
+            TF_RETURN_IF_ERROR(MoveRows(&rows.block->parsed.columns[i],
+                                        rows.begin, rows.end,
+                                        &out_tensors->back(), offset));
+            offset += rows.end - rows.begin;
+          }
+        }
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        // Save the position of the next record to produce. The blocks after
+        // it are read and parsed again after restoring.
+        int64 file_index = read_file_index_;
+        int64 offset = read_offset_;
+        if (!blocks_.empty()) {
+          const Block& block = *blocks_.front();
+          file_index = block.file_index;
+          offset = block.offset;
+          if (next_record_ > 0) {
+            offset += block.parsed.record_ends[next_record_ - 1];
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("file_index"), file_index));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("offset"), offset));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        StopReaderLocked(&l);
+        blocks_.clear();
+        next_record_ = 0;
+        end_of_input_ = false;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("file_index"), &read_file_index_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("offset"), &read_offset_));
+        return Status::OK();
+      }
+
+     private:
+      // A block of whole records of a file.
+      struct Block {
+        int64 file_index;
+        // Offset of the block in the (uncompressed) file.
+        int64 offset;
+        bool skip_header = false;
+        int64 num_records = 0;
+        // The records, until they are parsed.
+        string data;
+        // Set once the block is parsed, along with `status` and `parsed`.
+        bool done = false;
+        Status status;
+        CsvBlock parsed;
+      };
+
+      template <typename T>
+      static void MoveRowsOfType(Tensor* from, int64 begin, int64 end,
+                                 Tensor* to, int64 offset) {
+        T* from_data = from->flat<T>().data();
+        std::move(from_data + begin, from_data + end,
+                  to->flat<T>().data() + offset);
+      }
+
+      // Moves the values of rows [begin, end) of `from` to `to`, from row
+      // `offset` on.
+      static Status MoveRows(Tensor* from, int64 begin, int64 end, Tensor* to,
+                             int64 offset) {
+        switch (from->dtype()) {
+#define HANDLE_TYPE(T)                                    \
+  case DataTypeToEnum<T>::value:                          \
+    MoveRowsOfType<T>(from, begin, end, to, offset);      \
+    return Status::OK();
+          TF_CALL_int32(HANDLE_TYPE);
+          TF_CALL_int64(HANDLE_TYPE);
+          TF_CALL_float(HANDLE_TYPE);
+          TF_CALL_double(HANDLE_TYPE);
+          TF_CALL_string(HANDLE_TYPE);
+#undef HANDLE_TYPE
+          default:
+            return errors::InvalidArgument("csv: data type ", from->dtype(),
+                                           " not supported");
+        }
+      }
+
+      void EnsureReaderThreadStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!reader_thread_) {
+          reader_running_ = true;
+          std::shared_ptr<IteratorContext> ctx_copy(new IteratorContext(*ctx));
+          reader_thread_.reset(ctx->env()->StartThread(
+              {}, "parallel_csv_reader",
+              std::bind(&Iterator::ReaderThread, this, ctx_copy)));
+        }
+      }
+
+      // Stops the reader thread and waits for the blocks being parsed.
+      void StopReaderLocked(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        cancelled_ = true;
+        cond_var_.notify_all();
+        while (reader_running_ || num_calls_ > 0) {
+          cond_var_.wait(*l);
+        }
+        reader_thread_.reset();
+        cancelled_ = false;
+      }
+
+      void PopBlockLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        blocks_.pop_front();
+        next_record_ = 0;
+        cond_var_.notify_all();
+      }
+
+      void ReaderThread(const std::shared_ptr<IteratorContext>& ctx) {
+        auto cleanup = gtl::MakeCleanup([this] {
+          mutex_lock l(mu_);
+          reader_running_ = false;
+          cond_var_.notify_all();
+        });
+        while (true) {
+          int64 file_index;
+          int64 offset;
+          {
+            mutex_lock l(mu_);
+            if (cancelled_) return;
+            if (read_file_index_ >= dataset()->filenames_.size()) {
+              end_of_input_ = true;
+              cond_var_.notify_all();
+              return;
+            }
+            file_index = read_file_index_;
+            offset = read_offset_;
+          }
+          Status s = ReadFile(ctx, file_index, offset);
+          mutex_lock l(mu_);
+          if (cancelled_) return;
+          if (!s.ok()) {
+            // Report the error in place of the rest of the file.
+            std::shared_ptr<Block> block = std::make_shared<Block>();
+            block->file_index = file_index;
+            block->offset = read_offset_;
+            block->done = true;
+            block->status = s;
+            blocks_.push_back(std::move(block));
+            cond_var_.notify_all();
+          }
+          ++read_file_index_;
+          read_offset_ = 0;
+        }
+      }
+
+      // Reads the file at `file_index` from `offset` into blocks and
+      // schedules their parsing.
+      Status ReadFile(const std::shared_ptr<IteratorContext>& ctx,
+                      int64 file_index, int64 offset) {
+        std::unique_ptr<RandomAccessFile> file;
+        TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+            dataset()->filenames_[file_index], &file));
+        io::RandomAccessInputStream file_stream(file.get());
+        io::InputStreamInterface* input = &file_stream;
+        std::unique_ptr<io::ZlibInputStream> zlib_stream;
+        const int64 buffer_size = dataset()->options_.input_buffer_size;
+        if (dataset()->use_compression_) {
+          zlib_stream.reset(new io::ZlibInputStream(
+              &file_stream, buffer_size, buffer_size, dataset()->options_));
+          input = zlib_stream.get();
+        }
+        if (offset > 0) {
+          Status s = input->SkipNBytes(offset);
+          if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+        }
+
+        const CsvParseOptions& parse_options = dataset()->parse_options_;
+        CsvRecordScanner scanner(parse_options.delim,
+                                 parse_options.use_quote_delim);
+        bool skip_header = dataset()->header_ && offset == 0;
+        string data;
+        string chunk;
+        bool end_of_file = false;
+        while (!end_of_file) {
+          Status s = input->ReadNBytes(buffer_size, &chunk);
+          end_of_file = errors::IsOutOfRange(s);
+          if (!s.ok() && !end_of_file) return s;
+          if (data.empty()) {
+            data.swap(chunk);
+          } else {
+            data.append(chunk);
+          }
+          scanner.Scan(data);
+          size_t end = scanner.end();
+          int64 num_records = scanner.num_records();
+          if (end_of_file) {
+            end = data.size();
+            num_records = scanner.num_records_at_eof();
+            if (skip_header && num_records == 0) {
+              return errors::InvalidArgument("Can't read header of file");
+            }
+          }
+          if (num_records == 0) continue;
+
+          std::shared_ptr<Block> block = std::make_shared<Block>();
+          block->file_index = file_index;
+          block->offset = offset;
+          block->skip_header = skip_header;
+          block->num_records = num_records;
+          if (end == data.size()) {
+            block->data.swap(data);
+          } else {
+            block->data = data.substr(0, end);
+            data.erase(0, end);
+          }
+          offset += end;
+          skip_header = false;
+          scanner.Reset();
+          if (!ScheduleBlock(ctx, std::move(block), offset)) {
+            return errors::Cancelled("Iterator was destroyed");
+          }
+        }
+        return Status::OK();
+      }
+
+      // Waits for room in `blocks_`, adds `block` to it and parses it
+      // asynchronously. Returns false if the reader is cancelled instead.
+      bool ScheduleBlock(const std::shared_ptr<IteratorContext>& ctx,
+                         std::shared_ptr<Block> block, int64 next_offset) {
+        {
+          mutex_lock l(mu_);
+          // One block is being consumed while the others are parsed.
+          while (!cancelled_ && blocks_.size() > max_parallel_calls_) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_) return false;
+          blocks_.push_back(block);
+          read_offset_ = next_offset;
+          ++num_calls_;
+        }
+        (*ctx->runner())([this, ctx, block]() {
+          Status s =
+              ParseCsvBlock(dataset()->parse_options_, block->data,
+                            block->num_records, block->skip_header,
+                            ctx->allocator({}), &block->parsed);
+          string().swap(block->data);
+          mutex_lock l(mu_);
+          block->status = s;
+          block->done = true;
+          --num_calls_;
+          cond_var_.notify_all();
+        });
+        return true;
+      }
+
+      const int64 max_parallel_calls_;
+      mutex mu_;
+      condition_variable cond_var_;
+      // The blocks being parsed or consumed, in order.
+      std::deque<std::shared_ptr<Block>> blocks_ GUARDED_BY(mu_);
+      // Index of the next record to produce in `blocks_.front()`.
+      int64 next_record_ GUARDED_BY(mu_) = 0;
+      // Position of the reader after the last block in `blocks_`.
+      int64 read_file_index_ GUARDED_BY(mu_) = 0;
+      int64 read_offset_ GUARDED_BY(mu_) = 0;
+      bool end_of_input_ GUARDED_BY(mu_) = false;
+      int64 num_calls_ GUARDED_BY(mu_) = 0;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      bool reader_running_ GUARDED_BY(mu_) = false;
+      std::unique_ptr<Thread> reader_thread_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const bool header_;
+    const bool use_compression_;
+    const string compression_type_;
+    const io::ZlibCompressionOptions options_;
+    const CsvParseOptions parse_options_;
+    const int64 batch_size_;
+    const int64 num_parallel_calls_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ExperimentalParallelCSVDataset").Device(DEVICE_CPU),
+    ParallelCSVDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
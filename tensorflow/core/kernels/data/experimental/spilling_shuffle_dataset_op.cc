@@ -0,0 +1,636 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/compression_utils.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
+const int64 kReadBufferSize = 256 * 1024;       // 256 KB.
+
+// See documentation in ../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+//
+// The input is shuffled in windows of `buffer_size` consecutive elements.
+// While a window is read, its elements are kept in memory until their size
+// exceeds `memory_limit`; they are then written in a random order to a "run"
+// file in `spill_directory`. The elements of the window are then produced by
+// repeatedly choosing an element uniformly at random among the remaining
+// ones: either one of the elements still in memory, or the next element of
+// one of the runs, with a probability proportional to the number of elements
+// left in the run. Each window is therefore produced in a uniformly random
+// order, and the runs are only ever read sequentially.
+class SpillingShuffleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit SpillingShuffleDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(
+        ctx, buffer_size > 0,
+        errors::InvalidArgument("buffer_size must be greater than zero."));
+
+    int64 memory_limit;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "memory_limit", &memory_limit));
+    OP_REQUIRES(
+        ctx, memory_limit > 0,
+        errors::InvalidArgument("memory_limit must be greater than zero."));
+
+    string spill_directory;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "spill_directory",
+                                                    &spill_directory));
+    OP_REQUIRES(ctx, !spill_directory.empty(),
+                errors::InvalidArgument("spill_directory must not be empty."));
+    OP_REQUIRES_OK(ctx, ctx->env()->RecursivelyCreateDir(spill_directory));
+
+    string compression_type;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "compression_type",
+                                                    &compression_type));
+    OP_REQUIRES(ctx,
+                compression_type == io::compression::kNone ||
+                    compression_type == io::compression::kZlib ||
+                    compression_type == io::compression::kGzip ||
+                    compression_type == io::compression::kSnappy,
+                errors::InvalidArgument("Unsupported compression_type: ",
+                                        compression_type));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+    // By TensorFlow convention, passing 0 for both seeds indicates
+    // that the shuffling should be seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, input, buffer_size, memory_limit,
+                          std::move(spill_directory),
+                          std::move(compression_type), seed, seed2);
+  }
+
+ private:
+  // Like the reshuffling ShuffleDataset, every iterator of this dataset uses
+  // different seeds, drawn from a generator seeded with `seed` and `seed2`.
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+            int64 memory_limit, string spill_directory,
+            string compression_type, int64 seed, int64 seed2)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          buffer_size_(buffer_size),
+          memory_limit_(memory_limit),
+          spill_directory_(std::move(spill_directory)),
+          compression_type_(std::move(compression_type)),
+          seed_(seed),
+          seed2_(seed2),
+          parent_generator_(seed, seed2),
+          generator_(&parent_generator_) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      int64 iterator_seed;
+      int64 iterator_seed2;
+      {
+        mutex_lock l(mu_);
+        iterator_seed = Random();
+        iterator_seed2 = Random();
+      }
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::SpillingShuffle")},
+                       iterator_seed, iterator_seed2));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return strings::StrCat("SpillingShuffleDatasetOp(", buffer_size_, ", ",
+                             memory_limit_, ", ", seed_, ", ", seed2_,
+                             ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      Node* memory_limit = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(memory_limit_, &memory_limit));
+      Node* spill_directory = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(spill_directory_, &spill_directory));
+      Node* compression_type = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
+      Node* seed = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {input_graph_node, buffer_size, memory_limit, spill_directory,
+           compression_type, seed, seed2},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params, int64 seed, int64 seed2)
+          : DatasetIterator<Dataset>(params),
+            seed_(seed),
+            seed2_(seed2),
+            parent_generator_(seed, seed2),
+            generator_(&parent_generator_),
+            spill_prefix_(strings::Printf(
+                "shuffle_spill_%016llx",
+                static_cast<unsigned long long>(random::New64()))) {
+        std::vector<string> components =
+            str_util::Split(params.prefix, "::", str_util::SkipEmpty());
+        prefix_end_ = components.back();
+      }
+
+      ~Iterator() override {
+        // The files that the latest checkpoint refers to are kept, so that
+        // it can still be restored.
+        for (const auto& run : runs_) {
+          DeleteRun(run.get());
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        env_ = ctx->env();
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        while (num_elements_ == 0) {
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(FillWindowLocked(ctx));
+        }
+        const int64 index = Random() % num_elements_;
+        if (index < buffer_.size()) {
+          *out_tensors = std::move(buffer_[index]);
+          std::swap(buffer_[index], buffer_.back());
+          buffer_.pop_back();
+        } else {
+          TF_RETURN_IF_ERROR(ReadFromRunLocked(index - buffer_.size(),
+                                               out_tensors));
+        }
+        --num_elements_;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        {
+          mutex_lock l(dataset()->mu_);
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("ds_num_random_samples"),
+                                  dataset()->num_random_samples_));
+        }
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("num_random_samples"),
+                                               num_random_samples_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed"), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed2"), seed2_));
+        if (!input_impl_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("end_of_input_sequence"), ""));
+        } else {
+          TF_RETURN_IF_ERROR(SaveInput(writer, input_impl_));
+        }
+
+        // Windows are read within a single call to GetNext(), so only the
+        // remaining elements of the current window need to be saved: those
+        // still in memory, and the name and offset of each run. The run
+        // files are kept for as long as the latest checkpoint refers to
+        // them, and deleted by the next save that no longer does, so the
+        // checkpoint holds at most `memory_limit` bytes of elements.
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("buffer_size"), buffer_.size()));
+        for (size_t i = 0; i < buffer_.size(); ++i) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat("buffer_", i, "_size")),
+              buffer_[i].size()));
+          for (size_t j = 0; j < buffer_[i].size(); ++j) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                full_name(strings::StrCat("buffer_", i, "_", j)),
+                buffer_[i][j]));
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("runs_size"), runs_.size()));
+        std::vector<string> checkpointed_files;
+        for (size_t i = 0; i < runs_.size(); ++i) {
+          Run* run = runs_[i].get();
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat("run_", i, "_filename")),
+              run->filename));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat("run_", i, "_offset")),
+              static_cast<int64>(run->offset)));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat("run_", i, "_num_elements")),
+              run->num_elements));
+          run->checkpointed = true;
+          checkpointed_files.push_back(run->filename);
+        }
+        // The files that only earlier checkpoints refer to are deleted.
+        for (const string& filename : checkpointed_files_) {
+          if (std::find(checkpointed_files.begin(), checkpointed_files.end(),
+                        filename) == checkpointed_files.end()) {
+            DeleteSpillFile(filename);
+          }
+        }
+        checkpointed_files_ = std::move(checkpointed_files);
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        {
+          mutex_lock l(dataset()->mu_);
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("ds_num_random_samples"),
+                                 &dataset()->num_random_samples_));
+          dataset()->ResetRngs();
+        }
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("num_random_samples"),
+                                              &num_random_samples_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed"), &seed_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed2"), &seed2_));
+        ResetRngs();
+
+        if (!reader->Contains(full_name("end_of_input_sequence"))) {
+          TF_RETURN_IF_ERROR(
+              dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+          TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+        } else {
+          input_impl_.reset();
+        }
+
+        int64 buffer_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("buffer_size"), &buffer_size));
+        buffer_.clear();
+        buffer_.resize(buffer_size);
+        for (int64 i = 0; i < buffer_size; ++i) {
+          int64 element_size;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat("buffer_", i, "_size")),
+              &element_size));
+          buffer_[i].resize(element_size);
+          for (int64 j = 0; j < element_size; ++j) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                full_name(strings::StrCat("buffer_", i, "_", j)),
+                &buffer_[i][j]));
+          }
+        }
+        num_elements_ = buffer_size;
+
+        for (const auto& run : runs_) {
+          DeleteRun(run.get());
+        }
+        runs_.clear();
+        env_ = ctx->env();
+        // The runs read the files that the checkpoint refers to, which are
+        // kept until this iterator saves a checkpoint that no longer does.
+        checkpointed_files_.clear();
+        int64 runs_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("runs_size"), &runs_size));
+        for (int64 i = 0; i < runs_size; ++i) {
+          std::unique_ptr<Run> run(new Run);
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat("run_", i, "_filename")),
+              &run->filename));
+          int64 offset;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat("run_", i, "_offset")), &offset));
+          run->offset = offset;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat("run_", i, "_num_elements")),
+              &run->num_elements));
+          run->checkpointed = true;
+          if (!env_->FileExists(run->filename).ok()) {
+            return errors::NotFound(
+                "Shuffle spill file ", run->filename,
+                " does not exist. Only the latest checkpoint of an iterator "
+                "can be restored once the iterator has saved another one.");
+          }
+          checkpointed_files_.push_back(run->filename);
+          num_elements_ += run->num_elements;
+          runs_.push_back(std::move(run));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // A run of elements of the current window, written to a file in a
+      // random order.
+      struct Run {
+        string filename;
+        // Offset in the file and number of the elements not produced yet.
+        uint64 offset = 0;
+        int64 num_elements = 0;
+        // Whether a checkpoint refers to the file, which must then outlive
+        // the run.
+        bool checkpointed = false;
+        // `reader` borrows the object that `file` points to, so it must be
+        // destroyed first.
+        std::unique_ptr<RandomAccessFile> file;
+        std::unique_ptr<io::SequentialRecordReader> reader;
+      };
+
+      // Reads the next window of the input, spilling it to runs as needed.
+      Status FillWindowLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 start_micros = ctx->env()->NowMicros();
+        int64 num_log_entries = 0;
+        int64 buffer_bytes = 0;
+        int64 window_size = 0;
+        while (input_impl_ && window_size < dataset()->buffer_size_) {
+          if (ctx->env()->NowMicros() >
+              ((num_log_entries + 1) * kLogIntervalMicros) + start_micros) {
+            num_log_entries++;
+            LOG(INFO) << "Filling up shuffle buffer (this may take a while): "
+                      << window_size << " of " << dataset()->buffer_size_
+                      << ", " << runs_.size() << " runs spilled to disk";
+          }
+          std::vector<Tensor> input_element;
+          bool end_of_input_sequence = false;
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &input_element,
+                                                  &end_of_input_sequence));
+          if (end_of_input_sequence) {
+            input_impl_.reset();
+            break;
+          }
+          for (const Tensor& t : input_element) {
+            buffer_bytes += t.TotalBytes();
+          }
+          buffer_.push_back(std::move(input_element));
+          ++window_size;
+          if (buffer_bytes > dataset()->memory_limit_) {
+            TF_RETURN_IF_ERROR(SpillLocked(ctx));
+            buffer_bytes = 0;
+          }
+        }
+        if (num_log_entries > 0) {
+          LOG(INFO) << "Shuffle buffer filled.";
+        }
+        num_elements_ = window_size;
+        return Status::OK();
+      }
+
+      // Writes the elements in memory to a new run, in a random order.
+      Status SpillLocked(IteratorContext* ctx) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 start_micros = ctx->env()->NowMicros();
+        for (int64 i = buffer_.size() - 1; i > 0; --i) {
+          std::swap(buffer_[i], buffer_[Random() % (i + 1)]);
+        }
+
+        TF_RETURN_IF_ERROR(WriteRunLocked(
+            buffer_.size(), [this](int64 i, string* record) {
+              return CompressElement(buffer_[i], record);
+            }));
+        buffer_.clear();
+
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (stats_aggregator) {
+          uint64 file_size;
+          TF_RETURN_IF_ERROR(
+              ctx->env()->GetFileSize(runs_.back()->filename, &file_size));
+          const int64 elapsed_micros =
+              std::max<int64>(ctx->env()->NowMicros() - start_micros, 1);
+          stats_aggregator->AddToHistogram(
+              strings::StrCat(prefix_end_, "::spill_bytes_per_second"),
+              {file_size * 1e6 / elapsed_micros});
+          stats_aggregator->IncrementCounter(prefix_end_, "spilled_bytes",
+                                             file_size);
+          stats_aggregator->IncrementCounter(prefix_end_, "spilled_runs", 1);
+        }
+        return Status::OK();
+      }
+
+      // Appends a run of `num_elements` records to `runs_`, where
+      // `get_record(i, &record)` produces the i-th record.
+      Status WriteRunLocked(
+          int64 num_elements,
+          const std::function<Status(int64, string*)>& get_record)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::unique_ptr<Run> run(new Run);
+        run->filename = io::JoinPath(
+            dataset()->spill_directory_,
+            strings::StrCat(spill_prefix_, "_", num_spilled_runs_++));
+        std::unique_ptr<WritableFile> file;
+        TF_RETURN_IF_ERROR(env_->NewWritableFile(run->filename, &file));
+        // The run is added before it is written, so that its file is deleted
+        // along with the others if writing it fails.
+        run->num_elements = num_elements;
+        runs_.push_back(std::move(run));
+        {
+          io::RecordWriter writer(
+              file.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
+                              dataset()->compression_type_));
+          string record;
+          for (int64 i = 0; i < num_elements; ++i) {
+            TF_RETURN_IF_ERROR(get_record(i, &record));
+            TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+          }
+          TF_RETURN_IF_ERROR(writer.Close());
+        }
+        return file->Close();
+      }
+
+      io::RecordReaderOptions RunReaderOptions() const {
+        io::RecordReaderOptions options =
+            io::RecordReaderOptions::CreateRecordReaderOptions(
+                dataset()->compression_type_);
+        options.buffer_size = kReadBufferSize;
+        return options;
+      }
+
+      // Reads the next element of the run containing the `index`-th spilled
+      // element, counting from the first element left in the first run.
+      Status ReadFromRunLocked(int64 index, std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        size_t i = 0;
+        while (index >= runs_[i]->num_elements) {
+          index -= runs_[i]->num_elements;
+          ++i;
+        }
+        Run* run = runs_[i].get();
+        if (!run->reader) {
+          TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(run->filename,
+                                                       &run->file));
+          run->reader.reset(new io::SequentialRecordReader(
+              run->file.get(), RunReaderOptions()));
+          TF_RETURN_IF_ERROR(run->reader->SeekOffset(run->offset));
+        }
+        StringPiece record;
+        TF_RETURN_IF_ERROR(run->reader->ReadRecord(&record));
+        TF_RETURN_IF_ERROR(UncompressElement(record, out_tensors));
+        if (out_tensors->size() != dataset()->output_dtypes().size()) {
+          return errors::DataLoss("Corrupted shuffle spill file ",
+                                  run->filename);
+        }
+        run->offset = run->reader->TellOffset();
+        if (--run->num_elements == 0) {
+          DeleteRun(run);
+          runs_.erase(runs_.begin() + i);
+        }
+        return Status::OK();
+      }
+
+      // Closes the file of `run` and deletes it, unless a checkpoint refers
+      // to it.
+      void DeleteRun(Run* run) {
+        run->reader.reset();
+        run->file.reset();
+        if (!run->checkpointed) DeleteSpillFile(run->filename);
+      }
+
+      void DeleteSpillFile(const string& filename) {
+        if (env_ == nullptr) return;
+        Status s = env_->DeleteFile(filename);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to delete shuffle spill file " << filename
+                       << ": " << s;
+        }
+      }
+
+      random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        num_random_samples_++;
+        auto out = generator_();
+        return out;
+      }
+
+      void ResetRngs() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        // Reset the generators based on the current iterator seeds.
+        parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+        generator_ = random::SingleSampleAdapter<random::PhiloxRandom>(
+            &parent_generator_);
+        generator_.Skip(num_random_samples_);
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      Env* env_ = nullptr;
+      // The elements of the current window that are still in memory, and the
+      // runs it was spilled to.
+      std::vector<std::vector<Tensor>> buffer_ GUARDED_BY(mu_);
+      std::vector<std::unique_ptr<Run>> runs_ GUARDED_BY(mu_);
+      // Number of elements of the current window not produced yet.
+      int64 num_elements_ GUARDED_BY(mu_) = 0;
+      int64 seed_ GUARDED_BY(mu_);
+      int64 seed2_ GUARDED_BY(mu_);
+      random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator_
+          GUARDED_BY(mu_);
+      int64 num_random_samples_ GUARDED_BY(mu_) = 0;
+      // The run files that the latest checkpoint saved or restored by this
+      // iterator refers to.
+      std::vector<string> checkpointed_files_ GUARDED_BY(mu_);
+      // Files of new runs are named "<spill_prefix_>_<n>".
+      const string spill_prefix_;
+      int64 num_spilled_runs_ GUARDED_BY(mu_) = 0;
+      string prefix_end_;
+    };
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random() const
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_random_samples_++;
+      auto out = generator_();
+      return out;
+    }
+
+    void ResetRngs() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      // Reset the generators based on the current seeds.
+      parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    const DatasetBase* const input_;
+    const int64 buffer_size_;
+    const int64 memory_limit_;
+    const string spill_directory_;
+    const string compression_type_;
+    const int64 seed_;
+    const int64 seed2_;
+    mutable mutex mu_;
+    mutable random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+    mutable random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        GUARDED_BY(mu_);
+    mutable int64 num_random_samples_ GUARDED_BY(mu_) = 0;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ExperimentalSpillingShuffleDataset").Device(DEVICE_CPU),
+    SpillingShuffleDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
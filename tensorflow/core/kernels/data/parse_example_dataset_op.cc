@@ -188,13 +188,22 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         (*ctx->runner())([this, ctx, input_element, result, done]() {
           thread::ThreadPool* device_threadpool =
               ctx->lib()->device()->tensorflow_cpu_worker_threads()->workers;
+          // The input is normally a single vector of serialized examples,
+          // which is parsed in place. Otherwise, the components are
+          // concatenated first.
           std::vector<string> slice_vec;
-          for (Tensor t : input_element) {
-            auto serialized_t = t.flat<string>();
-            gtl::ArraySlice<string> slice(serialized_t.data(),
-                                          serialized_t.size());
-            for (auto it = slice.begin(); it != slice.end(); it++)
-              slice_vec.push_back(*it);
+          gtl::ArraySlice<string> serialized;
+          if (input_element.size() == 1) {
+            auto serialized_t = input_element[0].flat<string>();
+            serialized = gtl::ArraySlice<string>(serialized_t.data(),
+                                                 serialized_t.size());
+          } else {
+            for (const Tensor& t : input_element) {
+              auto serialized_t = t.flat<string>();
+              slice_vec.insert(slice_vec.end(), serialized_t.data(),
+                               serialized_t.data() + serialized_t.size());
+            }
+            serialized = slice_vec;
           }
           example::FastParseExampleConfig config = config_;
           // local copy of config_ for modification.
@@ -203,7 +212,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             config.collect_feature_stats = true;
           }
           example::Result example_result;
-          Status s = FastParseExample(config, slice_vec, {}, device_threadpool,
+          Status s = FastParseExample(config, serialized, {}, device_threadpool,
                                       &example_result);
           if (s.ok()) {
             (*result).resize(key_to_output_index_.size());
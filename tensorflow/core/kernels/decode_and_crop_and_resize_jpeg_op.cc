@@ -0,0 +1,261 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest libjpeg scaling denominator that decodes a crop of
+// `crop_height` x `crop_width` pixels to at least `out_height` x `out_width`
+// pixels, so that only a downscale of less than 2x is left to the resize.
+int ChooseRatio(int crop_height, int crop_width, int out_height,
+                int out_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (static_cast<int64>(out_height) * ratio <= crop_height &&
+        static_cast<int64>(out_width) * ratio <= crop_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// The rows (or columns) of the crop window [crop_start, crop_start +
+// crop_size) of the original image, in the image decoded at 1/ratio size.
+struct ScaledWindow {
+  ScaledWindow(int crop_start, int crop_size, int image_size, int ratio)
+      : start(crop_start / ratio),
+        size(std::min((image_size + ratio - 1) / ratio,
+                      (crop_start + crop_size + ratio - 1) / ratio) -
+             start) {}
+  int start;
+  int size;
+};
+
+struct CachedInterpolation {
+  int64 lower;  // Lower source index used in the interpolation
+  int64 upper;  // Upper source index used in the interpolation
+  float lerp;   // 1-D linear interpolation scale
+};
+
+// Samples the crop of one dimension at `out_size` positions from its scaled
+// window, the way ResizeBilinear without align_corners samples a decoded
+// crop. Pixel j of an image decoded at 1/ratio size covers the original
+// pixels [j * ratio, (j + 1) * ratio), so its center is at original
+// coordinate j * ratio + (ratio - 1) / 2. With ratio 1, the weights are
+// exactly those of ResizeBilinear.
+void ComputeInterpolationWeights(const int64 out_size, const int crop_start,
+                                 const int crop_size, const int ratio,
+                                 const ScaledWindow& window,
+                                 CachedInterpolation* interpolation) {
+  const float scale = CalculateResizeScale(crop_size, out_size, false);
+  const float offset =
+      crop_start - window.start * ratio - 0.5f * (ratio - 1);
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = std::max(0.0f, (i * scale + offset) / ratio);
+    interpolation[i].lower =
+        std::min(static_cast<int64>(in), static_cast<int64>(window.size - 1));
+    interpolation[i].upper = std::min(interpolation[i].lower + 1,
+                                      static_cast<int64>(window.size - 1));
+    interpolation[i].lerp = in - interpolation[i].lower;
+  }
+}
+
+// Decodes a crop window of a JPEG image straight to a smaller size. The
+// largest DCT scaling that keeps the crop above the requested size is
+// applied by libjpeg, which with libjpeg-turbo also skips the rows and MCU
+// columns outside the crop, and the decoded window is then bilinearly
+// resized to the requested size.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument(
+                    "channels must be 0, 1, or 3 for JPEG, got ", channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<string>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be 1-D with four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    auto crop_window_vec = crop_window.vec<int32>();
+    const int crop_y = crop_window_vec(0);
+    const int crop_x = crop_window_vec(1);
+    const int crop_height = crop_window_vec(2);
+    const int crop_width = crop_window_vec(3);
+
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with two elements, got shape ",
+                    size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("output dimensions must be positive"));
+
+    int image_width, image_height;
+    OP_REQUIRES(
+        context,
+        jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                           &image_height, nullptr),
+        errors::InvalidArgument("Invalid JPEG data, size ", input.size()));
+    OP_REQUIRES(context,
+                crop_width > 0 && crop_height > 0 && crop_x >= 0 &&
+                    crop_y >= 0 &&
+                    crop_y <= image_height - crop_height &&
+                    crop_x <= image_width - crop_width,
+                errors::InvalidArgument(
+                    "Invalid JPEG data or crop window: crop window [", crop_y,
+                    ", ", crop_x, ", ", crop_height, ", ", crop_width,
+                    "] for image of height ", image_height, " and width ",
+                    image_width));
+
+    // Use local copy of flags to avoid race condition as the class member is
+    // shared among different invocations.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ChooseRatio(crop_height, crop_width, out_height, out_width);
+    const ScaledWindow rows(crop_y, crop_height, image_height, flags.ratio);
+    const ScaledWindow cols(crop_x, crop_width, image_width, flags.ratio);
+    flags.crop = true;
+    flags.crop_y = rows.start;
+    flags.crop_x = cols.start;
+    flags.crop_height = rows.size;
+    flags.crop_width = cols.size;
+
+    // Decode the window, allocating it once the number of channels is known.
+    Tensor window;
+    OP_REQUIRES(
+        context,
+        jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [=, &window](int width, int height, int channels) -> uint8* {
+              Status status(context->allocate_temp(
+                  DT_UINT8, TensorShape({height, width, channels}), &window));
+              if (!status.ok()) {
+                VLOG(1) << status;
+                context->SetStatus(status);
+                return nullptr;
+              }
+              return window.flat<uint8>().data();
+            }),
+        errors::InvalidArgument("Invalid JPEG data or crop window, data size ",
+                                input.size()));
+    const int channels = window.dim_size(2);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    std::vector<CachedInterpolation> ys(out_height);
+    std::vector<CachedInterpolation> xs(out_width);
+    ComputeInterpolationWeights(out_height, crop_y, crop_height, flags.ratio,
+                                rows, ys.data());
+    ComputeInterpolationWeights(out_width, crop_x, crop_width, flags.ratio,
+                                cols, xs.data());
+    // Scale the x interpolation weights to avoid a multiplication during
+    // iteration.
+    for (CachedInterpolation& x : xs) {
+      x.lower *= channels;
+      x.upper *= channels;
+    }
+
+    const int64 in_row_size = static_cast<int64>(cols.size) * channels;
+    const uint8* window_data = window.flat<uint8>().data();
+    float* output_data = output->flat<float>().data();
+    for (int y = 0; y < out_height; ++y) {
+      const uint8* ys_input_lower_ptr = window_data + ys[y].lower * in_row_size;
+      const uint8* ys_input_upper_ptr = window_data + ys[y].upper * in_row_size;
+      const float ys_lerp = ys[y].lerp;
+      for (int x = 0; x < out_width; ++x) {
+        const int64 xs_lower = xs[x].lower;
+        const int64 xs_upper = xs[x].upper;
+        const float xs_lerp = xs[x].lerp;
+        for (int c = 0; c < channels; ++c) {
+          const float top_left(ys_input_lower_ptr[xs_lower + c]);
+          const float top_right(ys_input_lower_ptr[xs_upper + c]);
+          const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
+          const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
+          const float top = top_left + (top_right - top_left) * xs_lerp;
+          const float bottom =
+              bottom_left + (bottom_right - bottom_left) * xs_lerp;
+          *output_data++ = top + (bottom - top) * ys_lerp;
+        }
+      }
+    }
+  }
+
+ private:
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,327 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedElementwise op, which the grappler remapper creates
+// from chains of element-wise ops. The chain is evaluated block by block so
+// that intermediate results stay in cache instead of being written out as
+// full tensors.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Number of elements evaluated per step of the chain. Small enough for the
+// intermediate blocks of a long chain to stay in L1/L2.
+constexpr int64 kBlockSize = 1024;
+
+enum class CwiseOp {
+  // Unary ops.
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary ops.
+  kAdd,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kSquaredDifference,
+  kSub,
+};
+
+// The op types that can be fused. Keep in sync with the remapper.
+bool ParseCwiseOp(const string& name, CwiseOp* op, int* arity) {
+  static const auto* const kOps = new std::unordered_map<string, CwiseOp>({
+      {"Abs", CwiseOp::kAbs},
+      {"Exp", CwiseOp::kExp},
+      {"Log", CwiseOp::kLog},
+      {"Neg", CwiseOp::kNeg},
+      {"Reciprocal", CwiseOp::kReciprocal},
+      {"Inv", CwiseOp::kReciprocal},
+      {"Relu", CwiseOp::kRelu},
+      {"Relu6", CwiseOp::kRelu6},
+      {"Rsqrt", CwiseOp::kRsqrt},
+      {"Sigmoid", CwiseOp::kSigmoid},
+      {"Sqrt", CwiseOp::kSqrt},
+      {"Square", CwiseOp::kSquare},
+      {"Tanh", CwiseOp::kTanh},
+      {"Add", CwiseOp::kAdd},
+      {"Div", CwiseOp::kDiv},
+      {"RealDiv", CwiseOp::kDiv},
+      {"Maximum", CwiseOp::kMaximum},
+      {"Minimum", CwiseOp::kMinimum},
+      {"Mul", CwiseOp::kMul},
+      {"SquaredDifference", CwiseOp::kSquaredDifference},
+      {"Sub", CwiseOp::kSub},
+  });
+  auto it = kOps->find(name);
+  if (it == kOps->end()) {
+    return false;
+  }
+  *op = it->second;
+  *arity = *op >= CwiseOp::kAdd ? 2 : 1;
+  return true;
+}
+
+// One op of the chain. Operands are indices into the list of blocks
+// available while evaluating the chain: first the inputs, then the results
+// of the previous steps.
+struct Step {
+  CwiseOp op;
+  int operands[2];
+};
+
+template <typename T>
+void EvaluateStep(const Step& step, const std::vector<const T*>& blocks,
+                  int64 size, T* out_data) {
+  typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+  Eigen::Map<const Array> a(blocks[step.operands[0]], size);
+  Eigen::Map<Array> out(out_data, size);
+  switch (step.op) {
+    case CwiseOp::kAbs:
+      out = a.abs();
+      return;
+    case CwiseOp::kExp:
+      out = a.exp();
+      return;
+    case CwiseOp::kLog:
+      out = a.log();
+      return;
+    case CwiseOp::kNeg:
+      out = -a;
+      return;
+    case CwiseOp::kReciprocal:
+      out = a.inverse();
+      return;
+    case CwiseOp::kRelu:
+      out = a.max(T(0));
+      return;
+    case CwiseOp::kRelu6:
+      out = a.max(T(0)).min(T(6));
+      return;
+    case CwiseOp::kRsqrt:
+      out = a.rsqrt();
+      return;
+    case CwiseOp::kSigmoid:
+      out = a.unaryExpr(Eigen::internal::scalar_logistic_op<T>());
+      return;
+    case CwiseOp::kSqrt:
+      out = a.sqrt();
+      return;
+    case CwiseOp::kSquare:
+      out = a.square();
+      return;
+    case CwiseOp::kTanh:
+      out = a.tanh();
+      return;
+    default:
+      break;
+  }
+  Eigen::Map<const Array> b(blocks[step.operands[1]], size);
+  switch (step.op) {
+    case CwiseOp::kAdd:
+      out = a + b;
+      return;
+    case CwiseOp::kDiv:
+      out = a / b;
+      return;
+    case CwiseOp::kMaximum:
+      out = a.max(b);
+      return;
+    case CwiseOp::kMinimum:
+      out = a.min(b);
+      return;
+    case CwiseOp::kMul:
+      out = a * b;
+      return;
+    case CwiseOp::kSquaredDifference:
+      out = (a - b).square();
+      return;
+    case CwiseOp::kSub:
+      out = a - b;
+      return;
+    default:
+      LOG(FATAL) << "Unexpected op " << static_cast<int>(step.op);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int num_inputs;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &num_inputs));
+    std::vector<string> ops;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    std::vector<int32> operands;
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+
+    int next_operand = 0;
+    for (int i = 0; i < ops.size(); ++i) {
+      Step step;
+      int arity;
+      OP_REQUIRES(context, ParseCwiseOp(ops[i], &step.op, &arity),
+                  errors::InvalidArgument("Unsupported op in fused chain: ",
+                                          ops[i]));
+      OP_REQUIRES(context, next_operand + arity <= operands.size(),
+                  errors::InvalidArgument("Too few operands for ", ops[i]));
+      for (int j = 0; j < arity; ++j) {
+        const int32 operand = operands[next_operand++];
+        if (operand >= 0) {
+          OP_REQUIRES(context, operand < num_inputs,
+                      errors::InvalidArgument("Operand ", operand,
+                                              " is not a valid input index"));
+          step.operands[j] = operand;
+        } else {
+          // -k refers to the result of op k - 1.
+          OP_REQUIRES(context, -operand <= i,
+                      errors::InvalidArgument(
+                          "Op ", i, " refers to the result of op ",
+                          -operand - 1, " which is not evaluated before it"));
+          step.operands[j] = num_inputs + (-operand - 1);
+        }
+      }
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, next_operand == operands.size(),
+                errors::InvalidArgument("Expected ", next_operand,
+                                        " operands, got ", operands.size()));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList inputs;
+    OP_REQUIRES_OK(context, context->input_list("inputs", &inputs));
+
+    TensorShape shape;
+    gtl::InlinedVector<int, 4> forwardable_inputs;
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (!TensorShapeUtils::IsScalar(inputs[i].shape())) {
+        shape = inputs[i].shape();
+        break;
+      }
+    }
+    for (int i = 0; i < inputs.size(); ++i) {
+      const Tensor& input = inputs[i];
+      if (TensorShapeUtils::IsScalar(input.shape())) {
+        continue;
+      }
+      OP_REQUIRES(context, input.shape() == shape,
+                  errors::InvalidArgument(
+                      "Inputs of a fused element-wise op must have the same "
+                      "shape or be scalars, got ",
+                      shape.DebugString(), " and ",
+                      input.shape().DebugString()));
+      forwardable_inputs.push_back(i);
+    }
+
+    Tensor* output = nullptr;
+    // The output can reuse an input buffer: each block of an input is fully
+    // consumed before the corresponding block of the output is written.
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                forwardable_inputs, 0, shape, &output));
+    const int64 num_elements = shape.num_elements();
+    if (num_elements == 0) {
+      return;
+    }
+
+    const int num_inputs = inputs.size();
+    std::vector<const T*> input_data(num_inputs);
+    std::vector<bool> is_scalar(num_inputs);
+    for (int i = 0; i < num_inputs; ++i) {
+      input_data[i] = inputs[i].flat<T>().data();
+      is_scalar[i] = TensorShapeUtils::IsScalar(inputs[i].shape());
+    }
+    T* output_data = output->flat<T>().data();
+    const int num_steps = steps_.size();
+    const std::vector<Step>& steps = steps_;
+
+    auto work = [&](int64 begin_block, int64 end_block) {
+      // Scratch space for one block per step, plus one per scalar input
+      // which is broadcast once and reused for every block.
+      std::vector<T> scratch((num_steps + num_inputs) * kBlockSize);
+      std::vector<const T*> blocks(num_inputs + num_steps);
+      for (int i = 0; i < num_inputs; ++i) {
+        if (is_scalar[i]) {
+          T* broadcast = scratch.data() + (num_steps + i) * kBlockSize;
+          std::fill(broadcast, broadcast + kBlockSize, *input_data[i]);
+          blocks[i] = broadcast;
+        }
+      }
+      for (int64 block = begin_block; block < end_block; ++block) {
+        const int64 offset = block * kBlockSize;
+        const int64 size = std::min(kBlockSize, num_elements - offset);
+        for (int i = 0; i < num_inputs; ++i) {
+          if (!is_scalar[i]) {
+            blocks[i] = input_data[i] + offset;
+          }
+        }
+        for (int s = 0; s < num_steps; ++s) {
+          T* result = s + 1 == num_steps ? output_data + offset
+                                         : scratch.data() + s * kBlockSize;
+          EvaluateStep<T>(steps[s], blocks, size, result);
+          blocks[num_inputs + s] = result;
+        }
+      }
+    };
+
+    const int64 num_blocks = (num_elements + kBlockSize - 1) / kBlockSize;
+    // Rough per-block cost: a few cycles per element and op.
+    const int64 cost_per_block = kBlockSize * num_steps * 5;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, work);
+  }
+
+ private:
+  std::vector<Step> steps_;
+};
+
+#define REGISTER_KERNEL(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,105 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(DataType dtype, int num_inputs, const std::vector<string>& ops,
+                const std::vector<int>& operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_inputs, dtype))
+                           .Attr("ops", ops)
+                           .Attr("operands", operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, MulAddTanhMul) {
+  // tanh(x * y + z) * w
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 4, {"Mul", "Add", "Tanh", "Mul"},
+                      {0, 1, -1, 2, -2, -3, 3}));
+  // Large enough to span several blocks, with a partial last block.
+  const int num_elements = 2500;
+  std::vector<float> x(num_elements), y(num_elements), w(num_elements);
+  std::vector<float> expected(num_elements);
+  for (int i = 0; i < num_elements; ++i) {
+    x[i] = (i % 17) * 0.1f - 0.8f;
+    y[i] = (i % 5) * 0.3f;
+    w[i] = (i % 3) - 1.0f;
+    expected[i] = std::tanh(x[i] * y[i] + 0.5f) * w[i];
+  }
+  AddInputFromArray<float>(TensorShape({50, 50}), x);
+  AddInputFromArray<float>(TensorShape({50, 50}), y);
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  AddInputFromArray<float>(TensorShape({50, 50}), w);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_tensor(allocator(), DT_FLOAT, TensorShape({50, 50}));
+  test::FillValues<float>(&expected_tensor, expected);
+  test::ExpectClose(expected_tensor, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, ReusesIntermediateResults) {
+  // sigmoid(x) * x, then squared difference against y.
+  TF_ASSERT_OK(MakeOp(DT_DOUBLE, 2, {"Sigmoid", "Mul", "SquaredDifference"},
+                      {0, -1, 0, -2, 1}));
+  AddInputFromArray<double>(TensorShape({4}), {-2.0, -0.5, 0.0, 3.0});
+  AddInputFromArray<double>(TensorShape({4}), {1.0, 0.0, -1.0, 2.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<double> expected;
+  const double x[] = {-2.0, -0.5, 0.0, 3.0};
+  const double y[] = {1.0, 0.0, -1.0, 2.0};
+  for (int i = 0; i < 4; ++i) {
+    const double swish = x[i] / (1.0 + std::exp(-x[i]));
+    expected.push_back((swish - y[i]) * (swish - y[i]));
+  }
+  Tensor expected_tensor(allocator(), DT_DOUBLE, TensorShape({4}));
+  test::FillValues<double>(&expected_tensor, expected);
+  test::ExpectClose(expected_tensor, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsIncompatibleShapes) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, 2, {"Add"}, {0, 1}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsInvalidChains) {
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp(DT_FLOAT, 1, {"Cos"}, {0})));
+  // The first op cannot refer to a result.
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(MakeOp(DT_FLOAT, 1, {"Tanh", "Exp"}, {-1, 0})));
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp(DT_FLOAT, 2, {"Add"}, {0})));
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(MakeOp(DT_FLOAT, 1, {"Relu"}, {0, 0})));
+}
+
+}  // namespace
+}  // namespace tensorflow
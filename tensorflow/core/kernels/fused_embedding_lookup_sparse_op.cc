@@ -0,0 +1,248 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedEmbeddingLookupSparse op, which the grappler remapper
+// creates from a Gather feeding a SparseSegmentSum, SparseSegmentMean or
+// SparseSegmentSqrtN. Every embedding row is read from the params and added
+// straight into the output row of its segment, so the gathered [nnz, dim]
+// tensor is never materialized.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+template <typename T, typename Tids, typename Tidx>
+class FusedEmbeddingLookupSparseOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    if (combiner == "sum") {
+      combiner_ = Combiner::kSum;
+    } else if (combiner == "mean") {
+      combiner_ = Combiner::kMean;
+    } else if (combiner == "sqrtn") {
+      combiner_ = Combiner::kSqrtN;
+    } else {
+      context->CtxFailure(
+          errors::InvalidArgument("Unsupported combiner: ", combiner));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    OpInputList weights_list;
+    OP_REQUIRES_OK(context, context->input_list("weights", &weights_list));
+
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    const int64 num_ids = ids.NumElements();
+    const int64 num_indices = indices.NumElements();
+    OP_REQUIRES(context, num_indices == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+    const Tensor* weights = nullptr;
+    if (weights_list.size() > 0) {
+      weights = &weights_list[0];
+      OP_REQUIRES(context,
+                  weights->dims() >= 1 && weights->dim_size(0) == num_ids &&
+                      weights->NumElements() == num_ids,
+                  errors::InvalidArgument(
+                      "weights should have one value per id, got shape ",
+                      weights->shape().DebugString(), " for ", num_ids,
+                      " ids."));
+    }
+
+    const auto params_flat = params.flat_outer_dims<T>();
+    const int64 num_params = params_flat.dimension(0);
+    const int64 num_col = params_flat.dimension(1);
+    const auto ids_vec = ids.vec<Tids>();
+    const auto indices_vec = indices.vec<Tidx>();
+    const auto segment_vec = segment_ids.vec<int32>();
+    // As in the SparseSegment ops, the segment ids must be sorted.
+    const int32 output_rows =
+        num_indices > 0
+            ? internal::SubtleMustCopy(segment_vec(num_indices - 1)) + 1
+            : 0;
+    OP_REQUIRES(context, output_rows >= 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (num_indices == 0) {
+      return;
+    }
+    OP_REQUIRES(context, output_rows > 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+    auto output_flat = output->flat_outer_dims<T>();
+
+    // Find the segments and the params row of every entry first, checking
+    // the segment ids, the indices and the ids, so that the segments can then
+    // be reduced in parallel from a single read of the inputs.
+    std::vector<Segment> segments;
+    std::vector<int64> rows(num_indices);
+    std::vector<T> entry_weights(weights != nullptr ? num_indices : 0);
+    const auto weights_flat = weights != nullptr
+                                  ? weights->flat<T>()
+                                  : typename TTypes<T>::ConstFlat(nullptr, 0);
+    int64 start = 0;
+    int32 out_index = internal::SubtleMustCopy(segment_vec(start));
+    for (int64 end = 1; end <= num_indices; ++end) {
+      int32 next_index = 0;
+      if (end < num_indices) {
+        next_index = internal::SubtleMustCopy(segment_vec(end));
+        if (out_index == next_index) {
+          continue;
+        }
+        OP_REQUIRES(context, out_index < next_index,
+                    errors::InvalidArgument("segment ids are not increasing"));
+      }
+      OP_REQUIRES(
+          context, FastBoundsCheck(out_index, output_rows),
+          errors::InvalidArgument(
+              "Segment id ", out_index, " out of range [0, ", output_rows,
+              "), possibly because 'segment_ids' input is not sorted."));
+      for (int64 i = start; i < end; ++i) {
+        const Tidx index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(context, FastBoundsCheck(index, num_ids),
+                    errors::InvalidArgument("Bad: indices[", i, "] == ", index,
+                                            " out of range [0, ", num_ids,
+                                            ")"));
+        const Tids id = internal::SubtleMustCopy(ids_vec(index));
+        OP_REQUIRES(context, FastBoundsCheck(id, num_params),
+                    errors::InvalidArgument("ids[", index, "] = ", id,
+                                            " is not in [0, ", num_params,
+                                            ")"));
+        rows[i] = id;
+        if (weights != nullptr) {
+          entry_weights[i] = weights_flat(index);
+        }
+      }
+      segments.push_back({start, end, out_index});
+      start = end;
+      out_index = next_index;
+    }
+
+    typedef Eigen::Map<const Eigen::Matrix<T, 1, Eigen::Dynamic>> ConstRow;
+    typedef Eigen::Map<Eigen::Matrix<T, 1, Eigen::Dynamic>> Row;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const Segment& segment = segments[s];
+        // Rows of the segment ids without entries are zero.
+        const int32 uninitialized_index =
+            s == 0 ? 0 : segments[s - 1].out_index + 1;
+        if (segment.out_index > uninitialized_index) {
+          Row(&output_flat(uninitialized_index, 0),
+              (segment.out_index - uninitialized_index) * num_col)
+              .setZero();
+        }
+        Row out(&output_flat(segment.out_index, 0), num_col);
+        out.setZero();
+        T scale(segment.end - segment.start);
+        if (weights == nullptr) {
+          for (int64 i = segment.start; i < segment.end; ++i) {
+            out += ConstRow(&params_flat(rows[i], 0), num_col);
+          }
+          if (combiner_ == Combiner::kSqrtN) {
+            scale = Eigen::numext::sqrt(scale);
+          }
+        } else {
+          T sum_weights(0);
+          T sum_squared_weights(0);
+          for (int64 i = segment.start; i < segment.end; ++i) {
+            const T weight = entry_weights[i];
+            out += weight * ConstRow(&params_flat(rows[i], 0), num_col);
+            sum_weights += weight;
+            sum_squared_weights += weight * weight;
+          }
+          scale = combiner_ == Combiner::kSqrtN
+                      ? Eigen::numext::sqrt(sum_squared_weights)
+                      : sum_weights;
+        }
+        if (combiner_ != Combiner::kSum) {
+          out /= scale;
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment =
+        (num_indices / segments.size() + 1) * num_col;
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          segments.size(), cost_per_segment, reduce_segments);
+  }
+
+ private:
+  // The entries [start, end) of a segment, reduced into output row
+  // `out_index`.
+  struct Segment {
+    int64 start;
+    int64 end;
+    int32 out_index;
+  };
+
+  Combiner combiner_;
+};
+
+#define REGISTER_KERNEL(T, Tids, Tidx)                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedEmbeddingLookupSparse")   \
+                              .Device(DEVICE_CPU)               \
+                              .TypeConstraint<T>("T")           \
+                              .TypeConstraint<Tids>("Tids")     \
+                              .TypeConstraint<Tidx>("Tidx"),    \
+                          FusedEmbeddingLookupSparseOp<T, Tids, Tidx>);
+
+#define REGISTER_KERNELS(T)         \
+  REGISTER_KERNEL(T, int32, int32); \
+  REGISTER_KERNEL(T, int32, int64); \
+  REGISTER_KERNEL(T, int64, int32); \
+  REGISTER_KERNEL(T, int64, int64);
+
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+#undef REGISTER_KERNEL
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,153 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedEmbeddingLookupSparseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(DataType dtype, DataType index_type, int num_weights,
+                const string& combiner) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedEmbeddingLookupSparse")
+                           .Input(FakeInput(dtype))
+                           .Input(FakeInput(index_type))
+                           .Input(FakeInput(index_type))
+                           .Input(FakeInput(DT_INT32))
+                           .Input(FakeInput(num_weights, dtype))
+                           .Attr("combiner", combiner)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+
+  // Embedding rows [7, 8], [1, 2], [5, 6] and [1, 2] in segments 0, 0, 2 and
+  // 2, which leaves segment 1 empty.
+  void AddLookupInputs() {
+    AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8});
+    AddInputFromArray<int32>(TensorShape({3}), {3, 0, 2});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 1, 2, 1});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+  }
+};
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Sum) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 0, "sum"));
+  AddLookupInputs();
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {8, 10, 0, 0, 6, 8});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Mean) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 0, "mean"));
+  AddLookupInputs();
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {4, 5, 0, 0, 3, 4});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, SqrtN) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 0, "sqrtn"));
+  AddLookupInputs();
+  TF_ASSERT_OK(RunOpKernel());
+
+  const float sqrt2 = std::sqrt(2.0f);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(
+      &expected, {8 / sqrt2, 10 / sqrt2, 0, 0, 6 / sqrt2, 8 / sqrt2});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, WeightedSum) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 1, "sum"));
+  AddLookupInputs();
+  // The weights of ids 3, 0 and 2.
+  AddInputFromArray<float>(TensorShape({3, 1}), {0.5, 2, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {5.5, 8, 0, 0, 7, 10});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, WeightedMean) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 1, "mean"));
+  AddLookupInputs();
+  AddInputFromArray<float>(TensorShape({3}), {0.5, 2, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Divided by the sums of the weights, 2.5 and 3.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected,
+                          {5.5 / 2.5, 8 / 2.5, 0, 0, 7.0 / 3, 10.0 / 3});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Int64IdsAndHigherRankParams) {
+  TF_ASSERT_OK(MakeOp(DT_DOUBLE, DT_INT64, 0, "sum"));
+  AddInputFromArray<double>(TensorShape({3, 1, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64>(TensorShape({2}), {2, 1});
+  AddInputFromArray<int64>(TensorShape({3}), {0, 1, 0});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_DOUBLE, TensorShape({2, 1, 2}));
+  test::FillValues<double>(&expected, {5, 6, 8, 10});
+  test::ExpectTensorEqual<double>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, RejectsOutOfRangeIds) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 0, "sum"));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, RejectsUnsortedSegments) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 0, "sum"));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, RejectsMismatchedWeights) {
+  TF_ASSERT_OK(MakeOp(DT_FLOAT, DT_INT32, 1, "sum"));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,309 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A separable resampler for the CPU kernels of the image resize ops.
+//
+// A resize is described by one ResampleFilter per dimension, which lists for
+// every output index the input indices it reads and their weights. Each
+// needed input row is first resampled horizontally into a float row of the
+// output width, which is cached while later output rows still read it, and
+// the output rows are then combined from those rows vertically. Both passes
+// read the input type directly, so no float copy of the input is made.
+//
+// Files including this header must define EIGEN_USE_THREADS.
+
+#ifndef TENSORFLOW_CORE_KERNELS_IMAGE_RESAMPLER_H_
+#define TENSORFLOW_CORE_KERNELS_IMAGE_RESAMPLER_H_
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The 1-D resampling of `in_size` inputs to `out_size` outputs. Output i
+// reads the inputs indices[offsets[i]] to indices[offsets[i + 1] - 1], which
+// are already bounded to [0, in_size), with the matching weights.
+//
+// A filter made with AddLerp has two taps per output, which are combined as
+// lower + (upper - lower) * lerp, the form ResizeBilinear has always used.
+class ResampleFilter {
+ public:
+  ResampleFilter(int64 in_size, int64 out_size, bool is_lerp)
+      : in_size_(in_size), out_size_(out_size), is_lerp_(is_lerp) {
+    offsets_.reserve(out_size + 1);
+    offsets_.push_back(0);
+  }
+
+  // Adds a tap to the output being built.
+  void AddTap(int64 index, float weight) {
+    DCHECK(!is_lerp_);
+    indices_.push_back(std::min(in_size_ - 1, std::max(int64{0}, index)));
+    weights_.push_back(weight);
+  }
+
+  // Sets the two taps of the output being built.
+  void AddLerp(int64 lower, int64 upper, float lerp) {
+    DCHECK(is_lerp_);
+    indices_.push_back(lower);
+    indices_.push_back(upper);
+    weights_.push_back(1.0f - lerp);
+    weights_.push_back(lerp);
+  }
+
+  // Completes the output being built and starts the next one.
+  void FinishOutput() {
+    const int64 begin = offsets_.back();
+    const int64 end = indices_.size();
+    DCHECK_GT(end, begin);
+    const auto minmax = std::minmax_element(indices_.begin() + begin,
+                                            indices_.begin() + end);
+    max_taps_ = std::max(max_taps_, end - begin);
+    max_span_ = std::max(max_span_, *minmax.second - *minmax.first + 1);
+    offsets_.push_back(end);
+  }
+
+  int64 in_size() const { return in_size_; }
+  int64 out_size() const { return out_size_; }
+  bool is_lerp() const { return is_lerp_; }
+  // The most taps of any output.
+  int64 max_taps() const { return max_taps_; }
+  // The widest range of inputs read by any output.
+  int64 max_span() const { return max_span_; }
+  const int64* offsets() const { return offsets_.data(); }
+  const int64* indices() const { return indices_.data(); }
+  const float* weights() const { return weights_.data(); }
+
+ private:
+  const int64 in_size_;
+  const int64 out_size_;
+  const bool is_lerp_;
+  int64 max_taps_ = 0;
+  int64 max_span_ = 0;
+  std::vector<int64> offsets_;
+  std::vector<int64> indices_;
+  std::vector<float> weights_;
+};
+
+// A thread-safe cache of the filters of one resize method, keyed by input
+// size, output size and scale, so that kernels resizing to the same sizes
+// step after step build their filters once. Kernels keep one cache per
+// method in a function-local static.
+class ResampleFilterCache {
+ public:
+  std::shared_ptr<const ResampleFilter> Get(
+      int64 in_size, int64 out_size, float scale,
+      const std::function<ResampleFilter()>& make_filter) {
+    {
+      mutex_lock l(mu_);
+      for (const Entry& entry : entries_) {
+        if (entry.in_size == in_size && entry.out_size == out_size &&
+            entry.scale == scale) {
+          return entry.filter;
+        }
+      }
+    }
+    std::shared_ptr<const ResampleFilter> filter =
+        std::make_shared<const ResampleFilter>(make_filter());
+    mutex_lock l(mu_);
+    entries_.push_back({in_size, out_size, scale, filter});
+    if (entries_.size() > kMaxEntries) {
+      entries_.pop_front();
+    }
+    return filter;
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 32;
+
+  struct Entry {
+    int64 in_size;
+    int64 out_size;
+    float scale;
+    std::shared_ptr<const ResampleFilter> filter;
+  };
+
+  mutex mu_;
+  std::deque<Entry> entries_ GUARDED_BY(mu_);
+};
+
+namespace resampler_internal {
+
+// Resamples the input row `input` of `in_width` pixels to the `out_width`
+// pixels of `output`. kChannels is the number of channels if known at
+// compile time, and -1 otherwise.
+template <int kChannels, typename T>
+void ResampleRow(const ResampleFilter& filter, const T* input, int channels,
+                 float* output) {
+  if (kChannels > 0) channels = kChannels;
+  const int64* offsets = filter.offsets();
+  const int64* indices = filter.indices();
+  const float* weights = filter.weights();
+  if (filter.is_lerp()) {
+    for (int64 x = 0; x < filter.out_size(); ++x) {
+      const T* lower = input + indices[2 * x] * channels;
+      const T* upper = input + indices[2 * x + 1] * channels;
+      const float lerp = weights[2 * x + 1];
+      for (int c = 0; c < channels; ++c) {
+        const float left(lower[c]);
+        const float right(upper[c]);
+        output[c] = left + (right - left) * lerp;
+      }
+      output += channels;
+    }
+    return;
+  }
+  for (int64 x = 0; x < filter.out_size(); ++x) {
+    const int64 begin = offsets[x];
+    const int64 end = offsets[x + 1];
+    const T* first = input + indices[begin] * channels;
+    for (int c = 0; c < channels; ++c) {
+      output[c] = static_cast<float>(first[c]) * weights[begin];
+    }
+    for (int64 i = begin + 1; i < end; ++i) {
+      const T* pixel = input + indices[i] * channels;
+      const float weight = weights[i];
+      for (int c = 0; c < channels; ++c) {
+        output[c] += static_cast<float>(pixel[c]) * weight;
+      }
+    }
+    output += channels;
+  }
+}
+
+template <int kChannels, typename T>
+void ResampleImages(const Eigen::ThreadPoolDevice& d,
+                    typename TTypes<T, 4>::ConstTensor images,
+                    const ResampleFilter& ys, const ResampleFilter& xs,
+                    typename TTypes<float, 4>::Tensor output) {
+  const int64 batch_size = images.dimension(0);
+  const int64 in_height = images.dimension(1);
+  const int64 in_width = images.dimension(2);
+  const int channels = images.dimension(3);
+  const int64 out_height = output.dimension(1);
+  const int64 out_width = output.dimension(2);
+  const int64 in_row_size = in_width * channels;
+  const int64 out_row_size = out_width * channels;
+  // The rows read by any output row are within max_span() consecutive rows,
+  // so they always fall in distinct slots of a cache of that many rows.
+  const int64 num_cached_rows = ys.max_span();
+
+  auto resample_rows = [&](int64 begin, int64 end) {
+    std::vector<float> cached_rows(num_cached_rows * out_row_size);
+    std::vector<int64> cached_row_ids(num_cached_rows, -1);
+    std::vector<const float*> rows(ys.max_taps());
+    for (int64 r = begin; r < end; ++r) {
+      const int64 b = r / out_height;
+      const int64 y = r % out_height;
+      const int64 tap_begin = ys.offsets()[y];
+      const int64 num_taps = ys.offsets()[y + 1] - tap_begin;
+      for (int64 t = 0; t < num_taps; ++t) {
+        const int64 in_y = ys.indices()[tap_begin + t];
+        const int64 slot = in_y % num_cached_rows;
+        float* row = &cached_rows[slot * out_row_size];
+        const int64 row_id = b * in_height + in_y;
+        if (cached_row_ids[slot] != row_id) {
+          ResampleRow<kChannels>(xs, images.data() + row_id * in_row_size,
+                                 channels, row);
+          cached_row_ids[slot] = row_id;
+        }
+        rows[t] = row;
+      }
+
+      float* out = output.data() + r * out_row_size;
+      const float* weights = ys.weights() + tap_begin;
+      if (ys.is_lerp()) {
+        const float* top = rows[0];
+        const float* bottom = rows[1];
+        const float lerp = weights[1];
+        for (int64 i = 0; i < out_row_size; ++i) {
+          out[i] = top[i] + (bottom[i] - top[i]) * lerp;
+        }
+        continue;
+      }
+      const float* first = rows[0];
+      const float first_weight = weights[0];
+      for (int64 i = 0; i < out_row_size; ++i) {
+        out[i] = first[i] * first_weight;
+      }
+      for (int64 t = 1; t < num_taps; ++t) {
+        const float* row = rows[t];
+        const float weight = weights[t];
+        for (int64 i = 0; i < out_row_size; ++i) {
+          out[i] += row[i] * weight;
+        }
+      }
+    }
+  };
+
+  // Each output row combines ys.max_taps() rows, and horizontally resamples
+  // the input rows it is the first to read, about one per output row when
+  // upsampling and in_height / out_height when downsampling.
+  const double new_rows_per_output_row =
+      std::min<double>(ys.max_taps(),
+                       std::max<double>(1.0, static_cast<double>(in_height) /
+                                                 out_height));
+  const double macs_per_output_row =
+      out_row_size * (ys.max_taps() + xs.max_taps() * new_rows_per_output_row);
+  const Eigen::TensorOpCost cost(
+      new_rows_per_output_row * in_row_size * sizeof(T),
+      out_row_size * sizeof(float),
+      macs_per_output_row * (Eigen::TensorOpCost::AddCost<float>() +
+                             Eigen::TensorOpCost::MulCost<float>()));
+  d.parallelFor(batch_size * out_height, cost, resample_rows);
+}
+
+}  // namespace resampler_internal
+
+// Resamples `images` of shape [batch, in_height, in_width, channels] into
+// `output` of shape [batch, ys.out_size(), xs.out_size(), channels], sharding
+// the output rows across the threads of `d`.
+template <typename T>
+void ResampleImages(const Eigen::ThreadPoolDevice& d,
+                    typename TTypes<T, 4>::ConstTensor images,
+                    const ResampleFilter& ys, const ResampleFilter& xs,
+                    typename TTypes<float, 4>::Tensor output) {
+  DCHECK_EQ(ys.in_size(), images.dimension(1));
+  DCHECK_EQ(xs.in_size(), images.dimension(2));
+  DCHECK_EQ(ys.out_size(), output.dimension(1));
+  DCHECK_EQ(xs.out_size(), output.dimension(2));
+  if (output.size() == 0) return;
+  switch (images.dimension(3)) {
+    case 1:
+      resampler_internal::ResampleImages<1, T>(d, images, ys, xs, output);
+      break;
+    case 3:
+      resampler_internal::ResampleImages<3, T>(d, images, ys, xs, output);
+      break;
+    case 4:
+      resampler_internal::ResampleImages<4, T>(d, images, ys, xs, output);
+      break;
+    default:
+      resampler_internal::ResampleImages<-1, T>(d, images, ys, xs, output);
+      break;
+  }
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_IMAGE_RESAMPLER_H_
@@ -19,10 +19,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/matmul_op.h"
 
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/prepacked_matmul.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
@@ -146,6 +148,50 @@ struct LaunchMatMulCPU : LaunchMatMulBase<CPUDevice, T> {};
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
+// Multiplies few enough rows of `a` by the constant weights `b` for a packed
+// copy of the weights, kept in `cache` across calls, to pay off. Returns false
+// for the products left to LaunchMatMul, and if there is no cache because the
+// weights can change.
+template <typename Device, typename T>
+struct LaunchPrepackedMatMul {
+  static bool launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      PackedWeightsCache* cache, Tensor* out) {
+    return false;
+  }
+};
+
+template <>
+struct LaunchPrepackedMatMul<CPUDevice, float> {
+  static bool launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      PackedWeightsCache* cache, Tensor* out) {
+    const int64 m = out->dim_size(0);
+    const int64 n = out->dim_size(1);
+    // Products with a single row or column are better served by
+    // ExplicitVectorMatrixOptimization and Eigen's matrix-vector products.
+    if (cache == nullptr || m < 2 || n < 2 || m > kMaxPrepackedMatMulRows) {
+      return false;
+    }
+    const bool transpose_a = dim_pair[0].first == 0;
+    const bool transpose_b = dim_pair[0].second == 1;
+    const int64 k = a.dim_size(dim_pair[0].first);
+    std::shared_ptr<const PackedWeights> packed_b =
+        cache->Get(ctx, transpose_b, b.flat<float>().data(), k, n);
+    if (packed_b == nullptr) {
+      return false;
+    }
+    const Status status = packed_b->Multiply(
+        ctx, transpose_a, a.flat<float>().data(), m, out->flat<float>().data());
+    if (!status.ok()) {
+      ctx->SetStatus(status);
+    }
+    return true;
+  }
+};
+
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
 struct LaunchMatMulSYCL : LaunchMatMulBase<SYCLDevice, T> {};
@@ -446,6 +492,11 @@ class MatMulOp : public OpKernel {
     LaunchMatMul<Device, T, USE_CUBLAS>::GetBlasGemmAlgorithm(
         ctx, &algorithms_, &algorithms_set_already_);
     use_autotune_ = MatmulAutotuneEnable();
+    bool constant_weights = false;
+    if (ctx->GetAttr(kConstantWeightsAttrName, &constant_weights).ok() &&
+        constant_weights) {
+      weights_cache_.reset(new PackedWeightsCache);
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -513,7 +564,8 @@ class MatMulOp : public OpKernel {
           &out_float);
       FloatToBFloat16(out_float.flat<float>().data(),
                       out->flat<bfloat16>().data(), out->NumElements());
-    } else {
+    } else if (!LaunchPrepackedMatMul<Device, T>::launch(
+                   ctx, a, b, dim_pair, weights_cache_.get(), out)) {
       LaunchMatMul<Device, T, USE_CUBLAS>::launch(
           ctx, a, b, dim_pair, &algorithms_, use_autotune_, out);
     }
@@ -525,6 +577,8 @@ class MatMulOp : public OpKernel {
   bool use_autotune_;
   bool transpose_a_;
   bool transpose_b_;
+  // Only set if the graph marks b as a constant.
+  std::unique_ptr<PackedWeightsCache> weights_cache_;
 };
 
 namespace functor {
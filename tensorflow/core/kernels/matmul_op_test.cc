@@ -14,22 +14,92 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class MatMulOpTest : public OpsTestBase {
+ protected:
+  // Runs a small float MatMul several times and checks every result against
+  // a plain loop. If constant_weights is set, the graph marks the weights as
+  // a constant and the kernel multiplies by a packed copy of them. Otherwise
+  // the weights are changed in place between runs, as by an assignment.
+  void TestMatMul(bool transpose_a, bool transpose_b, bool constant_weights) {
+    const int m = 5;
+    const int k = 37;
+    const int n = 29;
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "MatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Attr(kConstantWeightsAttrName, constant_weights)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInput<float>(transpose_a ? TensorShape({k, m}) : TensorShape({m, k}),
+                    [](int i) { return (i % 7) * 0.25f - 0.5f; });
+    AddInput<float>(transpose_b ? TensorShape({n, k}) : TensorShape({k, n}),
+                    [](int i) { return (i % 11) * 0.125f - 0.75f; });
+    const auto a = mutable_input(0).tensor->matrix<float>();
+    auto b = mutable_input(1).tensor->matrix<float>();
+
+    // Changing weights are unchanged for the first runs, and then change on
+    // every run.
+    for (int run = 0; run < 10; ++run) {
+      if (!constant_weights && run >= 3) {
+        b(run % b.dimension(0), run % b.dimension(1)) += 1.0f;
+      }
+      Tensor expected(DT_FLOAT, TensorShape({m, n}));
+      auto expected_matrix = expected.matrix<float>();
+      for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+          float sum = 0;
+          for (int l = 0; l < k; ++l) {
+            sum += (transpose_a ? a(l, i) : a(i, l)) *
+                   (transpose_b ? b(j, l) : b(l, j));
+          }
+          expected_matrix(i, j) = sum;
+        }
+      }
+      TF_ASSERT_OK(RunOpKernel());
+      test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+    }
+  }
+};
+
+TEST_F(MatMulOpTest, ConstantWeights) { TestMatMul(false, false, true); }
+
+TEST_F(MatMulOpTest, ConstantWeightsTransposed) {
+  TestMatMul(true, true, true);
+}
+
+TEST_F(MatMulOpTest, ChangingWeights) { TestMatMul(false, false, false); }
+
+TEST_F(MatMulOpTest, ChangingWeightsTransposed) {
+  TestMatMul(true, true, false);
+}
+
 template <typename T>
 static Graph* Matmul(int m, int k, int n, bool transpose_a, bool transpose_b,
-                     DataType type) {
+                     DataType type, bool constant_weights = false) {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor in0(type, transpose_a ? TensorShape({k, m}) : TensorShape({m, k}));
   in0.flat<T>().setRandom();
   Tensor in1(type, transpose_b ? TensorShape({n, k}) : TensorShape({k, n}));
   in1.flat<T>().setRandom();
-  test::graph::Matmul(g, test::graph::Constant(g, in0),
-                      test::graph::Constant(g, in1), transpose_a, transpose_b);
+  Node* matmul =
+      test::graph::Matmul(g, test::graph::Constant(g, in0),
+                          test::graph::Constant(g, in1), transpose_a,
+                          transpose_b);
+  // As set by ConstantWeightsPass in a session, which the benchmarks skip.
+  if (constant_weights) matmul->AddAttr(kConstantWeightsAttrName, true);
   return g;
 }
 
@@ -53,6 +123,18 @@ static Graph* Matmul(int m, int k, int n, bool transpose_a, bool transpose_b,
 // BM_MatmulDev(M, K, N, TA, TB, double, DT_DOUBLE, gpu);                   \
 // BM_MatmulDev(M, K, N, TA, TB, std::complex<double>, DT_COMPLEX128, gpu);
 
+// Float products by weights that the graph marks as constant, which are
+// multiplied by a packed copy of the weights.
+#define BM_MatmulConstantWeights(M, K, N, TA, TB)                          \
+  static void BM_MatmulConstantWeights##_##M##_##K##_##N##_##TA##_##TB(    \
+      int iters) {                                                         \
+    testing::UseRealTime();                                                \
+    testing::ItemsProcessed(static_cast<int64>(iters) * M * K * N * 2);    \
+    test::Benchmark("cpu", Matmul<float>(M, K, N, TA, TB, DT_FLOAT, true)) \
+        .Run(iters);                                                       \
+  }                                                                        \
+  BENCHMARK(BM_MatmulConstantWeights##_##M##_##K##_##N##_##TA##_##TB);
+
 // Batch size of 1 included for inference.
 // Typical fully connected layers
 BM_Matmul(1, 512, 512, false, false);
@@ -66,6 +148,14 @@ BM_Matmul(16, 1024, 1024, false, false);
 BM_Matmul(128, 1024, 1024, false, false);
 BM_Matmul(4096, 4096, 4096, false, false);
 
+BM_MatmulConstantWeights(8, 512, 512, false, false);
+BM_MatmulConstantWeights(16, 512, 512, false, false);
+BM_MatmulConstantWeights(128, 512, 512, false, false);
+BM_MatmulConstantWeights(8, 1024, 1024, false, false);
+BM_MatmulConstantWeights(16, 1024, 1024, false, false);
+BM_MatmulConstantWeights(128, 1024, 1024, false, false);
+BM_MatmulConstantWeights(8, 1024, 1024, false, true);
+
 // Backward for fully connected layers
 BM_Matmul(1, 1024, 1024, false, true);
 BM_Matmul(8, 1024, 1024, false, true);
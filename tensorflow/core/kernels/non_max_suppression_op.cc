@@ -19,10 +19,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/non_max_suppression_op.h"
 
+#include <algorithm>
 #include <functional>
 #include <queue>
 #include <vector>
 
+#include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -194,6 +197,101 @@ void DoNonMaxSuppressionOp(
   std::copy_n(selected.begin(), selected.size(), output_indices_data.data());
 }
 
+// Greedily selects up to `max_output_size` of the `num_boxes` boxes of one
+// image and class in descending order of score, and returns their number.
+// Box `i` is at `boxes + i * box_stride` and its score at
+// `scores[i * score_stride]`. Boxes whose IOU with a selected box is greater
+// than `iou_threshold` are removed, as in DoNonMaxSuppressionOp. With a
+// positive `soft_nms_sigma` (Soft-NMS), the score of every other remaining box
+// decays by exp(-iou^2 / (2 * soft_nms_sigma)) instead, and the box is removed
+// once its score is no longer above `score_threshold`.
+//
+// The remaining boxes are kept as a structure of arrays, so that the IOUs of
+// a selected box with all of them are computed with vectorized Eigen array
+// expressions. Boxes of equal score are selected in order of index.
+int BatchedNonMaxSuppressionOne(const float* boxes, int64 box_stride,
+                                const float* scores, int64 score_stride,
+                                int num_boxes, int max_output_size,
+                                float iou_threshold, float score_threshold,
+                                float soft_nms_sigma, int* selected_indices,
+                                float* selected_scores) {
+  std::vector<int> order;
+  for (int i = 0; i < num_boxes; ++i) {
+    if (scores[i * score_stride] > score_threshold) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [=](int i, int j) {
+    return scores[i * score_stride] > scores[j * score_stride];
+  });
+
+  int num_remaining = order.size();
+  Eigen::ArrayXf ymin(num_remaining), xmin(num_remaining);
+  Eigen::ArrayXf ymax(num_remaining), xmax(num_remaining);
+  Eigen::ArrayXf score(num_remaining);
+  std::vector<int> index(order);
+  for (int j = 0; j < num_remaining; ++j) {
+    const float* box = boxes + order[j] * box_stride;
+    ymin(j) = std::min(box[0], box[2]);
+    xmin(j) = std::min(box[1], box[3]);
+    ymax(j) = std::max(box[0], box[2]);
+    xmax(j) = std::max(box[1], box[3]);
+    score(j) = scores[order[j] * score_stride];
+  }
+  Eigen::ArrayXf area = (ymax - ymin) * (xmax - xmin);
+  Eigen::ArrayXf iou(num_remaining);
+  const float decay_scale = soft_nms_sigma > 0 ? -0.5f / soft_nms_sigma : 0;
+
+  int num_selected = 0;
+  while (num_selected < max_output_size && num_remaining > 0) {
+    const int n = num_remaining;
+    // Without Soft-NMS the scores don't change, and the remaining boxes stay
+    // sorted.
+    int next = 0;
+    if (decay_scale != 0) {
+      score.head(n).maxCoeff(&next);
+    }
+    selected_indices[num_selected] = index[next];
+    selected_scores[num_selected] = score(next);
+    ++num_selected;
+
+    // As in IOUGreaterThanThreshold, boxes with an empty area don't overlap.
+    if (area(next) > 0) {
+      const auto intersection =
+          (ymax.head(n).min(ymax(next)) - ymin.head(n).max(ymin(next)))
+              .max(0.0f) *
+          (xmax.head(n).min(xmax(next)) - xmin.head(n).max(xmin(next)))
+              .max(0.0f);
+      iou.head(n) = (area.head(n) > 0.0f)
+                        .select(intersection /
+                                    (area.head(n) + area(next) - intersection),
+                                0.0f);
+    } else {
+      iou.head(n).setZero();
+    }
+    if (decay_scale != 0) {
+      score.head(n) *= (decay_scale * iou.head(n).square()).exp();
+    }
+
+    // Keep the boxes that are neither selected nor removed, in order.
+    num_remaining = 0;
+    for (int j = 0; j < n; ++j) {
+      if (j == next || iou(j) > iou_threshold || score(j) <= score_threshold) {
+        continue;
+      }
+      const int k = num_remaining++;
+      ymin(k) = ymin(j);
+      xmin(k) = xmin(j);
+      ymax(k) = ymax(j);
+      xmax(k) = xmax(j);
+      area(k) = area(j);
+      score(k) = score(j);
+      index[k] = index[j];
+    }
+  }
+  return num_selected;
+}
+
 }  // namespace
 
 template <typename Device>
@@ -423,6 +521,117 @@ class NonMaxSuppressionWithOverlapsOp : public OpKernel {
   }
 };
 
+template <typename Device>
+class BatchedNonMaxSuppressionOp : public OpKernel {
+ public:
+  explicit BatchedNonMaxSuppressionOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_boxes, q, 4]
+    const Tensor& boxes = context->input(0);
+    // scores: [batch_size, num_boxes, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, boxes.dims() == 4 && boxes.dim_size(3) == 4,
+                errors::InvalidArgument(
+                    "boxes must be of shape [batch_size, num_boxes, q, 4], "
+                    "got shape ",
+                    boxes.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 3,
+                errors::InvalidArgument(
+                    "scores must be of shape [batch_size, num_boxes, "
+                    "num_classes], got shape ",
+                    scores.shape().DebugString()));
+    const int64 batch_size = boxes.dim_size(0);
+    const int num_boxes = boxes.dim_size(1);
+    const int q = boxes.dim_size(2);
+    const int num_classes = scores.dim_size(2);
+    OP_REQUIRES(context,
+                scores.dim_size(0) == batch_size &&
+                    scores.dim_size(1) == num_boxes,
+                errors::InvalidArgument("scores has incompatible shape"));
+    OP_REQUIRES(context, q == 1 || q == num_classes,
+                errors::InvalidArgument(
+                    "boxes must have 1 or num_classes boxes per anchor, got ",
+                    q, " for ", num_classes, " classes"));
+
+    const Tensor& max_output_size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_output_size.shape()),
+        errors::InvalidArgument("max_output_size must be 0-D, got shape ",
+                                max_output_size.shape().DebugString()));
+    const int max_output_size_val = max_output_size.scalar<int>()();
+    OP_REQUIRES(context, max_output_size_val >= 0,
+                errors::InvalidArgument("max_output_size must be >= 0"));
+    const Tensor& iou_threshold = context->input(3);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(iou_threshold.shape()),
+                errors::InvalidArgument("iou_threshold must be 0-D, got shape ",
+                                        iou_threshold.shape().DebugString()));
+    const float iou_threshold_val = iou_threshold.scalar<float>()();
+    OP_REQUIRES(context, iou_threshold_val >= 0 && iou_threshold_val <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+    const Tensor& score_threshold = context->input(4);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(score_threshold.shape()),
+        errors::InvalidArgument("score_threshold must be 0-D, got shape ",
+                                score_threshold.shape().DebugString()));
+    const float score_threshold_val = score_threshold.scalar<float>()();
+    const Tensor& soft_nms_sigma = context->input(5);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(soft_nms_sigma.shape()),
+        errors::InvalidArgument("soft_nms_sigma must be 0-D, got shape ",
+                                soft_nms_sigma.shape().DebugString()));
+    const float soft_nms_sigma_val = soft_nms_sigma.scalar<float>()();
+    OP_REQUIRES(context, soft_nms_sigma_val >= 0,
+                errors::InvalidArgument("soft_nms_sigma must be >= 0"));
+
+    Tensor* selected_indices = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, num_classes,
+                                       max_output_size_val}),
+                       &selected_indices));
+    Tensor* selected_scores = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       1, TensorShape({batch_size, num_classes,
+                                       max_output_size_val}),
+                       &selected_scores));
+    Tensor* valid_outputs = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       2, TensorShape({batch_size, num_classes}),
+                       &valid_outputs));
+    auto indices_data = selected_indices->tensor<int, 3>();
+    auto scores_data = selected_scores->tensor<float, 3>();
+    auto valid_data = valid_outputs->matrix<int>();
+    indices_data.setZero();
+    scores_data.setZero();
+
+    const float* boxes_data = boxes.flat<float>().data();
+    const float* input_scores_data = scores.flat<float>().data();
+    // Every image and class is an independent task.
+    auto suppress = [&](int64 begin, int64 end) {
+      for (int64 task = begin; task < end; ++task) {
+        const int64 b = task / num_classes;
+        const int c = task % num_classes;
+        valid_data(b, c) = BatchedNonMaxSuppressionOne(
+            boxes_data + (b * num_boxes * q + (q == 1 ? 0 : c)) * 4, q * 4,
+            input_scores_data + b * num_boxes * num_classes + c, num_classes,
+            num_boxes, max_output_size_val, iou_threshold_val,
+            score_threshold_val, soft_nms_sigma_val, &indices_data(b, c, 0),
+            &scores_data(b, c, 0));
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_task =
+        10 * static_cast<int64>(num_boxes) *
+        (std::min(max_output_size_val, num_boxes) + 1);
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch_size * num_classes, cost_per_task, suppress);
+  }
+};
+
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression").Device(DEVICE_CPU),
                         NonMaxSuppressionOp<CPUDevice>);
 
@@ -454,4 +663,7 @@ REGISTER_KERNEL_BUILDER(
     Name("NonMaxSuppressionWithOverlaps").Device(DEVICE_CPU),
     NonMaxSuppressionWithOverlapsOp<CPUDevice>);
 
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression").Device(DEVICE_CPU),
+                        BatchedNonMaxSuppressionOp<CPUDevice>);
+
 }  // namespace tensorflow
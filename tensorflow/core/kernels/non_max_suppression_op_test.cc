@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -861,4 +863,105 @@ TEST_F(NonMaxSuppressionWithOverlapsOpTest, TestEmptyInput) {
   test::ExpectTensorEqual<int>(expected, *GetOutput(0));
 }
 
+//
+// BatchedNonMaxSuppressionOp Tests
+//
+
+class BatchedNonMaxSuppressionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_EXPECT_OK(NodeDefBuilder("non_max_suppression_op",
+                                "BatchedNonMaxSuppression")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestSelectPerImageAndClass) {
+  MakeOp();
+  // Two images with the same boxes, shared by two classes.
+  const std::vector<float> boxes = {0, 0,  1, 1,  0, 0.1f,  1, 1.1f,
+                                    0, -0.1f, 1, 0.9f, 0, 10, 1, 11,
+                                    0, 10.1f, 1, 11.1f, 0, 100, 1, 101};
+  std::vector<float> batch_boxes(boxes);
+  batch_boxes.insert(batch_boxes.end(), boxes.begin(), boxes.end());
+  AddInputFromArray<float>(TensorShape({2, 6, 1, 4}), batch_boxes);
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 2}),
+      {.9f, .3f, .75f, .5f, .6f, .95f, .95f, .6f, .5f, .75f, .3f, .9f,
+       .1f, .1f, .1f, .1f, .1f, .1f, .1f, .1f, .1f, .1f, .1f, .1f});
+  AddInputFromArray<int>(TensorShape({}), {5});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {.2f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_indices(allocator(), DT_INT32, TensorShape({2, 2, 5}));
+  test::FillValues<int>(&expected_indices, {3, 0, 5, 0, 0, 2, 5, 4, 0, 0,
+                                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+  test::ExpectTensorEqual<int>(expected_indices, *GetOutput(0));
+  Tensor expected_scores(allocator(), DT_FLOAT, TensorShape({2, 2, 5}));
+  test::FillValues<float>(&expected_scores,
+                          {.95f, .9f, .3f, 0, 0, .95f, .9f, .75f, 0, 0,
+                           0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+  test::ExpectTensorEqual<float>(expected_scores, *GetOutput(1));
+  Tensor expected_valid(allocator(), DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&expected_valid, {3, 3, 0, 0});
+  test::ExpectTensorEqual<int>(expected_valid, *GetOutput(2));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestSoftNMS) {
+  MakeOp();
+  AddInputFromArray<float>(
+      TensorShape({1, 4, 1, 4}),
+      {0, 0, 1, 1, 0, 0.1f, 1, 1.1f, 0, 10, 1, 11, 0, 0.5f, 1, 1.5f});
+  AddInputFromArray<float>(TensorShape({1, 4, 1}), {.9f, .8f, .7f, .6f});
+  AddInputFromArray<int>(TensorShape({}), {4});
+  AddInputFromArray<float>(TensorShape({}), {.9f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Boxes 1 and 3 overlap box 0 below the IOU threshold, so their scores
+  // decay by exp(-iou^2) instead of being removed, and box 3 overtakes box 1.
+  const float iou_0_1 = 0.9f / 1.1f;
+  const float iou_0_3 = 1.0f / 3;
+  const float iou_3_1 = 0.6f / 1.4f;
+  Tensor expected_indices(allocator(), DT_INT32, TensorShape({1, 1, 4}));
+  test::FillValues<int>(&expected_indices, {0, 2, 3, 1});
+  test::ExpectTensorEqual<int>(expected_indices, *GetOutput(0));
+  Tensor expected_scores(allocator(), DT_FLOAT, TensorShape({1, 1, 4}));
+  test::FillValues<float>(
+      &expected_scores,
+      {.9f, .7f, .6f * std::exp(-iou_0_3 * iou_0_3),
+       .8f * std::exp(-iou_0_1 * iou_0_1 - iou_3_1 * iou_3_1)});
+  test::ExpectClose(expected_scores, *GetOutput(1));
+  Tensor expected_valid(allocator(), DT_INT32, TensorShape({1, 1}));
+  test::FillValues<int>(&expected_valid, {4});
+  test::ExpectTensorEqual<int>(expected_valid, *GetOutput(2));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestInconsistentBoxesPerClass) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 1, 3, 4}),
+                           {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {.9f, .8f});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  Status s = RunOpKernel();
+
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(str_util::StrContains(
+      s.ToString(), "boxes must have 1 or num_classes boxes per anchor"))
+      << s;
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,174 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/prepacked_matmul.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+typedef Eigen::internal::gebp_traits<float, float> Traits;
+typedef Eigen::internal::const_blas_data_mapper<float, int64, Eigen::ColMajor>
+    ColMajorMapper;
+typedef Eigen::internal::const_blas_data_mapper<float, int64, Eigen::RowMajor>
+    RowMajorMapper;
+typedef Eigen::internal::blas_data_mapper<float, int64, Eigen::ColMajor>
+    OutputMapper;
+typedef Eigen::internal::gebp_kernel<float, float, int64, OutputMapper,
+                                     Traits::mr, Traits::nr, false, false>
+    Kernel;
+
+template <typename Mapper, int StorageOrder>
+using LhsPacker =
+    Eigen::internal::gemm_pack_lhs<float, int64, Mapper, Traits::mr,
+                                   Traits::LhsProgress, StorageOrder>;
+template <typename Mapper, int StorageOrder>
+using RhsPacker = Eigen::internal::gemm_pack_rhs<float, int64, Mapper,
+                                                 Traits::nr, StorageOrder>;
+
+// The packed blocks start at multiples of 16 floats, so that the kernel can
+// load the lhs panels with aligned loads, as it does in Eigen.
+constexpr int64 kBlockAlignment = 16;
+
+// The weight rows multiplied by one shard of a product, in lhs panels.
+constexpr int64 kPanelsPerShard = 4;
+
+int64 RoundUp(int64 value, int64 multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+PackedWeights::PackedWeights(bool transpose, const float* weights, int64 k,
+                             int64 n)
+    : k_(k), n_(n) {
+  // The depth blocks are the ones Eigen picks for the caches, for a product
+  // with as many rows as the packed products may have.
+  int64 depth_block = k;
+  int64 rows_block = n;
+  int64 cols_block = kMaxPrepackedMatMulRows;
+  Eigen::internal::computeProductBlockingSizes<float, float, 1>(
+      depth_block, rows_block, cols_block);
+  depth_block_ = std::max<int64>(1, depth_block);
+
+  // weights^T is the n x k lhs, which is column major with stride n if the
+  // weights are not transposed, and row major with stride k otherwise.
+  const int64 block_size = RoundUp(depth_block_ * n_, kBlockAlignment);
+  const int64 num_blocks = (k_ + depth_block_ - 1) / depth_block_;
+  packed_ = Tensor(DT_FLOAT, TensorShape({num_blocks * block_size}));
+  float* packed = packed_.flat<float>().data();
+  for (int64 block = 0; block < num_blocks; ++block) {
+    const int64 depth_begin = block * depth_block_;
+    const int64 depth = std::min(depth_block_, k_ - depth_begin);
+    float* packed_block = packed + block * block_size;
+    if (transpose) {
+      const RowMajorMapper lhs(weights, k_);
+      LhsPacker<RowMajorMapper, Eigen::RowMajor>()(
+          packed_block, lhs.getSubMapper(0, depth_begin), depth, n_);
+    } else {
+      const ColMajorMapper lhs(weights, n_);
+      LhsPacker<ColMajorMapper, Eigen::ColMajor>()(
+          packed_block, lhs.getSubMapper(0, depth_begin), depth, n_);
+    }
+  }
+}
+
+Status PackedWeights::Multiply(OpKernelContext* context, bool transpose_in,
+                               const float* in, int64 m, float* out) const {
+  // in^T is the k x m rhs, which is column major with stride k if the input
+  // is not transposed, and row major with stride m otherwise. It is packed
+  // with the same depth blocks as the weights.
+  const int64 in_block_size = RoundUp(depth_block_ * m, kBlockAlignment);
+  const int64 num_blocks = (k_ + depth_block_ - 1) / depth_block_;
+  Tensor packed_in_tensor;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_FLOAT, TensorShape({num_blocks * in_block_size}), &packed_in_tensor));
+  float* packed_in = packed_in_tensor.flat<float>().data();
+  for (int64 block = 0; block < num_blocks; ++block) {
+    const int64 depth_begin = block * depth_block_;
+    const int64 depth = std::min(depth_block_, k_ - depth_begin);
+    float* packed_block = packed_in + block * in_block_size;
+    if (transpose_in) {
+      const RowMajorMapper rhs(in, m);
+      RhsPacker<RowMajorMapper, Eigen::RowMajor>()(
+          packed_block, rhs.getSubMapper(depth_begin, 0), depth, m);
+    } else {
+      const ColMajorMapper rhs(in, k_);
+      RhsPacker<ColMajorMapper, Eigen::ColMajor>()(
+          packed_block, rhs.getSubMapper(depth_begin, 0), depth, m);
+    }
+  }
+
+  // out^T is the n x m result, column major with stride n. Each shard
+  // computes a range of its rows, which start at a multiple of the height of
+  // the lhs panels, where the panels of a packed block start at row * depth.
+  const float* packed = packed_.flat<float>().data();
+  const int64 block_size = RoundUp(depth_block_ * n_, kBlockAlignment);
+  const int64 shard_rows = Traits::mr * kPanelsPerShard;
+  const int64 num_shards = (n_ + shard_rows - 1) / shard_rows;
+  auto multiply_rows = [&](int64 start, int64 limit) {
+    const OutputMapper out_mapper(out, n_);
+    for (int64 shard = start; shard < limit; ++shard) {
+      const int64 row_begin = shard * shard_rows;
+      const int64 rows = std::min(shard_rows, n_ - row_begin);
+      for (int64 j = 0; j < m; ++j) {
+        memset(out + j * n_ + row_begin, 0, rows * sizeof(float));
+      }
+      for (int64 block = 0; block < num_blocks; ++block) {
+        const int64 depth = std::min(depth_block_, k_ - block * depth_block_);
+        Kernel()(out_mapper.getSubMapper(row_begin, 0),
+                 packed + block * block_size + row_begin * depth,
+                 packed_in + block * in_block_size, rows, depth, m, 1.0f);
+      }
+    }
+  };
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_shards,
+        shard_rows * k_ * m, multiply_rows);
+  return Status::OK();
+}
+
+std::shared_ptr<const PackedWeights> PackedWeightsCache::Get(
+    OpKernelContext* context, bool transpose, const float* weights, int64 k,
+    int64 n) {
+  if (k == 0 || n == 0) return nullptr;
+  mutex_lock l(mu_);
+  if (packed_ != nullptr && transpose == transpose_ && k == packed_->k() &&
+      n == packed_->n()) {
+    return packed_;
+  }
+  packed_ = std::make_shared<const PackedWeights>(transpose, weights, k, n);
+  transpose_ = transpose;
+  const int64 bytes = packed_->size_bytes();
+  if (bytes > reported_bytes_) {
+    context->record_persistent_memory_allocation(bytes - reported_bytes_);
+    reported_bytes_ = bytes;
+  }
+  VLOG(1) << "Packed the " << k << "x" << n << " weights of "
+          << context->op_kernel().name() << ", using " << bytes << " bytes";
+  return packed_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,99 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Float matrix products against weights packed once for Eigen's GEBP kernel.
+//
+// Eigen's contraction packs both operands into the panel layout of its GEBP
+// kernel on every call. For a product of a few input rows by a constant
+// weight matrix, as in small-batch inference, packing the weights takes a
+// large share of the time of the product. Kernels whose weights are
+// constant keep a PackedWeightsCache, which packs the weights once and
+// multiplies later inputs by the packed copy.
+
+#ifndef TENSORFLOW_CORE_KERNELS_PREPACKED_MATMUL_H_
+#define TENSORFLOW_CORE_KERNELS_PREPACKED_MATMUL_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// The most input rows multiplied by packed weights. Larger products spend
+// little of their time packing the weights, and are left to Eigen's
+// contraction, which blocks both operands for the caches.
+constexpr int64 kMaxPrepackedMatMulRows = 128;
+
+// The weights of products out = in * weights, a k x n float matrix packed
+// into the lhs panels of Eigen's GEBP kernel. The products are computed
+// transposed, as out^T = weights^T * in^T, the way Eigen multiplies row major
+// tensors, so that the weights are the operand that is packed once.
+class PackedWeights {
+ public:
+  // Packs `weights`, which is a row major k x n matrix if transpose is false,
+  // and a row major n x k matrix otherwise.
+  PackedWeights(bool transpose, const float* weights, int64 k, int64 n);
+
+  int64 k() const { return k_; }
+  int64 n() const { return n_; }
+  // The memory used by the packed copy, in bytes.
+  int64 size_bytes() const { return packed_.AllocatedBytes(); }
+
+  // Computes out = in * weights, where `in` is a row major m x k matrix if
+  // transpose_in is false and a row major k x m matrix otherwise, and `out`
+  // is a row major m x n matrix.
+  Status Multiply(OpKernelContext* context, bool transpose_in, const float* in,
+                  int64 m, float* out) const;
+
+ private:
+  const int64 k_;
+  const int64 n_;
+  // The depth of the blocks of the product. The weights are packed block by
+  // block, the rows of block d starting at d * depth_block_ * n_.
+  int64 depth_block_;
+  Tensor packed_;
+};
+
+// Keeps the packed copy of the weights of a kernel that the graph marks with
+// kConstantWeightsAttrName, and packs them again only if their shape
+// changes. The contents of the weights are never checked again, so a cache
+// must not be used for weights that can change, such as variables.
+class PackedWeightsCache {
+ public:
+  // Returns the packed copy of `weights`, laid out as for the constructor of
+  // PackedWeights, or null if the weights are empty. Reports the memory of
+  // new copies to `context`.
+  std::shared_ptr<const PackedWeights> Get(OpKernelContext* context,
+                                           bool transpose,
+                                           const float* weights, int64 k,
+                                           int64 n);
+
+ private:
+  mutex mu_;
+  bool transpose_ GUARDED_BY(mu_) = false;
+  std::shared_ptr<const PackedWeights> packed_ GUARDED_BY(mu_);
+  // The largest memory use of the cache reported so far.
+  int64 reported_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PREPACKED_MATMUL_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -75,6 +76,17 @@ class QuantizedBiasAddOp : public OpKernel {
                              bias_ui8_array.size(), input_min, input_max,
                              bias_min, bias_max, total_min, total_max,
                              output->flat<qint32>().data());
+    } else if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
+               std::is_same<T3, qint32>()) {
+      auto input_ui8_array = input.flat<quint8>();
+      auto bias_ui8_array = bias.flat<quint8>();
+      GetOutputMinAndMaxForQuantizedAdd(input_min, input_max, bias_min,
+                                        bias_max, &total_min, &total_max);
+      quantized_gemm::BiasAdd(
+          context->template eigen_device<CPUDevice>(), input_ui8_array.data(),
+          input_ui8_array.size(), bias_ui8_array.data(), bias_ui8_array.size(),
+          input_min, input_max, bias_min, bias_max, total_min, total_max,
+          output->flat<qint32>().data());
     } else {
       QuantizedAddUsingEigen<T1, T2, T3>(
           context->template eigen_device<CPUDevice>(), input, input_min,
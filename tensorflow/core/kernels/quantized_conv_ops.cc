@@ -16,18 +16,18 @@ limitations under the License.
 // Implements quantized eight-bit versions of the convolution operations.
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 #define EIGEN_USE_THREADS
 
-#define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
-#include "public/gemmlowp.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/conv_ops.h"
-#include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/padding.h"
@@ -57,7 +57,8 @@ class ReferenceConvFunctor {
                   int filter_height, int filter_width, int filter_count,
                   int filter_offset, int stride, Padding padding,
                   T3* output_data, int output_height, int output_width,
-                  int output_shift, int output_offset, int output_mult) {
+                  int output_shift, int output_offset, int output_mult,
+                  quantized_gemm::PackedRhsCache* filter_cache) {
     // Set up some constants we need for the output down-shifting and
     // saturation.
     const int32 highest = static_cast<int32>(Eigen::NumTraits<T3>::highest());
@@ -203,7 +204,8 @@ class Im2ColConvFunctor {
                   int filter_height, int filter_width, int filter_count,
                   int filter_offset, int stride, Padding padding,
                   T3* output_data, int output_height, int output_width,
-                  int output_shift, int output_offset, int output_mult) {
+                  int output_shift, int output_offset, int output_mult,
+                  quantized_gemm::PackedRhsCache* filter_cache) {
     if (input_offset < 0) {
       // Only log the first few occurrences of this warning.
       static int warning_count = 0;
@@ -223,7 +225,7 @@ class Im2ColConvFunctor {
                    input_width, input_depth, input_offset, filter_data,
                    filter_height, filter_width, filter_count, filter_offset,
                    stride, padding, output_data, output_height, output_width,
-                   output_shift, output_offset, output_mult);
+                   output_shift, output_offset, output_mult, filter_cache);
       return;
     }
 
@@ -289,6 +291,28 @@ class Im2ColConvFunctor {
     core::ScopedUnref unref_buffer(im2col_buffer_resource);
     T1* im2col_buffer = im2col_buffer_resource->data;
 
+    // The optimized eight-bit gemm only works for a particular set of data
+    // types, so check if we meet those requirements and fall back to a slower
+    // reference implementation if not.
+    const bool use_quantized_gemm =
+        std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
+        std::is_same<T3, qint32>() && (output_offset == 0) &&
+        (output_mult == 1) && (output_shift == 0);
+    // The filter is the same for every chunk, so it's packed once per call,
+    // or taken from filter_cache if it's a constant of the graph.
+    std::shared_ptr<const quantized_gemm::PackedRhs> packed_filter;
+    if (use_quantized_gemm && quantized_gemm::HasPackedKernels()) {
+      if (filter_cache != nullptr) {
+        packed_filter = filter_cache->Get(/*transpose_b=*/false, filter_data,
+                                          filter_value_count, filter_count,
+                                          filter_count);
+      } else {
+        packed_filter = std::make_shared<const quantized_gemm::PackedRhs>(
+            /*transpose_b=*/false, filter_data, filter_value_count,
+            filter_count, filter_count);
+      }
+    }
+
     const int64 patch_count = (input_batches * output_height * output_width);
     const int64 chunk_count =
         (patch_count + (patches_per_chunk - 1)) / patches_per_chunk;
@@ -384,57 +408,16 @@ class Im2ColConvFunctor {
       const int ldc = filter_count;
       T3* chunk_output_data = output_data + (patch_index_start * filter_count);
 
-      if (meta::IsSupportedAndEnabled() && std::is_same<T1, quint8>() &&
-          std::is_same<T2, quint8>() && std::is_same<T3, qint32>() &&
-          (output_offset == 0) && (output_mult == 1) && (output_shift == 0) &&
-          (transpose_c == false) && (k <= 2048)) {
-        meta::QuantizedGemm(context, transpose_a, transpose_b, im2col_buffer,
-                            filter_data, chunk_output_data, m, n, k,
-                            -input_offset, -filter_offset, lda, ldb, ldc);
-      } else if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
-                 std::is_same<T3, qint32>() && (output_offset == 0) &&
-                 (output_mult == 1) && (output_shift == 0)) {
-        // The gemmlowp optimized library only works for a particular set of
-        // data types, so check if we meet those requirements and fall back to a
-        // slower reference implementation if not.
-        const uint8* im2col_data_as_uint8 = &(im2col_buffer->value);
-        const uint8* filter_data_as_uint8 = &(filter_data->value);
-        int32* output_data_as_int32 = &(chunk_output_data->value);
-        // All of the transpose_* variables are currently compile-time consts,
-        // so we could just hard-code these values too, but that would break if
-        // anybody changed those values in the future (e.g. to match the ability
-        // of MatMul to specify them as attributes). We're using a verbose
-        // approach of deriving the order values from the transpose variables to
-        // be able to catch any changes like that.
-        static const gemmlowp::MapOrder ResultOrder =
-            !transpose_c ? gemmlowp::MapOrder::RowMajor
-                         : gemmlowp::MapOrder::ColMajor;
-        static const gemmlowp::MapOrder LhsOrder =
-            !transpose_a ? gemmlowp::MapOrder::RowMajor
-                         : gemmlowp::MapOrder::ColMajor;
-        static const gemmlowp::MapOrder RhsOrder =
-            !transpose_b ? gemmlowp::MapOrder::RowMajor
-                         : gemmlowp::MapOrder::ColMajor;
-        gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(
-            im2col_data_as_uint8, m, k, lda);
-        gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(
-            filter_data_as_uint8, k, n, ldb);
-        gemmlowp::MatrixMap<std::int32_t, ResultOrder> result(
-            output_data_as_int32, m, n, ldc);
-        const std::tuple<> empty_pipeline = {};
-
-        auto& worker_threads =
-            *(context->device()->tensorflow_cpu_worker_threads());
-        TensorflowGemmContext context(worker_threads.num_threads,
-                                      worker_threads.workers);
-        gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                         gemmlowp::DefaultL8R8BitDepthParams>(
-            &context, lhs, rhs, &result, -input_offset, -filter_offset,
-            empty_pipeline);
-        // Since gemmlowp uses assembly to write to the output, msan won't
-        // detect the output buffer as written to, so we mark it manually.
-        TF_ANNOTATE_MEMORY_IS_INITIALIZED(output_data_as_int32,
-                                          m * n * sizeof(int32));
+      if (packed_filter != nullptr) {
+        quantized_gemm::Gemm(context->eigen_device<Eigen::ThreadPoolDevice>(),
+                             transpose_a, im2col_buffer, m, lda, -input_offset,
+                             *packed_filter, -filter_offset,
+                             chunk_output_data, ldc);
+      } else if (use_quantized_gemm && (transpose_c == false)) {
+        quantized_gemm::Gemm(context, transpose_a, transpose_b, im2col_buffer,
+                             filter_data, chunk_output_data, m, n, k,
+                             -input_offset, -filter_offset, lda, ldb, ldc,
+                             /*rhs_cache=*/nullptr);
       } else {
         ReferenceGemm<T1, T2, T3>(
             transpose_a, transpose_b, transpose_c, m, n, k, im2col_buffer,
@@ -477,6 +460,11 @@ class QuantizedConv2DOp : public OpKernel {
                     "Current implementation does not yet support "
                     "dilations in the batch and depth dimensions."));
     OP_REQUIRES_OK(context, context->GetAttr("padding", &padding_));
+    bool constant_filter = false;
+    if (context->GetAttr(kConstantWeightsAttrName, &constant_filter).ok() &&
+        constant_filter) {
+      filter_cache_.reset(new quantized_gemm::PackedRhsCache);
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -562,7 +550,7 @@ class QuantizedConv2DOp : public OpKernel {
                  input_cols, in_depth, offset_input, filter.flat<T2>().data(),
                  filter_rows, filter_cols, out_depth, offset_filter, stride,
                  padding_, output->flat<T3>().data(), out_rows, out_cols,
-                 shift_output, offset_output, mult_output);
+                 shift_output, offset_output, mult_output, filter_cache_.get());
 
     float min_output_value;
     float max_output_value;
@@ -582,6 +570,8 @@ class QuantizedConv2DOp : public OpKernel {
  private:
   std::vector<int32> strides_;
   Padding padding_;
+  // Only set if the graph marks the filter as a constant.
+  std::unique_ptr<quantized_gemm::PackedRhsCache> filter_cache_;
 };
 
 // Right now we only support taking two eight bit inputs, and returning the
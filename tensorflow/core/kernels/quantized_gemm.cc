@@ -0,0 +1,573 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/quantized_gemm.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
+#include "public/gemmlowp.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/meta_support.h"
+#include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+// The x86 kernels are compiled for AVX2 and AVX-512 VNNI with function
+// target attributes, whatever the flags of the build, and are only called
+// on CPUs that have these instructions.
+#if (defined(__x86_64__) || defined(__i386__)) &&    \
+    ((defined(__clang__) && __clang_major__ >= 6) || \
+     (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8))
+#define QUANTIZED_GEMM_USE_X86_KERNELS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace quantized_gemm {
+
+namespace {
+
+// The columns of a panel of the packed rhs.
+constexpr int kPanelWidth = 16;
+// The most lhs rows multiplied by one call of a kernel, which keeps all its
+// accumulators in the 32 zmm registers with VNNI and the 16 ymm registers
+// with AVX2.
+constexpr int kMaxKernelRows = 8;
+// The lhs rows and rhs panels of one unit of the sharded work.
+constexpr int kBlockRows = 64;
+constexpr int kBlockPanels = 4;
+
+enum class KernelKind { kNone, kAvx2, kAvx512Vnni };
+
+#ifdef QUANTIZED_GEMM_USE_X86_KERNELS
+
+// The bits of XCR0 for the state of the registers used by the kernels: XMM
+// and YMM for AVX2, and the opmask and ZMM registers as well for AVX-512.
+constexpr uint64 kXcr0AvxState = 0x6;
+constexpr uint64 kXcr0Avx512State = kXcr0AvxState | 0xe0;
+
+// Returns true if the OS saves and restores the register state in
+// `xcr0_mask`, which the kernels need on top of the CPU features: an OS can
+// leave the AVX-512 state disabled on a CPU that has AVX-512.
+bool OsSavesState(uint64 xcr0_mask) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+    return false;
+  }
+  uint32 xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  const uint64 xcr0 = (static_cast<uint64>(xcr0_high) << 32) | xcr0_low;
+  return (xcr0 & xcr0_mask) == xcr0_mask;
+}
+
+#endif  // QUANTIZED_GEMM_USE_X86_KERNELS
+
+KernelKind GetKernelKind() {
+  static const KernelKind kind = [] {
+#ifdef QUANTIZED_GEMM_USE_X86_KERNELS
+    if (port::TestCPUFeature(port::CPUFeature::AVX512F) &&
+        port::TestCPUFeature(port::CPUFeature::AVX512_VNNI) &&
+        OsSavesState(kXcr0Avx512State)) {
+      return KernelKind::kAvx512Vnni;
+    }
+    if (port::TestCPUFeature(port::CPUFeature::AVX2) &&
+        OsSavesState(kXcr0AvxState)) {
+      return KernelKind::kAvx2;
+    }
+#endif
+    return KernelKind::kNone;
+  }();
+  return kind;
+}
+
+// The lhs rows multiplied by one call of the kernel of `kind`.
+int KernelRows(KernelKind kind) {
+  return kind == KernelKind::kAvx512Vnni ? kMaxKernelRows : 6;
+}
+
+// The number of rows of the rhs that the kernels consume in each step.
+int KernelDepth(KernelKind kind) {
+  return kind == KernelKind::kAvx512Vnni ? 4 : 2;
+}
+
+int64 RoundUp(int64 value, int64 multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+#ifdef QUANTIZED_GEMM_USE_X86_KERNELS
+
+// Multiplies kRows rows of the packed lhs `a`, each of k_padded uint8 values,
+// by a panel of the packed rhs `b`, and stores the kRows x kPanelWidth
+// results in `tile`. Each VPDPBUSD adds the products of four uint8 values of
+// a row with four int8 values of each of the 16 columns.
+template <int kRows>
+__attribute__((target("avx512f,avx512vnni"))) void KernelAvx512Vnni(
+    const uint8* a, int k_padded, const int8* b, int32* tile) {
+  __m512i acc[kRows];
+#pragma GCC unroll 8
+  for (int r = 0; r < kRows; ++r) {
+    acc[r] = _mm512_setzero_si512();
+  }
+  for (int l = 0; l < k_padded; l += 4) {
+    const __m512i b_values = _mm512_loadu_si512(b);
+    b += 4 * kPanelWidth;
+#pragma GCC unroll 8
+    for (int r = 0; r < kRows; ++r) {
+      int32 a_values;
+      memcpy(&a_values, a + r * k_padded + l, sizeof(a_values));
+      acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(a_values),
+                                   b_values);
+    }
+  }
+#pragma GCC unroll 8
+  for (int r = 0; r < kRows; ++r) {
+    _mm512_storeu_si512(tile + r * kPanelWidth, acc[r]);
+  }
+}
+
+// As above for a lhs and rhs of int16 values, where each VPMADDWD adds the
+// products of two values of a row with two values of each of 8 columns.
+template <int kRows>
+__attribute__((target("avx2"))) void KernelAvx2(const int16* a, int k_padded,
+                                                const int16* b, int32* tile) {
+  __m256i acc_low[kRows];
+  __m256i acc_high[kRows];
+#pragma GCC unroll 8
+  for (int r = 0; r < kRows; ++r) {
+    acc_low[r] = _mm256_setzero_si256();
+    acc_high[r] = _mm256_setzero_si256();
+  }
+  for (int l = 0; l < k_padded; l += 2) {
+    const __m256i b_low =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    const __m256i b_high =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+    b += 2 * kPanelWidth;
+#pragma GCC unroll 8
+    for (int r = 0; r < kRows; ++r) {
+      int32 a_values;
+      memcpy(&a_values, a + r * k_padded + l, sizeof(a_values));
+      const __m256i a_pair = _mm256_set1_epi32(a_values);
+      acc_low[r] =
+          _mm256_add_epi32(acc_low[r], _mm256_madd_epi16(a_pair, b_low));
+      acc_high[r] =
+          _mm256_add_epi32(acc_high[r], _mm256_madd_epi16(a_pair, b_high));
+    }
+  }
+#pragma GCC unroll 8
+  for (int r = 0; r < kRows; ++r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + r * kPanelWidth),
+                        acc_low[r]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + r * kPanelWidth + 8),
+                        acc_high[r]);
+  }
+}
+
+void RunKernelAvx512Vnni(int rows, const uint8* a, int k_padded,
+                         const int8* b, int32* tile) {
+  switch (rows) {
+    case 1:
+      return KernelAvx512Vnni<1>(a, k_padded, b, tile);
+    case 2:
+      return KernelAvx512Vnni<2>(a, k_padded, b, tile);
+    case 3:
+      return KernelAvx512Vnni<3>(a, k_padded, b, tile);
+    case 4:
+      return KernelAvx512Vnni<4>(a, k_padded, b, tile);
+    case 5:
+      return KernelAvx512Vnni<5>(a, k_padded, b, tile);
+    case 6:
+      return KernelAvx512Vnni<6>(a, k_padded, b, tile);
+    case 7:
+      return KernelAvx512Vnni<7>(a, k_padded, b, tile);
+    default:
+      return KernelAvx512Vnni<8>(a, k_padded, b, tile);
+  }
+}
+
+void RunKernelAvx2(int rows, const int16* a, int k_padded, const int16* b,
+                   int32* tile) {
+  switch (rows) {
+    case 1:
+      return KernelAvx2<1>(a, k_padded, b, tile);
+    case 2:
+      return KernelAvx2<2>(a, k_padded, b, tile);
+    case 3:
+      return KernelAvx2<3>(a, k_padded, b, tile);
+    case 4:
+      return KernelAvx2<4>(a, k_padded, b, tile);
+    case 5:
+      return KernelAvx2<5>(a, k_padded, b, tile);
+    default:
+      return KernelAvx2<6>(a, k_padded, b, tile);
+  }
+}
+
+#endif  // QUANTIZED_GEMM_USE_X86_KERNELS
+
+// Adds int32 values with the wrap around of the int32 arithmetic of the
+// kernels.
+inline int32 WrappingAdd(int32 a, int32 b, int32 c) {
+  return static_cast<int32>(static_cast<uint32>(a) + static_cast<uint32>(b) +
+                            static_cast<uint32>(c));
+}
+
+// We have to break this out as a separate function because there are
+// multiple combinations of transpose attributes we need to support, and
+// they have to be compile-time constants to work with the templates used
+// internally.
+template <bool TransposeA, bool TransposeB>
+void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
+                      const quint8* b_data, qint32* c_data, int m, int n, int k,
+                      int offset_a, int offset_b, int lda, int ldb, int ldc) {
+  const uint8* a_data_as_uint8 = &(a_data->value);
+  const uint8* b_data_as_uint8 = &(b_data->value);
+  int32* c_data_as_int32 = &(c_data->value);
+  static const gemmlowp::MapOrder LhsOrder =
+      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  static const gemmlowp::MapOrder RhsOrder =
+      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data_as_uint8, m, k,
+                                                        lda);
+  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data_as_uint8, k, n,
+                                                        ldb);
+  gemmlowp::MatrixMap<std::int32_t, gemmlowp::MapOrder::RowMajor> result(
+      c_data_as_int32, m, n, ldc);
+  const std::tuple<> empty_pipeline = {};
+  auto& worker_threads =
+      *(op_context->device()->tensorflow_cpu_worker_threads());
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, offset_a, offset_b, empty_pipeline);
+  // Since gemmlowp uses assembly to write to the output, msan won't detect
+  // the output buffer as written to, so we mark it manually.
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
+}
+
+}  // namespace
+
+// Packs the rhs and runs the packed kernels.
+class PackedKernels {
+ public:
+  static void Pack(bool transpose_b, const quint8* b, int ldb,
+                   PackedRhs* packed) {
+    const KernelKind kind = GetKernelKind();
+    CHECK(kind != KernelKind::kNone)
+        << "The quantized GEMM kernels don't run on this CPU";
+    const int k = packed->k_;
+    const int n = packed->n_;
+    const int depth = KernelDepth(kind);
+    const int64 k_padded = RoundUp(k, depth);
+    const int64 packed_size = RoundUp(n, kPanelWidth) * k_padded;
+    packed->k_padded_ = k_padded;
+    packed->column_sums_.assign(n, 0);
+    if (kind == KernelKind::kAvx512Vnni) {
+      packed->data_int8_.assign(packed_size, 0);
+    } else {
+      packed->data_int16_.assign(packed_size, 0);
+    }
+    if (kind == KernelKind::kAvx512Vnni) {
+      // VPDPBUSD multiplies uint8 by int8 values, so the rhs is shifted down
+      // by 128, which Run() makes up for with the row sums of the lhs.
+      PackValues(transpose_b, b, ldb, k, n, depth, -128,
+                 packed->data_int8_.data(), packed->column_sums_.data());
+    } else {
+      PackValues(transpose_b, b, ldb, k, n, depth, 0,
+                 packed->data_int16_.data(), packed->column_sums_.data());
+    }
+  }
+
+  // Packs b into `data`, reading b along its rows or columns, whichever are
+  // contiguous.
+  template <typename T>
+  static void PackValues(bool transpose_b, const quint8* b, int ldb, int k,
+                         int n, int depth, int shift, T* data,
+                         int32* column_sums) {
+    const int64 panel_size = RoundUp(k, depth) * kPanelWidth;
+    auto index = [=](int l, int j) {
+      return (j / kPanelWidth) * panel_size +
+             (l / depth) * depth * kPanelWidth + (j % kPanelWidth) * depth +
+             l % depth;
+    };
+    if (transpose_b) {
+      for (int j = 0; j < n; ++j) {
+        const quint8* column = b + static_cast<int64>(j) * ldb;
+        int32 column_sum = 0;
+        for (int l = 0; l < k; ++l) {
+          const uint8 value = column[l].value;
+          data[index(l, j)] = static_cast<T>(value + shift);
+          column_sum += value;
+        }
+        column_sums[j] = column_sum;
+      }
+    } else {
+      for (int l = 0; l < k; ++l) {
+        const quint8* row = b + static_cast<int64>(l) * ldb;
+        for (int j = 0; j < n; ++j) {
+          const uint8 value = row[j].value;
+          data[index(l, j)] = static_cast<T>(value + shift);
+          column_sums[j] += value;
+        }
+      }
+    }
+  }
+
+  // Multiplies `a` by `b` into `c`, whose rows have stride ldc.
+  static void Run(const Eigen::ThreadPoolDevice& device, bool transpose_a,
+                  const quint8* a, int m, int lda, int offset_a,
+                  const PackedRhs& b, int offset_b, qint32* c, int ldc) {
+    const KernelKind kind = GetKernelKind();
+    CHECK(kind != KernelKind::kNone)
+        << "The quantized GEMM kernels don't run on this CPU";
+    const int k = b.k_;
+    const int n = b.n_;
+    const int k_padded = b.k_padded_;
+    if (m == 0 || n == 0) return;
+
+    // The sum of the products (a + offset_a) * (b + offset_b) is the sum of
+    // the products a * b, plus offset_b times the sum of the row of a, plus
+    // offset_a times the sum of the column of b, plus k * offset_a *
+    // offset_b. The terms of the rows are found as the lhs is packed, and
+    // the terms of the columns are found here.
+    const int64 row_sum_scale =
+        offset_b + (kind == KernelKind::kAvx512Vnni ? 128 : 0);
+    const int64 constant_term = static_cast<int64>(k) * offset_a * offset_b;
+    std::vector<int32> column_terms(n);
+    for (int j = 0; j < n; ++j) {
+      column_terms[j] =
+          static_cast<int32>(static_cast<int64>(offset_a) * b.column_sums_[j]);
+    }
+
+    const int max_kernel_rows = KernelRows(kind);
+    const int num_panels = (n + kPanelWidth - 1) / kPanelWidth;
+    const int64 num_row_blocks = (m + kBlockRows - 1) / kBlockRows;
+    const int64 num_column_blocks =
+        (num_panels + kBlockPanels - 1) / kBlockPanels;
+    auto multiply_blocks = [&](int64 start, int64 limit) {
+      std::vector<uint8> a_int8;
+      std::vector<int16> a_int16;
+      int32 row_terms[kBlockRows];
+      int32 tile[kMaxKernelRows * kPanelWidth];
+      int64 packed_row_block = -1;
+      for (int64 block = start; block < limit; ++block) {
+        const int64 row_block = block / num_column_blocks;
+        const int64 column_block = block % num_column_blocks;
+        const int row_begin = row_block * kBlockRows;
+        const int rows = std::min(kBlockRows, m - row_begin);
+        // Consecutive blocks usually share their rows, which are then
+        // packed only once.
+        if (row_block != packed_row_block) {
+          if (kind == KernelKind::kAvx512Vnni) {
+            a_int8.assign(static_cast<int64>(rows) * k_padded, 0);
+          } else {
+            a_int16.assign(static_cast<int64>(rows) * k_padded, 0);
+          }
+          for (int r = 0; r < rows; ++r) {
+            const int i = row_begin + r;
+            int64 row_sum = 0;
+            for (int l = 0; l < k; ++l) {
+              const uint8 value =
+                  transpose_a ? a[static_cast<int64>(l) * lda + i].value
+                              : a[static_cast<int64>(i) * lda + l].value;
+              if (kind == KernelKind::kAvx512Vnni) {
+                a_int8[r * k_padded + l] = value;
+              } else {
+                a_int16[r * k_padded + l] = value;
+              }
+              row_sum += value;
+            }
+            row_terms[r] =
+                static_cast<int32>(row_sum_scale * row_sum + constant_term);
+          }
+          packed_row_block = row_block;
+        }
+
+        const int panel_end =
+            std::min<int64>(num_panels, (column_block + 1) * kBlockPanels);
+        for (int panel = column_block * kBlockPanels; panel < panel_end;
+             ++panel) {
+          const int column_begin = panel * kPanelWidth;
+          const int columns = std::min(kPanelWidth, n - column_begin);
+          const int64 panel_offset =
+              static_cast<int64>(panel) * k_padded * kPanelWidth;
+          for (int r = 0; r < rows; r += max_kernel_rows) {
+            const int kernel_rows = std::min(max_kernel_rows, rows - r);
+#ifdef QUANTIZED_GEMM_USE_X86_KERNELS
+            if (kind == KernelKind::kAvx512Vnni) {
+              RunKernelAvx512Vnni(kernel_rows, &a_int8[r * k_padded],
+                                  k_padded, &b.data_int8_[panel_offset],
+                                  tile);
+            } else {
+              RunKernelAvx2(kernel_rows, &a_int16[r * k_padded], k_padded,
+                            &b.data_int16_[panel_offset], tile);
+            }
+#endif
+            for (int rr = 0; rr < kernel_rows; ++rr) {
+              const int32* tile_row = tile + rr * kPanelWidth;
+              const int32 row_term = row_terms[r + rr];
+              qint32* c_row = c +
+                              static_cast<int64>(row_begin + r + rr) * ldc +
+                              column_begin;
+              for (int j = 0; j < columns; ++j) {
+                c_row[j] = WrappingAdd(tile_row[j], row_term,
+                                       column_terms[column_begin + j]);
+              }
+            }
+          }
+        }
+      }
+    };
+
+    // Each unit packs up to kBlockRows rows of the lhs and multiplies them
+    // by up to kBlockPanels panels, with the kernels doing 32 (AVX2) to 64
+    // (VNNI) multiply-adds per instruction.
+    const double macs_per_block =
+        static_cast<double>(std::min(m, kBlockRows)) *
+        std::min(num_panels, kBlockPanels) * kPanelWidth * k_padded;
+    const Eigen::TensorOpCost cost(
+        std::min(m, kBlockRows) * k_padded +
+            std::min(num_panels, kBlockPanels) * kPanelWidth * k_padded,
+        std::min(m, kBlockRows) * kBlockPanels * kPanelWidth * sizeof(int32),
+        macs_per_block / (kind == KernelKind::kAvx512Vnni ? 64 : 32));
+    device.parallelFor(num_row_blocks * num_column_blocks, cost,
+                       multiply_blocks);
+  }
+};
+
+bool HasPackedKernels() { return GetKernelKind() != KernelKind::kNone; }
+
+PackedRhs::PackedRhs(bool transpose_b, const quint8* b, int k, int n, int ldb)
+    : k_(k), n_(n), k_padded_(0) {
+  PackedKernels::Pack(transpose_b, b, ldb, this);
+}
+
+int64 PackedRhs::size_bytes() const {
+  return data_int8_.size() * sizeof(int8) + data_int16_.size() * sizeof(int16) +
+         column_sums_.size() * sizeof(int32);
+}
+
+std::shared_ptr<const PackedRhs> PackedRhsCache::Get(bool transpose_b,
+                                                     const quint8* b, int k,
+                                                     int n, int ldb) {
+  mutex_lock l(mu_);
+  if (packed_ == nullptr || transpose_b != transpose_b_ || k != packed_->k() ||
+      n != packed_->n() || ldb != ldb_) {
+    packed_ = std::make_shared<const PackedRhs>(transpose_b, b, k, n, ldb);
+    transpose_b_ = transpose_b;
+    ldb_ = ldb;
+    VLOG(1) << "Packed a " << k << " x " << n << " quantized matrix into "
+            << packed_->size_bytes() << " bytes";
+  }
+  return packed_;
+}
+
+void Gemm(const Eigen::ThreadPoolDevice& device, bool transpose_a,
+          const quint8* a_data, int m, int lda, int offset_a,
+          const PackedRhs& b, int offset_b, qint32* c_data, int ldc) {
+  PackedKernels::Run(device, transpose_a, a_data, m, lda, offset_a, b,
+                     offset_b, c_data, ldc);
+}
+
+void Gemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+          const quint8* a_data, const quint8* b_data, qint32* c_data, int m,
+          int n, int k, int offset_a, int offset_b, int lda, int ldb, int ldc,
+          PackedRhsCache* rhs_cache) {
+  if (HasPackedKernels()) {
+    std::shared_ptr<const PackedRhs> packed =
+        rhs_cache != nullptr
+            ? rhs_cache->Get(transpose_b, b_data, k, n, ldb)
+            : std::make_shared<const PackedRhs>(transpose_b, b_data, k, n,
+                                                ldb);
+    Gemm(context->eigen_device<Eigen::ThreadPoolDevice>(), transpose_a,
+         a_data, m, lda, offset_a, *packed, offset_b, c_data, ldc);
+  } else if (meta::IsSupportedAndEnabled() && k <= 2048) {
+    // Gemmlowp/meta code path works on 32 & 64 bit Arm with NEON Simd and
+    // allows optimized quantized 8bit to 32bit gemm.
+    meta::QuantizedGemm(context, transpose_a, transpose_b, a_data, b_data,
+                        c_data, m, n, k, offset_a, offset_b, lda, ldb, ldc);
+  } else if (transpose_a) {
+    if (transpose_b) {
+      GemmlowpMultiply<true, true>(context, a_data, b_data, c_data, m, n, k,
+                                   offset_a, offset_b, lda, ldb, ldc);
+    } else {
+      GemmlowpMultiply<true, false>(context, a_data, b_data, c_data, m, n, k,
+                                    offset_a, offset_b, lda, ldb, ldc);
+    }
+  } else {
+    if (transpose_b) {
+      GemmlowpMultiply<false, true>(context, a_data, b_data, c_data, m, n, k,
+                                    offset_a, offset_b, lda, ldb, ldc);
+    } else {
+      GemmlowpMultiply<false, false>(context, a_data, b_data, c_data, m, n, k,
+                                     offset_a, offset_b, lda, ldb, ldc);
+    }
+  }
+}
+
+void BiasAdd(const Eigen::ThreadPoolDevice& device, const quint8* input,
+             int64 input_count, const quint8* bias, int bias_count,
+             float input_min, float input_max, float bias_min, float bias_max,
+             float output_min, float output_max, qint32* output) {
+  if (bias_count == 0) return;
+  // The values are converted with the expressions of QuantizedAddUsingEigen,
+  // so that the results are the same.
+  quint8 codes[256];
+  for (int i = 0; i < 256; ++i) {
+    codes[i] = static_cast<quint8>(i);
+  }
+  qint32 converted_codes[256];
+  std::vector<qint32> converted_bias(bias_count);
+  QuantizedToFloatStruct<quint8> input_q2f(input_min, input_max);
+  QuantizedToFloatStruct<quint8> bias_q2f(bias_min, bias_max);
+  FloatToQuantizedStruct<qint32> f2q(output_min, output_max);
+  const qint32 zero_in_total_space =
+      FloatToQuantized<qint32>(0.0f, output_min, output_max);
+  TTypes<quint8>::ConstFlat codes_flat(codes, 256);
+  TTypes<qint32>::Flat converted_codes_flat(converted_codes, 256);
+  converted_codes_flat = QUANTIZE_WITH_EIGEN(
+      DEQUANTIZE_WITH_EIGEN(codes_flat, input_q2f), f2q, qint32);
+  TTypes<quint8>::ConstFlat bias_flat(bias, bias_count);
+  TTypes<qint32>::Flat converted_bias_flat(converted_bias.data(), bias_count);
+  converted_bias_flat = QUANTIZE_WITH_EIGEN(
+                            DEQUANTIZE_WITH_EIGEN(bias_flat, bias_q2f), f2q,
+                            qint32) +
+                        zero_in_total_space;
+
+  auto add_bias = [&](int64 start, int64 limit) {
+    for (int64 row = start; row < limit; ++row) {
+      const quint8* input_row = input + row * bias_count;
+      qint32* output_row = output + row * bias_count;
+      for (int j = 0; j < bias_count; ++j) {
+        output_row[j] = converted_codes[input_row[j].value] + converted_bias[j];
+      }
+    }
+  };
+  device.parallelFor(input_count / bias_count,
+                     Eigen::TensorOpCost(bias_count * (sizeof(quint8) + 4),
+                                         bias_count * sizeof(qint32),
+                                         bias_count * 2),
+                     add_bias);
+}
+
+}  // namespace quantized_gemm
+}  // namespace tensorflow
@@ -0,0 +1,128 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_H_
+#define TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace Eigen {
+struct ThreadPoolDevice;
+}  // namespace Eigen
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace quantized_gemm {
+
+// The eight-bit matrix multiplication shared by the CPU quantized kernels.
+//
+// On x86 CPUs with AVX2 the multiplication runs on the kernels of this
+// library, which read the right-hand side from a packed copy that callers can
+// keep across calls, and which use the AVX-512 VNNI dot product instructions
+// when the CPU has them. The kernels are chosen at run time, so they don't
+// depend on the compiler flags of the build. On other CPUs the multiplication
+// is handed to gemmlowp/meta on ARM, or to gemmlowp.
+
+// Returns true if the packed kernels run on the current CPU. PackedRhs and the
+// Gemm overloads taking one may only be used if this is true.
+bool HasPackedKernels();
+
+// A k x n right-hand side, packed for the kernels of the current CPU.
+class PackedRhs {
+ public:
+  // Packs `b`, which is row major with stride ldb if transpose_b is false,
+  // and column major with stride ldb otherwise.
+  PackedRhs(bool transpose_b, const quint8* b, int k, int n, int ldb);
+
+  int k() const { return k_; }
+  int n() const { return n_; }
+  // The memory used by the packed copy, in bytes.
+  int64 size_bytes() const;
+
+ private:
+  friend class PackedKernels;
+
+  const int k_;
+  const int n_;
+  // k rounded up to the depth of one step of the kernels.
+  int k_padded_;
+  // Panels of 16 columns. With VNNI, the values of each group of 4 rows of a
+  // column are adjacent and shifted to int8, and otherwise the values of each
+  // pair of rows of a column are adjacent as int16.
+  std::vector<int8> data_int8_;
+  std::vector<int16> data_int16_;
+  // The sum of every column of b.
+  std::vector<int32> column_sums_;
+};
+
+// Keeps the packed copy of a right-hand side that never changes, such as the
+// weights of a kernel that the graph marks with kConstantWeightsAttrName, and
+// packs it again only if its shape changes. Its contents are never checked,
+// so it must not be used for values that can change between calls.
+class PackedRhsCache {
+ public:
+  std::shared_ptr<const PackedRhs> Get(bool transpose_b, const quint8* b,
+                                       int k, int n, int ldb);
+
+ private:
+  mutex mu_;
+  bool transpose_b_ GUARDED_BY(mu_) = false;
+  int ldb_ GUARDED_BY(mu_) = 0;
+  std::shared_ptr<const PackedRhs> packed_ GUARDED_BY(mu_);
+};
+
+// Calculates, with the packed kernels and the threads of `device`:
+//
+// for (i, j) in [0, m) x [0, b.n()) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offset_a) * (b[l, j] + offset_b)) : l in [0, k)
+//
+// If transpose_a is false the lhs operand has row major layout, otherwise
+// column major. lda and ldc are the strides of the lhs operand and of the
+// result.
+void Gemm(const Eigen::ThreadPoolDevice& device, bool transpose_a,
+          const quint8* a_data, int m, int lda, int offset_a,
+          const PackedRhs& b, int offset_b, qint32* c_data, int ldc);
+
+// Calculates the same product as meta::QuantizedGemm, with the packed
+// kernels if the CPU has them and gemmlowp otherwise. If rhs_cache is not
+// null, the packed copy of b is taken from it.
+void Gemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+          const quint8* a_data, const quint8* b_data, qint32* c_data, int m,
+          int n, int k, int offset_a, int offset_b, int lda, int ldb, int ldc,
+          PackedRhsCache* rhs_cache);
+
+// Adds `bias` to every row of the rows x bias_count matrix `input`, like
+// QuantizedAddUsingEigen does, with the inputs and the output quantized to
+// the given ranges. As every 8-bit input value has only 256 possible values
+// in the output range, they are converted once and the sum is a lookup and
+// an add of the converted bias of the column.
+void BiasAdd(const Eigen::ThreadPoolDevice& device, const quint8* input,
+             int64 input_count, const quint8* bias, int bias_count,
+             float input_min, float input_max, float bias_min, float bias_max,
+             float output_min, float output_max, qint32* output);
+
+}  // namespace quantized_gemm
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_H_
@@ -0,0 +1,171 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/quantized_gemm.h"
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/common_runtime/eigen_thread_pool.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace quantized_gemm {
+namespace {
+
+class QuantizedGemmTest : public ::testing::Test {
+ protected:
+  QuantizedGemmTest()
+      : threadpool_(Env::Default(), "test", 4 /* num_threads */),
+        wrapper_(&threadpool_),
+        device_(&wrapper_, 4 /* num_threads */),
+        philox_(testing::RandomSeed(), 17),
+        rnd_(&philox_) {}
+
+  std::vector<quint8> RandomValues(int64 count) {
+    std::vector<quint8> values(count);
+    for (quint8& value : values) {
+      value = rnd_.Uniform(256);
+    }
+    return values;
+  }
+
+  // Checks the packed kernels against a plain loop on a random product.
+  void TestGemm(int m, int n, int k, bool transpose_a, bool transpose_b,
+                int offset_a, int offset_b) {
+    const int lda = (transpose_a ? m : k) + rnd_.Uniform(3);
+    const int ldb = (transpose_b ? k : n) + rnd_.Uniform(3);
+    const int ldc = n + rnd_.Uniform(3);
+    const std::vector<quint8> a =
+        RandomValues(static_cast<int64>(transpose_a ? k : m) * lda);
+    const std::vector<quint8> b =
+        RandomValues(static_cast<int64>(transpose_b ? n : k) * ldb);
+
+    std::vector<int32> expected(m * n);
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        int64 sum = 0;
+        for (int l = 0; l < k; ++l) {
+          const int64 a_value =
+              transpose_a ? a[l * lda + i].value : a[i * lda + l].value;
+          const int64 b_value =
+              transpose_b ? b[j * ldb + l].value : b[l * ldb + j].value;
+          sum += (a_value + offset_a) * (b_value + offset_b);
+        }
+        expected[i * n + j] = static_cast<int32>(sum);
+      }
+    }
+
+    const PackedRhs packed(transpose_b, b.data(), k, n, ldb);
+    std::vector<qint32> c(m * ldc);
+    Gemm(device_, transpose_a, a.data(), m, lda, offset_a, packed, offset_b,
+         c.data(), ldc);
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        ASSERT_EQ(expected[i * n + j], c[i * ldc + j].value)
+            << "at " << i << ", " << j << " of " << m << "x" << n << "x" << k;
+      }
+    }
+  }
+
+  thread::ThreadPool threadpool_;
+  EigenThreadPoolWrapper wrapper_;
+  Eigen::ThreadPoolDevice device_;
+  random::PhiloxRandom philox_;
+  random::SimplePhilox rnd_;
+};
+
+TEST_F(QuantizedGemmTest, Gemm) {
+  if (!HasPackedKernels()) return;
+  for (int trial = 0; trial < 100; ++trial) {
+    const int m = 1 + rnd_.Uniform(150);
+    const int n = 1 + rnd_.Uniform(70);
+    const int k = 1 + rnd_.Uniform(trial % 10 == 0 ? 5 : 300);
+    const int offset_a = -static_cast<int>(rnd_.Uniform(256));
+    const int offset_b = -static_cast<int>(rnd_.Uniform(256));
+    TestGemm(m, n, k, rnd_.Uniform(2), rnd_.Uniform(2), offset_a, offset_b);
+  }
+}
+
+TEST_F(QuantizedGemmTest, GemmWrapsAround) {
+  if (!HasPackedKernels()) return;
+  // Offsets large enough for the sums to overflow int32, which wraps around
+  // as in the other gemm implementations.
+  TestGemm(33, 40, 500, false, false, 70000, -70000);
+  TestGemm(17, 9, 300, true, true, -70000, 1000);
+}
+
+TEST_F(QuantizedGemmTest, PackedRhsCache) {
+  if (!HasPackedKernels()) return;
+  PackedRhsCache cache;
+  std::vector<quint8> b = RandomValues(64 * 32);
+  const auto first = cache.Get(false, b.data(), 64, 32, 32);
+  EXPECT_EQ(first, cache.Get(false, b.data(), 64, 32, 32));
+  EXPECT_EQ(64, first->k());
+  EXPECT_EQ(32, first->n());
+  EXPECT_GT(first->size_bytes(), 0);
+
+  // The contents are never compared, as the cache only holds constants.
+  b[100] = b[100].value == 0 ? 1 : 0;
+  EXPECT_EQ(first, cache.Get(false, b.data(), 64, 32, 32));
+
+  // A changed shape is packed again.
+  const auto transposed = cache.Get(true, b.data(), 32, 64, 32);
+  EXPECT_NE(first, transposed);
+  EXPECT_EQ(32, transposed->k());
+  EXPECT_EQ(64, transposed->n());
+}
+
+TEST_F(QuantizedGemmTest, BiasAdd) {
+  const int rows = 37;
+  const int columns = 29;
+  const float input_min = -3.5f;
+  const float input_max = 7.25f;
+  const float bias_min = -0.5f;
+  const float bias_max = 0.75f;
+  Tensor input(DT_QUINT8, TensorShape({rows, columns}));
+  Tensor bias(DT_QUINT8, TensorShape({columns}));
+  for (int64 i = 0; i < input.NumElements(); ++i) {
+    input.flat<quint8>()(i) = rnd_.Uniform(256);
+  }
+  for (int64 i = 0; i < bias.NumElements(); ++i) {
+    bias.flat<quint8>()(i) = rnd_.Uniform(256);
+  }
+
+  Tensor expected(DT_QINT32, input.shape());
+  float expected_min;
+  float expected_max;
+  QuantizedAddUsingEigen<quint8, quint8, qint32>(
+      device_, input, input_min, input_max, bias, bias_min, bias_max,
+      &expected, &expected_min, &expected_max);
+
+  Tensor output(DT_QINT32, input.shape());
+  BiasAdd(device_, input.flat<quint8>().data(), input.NumElements(),
+          bias.flat<quint8>().data(), columns, input_min, input_max, bias_min,
+          bias_max, expected_min, expected_max,
+          output.flat<qint32>().data());
+  test::ExpectTensorEqual<qint32>(expected, output);
+}
+
+}  // namespace
+}  // namespace quantized_gemm
+}  // namespace tensorflow
@@ -17,52 +17,16 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
-#define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
-#include "public/gemmlowp.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
 
-// We have to break this out as a separate function because there are multiple
-// combinations of transpose attributes we need to support, and they have to be
-// compile-time constants to work with the templates used internally.
-template <bool TransposeA, bool TransposeB, bool TransposeC>
-void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
-                      const quint8* b_data, qint32* c_data, int m, int n, int k,
-                      int offset_a, int offset_b, int lda, int ldb, int ldc) {
-  const uint8* a_data_as_uint8 = &(a_data->value);
-  const uint8* b_data_as_uint8 = &(b_data->value);
-  int32* c_data_as_int32 = &(c_data->value);
-  static const gemmlowp::MapOrder ResultOrder =
-      !TransposeC ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
-  static const gemmlowp::MapOrder LhsOrder =
-      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
-  static const gemmlowp::MapOrder RhsOrder =
-      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
-  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data_as_uint8, m, k,
-                                                        lda);
-  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data_as_uint8, k, n,
-                                                        ldb);
-  gemmlowp::MatrixMap<std::int32_t, ResultOrder> result(c_data_as_int32, m, n,
-                                                        ldc);
-  const std::tuple<> empty_pipeline = {};
-  auto& worker_threads =
-      *(op_context->device()->tensorflow_cpu_worker_threads());
-  TensorflowGemmContext context(worker_threads.num_threads,
-                                worker_threads.workers);
-  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
-                                   gemmlowp::DefaultL8R8BitDepthParams>(
-      &context, lhs, rhs, &result, -offset_a, -offset_b, empty_pipeline);
-  // Since gemmlowp uses assembly to write to the output, msan won't detect
-  // the output buffer as written to, so we mark it manually.
-  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
-}
-
 template <class T1, class T2, class Toutput>
 class QuantizedMatMulOp : public OpKernel {
  public:
@@ -70,6 +34,11 @@ class QuantizedMatMulOp : public OpKernel {
       : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
     OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    bool constant_weights = false;
+    if (context->GetAttr(kConstantWeightsAttrName, &constant_weights).ok() &&
+        constant_weights) {
+      b_cache_.reset(new quantized_gemm::PackedRhsCache);
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -132,41 +101,16 @@ class QuantizedMatMulOp : public OpKernel {
     const size_t ldb = b.dim_size(1);
     const size_t ldc = n;
 
-    if (meta::IsSupportedAndEnabled() && std::is_same<T1, quint8>() &&
-        std::is_same<T2, quint8>() && std::is_same<Toutput, qint32>() &&
-        (offset_c == 0) && (mult_c == 1) && (shift_c == 0) &&
-        (transpose_c == false) && (k <= 2048)) {
-      // Gemmlowp/meta code path works on 32 & 64 bit Arm with NEON Simd and
-      // allows optimized quantized 8bit to 32bit gemm.
-      meta::QuantizedGemm(context, transpose_a_, transpose_b_, a_data, b_data,
-                          c_data, m, n, k, -offset_a, -offset_b, lda, ldb, ldc);
-    } else if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
-               std::is_same<Toutput, qint32>() && (offset_c == 0) &&
-               (mult_c == 1) && (shift_c == 0) && (transpose_c == false)) {
-      // The gemmlowp optimized library only works for a particular set of data
-      // types, so check if we meet those requirements and fall back to a slower
-      // reference implementation if not.
-      if (transpose_a_) {
-        if (transpose_b_) {
-          GemmlowpMultiply<true, true, false>(context, a_data, b_data, c_data,
-                                              m, n, k, offset_a, offset_b, lda,
-                                              ldb, ldc);
-        } else {
-          GemmlowpMultiply<true, false, false>(context, a_data, b_data, c_data,
-                                               m, n, k, offset_a, offset_b, lda,
-                                               ldb, ldc);
-        }
-      } else {
-        if (transpose_b_) {
-          GemmlowpMultiply<false, true, false>(context, a_data, b_data, c_data,
-                                               m, n, k, offset_a, offset_b, lda,
-                                               ldb, ldc);
-        } else {
-          GemmlowpMultiply<false, false, false>(context, a_data, b_data, c_data,
-                                                m, n, k, offset_a, offset_b,
-                                                lda, ldb, ldc);
-        }
-      }
+    if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
+        std::is_same<Toutput, qint32>() && (offset_c == 0) && (mult_c == 1) &&
+        (shift_c == 0) && (transpose_c == false)) {
+      // The optimized eight-bit gemm only works for a particular set of data
+      // types, so check if we meet those requirements and fall back to a
+      // slower reference implementation if not. When b is a constant, its
+      // packed copy is kept across steps.
+      quantized_gemm::Gemm(context, transpose_a_, transpose_b_, a_data, b_data,
+                           c_data, m, n, k, -offset_a, -offset_b, lda, ldb,
+                           ldc, b_cache_.get());
     } else {
       ReferenceGemm<T1, T2, Toutput>(
           transpose_a_, transpose_b_, transpose_c, m, n, k, a_data, offset_a,
@@ -189,6 +133,8 @@ class QuantizedMatMulOp : public OpKernel {
  private:
   bool transpose_a_;
   bool transpose_b_;
+  // Only set if the graph marks b as a constant.
+  std::unique_ptr<quantized_gemm::PackedRhsCache> b_cache_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
@@ -153,6 +153,18 @@ class ResizeBilinearOpAlignCornersTest : public OpsTestBase {
   }
 };
 
+class ResizeBilinearOpUint8Test : public OpsTestBase {
+ protected:
+  ResizeBilinearOpUint8Test() {
+    TF_EXPECT_OK(NodeDefBuilder("resize_bilinear_op", "ResizeBilinear")
+                     .Input(FakeInput(DT_UINT8))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("align_corners", false)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
 TEST_F(ResizeBilinearOpTest, TestResizeRandomDataSeveralInputsSizes1Channel) {
   RunManyRandomTests(1);
 }
@@ -430,6 +442,31 @@ TEST_F(ResizeBilinearOpTest, TestBilinear2x2To4x4) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(ResizeBilinearOpUint8Test, TestBilinear2x2x3To3x4x3) {
+  // Input, with channels 0, 1 and 2 equal to 10x, 20x and 30x of:
+  //  1, 2
+  //  3, 4
+  AddInputFromArray<uint8>(TensorShape({1, 2, 2, 3}),
+                           {10, 20, 30, 20, 40, 60, 30, 60, 90, 40, 80, 120});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Channel c of the output is 10 * (c + 1) times the resized 2x2 input.
+  const float rows[3][4] = {{1, 1.5, 2, 2},
+                            {7.0f / 3, 17.0f / 6, 10.0f / 3, 10.0f / 3},
+                            {3, 3.5, 4, 4}};
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 3, 4, 3}));
+  auto expected_tensor = expected.tensor<float, 4>();
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        expected_tensor(0, y, x, c) = rows[y][x] * 10 * (c + 1);
+      }
+    }
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
 // similar_size case
 TEST_F(ResizeBilinearOpTest, Test1_1c) { TestResize(1, 183, 299, 1, 299, 299); }
 TEST_F(ResizeBilinearOpTest, Test1_3c) { TestResize(1, 183, 299, 3, 299, 299); }
@@ -54,4 +54,46 @@ BM_ResizeDev(gpu, ResizeNearestNeighbor, 10, 499, 499);
 BM_ResizeDev(cpu, ResizeBilinear, 10, 499, 499);
 BM_ResizeDev(gpu, ResizeBilinear, 10, 499, 499);
 
+BM_ResizeDev(cpu, ResizeBicubic, 10, 499, 499);
+BM_ResizeDev(cpu, ResizeArea, 10, 499, 499);
+
+// Downsizes a batch of images to the 224 x 224 input size of many image
+// models.
+template <typename T>
+static Graph* BM_ResizeDown(const char* algorithm, int batches, int width,
+                            int height) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor in(DataTypeToEnum<T>::value, TensorShape({batches, width, height, 3}));
+  in.flat<T>().setRandom();
+
+  Tensor out_size(DT_INT32, TensorShape({2}));
+  auto out_size_flat = out_size.flat<int32>();
+  out_size_flat(0) = 224;
+  out_size_flat(1) = 224;
+
+  Node* ret;
+  Status s = NodeBuilder(g->NewName("n"), algorithm)
+                 .Input(test::graph::Constant(g, in))
+                 .Input(test::graph::Constant(g, out_size))
+                 .Finalize(g, &ret);
+  assert(s.ok());
+  return g;
+}
+
+#define BM_ResizeDownDev(DEVICE, ALGORITHM, T, B, W, H)                      \
+  static void BM_ResizeDown_##ALGORITHM##_##DEVICE##_##T##_##B##_##W##_##H( \
+      int iters) {                                                           \
+    testing::ItemsProcessed(iters* B* W* H * 3);                             \
+    test::Benchmark(#DEVICE, BM_ResizeDown<T>(#ALGORITHM, B, W, H))          \
+        .Run(iters);                                                         \
+  }                                                                          \
+  BENCHMARK(BM_ResizeDown_##ALGORITHM##_##DEVICE##_##T##_##B##_##W##_##H)
+
+BM_ResizeDownDev(cpu, ResizeBilinear, float, 16, 499, 499);
+BM_ResizeDownDev(cpu, ResizeBilinear, uint8, 16, 499, 499);
+BM_ResizeDownDev(cpu, ResizeBicubic, float, 16, 499, 499);
+BM_ResizeDownDev(cpu, ResizeBicubic, uint8, 16, 499, 499);
+BM_ResizeDownDev(cpu, ResizeArea, float, 16, 499, 499);
+BM_ResizeDownDev(cpu, ResizeArea, uint8, 16, 499, 499);
+
 }  // namespace tensorflow
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -185,6 +189,60 @@ struct AssignSYCL<scatter_op::UpdateOp::MAX> {
 #endif  // TENSORFLOW_USE_SYCL
 
 }  // namespace internal
+
+// Scatters of at least this many elements are applied by several threads on
+// CPU.
+constexpr int64 kMinParallelScatterSize = 64 * 1024;
+
+// Groups the updates of a scatter by destination, so that they can be applied
+// in parallel without conflicts. `rows[i]` is the destination row of update
+// `i`, in [0, num_rows). The updates are sorted by row, keeping the updates of
+// each row in their original order, and split at row boundaries into
+// `num_ranges` ranges of about the same number of updates: the updates of
+// range `r` are `order[range_starts[r]:range_starts[r + 1]]`. All the updates
+// of a row are in one range, so only a row with more than its share of the
+// updates makes its range larger than the others.
+inline void GroupUpdatesByRow(const std::vector<int64>& rows, int64 num_rows,
+                              int64 num_ranges,
+                              std::vector<int64>* range_starts,
+                              std::vector<int64>* order) {
+  const int64 num_updates = rows.size();
+  order->resize(num_updates);
+  if (num_rows <= 4 * num_updates) {
+    // Counting sort, which is stable.
+    std::vector<int64> next(num_rows + 1, 0);
+    for (const int64 row : rows) {
+      ++next[row + 1];
+    }
+    for (int64 row = 0; row < num_rows; ++row) {
+      next[row + 1] += next[row];
+    }
+    for (int64 i = 0; i < num_updates; ++i) {
+      (*order)[next[rows[i]]++] = i;
+    }
+  } else {
+    // Few updates of many rows.
+    std::iota(order->begin(), order->end(), 0);
+    std::stable_sort(order->begin(), order->end(),
+                     [&rows](int64 a, int64 b) { return rows[a] < rows[b]; });
+  }
+
+  range_starts->resize(num_ranges + 1);
+  (*range_starts)[0] = 0;
+  int64 start = 0;
+  for (int64 r = 1; r < num_ranges; ++r) {
+    int64 end = std::max(start, num_updates * r / num_ranges);
+    // Move the end of the range past the updates of the row it falls in.
+    while (end > start && end < num_updates &&
+           rows[(*order)[end]] == rows[(*order)[end - 1]]) {
+      ++end;
+    }
+    (*range_starts)[r] = end;
+    start = end;
+  }
+  (*range_starts)[num_ranges] = num_updates;
+}
+
 }  // namespace scatter_op
 
 namespace functor {
@@ -219,6 +277,64 @@ struct ScatterFunctorBase {
   }
 };
 
+template <typename T, typename Index, scatter_op::UpdateOp op>
+struct ScatterFunctorBase<CPUDevice, T, Index, op> {
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    // indices and params sizes were validated in DoCompute().
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    const int64 cols = params.dimension(1);
+    if (N * cols < scatter_op::kMinParallelScatterSize ||
+        c->device()->tensorflow_cpu_worker_threads()->num_threads <= 1) {
+      for (Index i = 0; i < N; i++) {
+        // Grab the index and check its validity.  Do this carefully,
+        // to avoid checking the value and grabbing it again from
+        // memory a second time (a security risk since it may change in
+        // between).
+        const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+        if (!FastBoundsCheck(index, limit)) return i;
+        // Copy last Ndim-1 dimensions of updates[i] to params[index]
+        scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
+                                              updates.template chip<0>(i));
+      }
+      return -1;
+    }
+    // Check all the indices before updating any row in parallel.
+    std::vector<int64> rows(N);
+    for (Index i = 0; i < N; i++) {
+      // Grab the index and check its validity.  Do this carefully,
+      // to avoid checking the value and grabbing it again from
+      // memory a second time (a security risk since it may change in between).
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      rows[i] = index;
+    }
+    // Update disjoint sets of rows in parallel, each with about the same
+    // number of updates.
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    const int64 num_ranges =
+        std::min<int64>(N, 4 * worker_threads->num_threads);
+    std::vector<int64> range_starts;
+    std::vector<int64> order;
+    scatter_op::GroupUpdatesByRow(rows, limit, num_ranges, &range_starts,
+                                  &order);
+    auto update_ranges = [&](int64 begin, int64 end) {
+      for (int64 j = range_starts[begin]; j < range_starts[end]; ++j) {
+        const int64 i = order[j];
+        // Copy last Ndim-1 dimensions of updates[i] to params[rows[i]]
+        scatter_op::internal::Assign<op>::Run(
+            params.template chip<0>(rows[i]), updates.template chip<0>(i));
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, num_ranges,
+          (N / num_ranges + 1) * cols, update_ranges);
+    return -1;
+  }
+};
+
 template <typename Device, typename Index>
 struct ScatterFunctorVariantAssignBase {
   Index operator()(OpKernelContext* c, const Device& d,
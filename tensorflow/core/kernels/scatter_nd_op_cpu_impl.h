@@ -20,7 +20,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/scatter_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -112,6 +115,53 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
+    if (batch_size * slice_size >= scatter_op::kMinParallelScatterSize &&
+        d.numThreads() > 1) {
+      // Check all the indices, then update disjoint sets of slices in
+      // parallel, each with about the same number of updates.
+      std::vector<int64> slices(batch_size);
+      for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+        Index i = 0;
+        bool out_of_bounds = false;
+        for (int dim = 0; dim < IXDIM; ++dim) {
+          const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+          out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+          i += ix_d * batch_strides[dim];
+        }
+        if (TF_PREDICT_FALSE(out_of_bounds)) {
+          return loc;
+        }
+        slices[loc] = i;
+      }
+      const int64 num_slices = Toutput.dimension(0);
+      const int64 num_ranges =
+          std::min<int64>(batch_size, 4 * d.numThreads());
+      std::vector<int64> range_starts;
+      std::vector<int64> order;
+      scatter_op::GroupUpdatesByRow(slices, num_slices, num_ranges,
+                                    &range_starts, &order);
+      auto update_ranges = [&](int64 begin, int64 end) {
+        for (int64 j = range_starts[begin]; j < range_starts[end]; ++j) {
+          const int64 loc = order[j];
+          auto input_chip = Toutput.template chip<0>(slices[loc]);
+          auto update_chip = Tupdates.template chip<0>(loc);
+          update_executor::UpdateExecutor<
+              decltype(input_chip), decltype(update_chip),
+              decltype(input_chip), OP>::Execute(input_chip, update_chip,
+                                                 input_chip);
+        }
+      };
+      const double updates_per_range =
+          static_cast<double>(batch_size) / num_ranges;
+      d.parallelFor(num_ranges,
+                    Eigen::TensorOpCost(
+                        2 * updates_per_range * slice_size * sizeof(T),
+                        updates_per_range * slice_size * sizeof(T),
+                        updates_per_range * slice_size),
+                    update_ranges);
+      return error_loc;
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -237,6 +237,54 @@ TEST_F(ScatterNdUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+TEST_F(ScatterNdUpdateOpTest, LargeScatterNdAddWithDuplicates) {
+  // Large enough to be applied by several threads, with index depth 2: a hot
+  // slice takes a third of the updates, and the others go to a few slices.
+  const int kDim0 = 20;
+  const int kDim1 = 10;
+  const int kSliceSize = 16;
+  const int kNumUpdates = 8192;
+  TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterNdAdd")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  std::vector<float> params(kDim0 * kDim1 * kSliceSize);
+  for (int i = 0; i < params.size(); ++i) {
+    params[i] = i % 5;
+  }
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int32> indices;
+  std::vector<float> updates(kNumUpdates * kSliceSize);
+  for (int i = 0; i < updates.size(); ++i) {
+    updates[i] = i % 11;
+  }
+  std::vector<float> expected_values = params;
+  for (int i = 0; i < kNumUpdates; ++i) {
+    const int32 i0 = i % 3 == 0 ? kDim0 / 2 : rnd.Uniform(4) * 3;
+    const int32 i1 = i % 3 == 0 ? kDim1 / 2 : rnd.Uniform(3);
+    indices.push_back(i0);
+    indices.push_back(i1);
+    for (int j = 0; j < kSliceSize; ++j) {
+      expected_values[(i0 * kDim1 + i1) * kSliceSize + j] +=
+          updates[i * kSliceSize + j];
+    }
+  }
+
+  AddInputFromArray<float>(TensorShape({kDim0, kDim1, kSliceSize}), params);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 2}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kSliceSize}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({kDim0, kDim1, kSliceSize}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
 class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
  public:
   void TestBody() override {}
@@ -251,7 +299,8 @@ class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
 };
 
 template <typename Index>
-static void BM_ScatterNdHelper(int iters, int embedding_size, const char* op) {
+static void BM_ScatterNdHelper(int iters, int embedding_size, const char* op,
+                               int num_updates = 1000, int num_distinct = 0) {
   testing::StopTiming();
   const int kRows = 10000000 / embedding_size;
   std::vector<float> values;
@@ -259,13 +308,15 @@ static void BM_ScatterNdHelper(int iters, int embedding_size, const char* op) {
   for (int i = 0; i < kRows * embedding_size; i++) {
     values.push_back(i);
   }
-  const int kNumUpdates = 1000;
+  const int kNumUpdates = num_updates;
+  // Updates go to the first `num_distinct` rows, or to any row if it is 0.
+  const int kMaxIndex = num_distinct > 0 ? num_distinct : kRows;
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices;
   std::vector<float> updates;
   for (int i = 0; i < kNumUpdates; i++) {
-    indices.push_back(rnd.Uniform(kRows));
+    indices.push_back(rnd.Uniform(kMaxIndex));
     for (int j = 0; j < embedding_size; j++) {
       updates.push_back(i * 10 + j);
     }
@@ -300,6 +351,12 @@ static void BM_ScatterNdAddInt64(int iters, int embedding_size) {
   BM_ScatterNdHelper<int64>(iters, embedding_size, "ScatterNdAdd");
 }
 
+// Many updates of 64 values to `num_distinct` rows, from mostly distinct rows
+// to heavily duplicated ones.
+static void BM_ScatterNdAddDuplicates(int iters, int num_distinct) {
+  BM_ScatterNdHelper<int32>(iters, 64, "ScatterNdAdd", 100000, num_distinct);
+}
+
 BENCHMARK(BM_ScatterNdUpdateInt32)
     ->Arg(1)
     ->Arg(10)
@@ -315,6 +372,7 @@ BENCHMARK(BM_ScatterNdUpdateInt64)
 
 BENCHMARK(BM_ScatterNdAddInt32)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 BENCHMARK(BM_ScatterNdAddInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK(BM_ScatterNdAddDuplicates)->Arg(10)->Arg(1000)->Arg(100000);
 
 }  // namespace
 }  // namespace tensorflow
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/scatter_functor.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -227,6 +229,127 @@ TEST_F(ScatterUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+// Returns the rows of a large scatter with duplicate indices: a hot row
+// takes a third of the updates, and the others go to a few rows.
+template <typename Index>
+std::vector<Index> SkewedScatterIndices(int num_updates, int num_rows) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<Index> indices;
+  for (int i = 0; i < num_updates; ++i) {
+    indices.push_back(i % 3 == 0 ? num_rows / 2 : rnd.Uniform(16) * 7);
+  }
+  return indices;
+}
+
+TEST_F(ScatterUpdateOpTest, LargeScatterAddWithDuplicates) {
+  // Large enough to be applied by several threads.
+  const int kRows = 200;
+  const int kCols = 32;
+  const int kNumUpdates = 4096;
+  TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterAdd")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  std::vector<float> params(kRows * kCols);
+  for (int i = 0; i < params.size(); ++i) {
+    params[i] = i % 5;
+  }
+  const std::vector<int32> indices =
+      SkewedScatterIndices<int32>(kNumUpdates, kRows);
+  std::vector<float> updates(kNumUpdates * kCols);
+  for (int i = 0; i < updates.size(); ++i) {
+    updates[i] = i % 11;
+  }
+  std::vector<float> expected_values = params;
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected_values[indices[i] * kCols + j] += updates[i * kCols + j];
+    }
+  }
+
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterUpdateOpTest, LargeScatterAddOutOfRange) {
+  const int kRows = 200;
+  const int kCols = 32;
+  const int kNumUpdates = 4096;
+  TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterAdd")
+                   .Input(FakeInput(DT_FLOAT_REF))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  std::vector<int32> indices =
+      SkewedScatterIndices<int32>(kNumUpdates, kRows);
+  indices[3000] = kRows;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, 1));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}),
+                           std::vector<float>(kNumUpdates * kCols, 2));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(str_util::StrContains(s.ToString(),
+                                    "indices[3000] = 200 is not in [0, 200)"))
+      << s;
+  // No row is updated when an index is out of range.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillFn<float>(&expected, [](int) { return 1.0f; });
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST(GroupUpdatesByRowTest, BalancesSkewedRows) {
+  // Row 5 takes half of the updates, and 9 other rows share the rest.
+  std::vector<int64> rows;
+  for (int i = 0; i < 1000; ++i) {
+    rows.push_back(i % 2 == 0 ? 5 : 100 + (i / 2) % 9);
+  }
+  std::vector<int64> range_starts;
+  std::vector<int64> order;
+  scatter_op::GroupUpdatesByRow(rows, 1000, 4, &range_starts, &order);
+  ASSERT_EQ(5, range_starts.size());
+  EXPECT_EQ(0, range_starts[0]);
+  EXPECT_EQ(1000, range_starts[4]);
+
+  std::vector<int> range_of_row(1000, -1);
+  int non_empty_ranges = 0;
+  for (int r = 0; r < 4; ++r) {
+    EXPECT_LE(range_starts[r], range_starts[r + 1]);
+    non_empty_ranges += range_starts[r] < range_starts[r + 1];
+    int64 previous = -1;
+    for (int64 j = range_starts[r]; j < range_starts[r + 1]; ++j) {
+      const int64 row = rows[order[j]];
+      // Every row is in a single range, with its updates in order.
+      EXPECT_TRUE(range_of_row[row] == -1 || range_of_row[row] == r) << row;
+      range_of_row[row] = r;
+      if (j > range_starts[r] && rows[order[j - 1]] == row) {
+        EXPECT_LT(previous, order[j]);
+      }
+      previous = order[j];
+    }
+  }
+  // The hot row fills one range, and the other rows are split between the
+  // others.
+  EXPECT_LE(3, non_empty_ranges);
+  std::vector<int64> sorted_order = order;
+  std::sort(sorted_order.begin(), sorted_order.end());
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, sorted_order[i]);
+  }
+}
+
 class ScatterUpdateBM : public ScatterUpdateOpTest {
  public:
   void TestBody() override {}
@@ -241,7 +364,8 @@ class ScatterUpdateBM : public ScatterUpdateOpTest {
 };
 
 template <typename Index>
-static void BM_ScatterHelper(int iters, int embedding_size, const char* op) {
+static void BM_ScatterHelper(int iters, int embedding_size, const char* op,
+                             int num_updates = 1000, int num_distinct = 0) {
   testing::StopTiming();
   const int kRows = 10000000 / embedding_size;
   std::vector<float> values;
@@ -249,13 +373,15 @@ static void BM_ScatterHelper(int iters, int embedding_size, const char* op) {
   for (int i = 0; i < kRows * embedding_size; i++) {
     values.push_back(i);
   }
-  const int kNumUpdates = 1000;
+  const int kNumUpdates = num_updates;
+  // Updates go to the first `num_distinct` rows, or to any row if it is 0.
+  const int kMaxIndex = num_distinct > 0 ? num_distinct : kRows;
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices;
   std::vector<float> updates;
   for (int i = 0; i < kNumUpdates; i++) {
-    indices.push_back(rnd.Uniform(kRows));
+    indices.push_back(rnd.Uniform(kMaxIndex));
     for (int j = 0; j < embedding_size; j++) {
       updates.push_back(i * 10 + j);
     }
@@ -318,6 +444,15 @@ static void BM_ScatterMaxInt64(int iters, int embedding_size) {
   BM_ScatterHelper<int64>(iters, embedding_size, "ScatterMax");
 }
 
+// Many updates of 64 values to `num_distinct` rows, from mostly distinct rows
+// to heavily duplicated ones.
+static void BM_ScatterAddDuplicates(int iters, int num_distinct) {
+  BM_ScatterHelper<int32>(iters, 64, "ScatterAdd", 100000, num_distinct);
+}
+static void BM_ScatterUpdateDuplicates(int iters, int num_distinct) {
+  BM_ScatterHelper<int32>(iters, 64, "ScatterUpdate", 100000, num_distinct);
+}
+
 BENCHMARK(BM_ScatterUpdateInt32)
     ->Arg(1)
     ->Arg(10)
@@ -356,5 +491,8 @@ BENCHMARK(BM_ScatterMinInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 BENCHMARK(BM_ScatterMaxInt32)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 BENCHMARK(BM_ScatterMaxInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 
+BENCHMARK(BM_ScatterAddDuplicates)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_ScatterUpdateDuplicates)->Arg(10)->Arg(1000)->Arg(100000);
+
 }  // namespace
 }  // namespace tensorflow
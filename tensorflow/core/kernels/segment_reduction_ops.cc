@@ -33,7 +33,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -372,15 +374,42 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
                   typename TTypes<Index>::ConstFlat segment_ids,
                   const Index data_size, const T* data,
                   typename TTypes<T, 2>::Tensor output) {
-    output.setConstant(InitialValueF()());
     if (data_size == 0) {
+      output.setConstant(InitialValueF()());
       return;
     }
     const int64 N = segment_ids.dimension(0);
-    ReductionF reduction;
-    auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, data_size / N);
+    const int64 row_size = data_size / N;
+    auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, row_size);
+    // Smaller inputs are reduced by a single thread, as grouping the rows by
+    // segment would cost more than it saves.
+    const int64 kMinParallelDataSize = 32 * 1024;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    if (data_size < kMinParallelDataSize || worker_threads->num_threads <= 1) {
+      output.setConstant(InitialValueF()());
+      ReductionF reduction;
+      for (int64 i = 0; i < N; ++i) {
+        Index j = internal::SubtleMustCopy(segment_ids(i));
+        if (j < 0) {
+          continue;
+        }
+        OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
+                    errors::InvalidArgument(
+                        "segment_ids", SliceDebugString(segment_ids_shape, i),
+                        " = ", j, " is out of range [0, ", num_segments, ")"));
+        reduction(data_flat.template chip<0>(i), output.template chip<0>(j));
+      }
+      return;
+    }
+
+    // Group the rows by segment, keeping them in order so that each segment
+    // is reduced in the same order as above, and reduce ranges of segments
+    // in parallel.
+    std::vector<Index> ids(N);
+    std::vector<int64> segment_starts(num_segments + 1, 0);
     for (int64 i = 0; i < N; ++i) {
-      Index j = internal::SubtleMustCopy(segment_ids(i));
+      const Index j = internal::SubtleMustCopy(segment_ids(i));
+      ids[i] = j;
       if (j < 0) {
         continue;
       }
@@ -388,8 +417,33 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
                   errors::InvalidArgument(
                       "segment_ids", SliceDebugString(segment_ids_shape, i),
                       " = ", j, " is out of range [0, ", num_segments, ")"));
-      reduction(data_flat.template chip<0>(i), output.template chip<0>(j));
+      ++segment_starts[j + 1];
+    }
+    for (Index j = 0; j < num_segments; ++j) {
+      segment_starts[j + 1] += segment_starts[j];
+    }
+    std::vector<int64> rows(segment_starts[num_segments]);
+    {
+      std::vector<int64> next_row(segment_starts.begin(),
+                                  segment_starts.end() - 1);
+      for (int64 i = 0; i < N; ++i) {
+        if (ids[i] >= 0) rows[next_row[ids[i]]++] = i;
+      }
     }
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      ReductionF reduction;
+      for (int64 j = begin; j < end; ++j) {
+        auto output_row = output.template chip<0>(j);
+        output_row.setConstant(InitialValueF()());
+        for (int64 k = segment_starts[j]; k < segment_starts[j + 1]; ++k) {
+          reduction(data_flat.template chip<0>(rows[k]), output_row);
+        }
+      }
+    };
+    const int64 cost_per_segment =
+        (rows.size() / std::max<int64>(num_segments, 1) + 1) * row_size;
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, reduce_segments);
   }
 };
 
@@ -656,7 +710,6 @@ class SparseSegmentReductionOpBase : public OpKernel {
     auto input_flat = input.flat_outer_dims<T>();
     const int64 num_col = input_flat.dimension(1);
     const auto indices_vec = indices.vec<Index>();
-    typedef int32 OutputRow;
     const auto segment_vec = segment_ids.vec<OutputRow>();
     // Note that the current implementation assumes that segment_vec values are
     // sorted.
@@ -691,12 +744,12 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
+    // Find the segments first, checking the segment ids and the indices, so
+    // that the segments can then be reduced in parallel.
+    std::vector<Segment> segments;
+    int64 start = 0;
     OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    for (int64 end = 1; end <= num_indices; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
@@ -704,7 +757,6 @@ class SparseSegmentReductionOpBase : public OpKernel {
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
         if (out_index == next_index) {
-          ++end;
           continue;
         }
         // We have a new segment here.  Verify that the segment ids are growing.
@@ -717,34 +769,63 @@ class SparseSegmentReductionOpBase : public OpKernel {
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+      for (int64 i = start; i < end; ++i) {
+        const Index index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(context, FastBoundsCheck(index, input_flat.dimension(0)),
+                    errors::InvalidArgument(
+                        "Bad: indices[", i, "] == ", index,
+                        " out of range [0, ", input_flat.dimension(0), ")"));
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
+      segments.push_back({start, end, out_index});
       start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
-      if (end > num_indices) break;
     }
 
+    // The indices were checked above, but Reduce checks them again in case
+    // they are modified concurrently. The first bad position is reported
+    // once all the shards are done.
+    mutex bad_index_mu;
+    int64 bad_index = -1;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const Segment& segment = segments[s];
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        const OutputRow uninitialized_index =
+            s == 0 ? 0 : segments[s - 1].out_index + 1;
+        if (segment.out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment.out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        const int64 bad_offset =
+            Reduce(input_flat, indices_vec, segment.start,
+                   segment.end - segment.start,
+                   output_flat.template chip<0>(segment.out_index));
+        if (bad_offset >= 0) {
+          mutex_lock l(bad_index_mu);
+          if (bad_index < 0 || segment.start + bad_offset < bad_index) {
+            bad_index = segment.start + bad_offset;
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment =
+        (num_indices / segments.size() + 1) * num_col;
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          segments.size(), cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_index < 0,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ",
+                    indices_vec(bad_index), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
+
     // Fill the gap at the end with the default value.
+    const OutputRow uninitialized_index = segments.back().out_index + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -756,6 +837,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
 
  private:
   typedef int32 Index;
+  typedef int32 OutputRow;
+
+  // The indices [start, end) of a segment, reduced into output row
+  // `out_index`.
+  struct Segment {
+    int64 start;
+    int64 end;
+    OutputRow out_index;
+  };
 
   int64 Reduce(const typename TTypes<T>::ConstMatrix& input_flat,
                const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
@@ -113,6 +113,80 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+static void UnsortedSegmentSumHelper(int iters, int num_rows, int num_cols,
+                                     int num_segments) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({num_rows, num_cols}));
+  input.flat<float>().setRandom();
+  Tensor segment_ids(DT_INT32, TensorShape({num_rows}));
+  auto segment_ids_flat = segment_ids.flat<int32>();
+  for (int i = 0; i < num_rows; ++i) {
+    segment_ids_flat(i) = (i * 31) % num_segments;
+  }
+  Tensor num_segments_t(DT_INT32, TensorShape({}));
+  num_segments_t.scalar<int32>()() = num_segments;
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UnsortedSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, segment_ids))
+                  .Input(test::graph::Constant(g, num_segments_t))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * num_rows * num_cols *
+                          sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_UnsortedSegmentSum_Few(int iters, int num_rows) {
+  UnsortedSegmentSumHelper(iters, num_rows, 128, 16);
+}
+
+static void BM_UnsortedSegmentSum_Many(int iters, int num_rows) {
+  UnsortedSegmentSumHelper(iters, num_rows, 128, num_rows / 4);
+}
+
+BENCHMARK(BM_UnsortedSegmentSum_Few)->Arg(64)->Arg(4096)->Arg(65536);
+BENCHMARK(BM_UnsortedSegmentSum_Many)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_SparseSegmentSum(int iters, int num_indices) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kNumRows = 10000;
+  const int kDim = 64;
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, kDim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  auto segments_flat = segments.flat<int32>();
+  // Segments of 10 random rows, as in an embedding lookup.
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (i * 7919) % kNumRows;
+    segments_flat(i) = i / 10;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * num_indices * kDim *
+                          sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+BENCHMARK(BM_SparseSegmentSum)->Arg(100)->Arg(10000)->Arg(100000);
+
 static void SparseSegmentMeanGradHelper(int iters, float uniqueness, int size) {
   testing::StopTiming();
   Graph* g = new Graph(OpRegistry::Global());
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/string_hash_util.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -73,12 +74,11 @@ class SparseTensorColumn : public ColumnInterface<InternalType> {
   std::vector<int64> feature_start_indices_;
 };
 
-// InternalType is int64 only when using HashCrosser.
+// InternalType is int64 only when using HashCrosser. String features have
+// already been replaced by their fingerprints.
 template <>
 int64 SparseTensorColumn<int64>::Feature(int64 batch, int64 n) const {
   const int64 start = feature_start_indices_[batch];
-  if (DT_STRING == values_.dtype())
-    return Fingerprint64(values_.vec<string>().data()[start + n]);
   return values_.vec<int64>().data()[start + n];
 }
 
@@ -114,11 +114,10 @@ class DenseTensorColumn : public ColumnInterface<InternalType> {
   const Tensor& tensor_;
 };
 
-// InternalType is int64 only when using HashCrosser.
+// InternalType is int64 only when using HashCrosser. String features have
+// already been replaced by their fingerprints.
 template <>
 int64 DenseTensorColumn<int64>::Feature(int64 batch, int64 n) const {
-  if (DT_STRING == tensor_.dtype())
-    return Fingerprint64(tensor_.matrix<string>()(batch, n));
   return tensor_.matrix<int64>()(batch, n);
 }
 
@@ -195,7 +194,12 @@ class HashCrosser {
   HashCrosser(
       const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns,
       const int64 num_buckets, const uint64 hash_key)
-      : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
+      : columns_(columns),
+        // To prevent negative output without buckets, we take the modulo to
+        // max int64.
+        remainder_(num_buckets > 0 ? num_buckets
+                                   : std::numeric_limits<int64>::max()),
+        hash_key_(hash_key) {}
 
   int64 Generate(const int64 batch_index,
                  const std::vector<int>& permutation) const {
@@ -206,17 +210,12 @@ class HashCrosser {
       hashed_output = FingerprintCat64(hashed_output, hash_i);
     }
     // The return value is int64 based on the number of buckets.
-    if (num_buckets_ > 0) {
-      return hashed_output % num_buckets_;
-    } else {
-      // To prevent negative output we take modulo to max int64.
-      return hashed_output % std::numeric_limits<int64>::max();
-    }
+    return remainder_(hashed_output);
   }
 
  private:
   const std::vector<std::unique_ptr<ColumnInterface<int64>>>& columns_;
-  const int64 num_buckets_;
+  const UInt64Remainder remainder_;
   const uint64 hash_key_;
 };
 
@@ -311,9 +310,14 @@ class SparseCrossOp : public OpKernel {
     ValidateInput(context, indices_list_in, values_list_in, shapes_list_in,
                   dense_list_in);
 
+    std::vector<Tensor> values_in;
+    OP_REQUIRES_OK(context, ColumnInputs(context, values_list_in, &values_in));
+    std::vector<Tensor> dense_in;
+    OP_REQUIRES_OK(context, ColumnInputs(context, dense_list_in, &dense_in));
+
     std::vector<std::unique_ptr<ColumnInterface<InternalType>>> columns =
-        GenerateColumnsFromInput(indices_list_in, values_list_in,
-                                 shapes_list_in, dense_list_in);
+        GenerateColumnsFromInput(indices_list_in, values_in, shapes_list_in,
+                                 dense_list_in, dense_in);
 
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Crosser crosser(
         columns, num_buckets_, hash_key_);
@@ -441,12 +445,41 @@ class SparseCrossOp : public OpKernel {
     return 0;
   }
 
-  // Generate the columns given the sparse and dense inputs.
+  // Returns the tensors of `list_in` that the columns read features from. For
+  // hashed crosses, each string tensor is replaced by an int64 tensor of the
+  // fingerprints of its strings. The strings are fingerprinted once, in
+  // batches, instead of once for every cross they take part in.
+  Status ColumnInputs(OpKernelContext* context, const OpInputList& list_in,
+                      std::vector<Tensor>* out) {
+    out->reserve(list_in.size());
+    for (int i = 0; i < list_in.size(); ++i) {
+      const Tensor& in = list_in[i];
+      if (!HASHED_OUTPUT || in.dtype() != DT_STRING) {
+        out->push_back(in);
+        continue;
+      }
+      Tensor fingerprints;
+      TF_RETURN_IF_ERROR(
+          context->allocate_temp(DT_INT64, in.shape(), &fingerprints));
+      ShardedHashStrings(
+          context, in.flat<string>().data(), in.NumElements(),
+          [](const string& s) { return Fingerprint64(s); },
+          [](uint64 fingerprint) { return static_cast<int64>(fingerprint); },
+          fingerprints.flat<int64>().data());
+      out->push_back(std::move(fingerprints));
+    }
+    return Status::OK();
+  }
+
+  // Generate the columns given the sparse and dense inputs. `values_in` and
+  // `dense_in` hold the features, as returned by ColumnInputs(); they must
+  // outlive the columns.
   std::vector<std::unique_ptr<ColumnInterface<InternalType>>>
   GenerateColumnsFromInput(const OpInputList& indices_list_in,
-                           const OpInputList& values_list_in,
+                           const std::vector<Tensor>& values_in,
                            const OpInputList& shapes_list_in,
-                           const OpInputList& dense_list_in) {
+                           const OpInputList& dense_list_in,
+                           const std::vector<Tensor>& dense_in) {
     std::vector<std::unique_ptr<ColumnInterface<InternalType>>> columns;
     const int64 batch_size = CalculateBatchSize(shapes_list_in, dense_list_in);
     const int64 number_of_columns = shapes_list_in.size();
@@ -459,15 +492,14 @@ class SparseCrossOp : public OpKernel {
     ExtractFeatureData(indices_list_in, batch_size, &feature_counts,
                        &feature_start_indices);
 
-    columns.reserve(values_list_in.size());
-    for (int i = 0; i < values_list_in.size(); ++i) {
+    columns.reserve(values_in.size() + dense_in.size());
+    for (int i = 0; i < values_in.size(); ++i) {
       columns.emplace_back(new SparseTensorColumn<InternalType>(
-          values_list_in[i], std::move(feature_counts[i]),
+          values_in[i], std::move(feature_counts[i]),
           std::move(feature_start_indices[i])));
     }
-    for (int i = 0; i < dense_list_in.size(); ++i) {
-      columns.emplace_back(
-          new DenseTensorColumn<InternalType>(dense_list_in[i]));
+    for (int i = 0; i < dense_in.size(); ++i) {
+      columns.emplace_back(new DenseTensorColumn<InternalType>(dense_in[i]));
     }
 
     return columns;
@@ -19,6 +19,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -243,6 +246,8 @@ template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
 struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
   // Vectorize certain operations above this size.
   static const std::size_t kNumVectorize = 32;
+  // Use several threads above this number of multiply-adds.
+  static const std::size_t kMinParallelWork = 64 * 1024;
 
   static Status Compute(const CPUDevice& d, typename TTypes<T>::Matrix out,
                         typename TTypes<Tindices>::ConstMatrix a_indices,
@@ -254,11 +259,11 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     const int lhs_index_a = ADJ_A ? 1 : 0;
     const int rhs_index_a = ADJ_A ? 0 : 1;
 
-    out.setZero();
+    if (d.numThreads() > 1 && nnz * rhs_right >= kMinParallelWork) {
+      return ComputeParallel(d, out, a_indices, a_values, b);
+    }
 
-    // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-    // approach that achieves the performance of the single threaded
-    // one.  Perhaps Eigen threadpool implementation is just too slow?
+    out.setZero();
 
     if (rhs_right < kNumVectorize) {
       // Disable vectorization if the RHS of output is too small
@@ -312,6 +317,99 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     }
     return Status::OK();
   }
+
+ private:
+  // Computes the product with the nonzeros grouped by output row, in
+  // parallel over blocks of columns of the output rows.
+  static Status ComputeParallel(
+      const CPUDevice& d, typename TTypes<T>::Matrix out,
+      typename TTypes<Tindices>::ConstMatrix a_indices,
+      typename TTypes<T>::ConstVec a_values,
+      typename TTypes<T>::ConstMatrix b) {
+    typedef Eigen::Matrix<T, 1, Eigen::Dynamic> RowVector;
+    const std::size_t nnz = a_values.size();
+    const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+    const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+    const int lhs_index_a = ADJ_A ? 1 : 0;
+    const int rhs_index_a = ADJ_A ? 0 : 1;
+    const int64 out_rows = out.dimension(0);
+
+    // Group the nonzeros by output row with a counting sort. It keeps the
+    // nonzeros of each row in order, so that each output value is summed in
+    // the same order as by the serial loops.
+    std::vector<Tindices> ms(nnz);
+    std::vector<Tindices> ks(nnz);
+    std::vector<int64> row_starts(out_rows + 1, 0);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+      if (!FastBoundsCheck(k, lhs_right)) {
+        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+      }
+      if (!FastBoundsCheck(m, out.dimension(0))) {
+        return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
+      }
+      ms[i] = m;
+      ks[i] = k;
+      ++row_starts[m + 1];
+    }
+    for (int64 m = 0; m < out_rows; ++m) {
+      row_starts[m + 1] += row_starts[m];
+    }
+    std::vector<Tindices> sorted_ks(nnz);
+    std::vector<T> sorted_values(nnz);
+    {
+      std::vector<int64> next(row_starts.begin(), row_starts.end() - 1);
+      for (std::size_t i = 0; i < nnz; ++i) {
+        const int64 j = next[ms[i]]++;
+        sorted_ks[j] = ks[i];
+        sorted_values[j] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+      }
+    }
+
+    // Output rows are computed in blocks of columns, which stay in cache
+    // while the rows of B, or the columns of B for its adjoint, are added to
+    // them. The columns of B are read in place with a stride rather than
+    // transposing all of B, which would cost O(|B|) even when A only has a
+    // few nonzeros.
+    typedef Eigen::Map<const RowVector, 0, Eigen::InnerStride<>> StridedRow;
+    const std::size_t kColumnBlockSize = 1024;
+    const int64 num_blocks =
+        (rhs_right + kColumnBlockSize - 1) / kColumnBlockSize;
+    auto compute_blocks = [&](int64 begin, int64 end) {
+      for (int64 block = begin; block < end; ++block) {
+        const int64 m = block / num_blocks;
+        const std::size_t col = (block % num_blocks) * kColumnBlockSize;
+        const std::size_t num_cols =
+            std::min(kColumnBlockSize, rhs_right - col);
+        Eigen::Map<RowVector> out_block(&out(m, col), num_cols);
+        out_block.setZero();
+        for (int64 j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+          const Tindices k = sorted_ks[j];
+          if (ADJ_B) {
+            out_block.noalias() +=
+                sorted_values[j] *
+                StridedRow(&b(col, k), num_cols,
+                           Eigen::InnerStride<>(lhs_right))
+                    .conjugate();
+          } else {
+            out_block.noalias() +=
+                sorted_values[j] *
+                Eigen::Map<const RowVector>(&b(k, col), num_cols);
+          }
+        }
+      }
+    };
+    const double nnz_per_row = static_cast<double>(nnz) / out_rows;
+    const double block_size = std::min(kColumnBlockSize, rhs_right);
+    const Eigen::TensorOpCost cost(
+        nnz_per_row * block_size * sizeof(T), block_size * sizeof(T),
+        nnz_per_row * block_size *
+            (Eigen::TensorOpCost::AddCost<T>() +
+             Eigen::TensorOpCost::MulCost<T>()));
+    d.parallelFor(out_rows * num_blocks, cost, compute_blocks);
+    return Status::OK();
+  }
 };
 
 }  // namespace functor
@@ -117,4 +117,13 @@ BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, true);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, true);
 
+// Embedding-like products, with a batch of sparse rows and a wide B.
+BM_SparseTensorDenseMatmul(32768, 1024, 20000, 64, false, false);
+BM_SparseTensorDenseMatmul(32768, 1024, 20000, 512, false, false);
+BM_SparseTensorDenseMatmul(32768, 1024, 20000, 512, false, true);
+BM_SparseTensorDenseMatmul(32768, 1024, 20000, 512, true, false);
+BM_SparseTensorDenseMatmul(262144, 8192, 20000, 512, false, false);
+// A very sparse A against the adjoint of a large B.
+BM_SparseTensorDenseMatmul(1024, 512, 16384, 512, false, true);
+
 }  // end namespace tensorflow
@@ -0,0 +1,149 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_STRING_HASH_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_STRING_HASH_UTIL_H_
+
+#include <algorithm>
+#include <string>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Computes `x % divisor` for a fixed `divisor` with a multiplication and
+// shifts instead of a division, following "Division by Invariant Integers
+// using Multiplication" (Granlund and Montgomery, 1994). The result is exactly
+// `x % divisor`, so bucket ids computed with it match those computed with `%`.
+// Falls back to `%` on compilers without 128-bit integers.
+class UInt64Remainder {
+ public:
+  explicit UInt64Remainder(uint64 divisor) : divisor_(divisor) {
+    CHECK_GT(divisor, 0);
+    if ((divisor & (divisor - 1)) == 0) {
+      is_power_of_two_ = true;
+      return;
+    }
+#if defined(__SIZEOF_INT128__)
+    shift_ = Log2Floor64(divisor);
+    // Since 2^shift < divisor < 2^(shift + 1), the quotient fits in 64 bits.
+    const unsigned __int128 numerator = static_cast<unsigned __int128>(1)
+                                        << (64 + shift_);
+    uint64 multiplier = static_cast<uint64>(numerator / divisor);
+    const uint64 remainder = static_cast<uint64>(numerator % divisor);
+    if (divisor - remainder < (uint64{1} << shift_)) {
+      // floor(2^(64 + shift) / divisor) + 1 is a precise enough reciprocal.
+      needs_add_ = false;
+    } else {
+      // The precise reciprocal needs 65 bits; its top bit is implicit and
+      // added back in operator().
+      multiplier += multiplier;
+      const uint64 twice_remainder = remainder + remainder;
+      if (twice_remainder >= divisor || twice_remainder < remainder) {
+        multiplier += 1;
+      }
+      needs_add_ = true;
+    }
+    multiplier_ = multiplier + 1;
+#endif
+  }
+
+  uint64 operator()(uint64 x) const {
+    if (is_power_of_two_) return x & (divisor_ - 1);
+#if defined(__SIZEOF_INT128__)
+    uint64 quotient = static_cast<uint64>(
+        (static_cast<unsigned __int128>(multiplier_) * x) >> 64);
+    if (needs_add_) {
+      quotient = (((x - quotient) >> 1) + quotient) >> shift_;
+    } else {
+      quotient >>= shift_;
+    }
+    return x - quotient * divisor_;
+#else
+    return x % divisor_;
+#endif
+  }
+
+ private:
+  uint64 divisor_;
+  bool is_power_of_two_ = false;
+  bool needs_add_ = false;
+  int shift_ = 0;
+  uint64 multiplier_ = 0;
+};
+
+// Sets `output[i] = hash(input[i])` for `i` in [0, size). The strings are
+// hashed in small groups, and the contents of the next group are prefetched
+// while the current group is hashed: for large batches of short strings, the
+// cache misses on the string contents cost more than the hashing itself.
+template <typename Hash>
+void HashStrings(const string* input, int64 size, const Hash& hash,
+                 uint64* output) {
+  constexpr int64 kGroupSize = 8;
+  for (int64 begin = 0; begin < size; begin += kGroupSize) {
+    const int64 end = std::min(begin + kGroupSize, size);
+    const int64 prefetch_end = std::min(end + kGroupSize, size);
+    for (int64 i = end; i < prefetch_end; ++i) {
+      port::prefetch<port::PREFETCH_HINT_T0>(input[i].data());
+    }
+    for (int64 i = begin; i < end; ++i) {
+      output[i] = hash(input[i]);
+    }
+  }
+}
+
+// Sets `output[i] = reduce(hash(input[i]))` for `i` in [0, size), sharding
+// large inputs over the intra-op thread pool of `ctx`.
+template <typename Hash, typename Reduce>
+void ShardedHashStrings(OpKernelContext* ctx, const string* input, int64 size,
+                        const Hash& hash, const Reduce& reduce,
+                        int64* output) {
+  // Rough cost of hashing a short string, in cycles.
+  constexpr int64 kCostPerString = 100;
+  auto work = [&](int64 begin, int64 end) {
+    // `output` is reused as scratch space for the hashes.
+    uint64* hashes = reinterpret_cast<uint64*>(output + begin);
+    HashStrings(input + begin, end - begin, hash, hashes);
+    for (int64 i = 0; i < end - begin; ++i) {
+      output[begin + i] = reduce(hashes[i]);
+    }
+  };
+  const auto& worker_threads = *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, size,
+        kCostPerString, work);
+}
+
+// Sets `output[i] = hash(input[i]) % num_buckets` for `i` in [0, size).
+template <typename Hash>
+void HashStringsToBuckets(OpKernelContext* ctx, const string* input,
+                          int64 size, const Hash& hash, int64 num_buckets,
+                          int64* output) {
+  const UInt64Remainder remainder(num_buckets);
+  // The number of buckets is always in the positive range of int64 so is the
+  // resulting bucket id. Casting the bucket id from uint64 to int64 is safe.
+  ShardedHashStrings(
+      ctx, input, size, hash,
+      [&remainder](uint64 h) { return static_cast<int64>(remainder(h)); },
+      output);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_STRING_HASH_UTIL_H_
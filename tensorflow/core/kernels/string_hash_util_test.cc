@@ -0,0 +1,67 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/string_hash_util.h"
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(UInt64RemainderTest, MatchesModulo) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  const uint64 kMax = std::numeric_limits<uint64>::max();
+  std::vector<uint64> divisors = {
+      1,    2,    3,    5,    7,    10,   64,   100,  1000,      1 << 20,
+      1000003, 0x7fffffffffffffffULL, 0x8000000000000000ULL, kMax - 1, kMax};
+  for (int i = 0; i < 100; ++i) {
+    divisors.push_back(rnd.Rand64() >> rnd.Uniform(64));
+  }
+  for (const uint64 divisor : divisors) {
+    if (divisor == 0) continue;
+    const UInt64Remainder remainder(divisor);
+    std::vector<uint64> values = {0,          1,          divisor - 1,
+                                  divisor,    divisor + 1, kMax - 1,
+                                  kMax,       2 * divisor - 1};
+    for (int i = 0; i < 1000; ++i) {
+      values.push_back(rnd.Rand64());
+    }
+    for (const uint64 x : values) {
+      ASSERT_EQ(x % divisor, remainder(x)) << x << " % " << divisor;
+    }
+  }
+}
+
+TEST(HashStringsTest, HashesEveryString) {
+  std::vector<string> input;
+  for (int i = 0; i < 21; ++i) {
+    input.push_back(string(i, 'a'));
+  }
+  std::vector<uint64> output(input.size());
+  HashStrings(input.data(), input.size(),
+              [](const string& s) { return s.size() * 3; }, output.data());
+  for (int i = 0; i < input.size(); ++i) {
+    EXPECT_EQ(i * 3, output[i]);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
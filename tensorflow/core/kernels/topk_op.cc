@@ -36,6 +36,93 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Rows at least this long with k at most kMaxThresholdSelectRatio times
+// smaller than the row select their top k by filtering against an estimated
+// threshold (see SelectTopKByThreshold).
+constexpr int64 kMinThresholdSelectCols = 4096;
+constexpr int64 kMaxThresholdSelectRatio = 8;
+
+// Orders the columns of a row by decreasing value, breaking ties by
+// increasing column.
+template <typename T>
+struct StableGreater {
+  bool operator()(const int32 a, const int32 b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+  const T* input_data;
+};
+
+// Writes the columns of the k largest values of `input_data` to `indices`,
+// in decreasing order if `sorted`.
+//
+// A threshold is taken from a strided sample of the row so that a few times
+// k values are expected to reach it. Blocks of the row are compared against
+// it without branching, which the compiler vectorizes, and only the columns
+// of blocks with a value reaching the threshold are collected. The top k of
+// those candidates are then found with nth_element, and only they are
+// sorted. Every value of the true top k reaches the threshold whenever at
+// least k values do, so the result matches the heap. Otherwise, which the
+// sample makes unlikely, this returns false without writing `indices`.
+//
+// `sample` and `candidates` are scratch space reused across rows.
+template <typename T>
+bool SelectTopKByThreshold(const T* input_data, const int64 num_cols,
+                           const int k, const bool sorted,
+                           std::vector<T>* sample,
+                           std::vector<int32>* candidates, int32* indices) {
+  const int64 num_samples = std::min(num_cols, 1024 + num_cols / 64);
+  sample->resize(num_samples);
+  for (int64 i = 0; i < num_samples; ++i) {
+    (*sample)[i] = input_data[i * num_cols / num_samples];
+  }
+  // Aim for about 2 * k survivors, plus a margin for the sampling error of
+  // small ranks.
+  const int64 rank = std::min(
+      num_samples - 1,
+      2 * ((k * num_samples + num_cols - 1) / num_cols) + 16);
+  std::nth_element(sample->begin(), sample->begin() + rank, sample->end(),
+                   [](const T a, const T b) { return b < a; });
+  const T threshold = (*sample)[rank];
+
+  constexpr int64 kBlockSize = 16;
+  candidates->clear();
+  int64 c = 0;
+  for (; c + kBlockSize <= num_cols; c += kBlockSize) {
+    const T* block = input_data + c;
+    int any_selected = 0;
+    for (int64 i = 0; i < kBlockSize; ++i) {
+      any_selected |= !(block[i] < threshold);
+    }
+    if (!any_selected) continue;
+    for (int64 i = 0; i < kBlockSize; ++i) {
+      if (!(block[i] < threshold)) candidates->push_back(c + i);
+    }
+  }
+  for (; c < num_cols; ++c) {
+    if (!(input_data[c] < threshold)) candidates->push_back(c);
+  }
+  if (static_cast<int64>(candidates->size()) < k) return false;
+
+  const StableGreater<T> comp{input_data};
+  std::nth_element(candidates->begin(), candidates->begin() + (k - 1),
+                   candidates->end(), comp);
+  if (sorted) {
+    std::sort(candidates->begin(), candidates->begin() + k, comp);
+  }
+  std::copy(candidates->begin(), candidates->begin() + k, indices);
+  return true;
+}
+
+}  // namespace
+
 template <typename Device, typename T>
 class TopK : public OpKernel {
  public:
@@ -134,26 +221,18 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    const bool select_by_threshold =
+        num_cols >= kMinThresholdSelectCols &&
+        k * kMaxThresholdSelectRatio <= num_cols;
     auto SortIndices = [&, context](int start_batch, int limit_batch) {
+      std::vector<T> sample;
+      std::vector<int32> candidates;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32 a, const int32 b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
+        const StableGreater<T> stable_comp{input_data};
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -176,9 +255,14 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+        } else if (select_by_threshold &&
+                   SelectTopKByThreshold(input_data, num_cols, k, sorted,
+                                         &sample, &candidates,
+                                         &indices(b, 0))) {
+          // The indices were written by SelectTopKByThreshold.
         } else {
           // Use the TopN heap object to sort.
-          gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+          gtl::TopN<int32, StableGreater<T>> filter(k, stable_comp);
           filter.reserve(num_cols);
           for (int32 c = 0; c < num_cols; ++c) {
             filter.push(c);
@@ -206,14 +290,21 @@ struct TopKFunctor<CPUDevice, T> {
     };
 
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
-    // If K == N, assume the cost is N*log(K + 1).
+    // If K == N, assume the cost is N*log(K + 1). Selecting by threshold
+    // is about one comparison per column, plus sorting the K results.
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
                             Eigen::TensorOpCost::AddCost<T>();
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
                             Eigen::numext::log2(static_cast<float>(k + 1)));
-    const double sort_cost = (k == num_cols) ? base_cost : 4 * base_cost;
+    const double threshold_cost =
+        cmp_cost *
+        (num_cols + k * Eigen::numext::log2(static_cast<float>(k + 1)));
+    const double sort_cost =
+        (k == num_cols) ? base_cost
+                        : (select_by_threshold ? threshold_cost
+                                               : 4 * base_cost);
     const double copy_cost = 2 * k * Eigen::TensorOpCost::AddCost<T>();
     const double total_cost = sort_cost + copy_cost;
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
@@ -21,6 +21,8 @@ namespace compression {
 
 const char kNone[] = "";
 const char kGzip[] = "GZIP";
+const char kZlib[] = "ZLIB";
+const char kSnappy[] = "SNAPPY";
 
 }  // namespace compression
 }  // namespace io
@@ -22,6 +22,8 @@ namespace compression {
 
 extern const char kNone[];
 extern const char kGzip[];
+extern const char kZlib[];
+extern const char kSnappy[];
 
 }  // namespace compression
 }  // namespace io
@@ -0,0 +1,91 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace io {
+
+const char RecordIndex::kMagic[] = "TFRIDX01";
+
+string RecordIndex::IndexFileName(StringPiece fname) {
+  return strings::StrCat(fname, ".index");
+}
+
+Status RecordIndex::Write(const std::vector<uint64>& offsets,
+                          WritableFile* dest) {
+  TF_RETURN_IF_ERROR(dest->Append(StringPiece(kMagic, kMagicSize)));
+  string encoded;
+  encoded.reserve(offsets.size() * sizeof(uint64));
+  for (uint64 offset : offsets) {
+    core::PutFixed64(&encoded, offset);
+  }
+  TF_RETURN_IF_ERROR(dest->Append(encoded));
+  char footer[kFooterSize];
+  core::EncodeFixed64(footer, offsets.size());
+  core::EncodeFixed32(footer + sizeof(uint64),
+                      crc32c::Mask(crc32c::Value(encoded.data(),
+                                                 encoded.size())));
+  return dest->Append(StringPiece(footer, sizeof(footer)));
+}
+
+Status RecordIndex::Read(Env* env, const string& fname,
+                         std::unique_ptr<RecordIndex>* index) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, fname, &contents));
+  if (contents.size() < kMagicSize + kFooterSize ||
+      StringPiece(contents.data(), kMagicSize) !=
+          StringPiece(kMagic, kMagicSize)) {
+    return errors::DataLoss("Not a TFRecord index file: ", fname);
+  }
+  const char* footer = contents.data() + contents.size() - kFooterSize;
+  const uint64 num_records = core::DecodeFixed64(footer);
+  const size_t data_size = contents.size() - kMagicSize - kFooterSize;
+  if (data_size != num_records * sizeof(uint64)) {
+    return errors::DataLoss("Truncated TFRecord index file: ", fname);
+  }
+  const char* data = contents.data() + kMagicSize;
+  const uint32 masked_crc = core::DecodeFixed32(footer + sizeof(uint64));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data, data_size)) {
+    return errors::DataLoss("Corrupted TFRecord index file: ", fname);
+  }
+  std::vector<uint64> offsets(num_records);
+  for (uint64 i = 0; i < num_records; ++i) {
+    offsets[i] = core::DecodeFixed64(data + i * sizeof(uint64));
+  }
+  index->reset(new RecordIndex(std::move(offsets)));
+  return Status::OK();
+}
+
+IndexedRecordReader::IndexedRecordReader(RandomAccessFile* file,
+                                         const RecordIndex* index)
+    : reader_(file), index_(index) {}
+
+Status IndexedRecordReader::ReadRecord(int64 i, string* record) {
+  if (i < 0 || i >= index_->num_records()) {
+    return errors::OutOfRange("Record ", i, " is out of range [0, ",
+                              index_->num_records(), ")");
+  }
+  uint64 offset = index_->offset(i);
+  return reader_.ReadRecord(&offset, record);
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// A record index maps the number of each record of an uncompressed TFRecord
+// file to its offset in the file, so that records can be read in any order.
+// It is stored in a sidecar file next to the TFRecord file.
+//
+// Format of the index file:
+//  byte      magic[8]
+//  uint64    offset[num_records]
+//  uint64    num_records
+//  uint32    masked crc of offset[0, num_records)
+class RecordIndex {
+ public:
+  static const char kMagic[];
+  static const size_t kMagicSize = 8;
+  static const size_t kFooterSize = sizeof(uint64) + sizeof(uint32);
+
+  // Returns the name of the index file of the TFRecord file `fname`.
+  static string IndexFileName(StringPiece fname);
+
+  // Reads the index stored in `fname`.
+  static Status Read(Env* env, const string& fname,
+                     std::unique_ptr<RecordIndex>* index);
+
+  // Writes the index of a file whose records start at `offsets`.
+  static Status Write(const std::vector<uint64>& offsets, WritableFile* dest);
+
+  int64 num_records() const { return offsets_.size(); }
+
+  // Offset of record `i`, which must be in [0, num_records()).
+  uint64 offset(int64 i) const { return offsets_[i]; }
+
+ private:
+  explicit RecordIndex(std::vector<uint64> offsets)
+      : offsets_(std::move(offsets)) {}
+
+  const std::vector<uint64> offsets_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordIndex);
+};
+
+// Reads the records of an uncompressed TFRecord file by record number, using
+// its index.
+//
+// Note: this class is not thread safe; external synchronization required.
+class IndexedRecordReader {
+ public:
+  // "*file" and "*index" must remain live while this reader is in use.
+  IndexedRecordReader(RandomAccessFile* file, const RecordIndex* index);
+
+  int64 num_records() const { return index_->num_records(); }
+
+  // Reads record `i` into *record. Returns OUT_OF_RANGE if `i` is not in
+  // [0, num_records()).
+  Status ReadRecord(int64 i, string* record);
+
+ private:
+  RecordReader reader_;
+  const RecordIndex* const index_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
@@ -0,0 +1,137 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+std::vector<string> MakeRecords(int n) {
+  std::vector<string> records;
+  for (int i = 0; i < n; ++i) {
+    // Records of varying sizes, including empty ones.
+    records.push_back(string(i % 7 * 13, 'a' + i % 26));
+  }
+  return records;
+}
+
+void WriteIndexedFile(const string& fname,
+                      const std::vector<string>& records) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(env->NewWritableFile(RecordIndex::IndexFileName(fname),
+                                    &index_file));
+  RecordWriter writer(file.get(), index_file.get());
+  for (const string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  // Closing again must not write the index twice.
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+  TF_ASSERT_OK(index_file->Close());
+}
+
+TEST(RecordIndexTest, RandomAccess) {
+  const string fname = io::JoinPath(testing::TmpDir(), "indexed.tfrecord");
+  const std::vector<string> records = MakeRecords(100);
+  WriteIndexedFile(fname, records);
+
+  Env* env = Env::Default();
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(env, RecordIndex::IndexFileName(fname), &index));
+  EXPECT_EQ(records.size(), index->num_records());
+  EXPECT_EQ(0, index->offset(0));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  IndexedRecordReader reader(file.get(), index.get());
+  string record;
+  // Read backwards, then a few arbitrary records.
+  for (int i = records.size() - 1; i >= 0; --i) {
+    TF_ASSERT_OK(reader.ReadRecord(i, &record));
+    EXPECT_EQ(records[i], record);
+  }
+  for (int i : {42, 7, 99, 0, 42}) {
+    TF_ASSERT_OK(reader.ReadRecord(i, &record));
+    EXPECT_EQ(records[i], record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(100, &record)));
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(-1, &record)));
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const string fname = io::JoinPath(testing::TmpDir(), "empty.tfrecord");
+  WriteIndexedFile(fname, {});
+  std::unique_ptr<RecordIndex> index;
+  TF_ASSERT_OK(RecordIndex::Read(Env::Default(),
+                                 RecordIndex::IndexFileName(fname), &index));
+  EXPECT_EQ(0, index->num_records());
+}
+
+TEST(RecordIndexTest, CorruptedIndex) {
+  Env* env = Env::Default();
+  const string fname = io::JoinPath(testing::TmpDir(), "corrupted.tfrecord");
+  WriteIndexedFile(fname, MakeRecords(10));
+  const string index_fname = RecordIndex::IndexFileName(fname);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, index_fname, &contents));
+
+  std::unique_ptr<RecordIndex> index;
+  string corrupted = contents;
+  corrupted[RecordIndex::kMagicSize + 3] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(env, index_fname, corrupted));
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, index_fname, &index)));
+
+  TF_ASSERT_OK(WriteStringToFile(env, index_fname, contents.substr(1)));
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, index_fname, &index)));
+
+  TF_ASSERT_OK(WriteStringToFile(
+      env, index_fname,
+      contents.substr(0, RecordIndex::kMagicSize + sizeof(uint64)) +
+          contents.substr(contents.size() - RecordIndex::kFooterSize)));
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, index_fname, &index)));
+}
+
+TEST(RecordIndexTest, CompressedFilesAreNotIndexed) {
+  Env* env = Env::Default();
+  const string fname = io::JoinPath(testing::TmpDir(), "compressed.tfrecord");
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_ASSERT_OK(env->NewWritableFile(RecordIndex::IndexFileName(fname),
+                                    &index_file));
+  RecordWriter writer(file.get(), index_file.get(),
+                      RecordWriterOptions::CreateRecordWriterOptions("ZLIB"));
+  EXPECT_TRUE(errors::IsFailedPrecondition(writer.WriteRecord("abc")));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
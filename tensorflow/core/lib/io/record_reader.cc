@@ -31,7 +31,7 @@ namespace io {
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
-  if (compression_type == "ZLIB") {
+  if (compression_type == compression::kZlib) {
     options.compression_type = io::RecordReaderOptions::ZLIB_COMPRESSION;
 #if defined(IS_SLIM_BUILD)
     LOG(ERROR) << "Compression is not supported but compression_type is set."
@@ -46,6 +46,12 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,6 +77,18 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::SNAPPY_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    // The snappy buffers read the file directly, and must fit a whole block,
+    // before and after decompression. Snappy compresses n bytes to at most
+    // 32 + n + n / 6 bytes.
+    const size_t block_size = options.snappy_block_size;
+    input_stream_.reset(new SnappyInputBuffer(
+        file, 32 + block_size + block_size / 6, block_size));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -125,10 +143,9 @@ Status RecordReader::GetMetadata(Metadata* md) {
     // loop should be guaranteed to either return after reaching EOF
     // or encountering an error.
     uint64 offset = 0;
-    string record;
     while (true) {
       // Read header, containing size of data.
-      Status s = ReadChecksummed(offset, sizeof(uint64), &record);
+      Status s = ReadChecksummed(offset, sizeof(uint64), &header_);
       if (!s.ok()) {
         if (errors::IsOutOfRange(s)) {
           // We should reach out of range when the record file is complete.
@@ -138,7 +155,7 @@ Status RecordReader::GetMetadata(Metadata* md) {
       }
 
       // Read the length of the data.
-      const uint64 length = core::DecodeFixed64(record.data());
+      const uint64 length = core::DecodeFixed64(header_.data());
 
       // Skip reading the actual data since we just want the number
       // of records and the size of the data.
@@ -175,13 +192,14 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
   }
   DCHECK_EQ(desired_pos, input_stream_->Tell());
 
-  // Read header data.
-  Status s = ReadChecksummed(*offset, sizeof(uint64), record);
+  // Read header data. The header goes into a scratch buffer that is reused
+  // across calls, so that reading a record does not allocate for it.
+  Status s = ReadChecksummed(*offset, sizeof(uint64), &header_);
   if (!s.ok()) {
     last_read_failed_ = true;
     return s;
   }
-  const uint64 length = core::DecodeFixed64(record->data());
+  const uint64 length = core::DecodeFixed64(header_.data());
 
   // Read data
   s = ReadChecksummed(*offset + kHeaderSize, length, record);
@@ -198,6 +216,12 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
   return Status::OK();
 }
 
+Status RecordReader::ReadRecord(uint64* offset, StringPiece* record) {
+  TF_RETURN_IF_ERROR(ReadRecord(offset, &record_));
+  *record = record_;
+  return Status::OK();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
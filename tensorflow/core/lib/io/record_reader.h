@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_inputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -34,7 +35,11 @@ namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   // If buffer_size is non-zero, then all reads must be sequential, and no
@@ -48,6 +53,10 @@ class RecordReaderOptions {
 #if !defined(IS_SLIM_BUILD)
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
+
+  // Options specific to snappy compression. Must be at least the
+  // `snappy_block_size` the file was written with.
+  int32 snappy_block_size = 256 << 10;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -91,6 +100,11 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, string* record);
 
+  // Same as above, but *record points into a buffer owned by this reader,
+  // which is reused for every record instead of allocating a new string.
+  // *record remains valid until the next call to a method of this reader.
+  Status ReadRecord(uint64* offset, StringPiece* record);
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -109,6 +123,11 @@ class RecordReader {
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
 
+  // Scratch space for record headers, and for the records returned as
+  // StringPieces. Both keep their capacity between reads.
+  string header_;
+  string record_;
+
   std::unique_ptr<Metadata> cached_metadata_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
@@ -133,6 +152,12 @@ class SequentialRecordReader {
     return underlying_.ReadRecord(&offset_, record);
   }
 
+  // Same as above, but *record points into a buffer owned by this reader and
+  // remains valid until the next call to a method of this reader.
+  Status ReadRecord(StringPiece* record) {
+    return underlying_.ReadRecord(&offset_, record);
+  }
+
   // Returns the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
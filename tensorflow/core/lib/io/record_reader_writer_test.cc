@@ -23,9 +23,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -41,9 +44,18 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::SNAPPY_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
+bool SnappyCompressionSupported() {
+  string out;
+  StringPiece in = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+  return port::Snappy_Compress(in.data(), in.size(), &out);
+}
+
 uint64 GetFileSize(const string& fname) {
   Env* env = Env::Default();
   uint64 fsize;
@@ -117,6 +129,16 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestSnappyFlush) {
+  if (!SnappyCompressionSupported()) {
+    LOG(INFO) << "Snappy disabled. Skipping test";
+    return;
+  }
+  io::RecordWriterOptions options;
+  options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  VerifyFlush(options);
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -196,6 +218,101 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestSnappy) {
+  if (!SnappyCompressionSupported()) {
+    LOG(INFO) << "Snappy disabled. Skipping test";
+    return;
+  }
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
+  // Records smaller and larger than a block, which must be split.
+  const std::vector<string> records = {"abc", string(300, 'x'), "defg",
+                                       string(1000, 'y'), ""};
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriterOptions options;
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+    options.snappy_block_size = 128;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options =
+        io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY");
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    std::vector<uint64> offsets;
+    string record;
+    for (const string& expected : records) {
+      offsets.push_back(offset);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+
+    // Seeking backwards rereads the stream from the start.
+    offset = offsets[1];
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[1], record);
+    EXPECT_EQ(offsets[2], offset);
+
+    io::RecordReader::Metadata md;
+    TF_ASSERT_OK(reader.GetMetadata(&md));
+    EXPECT_EQ(records.size(), md.stats.entries);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadRecordIntoStringPiece) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_string_piece_test";
+  const std::vector<string> records = {string(1000, 'a'), "b", "",
+                                       string(100, 'c')};
+
+  for (const string& compression_type :
+       {io::compression::kNone, io::compression::kZlib}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(
+          file.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+      for (const string& record : records) {
+        TF_EXPECT_OK(writer.WriteRecord(record));
+      }
+      TF_CHECK_OK(writer.Close());
+    }
+
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::SequentialRecordReader reader(
+        read_file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+    StringPiece record;
+    const char* buffer = nullptr;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&record));
+      EXPECT_EQ(expected, record);
+      // The first record is the largest one, so the buffer it was read into
+      // is reused for the following ones.
+      if (buffer == nullptr) {
+        buffer = record.data();
+      } else if (!record.empty()) {
+        EXPECT_EQ(buffer, record.data());
+      }
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -219,4 +336,78 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+// Measures the throughput of reading and decompressing records with a single
+// thread. If `string_piece` is true, records are read into StringPieces rather
+// than strings.
+static void BM_ReadRecords(int iters, const string& compression_type,
+                           bool string_piece) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  const string fname = strings::StrCat(testing::TmpDir(),
+                                       "/record_reader_benchmark_",
+                                       compression_type);
+  // Distinct, moderately compressible records, like serialized examples.
+  const int kNumRecords = 1000;
+  int64 bytes = 0;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(
+        file.get(),
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+    uint32 value = 1;
+    for (int i = 0; i < kNumRecords; ++i) {
+      string record;
+      for (int j = 0; record.size() < 1000; ++j) {
+        value = value * 1664525 + 1013904223;
+        strings::StrAppend(&record, "feature_", j % 17, ":", value % 100000,
+                           ";");
+      }
+      bytes += record.size();
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  const io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(compression_type);
+  testing::BytesProcessed(iters * bytes);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    io::SequentialRecordReader reader(file.get(), options);
+    string result;
+    StringPiece result_piece;
+    for (int j = 0; j < kNumRecords; ++j) {
+      if (string_piece) {
+        TF_CHECK_OK(reader.ReadRecord(&result_piece));
+      } else {
+        TF_CHECK_OK(reader.ReadRecord(&result));
+      }
+    }
+  }
+}
+
+static void BM_ReadRecordsUncompressed(int iters) {
+  BM_ReadRecords(iters, io::compression::kNone, false);
+}
+BENCHMARK(BM_ReadRecordsUncompressed);
+
+static void BM_ReadRecordsUncompressedStringPiece(int iters) {
+  BM_ReadRecords(iters, io::compression::kNone, true);
+}
+BENCHMARK(BM_ReadRecordsUncompressedStringPiece);
+
+static void BM_ReadRecordsZlib(int iters) {
+  BM_ReadRecords(iters, io::compression::kZlib, false);
+}
+BENCHMARK(BM_ReadRecordsZlib);
+
+static void BM_ReadRecordsSnappy(int iters) {
+  if (!SnappyCompressionSupported()) return;
+  BM_ReadRecords(iters, io::compression::kSnappy, false);
+}
+BENCHMARK(BM_ReadRecordsSnappy);
+
 }  // namespace tensorflow
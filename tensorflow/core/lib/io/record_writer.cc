@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -26,12 +28,20 @@ namespace {
 bool IsZlibCompressed(RecordWriterOptions options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
+
+bool IsSnappyCompressed(RecordWriterOptions options) {
+  return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
+}
+
+bool IsCompressed(RecordWriterOptions options) {
+  return IsZlibCompressed(options) || IsSnappyCompressed(options);
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     const string& compression_type) {
   RecordWriterOptions options;
-  if (compression_type == "ZLIB") {
+  if (compression_type == compression::kZlib) {
     options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
 #if defined(IS_SLIM_BUILD)
     LOG(ERROR) << "Compression is not supported but compression_type is set."
@@ -46,6 +56,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,6 +87,14 @@ RecordWriter::RecordWriter(WritableFile* dest,
                  << s.ToString();
     }
     dest_ = zlib_output_buffer;
+#endif  // IS_SLIM_BUILD
+  } else if (IsSnappyCompressed(options)) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    // The output buffer only batches writes to the file.
+    dest_ = new SnappyOutputBuffer(dest, options.snappy_block_size,
+                                   options.snappy_block_size);
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
@@ -79,6 +103,12 @@ RecordWriter::RecordWriter(WritableFile* dest,
   }
 }
 
+RecordWriter::RecordWriter(WritableFile* dest, WritableFile* index_dest,
+                           const RecordWriterOptions& options)
+    : RecordWriter(dest, options) {
+  index_dest_ = index_dest;
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -98,19 +128,38 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   //  uint32    masked crc of length
   //  byte      data[length]
   //  uint32    masked crc of data
+  if (index_dest_ != nullptr &&
+      options_.compression_type != RecordWriterOptions::NONE) {
+    return errors::FailedPrecondition(
+        "Record indices are only supported for uncompressed files");
+  }
   char header[kHeaderSize];
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (index_dest_ != nullptr) {
+    record_offsets_.push_back(offset_);
+    offset_ += kHeaderSize + data.size() + kFooterSize;
+  }
+  return Status::OK();
 }
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
+  if (index_dest_ != nullptr &&
+      options_.compression_type == RecordWriterOptions::NONE) {
+    // The index is written once, even though uncompressed writers may be
+    // closed more than once.
+    WritableFile* index_dest = index_dest_;
+    index_dest_ = nullptr;
+    TF_RETURN_IF_ERROR(RecordIndex::Write(record_offsets_, index_dest));
+    TF_RETURN_IF_ERROR(index_dest->Flush());
+  }
 #if !defined(IS_SLIM_BUILD)
-  if (IsZlibCompressed(options_)) {
+  if (IsCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -125,7 +174,7 @@ Status RecordWriter::Flush() {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
-  if (IsZlibCompressed(options_)) {
+  if (IsCompressed(options_)) {
     return dest_->Flush();
   }
   return Status::OK();
@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
@@ -35,7 +38,11 @@ namespace io {
 
 class RecordWriterOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   static RecordWriterOptions CreateRecordWriterOptions(
@@ -44,6 +51,11 @@ class RecordWriterOptions {
 // Options specific to zlib compression.
 #if !defined(IS_SLIM_BUILD)
   tensorflow::io::ZlibCompressionOptions zlib_options;
+
+  // Options specific to snappy compression. The records are compressed in
+  // independent blocks of at most `snappy_block_size` bytes, which must not
+  // be larger than the `snappy_block_size` of the readers.
+  int32 snappy_block_size = 256 << 10;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -63,6 +75,13 @@ class RecordWriter {
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Create a writer that also writes an index of the records to "*index_dest"
+  // when it is closed (see RecordIndex). Indices are only supported for
+  // uncompressed files. "*index_dest" must be initially empty and must remain
+  // live while this Writer is in use.
+  RecordWriter(WritableFile* dest, WritableFile* index_dest,
+               const RecordWriterOptions& options = RecordWriterOptions());
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -76,7 +95,8 @@ class RecordWriter {
   // WritableFile.
   Status Flush();
 
-  // Writes all output to the file. Does *not* close the WritableFile.
+  // Writes all output to the file, and the index if there is one. Does *not*
+  // close the WritableFiles.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -94,6 +114,11 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Only set when writing an index.
+  WritableFile* index_dest_ = nullptr;
+  uint64 offset_ = 0;
+  std::vector<uint64> record_offsets_;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
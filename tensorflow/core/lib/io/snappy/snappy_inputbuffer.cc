@@ -47,15 +47,13 @@ Status SnappyInputBuffer::ReadNBytes(int64 bytes_to_read, string* result) {
   return Status::OK();
 }
 
-int64 SnappyInputBuffer::Tell() const {
-  // TODO(srbs): Implement this.
-  return -1;
-}
+int64 SnappyInputBuffer::Tell() const { return bytes_read_; }
 
 Status SnappyInputBuffer::Reset() {
   file_pos_ = 0;
   avail_in_ = 0;
   avail_out_ = 0;
+  bytes_read_ = 0;
   next_in_ = input_buffer_.get();
 
   return Status::OK();
@@ -68,6 +66,7 @@ size_t SnappyInputBuffer::ReadBytesFromCache(size_t bytes_to_read,
     result->append(next_out_, can_read_bytes);
     next_out_ += can_read_bytes;
     avail_out_ -= can_read_bytes;
+    bytes_read_ += can_read_bytes;
   }
 
   return can_read_bytes;
@@ -105,7 +104,12 @@ Status SnappyInputBuffer::Inflate() {
   DCHECK_EQ(avail_out_, 0);
 
   // Output buffer must be large enough to fit the uncompressed block.
-  DCHECK_GE(output_buffer_capacity_, uncompressed_length);
+  if (uncompressed_length > output_buffer_capacity_) {
+    return errors::ResourceExhausted(
+        "Output buffer(size: ", output_buffer_capacity_,
+        " bytes) too small. Should be larger than ", uncompressed_length,
+        " bytes.");
+  }
   next_out_ = output_buffer_.get();
 
   bool status = port::Snappy_Uncompress(next_in_, compressed_block_length,
@@ -45,37 +45,42 @@ Status SnappyOutputBuffer::Write(StringPiece data) {
   }
 
   // If there isn't enough available space in the input_buffer_ we empty it
-  // by uncompressing its contents. If data now fits in input_buffer_
-  // we add it there else we directly deflate it.
+  // by compressing its contents.
   TF_RETURN_IF_ERROR(DeflateBuffered());
 
-  // input_buffer_ should be empty at this point.
-  if (bytes_to_write <= AvailableInputSpace()) {
-    AddToInputBuffer(data);
-    return Status::OK();
-  }
-
-  // `data` is too large to fit in input buffer so we deflate it directly.
+  // `data` is compressed directly in blocks of the size of input_buffer_, so
+  // that no block is larger than the input buffer, and the rest is buffered.
   // Note that at this point we have already deflated all existing input so
   // we do not need to backup next_in and avail_in.
-  next_in_ = const_cast<char*>(data.data());
-  avail_in_ = bytes_to_write;
-
-  TF_RETURN_IF_ERROR(Deflate());
-
-  DCHECK(avail_in_ == 0);  // All input will be used up.
+  while (data.size() > input_buffer_capacity_) {
+    next_in_ = const_cast<char*>(data.data());
+    avail_in_ = input_buffer_capacity_;
+    TF_RETURN_IF_ERROR(Deflate());
+    DCHECK(avail_in_ == 0);  // All input will be used up.
+    data.remove_prefix(input_buffer_capacity_);
+  }
 
   next_in_ = input_buffer_.get();
+  AddToInputBuffer(data);
 
   return Status::OK();
 }
 
+Status SnappyOutputBuffer::Append(StringPiece data) { return Write(data); }
+
 Status SnappyOutputBuffer::Flush() {
   TF_RETURN_IF_ERROR(DeflateBuffered());
   TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
   return Status::OK();
 }
 
+Status SnappyOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status SnappyOutputBuffer::Close() { return Flush(); }
+
 int32 SnappyOutputBuffer::AvailableInputSpace() const {
   return input_buffer_capacity_ - avail_in_;
 }
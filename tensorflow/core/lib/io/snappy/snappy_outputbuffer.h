@@ -37,13 +37,16 @@ namespace io {
 // The compressed output is buffered in a buffer of size `output_buffer_bytes`
 // which gets flushed to file when full.
 //
+// Data is compressed in blocks of at most `input_buffer_bytes` bytes, so
+// the reader needs an output buffer of at least that size.
+//
 // Output file format:
 // The output file consists of a sequence of compressed blocks. Each block
 // starts with a 4 byte header which stores the length (in bytes) of the
 // _compressed_ block _excluding_ this header. The compressed
 // block (excluding the 4 byte header) is a valid snappy block and can directly
 // be uncompressed using Snappy_Uncompress.
-class SnappyOutputBuffer {
+class SnappyOutputBuffer : public WritableFile {
  public:
   // Create an SnappyOutputBuffer for `file` with two buffers that cache the
   // 1. input data to be deflated
@@ -63,9 +66,18 @@ class SnappyOutputBuffer {
   // To immediately write contents to file call `Flush()`.
   Status Write(StringPiece data);
 
+  // Same as Write().
+  Status Append(StringPiece data) override;
+
   // Compresses any cached input and writes all output to file. This must be
   // called before the destructor to avoid any data loss.
-  Status Flush();
+  Status Flush() override;
+
+  // Flushes and syncs the underlying file.
+  Status Sync() override;
+
+  // Same as Flush(). Does *not* close the underlying file.
+  Status Close() override;
 
  private:
   // Appends `data` to `input_buffer_`.
@@ -1640,6 +1640,104 @@ REGISTER_OP("ClipByValue")
     .Attr("T: numbertype")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+// --------------------------------------------------------------------------
+REGISTER_OP("_FusedElementwise")
+    .Input("inputs: N * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("N: int >= 1")
+    .Attr("ops: list(string) >= 1")
+    .Attr("operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      // Every input either has the shape of the output or is a scalar.
+      ShapeHandle out = c->Scalar();
+      bool found_non_scalar = false;
+      for (int i = 0; i < c->num_inputs(); ++i) {
+        ShapeHandle input = c->input(i);
+        if (c->RankKnown(input) && c->Rank(input) == 0) {
+          continue;
+        }
+        if (!found_non_scalar) {
+          out = input;
+          found_non_scalar = true;
+          continue;
+        }
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(c->Merge(out, input, &out),
+                                        "From merging shape ", i,
+                                        " with other shapes.");
+      }
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Evaluates a chain of element-wise ops in a single pass over memory.
+
+`ops` lists the op types of the chain in evaluation order; the output of the
+last op is the output of the fused op. `operands` holds the operands of every
+op in turn, one for unary and two for binary ops. A non-negative operand `i`
+refers to `inputs[i]`, a negative operand `-k` to the result of `ops[k - 1]`.
+Every input must either have the shape of the output or be a scalar.
+
+NOTE Do not invoke this operator directly in Python. Grappler's remapper is
+expected to create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+REGISTER_OP("_FusedEmbeddingLookupSparse")
+    .Input("params: T")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: int32")
+    .Input("weights: num_weights * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tids: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("num_weights: int >= 0")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params_shape));
+      ShapeHandle ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids_shape));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+      // indices and segment_ids should merge cleanly.
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+      for (int i = 4; i < c->num_inputs(); ++i) {
+        ShapeHandle weights_shape;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &weights_shape));
+        DimensionHandle unused_dim;
+        TF_RETURN_IF_ERROR(c->Merge(c->Dim(weights_shape, 0),
+                                    c->Dim(ids_shape, 0), &unused_dim));
+      }
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Looks up embeddings and combines them per segment in a single pass.
+
+Computes the `combiner` reduction of `params[ids[indices]]` over the segments
+given by `segment_ids`, like a Gather of `params` at `ids` feeding a
+SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN, without
+materializing the gathered rows. If `weights` is given, it holds one weight
+per id, the rows are scaled by their weights, and the mean and sqrtn
+combiners divide by the sum of the weights and the square root of the sum of
+the squared weights respectively, as in `embedding_lookup_sparse`.
+
+NOTE Do not invoke this operator directly in Python. Grappler's remapper is
+expected to create these operators.
+)doc");
+
 #ifdef INTEL_MKL
 REGISTER_OP("_MklAddN")
     .Input("inputs: N * T")
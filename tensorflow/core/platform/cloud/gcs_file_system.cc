@@ -83,6 +83,16 @@ constexpr size_t kDefaultMaxCacheSize = 2 * kDefaultBlockSize;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of blocks that
+// are fetched ahead of a sequential reader. This is further limited to half of
+// the blocks that fit in the cache. 0 disables readahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+constexpr size_t kDefaultReadaheadBlocks = 4;
+// The environment variable that overrides the maximum number of blocks that
+// are fetched ahead of readers in parallel, across all files.
+constexpr char kReadaheadMaxInflight[] =
+    "GCS_READ_CACHE_READAHEAD_MAX_INFLIGHT";
+constexpr size_t kDefaultReadaheadMaxInflight = 4;
 // The environment variable that overrides the maximum age of entries in the
 // Stat cache. A value of 0 (the default) means nothing is cached.
 constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
@@ -668,9 +678,18 @@ GcsFileSystem::GcsFileSystem() {
     // Setting either to 0 disables the cache; set both for good measure.
     block_size = max_bytes = 0;
   }
+  readahead_max_blocks_ = kDefaultReadaheadBlocks;
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_max_blocks_ = value;
+  }
+  readahead_max_inflight_ = kDefaultReadaheadMaxInflight;
+  if (GetEnvVar(kReadaheadMaxInflight, strings::safe_strtou64, &value)) {
+    readahead_max_inflight_ = value;
+  }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "readahead blocks = " << readahead_max_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -863,13 +882,17 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  RamFileBlockCache::ReadaheadOptions readahead;
+  readahead.max_blocks = readahead_max_blocks_;
+  readahead.max_inflight = readahead_max_inflight_;
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      readahead));
   return file_block_cache;
 }
 
@@ -308,6 +308,10 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<AuthProvider> auth_provider_ GUARDED_BY(mu_);
   std::shared_ptr<HttpRequest::Factory> http_request_factory_;
   std::unique_ptr<ZoneProvider> zone_provider_;
+  // The readahead settings of the block cache (see
+  // RamFileBlockCache::ReadaheadOptions). Readahead is disabled by default.
+  size_t readahead_max_blocks_ = 0;
+  size_t readahead_max_inflight_ = 0;
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
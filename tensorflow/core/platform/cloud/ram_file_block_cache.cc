@@ -20,6 +20,12 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
+namespace {
+
+// The maximum number of files whose access pattern is tracked for readahead.
+constexpr size_t kMaxReadaheadFiles = 1024;
+
+}  // namespace
 
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
@@ -43,6 +49,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -80,12 +91,8 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
   // incomplete reads may still go undetected.
-  if (block->data.size() < block_size_) {
-    Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
-    }
+  if (block->data.size() < block_size_ && HasDataAfter(key)) {
+    return errors::Internal("Block cache contents are inconsistent.");
   }
 
   Trim();
@@ -173,6 +180,7 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     finish += block_size_;
   }
   size_t total_bytes_transferred = 0;
+  bool eof = false;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
@@ -210,13 +218,89 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
+      eof = true;
       break;
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  MaybeReadahead(filename, start, finish, eof);
   return Status::OK();
 }
 
+void RamFileBlockCache::MaybeReadahead(const string& filename, size_t start,
+                                       size_t finish, bool eof) {
+  if (!readahead_pool_) {
+    return;
+  }
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> fetches;
+  {
+    mutex_lock lock(mu_);
+    auto it = readahead_state_.find(filename);
+    if (eof) {
+      if (it != readahead_state_.end()) {
+        readahead_state_.erase(it);
+      }
+      return;
+    }
+    if (it == readahead_state_.end()) {
+      // Only the files that are being read need a state, and most of them are
+      // read to the end. Forget the others if there are too many.
+      if (readahead_state_.size() >= kMaxReadaheadFiles) {
+        readahead_state_.clear();
+      }
+      readahead_state_[filename].next_offset = finish;
+      return;
+    }
+    ReadaheadState& state = it->second;
+    if (start == state.next_offset) {
+      // The read moved on to the next block.
+      state.num_blocks = std::min(std::max<size_t>(2 * state.num_blocks, 1),
+                                  max_readahead_blocks_);
+    } else if (start + block_size_ != state.next_offset) {
+      // The read did not continue in the last block that was read either.
+      state.num_blocks = 0;
+    }
+    state.next_offset = finish;
+    for (size_t i = 0; i < state.num_blocks &&
+                       readahead_inflight_ < max_readahead_inflight_;
+         ++i) {
+      Key key = std::make_pair(filename, finish + i * block_size_);
+      if (block_map_.find(key) != block_map_.end()) {
+        // The block is already cached or being fetched.
+        continue;
+      }
+      fetches.emplace_back(key, Insert(key));
+      ++readahead_inflight_;
+    }
+  }
+  for (const auto& fetch : fetches) {
+    const Key& key = fetch.first;
+    const std::shared_ptr<Block>& block = fetch.second;
+    readahead_pool_->Schedule([this, key, block] { FetchAhead(key, block); });
+  }
+}
+
+void RamFileBlockCache::FetchAhead(const Key& key,
+                                   const std::shared_ptr<Block>& block) {
+  // On error, the block is left in the ERROR state so that the next read
+  // fetches it again and reports the error.
+  Status status = MaybeFetch(key, block);
+  mutex_lock lock(mu_);
+  --readahead_inflight_;
+  if (!status.ok() || block->timestamp == 0) {
+    return;
+  }
+  if (block->data.empty()) {
+    // The block starts past the end of the file.
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end() && entry->second == block) {
+      RemoveBlock(entry);
+    }
+    return;
+  }
+  Trim();
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64 file_signature) {
   mutex_lock lock(mu_);
@@ -262,6 +346,7 @@ void RamFileBlockCache::Flush() {
   lru_list_.clear();
   lra_list_.clear();
   cache_size_ = 0;
+  readahead_state_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -270,6 +355,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  readahead_state_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -289,4 +375,19 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   block_map_.erase(entry);
 }
 
+bool RamFileBlockCache::HasDataAfter(const Key& key) {
+  Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
+  auto it = block_map_.upper_bound(fmax);
+  while (it != block_map_.begin() && key < (--it)->first) {
+    // Blocks fetched ahead of a reader can still be in flight, or be empty
+    // because they start past the end of the file.
+    mutex_lock l(it->second->mu);
+    if (it->second->state == FetchState::FINISHED &&
+        !it->second->data.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -49,22 +51,60 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// \brief Options for fetching blocks ahead of sequential readers.
+  ///
+  /// When consecutive reads of a file access consecutive blocks, the cache
+  /// starts fetching the blocks that follow in the background, in parallel.
+  /// The number of blocks fetched ahead of the reader starts at 1 and doubles
+  /// with every sequential read, up to `max_blocks`. It drops back to 0 as
+  /// soon as the file is read out of order.
+  struct ReadaheadOptions {
+    /// The maximum number of blocks fetched ahead of a reader. It is further
+    /// limited to half of the blocks that fit in the cache. 0 disables
+    /// readahead.
+    size_t max_blocks = 0;
+    /// The maximum number of background fetches in flight, shared by all the
+    /// files that are read sequentially.
+    size_t max_inflight = 4;
+  };
+
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
                     BlockFetcher block_fetcher, Env* env = Env::Default())
+      : RamFileBlockCache(block_size, max_bytes, max_staleness,
+                          std::move(block_fetcher), ReadaheadOptions(), env) {}
+
+  RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
+                    BlockFetcher block_fetcher,
+                    const ReadaheadOptions& readahead_options,
+                    Env* env = Env::Default())
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_readahead_blocks_(
+            IsCacheEnabled() ? std::min(readahead_options.max_blocks,
+                                        max_bytes / block_size / 2)
+                             : 0),
+        max_readahead_inflight_(readahead_options.max_inflight) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_readahead_blocks_ > 0 && max_readahead_inflight_ > 0) {
+      readahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_readahead_FBC", max_readahead_inflight_));
+    }
     VLOG(1) << "GCS file block cache is "
-            << (IsCacheEnabled() ? "enabled" : "disabled");
+            << (IsCacheEnabled() ? "enabled" : "disabled")
+            << ", readahead is "
+            << (readahead_pool_ ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying readahead_pool_ will block until all the scheduled fetches
+    // are done.
+    readahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -130,6 +170,10 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of a sequential reader.
+  const size_t max_readahead_blocks_;
+  /// The maximum number of readahead fetches in flight across all files.
+  const size_t max_readahead_inflight_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -187,6 +231,14 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The access pattern of a file, for readahead.
+  struct ReadaheadState {
+    /// The offset of the block following the last block that was read.
+    size_t next_offset = 0;
+    /// The number of blocks to fetch ahead of the next read.
+    size_t num_blocks = 0;
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() LOCKS_EXCLUDED(mu_);
 
@@ -196,9 +248,23 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new block for a Key that is not in the block cache.
+  std::shared_ptr<Block> Insert(const Key& key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       LOCKS_EXCLUDED(mu_);
 
+  /// Updates the access pattern of `filename` after a read of the blocks in
+  /// [start, finish), and schedules the fetch of the blocks that follow if
+  /// the file is read sequentially. `eof` is true if the read reached the
+  /// end of the file.
+  void MaybeReadahead(const string& filename, size_t start, size_t finish,
+                      bool eof) LOCKS_EXCLUDED(mu_);
+
+  /// Fetches a block scheduled by MaybeReadahead.
+  void FetchAhead(const Key& key, const std::shared_ptr<Block>& block)
+      LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -213,12 +279,20 @@ class RamFileBlockCache : public FileBlockCache {
   /// cache size accordingly.
   void RemoveBlock(BlockMap::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Returns true if the block map contains a fetched, non-empty block of the
+  /// file in `key` after `key`.
+  bool HasDataAfter(const Key& key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
 
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads that fetch blocks ahead of sequential readers, or null if
+  /// readahead is disabled.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -241,6 +315,12 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+
+  /// The access pattern of the files that are being read.
+  std::map<string, ReadaheadState> readahead_state_ GUARDED_BY(mu_);
+
+  /// The number of readahead fetches that are scheduled or in flight.
+  size_t readahead_inflight_ GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -560,5 +562,149 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+// A fetcher for readahead tests that serves a file of `file_size` bytes and
+// records the offsets it was called with.
+class RecordingFetcher {
+ public:
+  explicit RecordingFetcher(size_t file_size) : file_size_(file_size) {}
+
+  RamFileBlockCache::BlockFetcher fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      {
+        mutex_lock l(mu_);
+        requests_.emplace_back(filename, offset);
+      }
+      *bytes_transferred = offset < file_size_
+                               ? std::min(n, file_size_ - offset)
+                               : 0;
+      memset(buffer, 'x', *bytes_transferred);
+      return Status::OK();
+    };
+  }
+
+  // Returns the number of requests for `offset` in `filename`.
+  int NumRequests(const string& filename, size_t offset) {
+    mutex_lock l(mu_);
+    return std::count(requests_.begin(), requests_.end(),
+                      std::make_pair(filename, offset));
+  }
+
+  size_t TotalRequests() {
+    mutex_lock l(mu_);
+    return requests_.size();
+  }
+
+  // Waits for a request for `offset` in `filename`.
+  void WaitForRequest(const string& filename, size_t offset) {
+    for (int i = 0; i < 1000 && NumRequests(filename, offset) == 0; ++i) {
+      Env::Default()->SleepForMicroseconds(10000);
+    }
+    EXPECT_EQ(1, NumRequests(filename, offset));
+  }
+
+ private:
+  const size_t file_size_;
+  mutex mu_;
+  std::vector<std::pair<string, size_t>> requests_ GUARDED_BY(mu_);
+};
+
+TEST(RamFileBlockCacheTest, ReadaheadSequential) {
+  const size_t block_size = 8;
+  RecordingFetcher fetcher(10 * block_size);
+  RamFileBlockCache::ReadaheadOptions readahead;
+  readahead.max_blocks = 4;
+  readahead.max_inflight = 2;
+  RamFileBlockCache cache(block_size, 10 * block_size, 0, fetcher.fetcher(),
+                          readahead);
+  std::vector<char> out;
+  // The first two reads establish a sequential access pattern.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  fetcher.WaitForRequest("a", 2 * block_size);
+  // Reading within the same block keeps the readahead window.
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size + 1, 2, &out));
+  for (size_t pos = 2 * block_size; pos < 10 * block_size; pos += block_size) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", pos, block_size, &out));
+    EXPECT_EQ(out, std::vector<char>(block_size, 'x'));
+  }
+  // Every block was fetched once, whether ahead of the reader or not.
+  for (size_t pos = 0; pos < 10 * block_size; pos += block_size) {
+    EXPECT_EQ(1, fetcher.NumRequests("a", pos)) << pos;
+  }
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadRandomAccess) {
+  const size_t block_size = 8;
+  RecordingFetcher fetcher(10 * block_size);
+  RamFileBlockCache::ReadaheadOptions readahead;
+  readahead.max_blocks = 4;
+  {
+    RamFileBlockCache cache(block_size, 10 * block_size, 0, fetcher.fetcher(),
+                            readahead);
+    std::vector<char> out;
+    for (size_t block : {0, 5, 2, 7, 3}) {
+      TF_EXPECT_OK(
+          ReadCache(&cache, "a", block * block_size, block_size, &out));
+    }
+  }
+  // Destroying the cache waits for any fetch ahead of the reader.
+  EXPECT_EQ(5, fetcher.TotalRequests());
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadPastEndOfFile) {
+  const size_t block_size = 8;
+  RecordingFetcher fetcher(2 * block_size);
+  RamFileBlockCache::ReadaheadOptions readahead;
+  readahead.max_blocks = 4;
+  RamFileBlockCache cache(block_size, 10 * block_size, 0, fetcher.fetcher(),
+                          readahead);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  fetcher.WaitForRequest("a", 2 * block_size);
+  // The empty block past the end of the file is dropped, and does not make
+  // the cache inconsistent.
+  for (int i = 0; i < 1000 && cache.CacheSize() != 2 * block_size; ++i) {
+    Env::Default()->SleepForMicroseconds(10000);
+  }
+  EXPECT_EQ(2 * block_size, cache.CacheSize());
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  EXPECT_EQ(errors::Code::OUT_OF_RANGE,
+            ReadCache(&cache, "a", 2 * block_size + 1, 1, &out).code());
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadSharedBudget) {
+  const size_t block_size = 8;
+  Notification release;
+  std::atomic<int> num_readahead_requests(0);
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    if (offset >= 2 * block_size) {
+      // Only readahead fetches go this far.
+      num_readahead_requests++;
+      release.WaitForNotification();
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  RamFileBlockCache::ReadaheadOptions readahead;
+  readahead.max_blocks = 4;
+  readahead.max_inflight = 1;
+  {
+    RamFileBlockCache cache(block_size, 10 * block_size, 0, fetcher,
+                            readahead);
+    std::vector<char> out;
+    for (const string& filename : {"a", "b"}) {
+      TF_EXPECT_OK(ReadCache(&cache, filename, 0, block_size, &out));
+      TF_EXPECT_OK(ReadCache(&cache, filename, block_size, block_size, &out));
+    }
+    release.Notify();
+  }
+  // The readahead of "a" used up the budget, so "b" was not read ahead.
+  EXPECT_EQ(1, num_readahead_requests);
+}
+
 }  // namespace
 }  // namespace tensorflow
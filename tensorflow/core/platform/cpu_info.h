@@ -93,6 +93,7 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+  AVX512_VNNI = 38,    // Vector neural network instructions
 };
 
 // Checks whether the current processor supports one of the features above.
@@ -0,0 +1,387 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/column_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/iterator.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+
+namespace tensorflow {
+namespace columnar {
+
+namespace {
+
+const char kHeaderKey[] = "header";
+
+string ChunkKey(int64 group, StringPiece column_name) {
+  return strings::StrCat(
+      strings::Printf("%010lld/", static_cast<long long>(group)), column_name);
+}
+
+void PutString(string* dst, StringPiece value) {
+  core::PutVarint32(dst, value.size());
+  dst->append(value.data(), value.size());
+}
+
+bool GetString(StringPiece* input, StringPiece* value) {
+  uint32 length;
+  if (!core::GetVarint32(input, &length) || input->size() < length) {
+    return false;
+  }
+  *value = StringPiece(input->data(), length);
+  input->remove_prefix(length);
+  return true;
+}
+
+// Appends the values of `tensor` to `chunk`.
+void AppendValues(const Tensor& tensor, string* chunk) {
+  if (tensor.dtype() == DT_STRING) {
+    auto values = tensor.flat<string>();
+    for (int64 i = 0; i < values.size(); ++i) {
+      PutString(chunk, values(i));
+    }
+  } else {
+    const StringPiece data = tensor.tensor_data();
+    chunk->append(data.data(), data.size());
+  }
+}
+
+// Decodes the `num_values` values at the start of `*chunk` into `*values`,
+// which must have room for them.
+Status DecodeValues(int64 num_values, StringPiece* chunk, Tensor* values) {
+  if (values->dtype() == DT_STRING) {
+    auto strings = values->flat<string>();
+    for (int64 i = 0; i < num_values; ++i) {
+      StringPiece value;
+      if (!GetString(chunk, &value)) {
+        return errors::DataLoss("Corrupted string column chunk");
+      }
+      strings(i).assign(value.data(), value.size());
+    }
+  } else {
+    // Numeric values are stored as they are laid out in a tensor.
+    const size_t size = num_values * DataTypeSize(values->dtype());
+    if (chunk->size() < size) {
+      return errors::DataLoss("Truncated column chunk");
+    }
+    memcpy(const_cast<char*>(values->tensor_data().data()), chunk->data(),
+           size);
+    chunk->remove_prefix(size);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ValidateColumnSpec(const ColumnSpec& column) {
+  if (column.name.empty()) {
+    return errors::InvalidArgument("Column names must not be empty");
+  }
+  if (column.dtype != DT_STRING && !DataTypeCanUseMemcpy(column.dtype)) {
+    return errors::InvalidArgument("Column ", column.name,
+                                   " has unsupported type ",
+                                   DataTypeString(column.dtype));
+  }
+  if (column.variable_length() &&
+      !(column.shape.dims() == 1 && column.shape.dim_size(0) == -1)) {
+    return errors::InvalidArgument(
+        "Column ", column.name,
+        " must have a fully defined shape or the shape [-1], not ",
+        column.shape.DebugString());
+  }
+  return Status::OK();
+}
+
+ColumnFileWriter::ColumnFileWriter(std::vector<ColumnSpec> columns,
+                                   WritableFile* file, const Options& options)
+    : columns_(std::move(columns)),
+      options_(options),
+      chunks_(columns_.size()),
+      row_lengths_(columns_.size()) {
+  if (options_.rows_per_group <= 0) {
+    status_ = errors::InvalidArgument("rows_per_group must be positive, not ",
+                                      options_.rows_per_group);
+  }
+  std::set<StringPiece> names;
+  for (const ColumnSpec& column : columns_) {
+    if (status_.ok()) status_ = ValidateColumnSpec(column);
+    if (status_.ok() && !names.insert(column.name).second) {
+      status_ = errors::InvalidArgument("Duplicate column name: ", column.name);
+    }
+  }
+  for (int i = 0; i < columns_.size(); ++i) {
+    sorted_columns_.push_back(i);
+  }
+  std::sort(sorted_columns_.begin(), sorted_columns_.end(),
+            [this](int a, int b) {
+              return columns_[a].name < columns_[b].name;
+            });
+
+  table::Options table_options;
+  table_options.compression = options_.compression;
+  builder_.reset(new table::TableBuilder(table_options, file));
+}
+
+ColumnFileWriter::~ColumnFileWriter() {
+  if (!closed_) builder_->Abandon();
+}
+
+Status ColumnFileWriter::AppendRow(gtl::ArraySlice<Tensor> values) {
+  TF_RETURN_IF_ERROR(status_);
+  if (closed_) {
+    return errors::FailedPrecondition("Writer is closed");
+  }
+  if (values.size() != columns_.size()) {
+    return errors::InvalidArgument("Expected ", columns_.size(),
+                                   " values, but got ", values.size());
+  }
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    const ColumnSpec& column = columns_[i];
+    if (values[i].dtype() != column.dtype) {
+      return errors::InvalidArgument(
+          "Value of column ", column.name, " has type ",
+          DataTypeString(values[i].dtype()), " instead of ",
+          DataTypeString(column.dtype));
+    }
+    if (!column.shape.IsCompatibleWith(values[i].shape())) {
+      return errors::InvalidArgument(
+          "Value of column ", column.name, " has shape ",
+          values[i].shape().DebugString(), " instead of ",
+          column.shape.DebugString());
+    }
+  }
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].variable_length()) {
+      core::PutVarint64(&row_lengths_[i], values[i].NumElements());
+    }
+    AppendValues(values[i], &chunks_[i]);
+  }
+  if (++rows_in_group_ == options_.rows_per_group) {
+    status_ = FlushGroup();
+  }
+  return status_;
+}
+
+Status ColumnFileWriter::FlushGroup() {
+  const int64 group = group_sizes_.size();
+  for (int i : sorted_columns_) {
+    string& chunk = chunks_[i];
+    if (columns_[i].variable_length()) {
+      chunk.insert(0, row_lengths_[i]);
+      row_lengths_[i].clear();
+    }
+    builder_->Add(ChunkKey(group, columns_[i].name), chunk);
+    builder_->Flush();
+    chunk.clear();
+  }
+  group_sizes_.push_back(rows_in_group_);
+  rows_in_group_ = 0;
+  return builder_->status();
+}
+
+Status ColumnFileWriter::Close() {
+  if (closed_) return status_;
+  if (status_.ok() && rows_in_group_ > 0) {
+    status_ = FlushGroup();
+  }
+  closed_ = true;
+  if (!status_.ok()) {
+    builder_->Abandon();
+    return status_;
+  }
+
+  // Header: the columns, then the number of rows of each group.
+  string header;
+  core::PutVarint32(&header, columns_.size());
+  for (const ColumnSpec& column : columns_) {
+    PutString(&header, column.name);
+    core::PutVarint32(&header, column.dtype);
+    core::PutVarint32(&header, column.shape.dims());
+    for (int d = 0; d < column.shape.dims(); ++d) {
+      // Unknown dimensions are stored as 0.
+      core::PutVarint64(&header, column.shape.dim_size(d) + 1);
+    }
+  }
+  core::PutVarint64(&header, group_sizes_.size());
+  for (int64 size : group_sizes_) {
+    core::PutVarint64(&header, size);
+  }
+  builder_->Add(kHeaderKey, header);
+  status_ = builder_->Finish();
+  return status_;
+}
+
+ColumnFileReader::ColumnFileReader(std::unique_ptr<RandomAccessFile> file,
+                                   std::unique_ptr<table::Table> table)
+    : file_(std::move(file)), table_(std::move(table)) {}
+
+Status ColumnFileReader::Open(Env* env, const string& filename,
+                              std::unique_ptr<ColumnFileReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  table::Table* table;
+  TF_RETURN_IF_ERROR(
+      table::Table::Open(table::Options(), file.get(), file_size, &table));
+  reader->reset(new ColumnFileReader(std::move(file),
+                                     std::unique_ptr<table::Table>(table)));
+  Status s = (*reader)->ReadHeader();
+  if (!s.ok()) {
+    reader->reset();
+    return errors::DataLoss("Not a valid column file: ", filename, ": ",
+                            s.error_message());
+  }
+  return Status::OK();
+}
+
+Status ColumnFileReader::ReadHeader() {
+  std::unique_ptr<table::Iterator> iter(table_->NewIterator());
+  iter->Seek(kHeaderKey);
+  TF_RETURN_IF_ERROR(iter->status());
+  if (!iter->Valid() || iter->key() != kHeaderKey) {
+    return errors::DataLoss("Missing header");
+  }
+  StringPiece header = iter->value();
+  uint32 num_columns;
+  if (!core::GetVarint32(&header, &num_columns)) {
+    return errors::DataLoss("Corrupted header");
+  }
+  for (uint32 i = 0; i < num_columns; ++i) {
+    ColumnSpec column;
+    StringPiece name;
+    uint32 dtype;
+    uint32 rank;
+    if (!GetString(&header, &name) || !core::GetVarint32(&header, &dtype) ||
+        !core::GetVarint32(&header, &rank)) {
+      return errors::DataLoss("Corrupted header");
+    }
+    column.name = string(name);
+    column.dtype = static_cast<DataType>(dtype);
+    std::vector<int64> dims(rank);
+    for (uint32 d = 0; d < rank; ++d) {
+      uint64 dim;
+      if (!core::GetVarint64(&header, &dim)) {
+        return errors::DataLoss("Corrupted header");
+      }
+      dims[d] = static_cast<int64>(dim) - 1;
+    }
+    column.shape = PartialTensorShape(dims);
+    TF_RETURN_IF_ERROR(ValidateColumnSpec(column));
+    columns_.push_back(std::move(column));
+  }
+  uint64 num_groups;
+  if (!core::GetVarint64(&header, &num_groups)) {
+    return errors::DataLoss("Corrupted header");
+  }
+  for (uint64 i = 0; i < num_groups; ++i) {
+    uint64 size;
+    if (!core::GetVarint64(&header, &size)) {
+      return errors::DataLoss("Corrupted header");
+    }
+    group_sizes_.push_back(size);
+  }
+  if (!header.empty()) {
+    return errors::DataLoss("Corrupted header");
+  }
+  return Status::OK();
+}
+
+int ColumnFileReader::FindColumn(StringPiece name) const {
+  for (int i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) return i;
+  }
+  return -1;
+}
+
+int64 ColumnFileReader::num_rows() const {
+  int64 num_rows = 0;
+  for (int64 size : group_sizes_) {
+    num_rows += size;
+  }
+  return num_rows;
+}
+
+Status ColumnFileReader::ReadColumn(int64 group, int column, Tensor* values,
+                                    Tensor* row_lengths) const {
+  if (group < 0 || group >= num_groups()) {
+    return errors::OutOfRange("Row group ", group, " is out of range [0, ",
+                              num_groups(), ")");
+  }
+  if (column < 0 || column >= columns_.size()) {
+    return errors::OutOfRange("Column ", column, " is out of range [0, ",
+                              columns_.size(), ")");
+  }
+  const ColumnSpec& spec = columns_[column];
+  const string key = ChunkKey(group, spec.name);
+  std::unique_ptr<table::Iterator> iter(table_->NewIterator());
+  iter->Seek(key);
+  TF_RETURN_IF_ERROR(iter->status());
+  if (!iter->Valid() || iter->key() != key) {
+    return errors::DataLoss("Missing chunk ", key);
+  }
+  // The chunk points into the block of the table, and the values are
+  // decoded from there directly into the output tensors.
+  StringPiece chunk = iter->value();
+
+  const int64 num_rows = group_sizes_[group];
+  TensorShape shape;
+  if (spec.variable_length()) {
+    *row_lengths = Tensor(DT_INT64, TensorShape({num_rows}));
+    auto lengths = row_lengths->vec<int64>();
+    int64 num_values = 0;
+    for (int64 i = 0; i < num_rows; ++i) {
+      uint64 length;
+      if (!core::GetVarint64(&chunk, &length) || length > chunk.size()) {
+        return errors::DataLoss("Corrupted chunk ", key);
+      }
+      lengths(i) = length;
+      num_values += length;
+    }
+    shape.AddDim(num_values);
+  } else {
+    TensorShape row_shape;
+    spec.shape.AsTensorShape(&row_shape);
+    shape.AddDim(num_rows);
+    shape.AppendShape(row_shape);
+  }
+  // Every value takes at least a byte, so a corrupted chunk cannot make us
+  // allocate much more memory than its size.
+  const int64 num_values = shape.num_elements();
+  const int64 min_value_size =
+      spec.dtype == DT_STRING ? 1 : DataTypeSize(spec.dtype);
+  if (num_values > chunk.size() / min_value_size) {
+    return errors::DataLoss("Truncated chunk ", key);
+  }
+  *values = Tensor(spec.dtype, shape);
+  Status s = DecodeValues(num_values, &chunk, values);
+  if (s.ok() && !chunk.empty()) {
+    s = errors::DataLoss("Unexpected data at the end of chunk");
+  }
+  if (!s.ok()) {
+    return errors::DataLoss(s.error_message(), " ", key);
+  }
+  return Status::OK();
+}
+
+}  // namespace columnar
+}  // namespace tensorflow
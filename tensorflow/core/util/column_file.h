@@ -0,0 +1,182 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A column file stores a table of rows column by column, so that the values
+// of a column can be read into a tensor without parsing the other columns,
+// and without decoding the values at all for numeric columns.
+//
+// The rows are split into row groups of up to `rows_per_group` rows. The
+// values of each column in a row group form a chunk, which is stored as an
+// entry of a table::Table:
+//
+//   "<group>/<column name>" -> chunk, where <group> is zero-padded to 10 digits
+//   "header"                -> the columns, and the number of rows of each
+//                              row group
+//
+// Each chunk is written to its own block of the table, so that reading a
+// column does not read the blocks of the other columns.
+//
+// A chunk of a variable-length column starts with the varint64 number of
+// values of each row. The values follow: numeric values in their in-memory
+// representation, strings as a varint32 length followed by the bytes.
+//
+// Usage:
+//
+//   ColumnFileWriter writer({{"label", DT_INT64, PartialTensorShape({})},
+//                            {"ids", DT_INT64, PartialTensorShape({-1})}},
+//                           file.get());
+//   TF_RETURN_IF_ERROR(writer.AppendRow({label, ids}));
+//   TF_RETURN_IF_ERROR(writer.Close());
+//
+//   std::unique_ptr<ColumnFileReader> reader;
+//   TF_RETURN_IF_ERROR(ColumnFileReader::Open(env, filename, &reader));
+//   Tensor values, row_lengths;
+//   TF_RETURN_IF_ERROR(reader->ReadColumn(group, column, &values,
+//                                         &row_lengths));
+
+#ifndef TENSORFLOW_CORE_UTIL_COLUMN_FILE_H_
+#define TENSORFLOW_CORE_UTIL_COLUMN_FILE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/io/table.h"
+#include "tensorflow/core/lib/io/table_builder.h"
+#include "tensorflow/core/lib/io/table_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace columnar {
+
+// A column of a column file.
+struct ColumnSpec {
+  string name;
+  DataType dtype;
+  // Shape of the value of the column in each row. A fully defined shape
+  // describes a dense column, and the shape [-1] a column with a vector of
+  // any length in each row.
+  PartialTensorShape shape;
+
+  bool variable_length() const { return !shape.IsFullyDefined(); }
+};
+
+// Checks that `column` can be stored in a column file.
+Status ValidateColumnSpec(const ColumnSpec& column);
+
+// Writes a column file.
+//
+// Note: this class is not thread safe; external synchronization required.
+class ColumnFileWriter {
+ public:
+  struct Options {
+    Options() {}
+    // Maximum number of rows of a row group. Readers read whole row groups,
+    // so this bounds their memory use.
+    int64 rows_per_group{1024};
+    table::CompressionType compression{table::kSnappyCompression};
+  };
+
+  // Creates a writer of a file with the given columns, which must have
+  // distinct names. "*file" must remain live while this writer is in use.
+  ColumnFileWriter(std::vector<ColumnSpec> columns, WritableFile* file,
+                   const Options& options = Options());
+  ~ColumnFileWriter();
+
+  // Appends a row. `values[i]` is the value of column i, which must have the
+  // dtype of the column and its shape, or any vector shape for a
+  // variable-length column.
+  Status AppendRow(gtl::ArraySlice<Tensor> values);
+
+  // Writes the buffered rows and the header of the file. Does not close the
+  // file.
+  Status Close() TF_MUST_USE_RESULT;
+
+  Status status() const { return status_; }
+
+ private:
+  Status FlushGroup();
+
+  const std::vector<ColumnSpec> columns_;
+  const Options options_;
+  // Indices of the columns in the order of their names, which is the order
+  // of their keys.
+  std::vector<int> sorted_columns_;
+  std::unique_ptr<table::TableBuilder> builder_;
+  bool closed_ = false;
+  Status status_;
+
+  // The chunks of the current row group, and the row lengths of its
+  // variable-length columns.
+  std::vector<string> chunks_;
+  std::vector<string> row_lengths_;
+  int64 rows_in_group_ = 0;
+  std::vector<int64> group_sizes_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnFileWriter);
+};
+
+// Reads the columns of a column file. A ColumnFileReader may be safely
+// accessed from multiple threads without external synchronization.
+class ColumnFileReader {
+ public:
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnFileReader>* reader);
+
+  const std::vector<ColumnSpec>& columns() const { return columns_; }
+
+  // Returns the index of the column named `name`, or -1 if there is none.
+  int FindColumn(StringPiece name) const;
+
+  int64 num_groups() const { return group_sizes_.size(); }
+  int64 num_rows_in_group(int64 group) const { return group_sizes_[group]; }
+  int64 num_rows() const;
+
+  // Reads the values of `column` in row group `group`.
+  //
+  // For a dense column, *values is set to a tensor of shape
+  // [num_rows_in_group(group)] + shape, and `row_lengths` is ignored.
+  //
+  // For a variable-length column, *values is set to the vector of the values
+  // of all the rows of the group, and *row_lengths to the int64 vector of the
+  // number of values of each row.
+  Status ReadColumn(int64 group, int column, Tensor* values,
+                    Tensor* row_lengths) const;
+
+ private:
+  ColumnFileReader(std::unique_ptr<RandomAccessFile> file,
+                   std::unique_ptr<table::Table> table);
+
+  Status ReadHeader();
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  const std::unique_ptr<table::Table> table_;
+  std::vector<ColumnSpec> columns_;
+  std::vector<int64> group_sizes_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnFileReader);
+};
+
+}  // namespace columnar
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_COLUMN_FILE_H_
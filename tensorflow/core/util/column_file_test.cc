@@ -0,0 +1,145 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/column_file.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace columnar {
+namespace {
+
+std::vector<ColumnSpec> TestColumns() {
+  return {{"label", DT_INT64, PartialTensorShape({})},
+          {"embedding", DT_FLOAT, PartialTensorShape({2})},
+          {"ids", DT_INT32, PartialTensorShape({-1})},
+          {"tokens", DT_STRING, PartialTensorShape({-1})}};
+}
+
+// Writes `num_rows` rows: row i has label i, embedding [i, -i], i % 3 ids
+// and i % 2 tokens.
+void WriteTestFile(const string& fname, int num_rows, int rows_per_group) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  ColumnFileWriter::Options options;
+  options.rows_per_group = rows_per_group;
+  ColumnFileWriter writer(TestColumns(), file.get(), options);
+  TF_ASSERT_OK(writer.status());
+  for (int i = 0; i < num_rows; ++i) {
+    Tensor label(DT_INT64, TensorShape({}));
+    label.scalar<int64>()() = i;
+    Tensor embedding = test::AsTensor<float>({1.0f * i, -1.0f * i});
+    Tensor ids(DT_INT32, TensorShape({i % 3}));
+    for (int j = 0; j < i % 3; ++j) ids.vec<int32>()(j) = 10 * i + j;
+    Tensor tokens(DT_STRING, TensorShape({i % 2}));
+    if (i % 2) tokens.vec<string>()(0) = strings::StrCat("token", i);
+    TF_ASSERT_OK(writer.AppendRow({label, embedding, ids, tokens}));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+}
+
+TEST(ColumnFileTest, ReadColumns) {
+  const string fname = io::JoinPath(testing::TmpDir(), "columns");
+  WriteTestFile(fname, 10, 4);
+
+  std::unique_ptr<ColumnFileReader> reader;
+  TF_ASSERT_OK(ColumnFileReader::Open(Env::Default(), fname, &reader));
+  ASSERT_EQ(4, reader->columns().size());
+  EXPECT_EQ(10, reader->num_rows());
+  ASSERT_EQ(3, reader->num_groups());
+  EXPECT_EQ(4, reader->num_rows_in_group(0));
+  EXPECT_EQ(2, reader->num_rows_in_group(2));
+  EXPECT_EQ(-1, reader->FindColumn("missing"));
+  const int label = reader->FindColumn("label");
+  const int embedding = reader->FindColumn("embedding");
+  const int ids = reader->FindColumn("ids");
+  const int tokens = reader->FindColumn("tokens");
+  EXPECT_EQ(DT_FLOAT, reader->columns()[embedding].dtype);
+  EXPECT_TRUE(reader->columns()[ids].variable_length());
+
+  Tensor values, row_lengths;
+  TF_ASSERT_OK(reader->ReadColumn(1, label, &values, &row_lengths));
+  test::ExpectTensorEqual<int64>(values, test::AsTensor<int64>({4, 5, 6, 7}));
+  TF_ASSERT_OK(reader->ReadColumn(2, embedding, &values, &row_lengths));
+  test::ExpectTensorEqual<float>(
+      values, test::AsTensor<float>({8, -8, 9, -9}, TensorShape({2, 2})));
+  TF_ASSERT_OK(reader->ReadColumn(1, ids, &values, &row_lengths));
+  test::ExpectTensorEqual<int64>(row_lengths,
+                                 test::AsTensor<int64>({1, 2, 0, 1}));
+  test::ExpectTensorEqual<int32>(values,
+                                 test::AsTensor<int32>({40, 50, 51, 70}));
+  TF_ASSERT_OK(reader->ReadColumn(0, tokens, &values, &row_lengths));
+  test::ExpectTensorEqual<int64>(row_lengths,
+                                 test::AsTensor<int64>({0, 1, 0, 1}));
+  test::ExpectTensorEqual<string>(values,
+                                  test::AsTensor<string>({"token1", "token3"}));
+
+  EXPECT_TRUE(errors::IsOutOfRange(
+      reader->ReadColumn(3, label, &values, &row_lengths)));
+  EXPECT_TRUE(errors::IsOutOfRange(
+      reader->ReadColumn(0, 4, &values, &row_lengths)));
+}
+
+TEST(ColumnFileTest, EmptyFile) {
+  const string fname = io::JoinPath(testing::TmpDir(), "empty_columns");
+  WriteTestFile(fname, 0, 4);
+  std::unique_ptr<ColumnFileReader> reader;
+  TF_ASSERT_OK(ColumnFileReader::Open(Env::Default(), fname, &reader));
+  EXPECT_EQ(4, reader->columns().size());
+  EXPECT_EQ(0, reader->num_groups());
+}
+
+TEST(ColumnFileTest, InvalidColumns) {
+  const string fname = io::JoinPath(testing::TmpDir(), "invalid_columns");
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  {
+    ColumnFileWriter writer({{"a", DT_INT64, PartialTensorShape({})},
+                             {"a", DT_INT64, PartialTensorShape({})}},
+                            file.get());
+    EXPECT_TRUE(errors::IsInvalidArgument(writer.status()));
+  }
+  {
+    ColumnFileWriter writer({{"a", DT_INT64, PartialTensorShape({-1, 2})}},
+                            file.get());
+    EXPECT_TRUE(errors::IsInvalidArgument(writer.status()));
+  }
+  {
+    ColumnFileWriter writer({{"a", DT_INT64, PartialTensorShape({2})}},
+                            file.get());
+    TF_EXPECT_OK(writer.status());
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AppendRow({test::AsTensor<int64>({1, 2, 3})})));
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AppendRow({test::AsTensor<int32>({1, 2})})));
+  }
+}
+
+TEST(ColumnFileTest, NotAColumnFile) {
+  const string fname = io::JoinPath(testing::TmpDir(), "not_columns");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, "not a table"));
+  std::unique_ptr<ColumnFileReader> reader;
+  EXPECT_FALSE(ColumnFileReader::Open(Env::Default(), fname, &reader).ok());
+}
+
+}  // namespace
+}  // namespace columnar
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/casts.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -159,15 +161,17 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          uint32 buffer32;
-          if (!stream.ReadLittleEndian32(&buffer32)) return false;
-          float_list->push_back(bit_cast<float>(buffer32));
+        const uint8* packed;
+        if (!GetPackedData(&stream, packed_length, &packed)) return false;
+        if (packed_length % sizeof(uint32) != 0) return false;
+
+        // Decode the values directly from the buffer rather than one at a
+        // time through the stream.
+        const char* p = reinterpret_cast<const char*>(packed);
+        const char* end = p + packed_length;
+        for (; p != end; p += sizeof(uint32)) {
+          float_list->push_back(bit_cast<float>(core::DecodeFixed32(p)));
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kFixed32Tag(1))) return false;
@@ -201,15 +205,11 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        const uint8* packed;
+        if (!GetPackedData(&stream, packed_length, &packed)) return false;
+        if (!ParsePackedVarints(packed, packed + packed_length, int64_list)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -226,6 +226,54 @@ class Feature {
   StringPiece GetSerialized() const { return serialized_; }
 
  private:
+  // Points *data to the `length` bytes of a packed field at the current
+  // position of `stream`, and skips past them.
+  static bool GetPackedData(protobuf::io::CodedInputStream* stream,
+                            uint32 length, const uint8** data) {
+    const void* ptr;
+    int size;
+    if (length == 0) {
+      *data = nullptr;
+      return true;
+    }
+    if (!stream->GetDirectBufferPointer(&ptr, &size)) return false;
+    if (static_cast<uint32>(size) < length) return false;
+    *data = static_cast<const uint8*>(ptr);
+    return stream->Skip(length);
+  }
+
+  // Decodes the packed varints in [p, end). Most int64 features hold small
+  // values (ids, counts, labels) whose varints are a single byte, so eight
+  // bytes are checked at once and decoded without the per-byte loop when none
+  // of them has a continuation bit.
+  template <typename Result>
+  static bool ParsePackedVarints(const uint8* p, const uint8* end,
+                                 Result* int64_list) {
+    while (p != end) {
+      if (end - p >= 8) {
+        uint64 word;
+        memcpy(&word, p, sizeof(word));
+        if ((word & 0x8080808080808080ULL) == 0) {
+          for (int i = 0; i < 8; ++i) {
+            int64_list->push_back(static_cast<int64>(p[i]));
+          }
+          p += 8;
+          continue;
+        }
+      }
+      // Same limits as CodedInputStream::ReadVarint64: at most 10 bytes.
+      uint64 n = 0;
+      for (int shift = 0;; shift += 7) {
+        if (p == end || shift >= 64) return false;
+        const uint8 byte = *p++;
+        n |= static_cast<uint64>(byte & 0x7f) << shift;
+        if (byte < 0x80) break;
+      }
+      int64_list->push_back(static_cast<int64>(n));
+    }
+    return true;
+  }
+
   // TODO(lew): Pair of uint8* would be more natural.
   StringPiece serialized_;
 };
@@ -490,7 +538,7 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 }
 
 Status FastParseSerializedExample(
-    const string& serialized_example, const string& example_name,
+    StringPiece serialized_example, const string& example_name,
     const size_t example_index, const Config& config,
     const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
     SeededHasher hasher, std::vector<Tensor>* output_dense,
@@ -1185,7 +1233,7 @@ Status FastParseExample(const Config& config,
   return Status::OK();
 }
 
-Status FastParseSingleExample(const Config& config, const string& serialized,
+Status FastParseSingleExample(const Config& config, StringPiece serialized,
                               Result* result) {
   DCHECK(result != nullptr);
   // Check config so we can safely CHECK(false) in switches on config.*.dtype
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -170,6 +171,46 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64OfAllSizes) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  // Runs of single-byte varints mixed with varints of every length.
+  for (int i = 0; i < 20; ++i) int64_list->add_value(i);
+  for (int shift = 0; shift < 64; shift += 3) {
+    int64_list->add_value(int64{1} << shift);
+    for (int i = 0; i < shift % 11; ++i) int64_list->add_value(i);
+  }
+  int64_list->add_value(-1);
+  int64_list->add_value(std::numeric_limits<int64>::min());
+  int64_list->add_value(std::numeric_limits<int64>::max());
+  for (int i = 0; i < 9; ++i) int64_list->add_value(127 - i);
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, PackedFloats) {
+  Example example;
+  auto* float_list = (*example.mutable_features()->mutable_feature())["x"]
+                         .mutable_float_list();
+  for (int i = 0; i < 100; ++i) float_list->add_value(i * 0.25f - 3.f);
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, MalformedPacked) {
+  // Packed int64 list whose last varint has its continuation bit set.
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x8d",
+      &example));
+  // Packed float list whose length is not a multiple of 4.
+  const char kBadFloats[] =
+      "\x0a\x10\x0a\x0e\x0a\x03\x61\x67\x65\x12\x07\x12\x05\x0a\x03"
+      "\x00\x00\x80";
+  Example float_example;
+  EXPECT_FALSE(TestFastParse(string(kBadFloats, sizeof(kBadFloats) - 1),
+                             &float_example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -2196,17 +2196,19 @@ class RangeDataset(DatasetSource):
 class CacheDataset(UnaryDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename):
+  def __init__(self, input_dataset, filename, compression=None):
     """See `Dataset.cache()` for details."""
     super(CacheDataset, self).__init__(input_dataset)
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    self._compression = compression or ""
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.cache_dataset(
         self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
         filename=self._filename,
+        compression=self._compression,
         **flat_structure(self))
 
   @property
@@ -187,6 +187,79 @@ class DecodeJpegBenchmark(test.Benchmark):
           iters=num_iters,
           wall_time=duration_decode_after_crop)
 
+  def _evalDecodeCropResizeJpeg(self, image_name, parallelism, num_iters,
+                                fused, crop_window, size, tile):
+    """Evaluate decoding, cropping and resizing the given image.
+
+    Args:
+      image_name: a string of image file name (without suffix).
+      parallelism: the number of concurrent decodes to be run.
+      num_iters: number of iterations for evaluation.
+      fused: If true, use the fused DecodeAndCropAndResizeJpeg instead of
+          DecodeAndCropJpeg followed by ResizeBilinear.
+      crop_window: the window to crop from the decoded image.
+      size: the size to resize the crop to.
+      tile: tile the image to composite a larger fake image.
+
+    Returns:
+      The duration of the run in seconds.
+    """
+    ops.reset_default_graph()
+
+    image_file_path = os.path.join(prefix_path, image_name)
+    single_image = image_ops.decode_jpeg(
+        io_ops.read_file(image_file_path), channels=3, name='single_image')
+    tiled_image = array_ops.tile(single_image, tile)
+    image_content = variable_scope.get_variable(
+        'tiled_image_%s' % image_name,
+        initializer=image_ops.encode_jpeg(tiled_image))
+
+    with session.Session() as sess:
+      sess.run(variables.global_variables_initializer())
+      images = []
+      for _ in xrange(parallelism):
+        if fused:
+          image = image_ops.decode_and_crop_and_resize_jpeg(
+              image_content, crop_window, size, channels=3)
+        else:
+          image = image_ops.decode_and_crop_jpeg(
+              image_content, crop_window, channels=3)
+          image = image_ops.resize_bilinear(
+              array_ops.expand_dims(image, 0), size)
+        images.append(image)
+      r = control_flow_ops.group(*images)
+
+      for _ in xrange(3):
+        # Skip warm up time.
+        sess.run(r)
+
+      start_time = time.time()
+      for _ in xrange(num_iters):
+        sess.run(r)
+      end_time = time.time()
+    return end_time - start_time
+
+  def benchmarkDecodeCropResizeJpegLarge(self):
+    """Evaluate decoding a large image to a small training size."""
+    num_iters = 10
+    crop_window = [100, 200, 1200, 1500]
+    size = [224, 224]
+    tile = [4, 4, 1]
+    for parallelism in [1, 100]:
+      # Tile the medium size image to composite a larger fake image.
+      duration_separate = self._evalDecodeCropResizeJpeg(
+          'medium.jpg', parallelism, num_iters, False, crop_window, size, tile)
+      duration_fused = self._evalDecodeCropResizeJpeg(
+          'medium.jpg', parallelism, num_iters, True, crop_window, size, tile)
+      self.report_benchmark(
+          name='decode_crop_then_resize_jpeg_large_p%d' % (parallelism),
+          iters=num_iters,
+          wall_time=duration_separate)
+      self.report_benchmark(
+          name='decode_crop_resize_jpeg_large_p%d' % (parallelism),
+          iters=num_iters,
+          wall_time=duration_fused)
+
 
 if __name__ == '__main__':
   test.main()
@@ -447,6 +447,24 @@ class UnsortedSegmentTest(SegmentReductionHelper):
         self.assertAllClose(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, s)
 
+  def testLargeValues(self):
+    # Large enough inputs are reduced by several threads on CPU.
+    np.random.seed(17)
+    num_segments = 100
+    indices = np.random.randint(-1, num_segments, size=4000)
+    np_x = np.random.rand(4000, 16)
+    with self.test_session(use_gpu=False):
+      for np_op, tf_op, initial_value in [
+          (np.add, math_ops.unsorted_segment_sum, 0),
+          (np.maximum, math_ops.unsorted_segment_max, np.finfo(np.float64).min)
+      ]:
+        np_ans = np.full((num_segments, 16), initial_value)
+        for i, index in enumerate(indices):
+          if index >= 0:
+            np_ans[index] = np_op(np_ans[index], np_x[i])
+        s = tf_op(np_x, segment_ids=indices, num_segments=num_segments)
+        self.assertAllClose(np_ans, s.eval())
+
 
 class SparseSegmentReductionHelper(SegmentReductionHelper):
 
@@ -507,6 +525,30 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           # and may therefore vary dynamically.
           self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testLargeValues(self):
+    # Large enough inputs are reduced by several threads, with gaps between
+    # the segments and after the last one.
+    np.random.seed(23)
+    segment_indices = np.sort(
+        np.random.randint(0, 2000, size=5000) * 2).astype(np.int32)
+    num_segments = 4010
+    tf_x, np_x = self._input([1000, 64], dtype=dtypes_lib.float64)
+    indices = np.random.randint(0, 1000, size=5000).astype(np.int32)
+    ops_list = [(np.add, None, math_ops.sparse_segment_sum_with_num_segments),
+                (self._mean_cum_op, self._mean_reduce_op,
+                 math_ops.sparse_segment_mean_with_num_segments)]
+    with self.test_session(use_gpu=False):
+      for np_op1, np_op2, tf_op in ops_list:
+        np_ans = self._sparseSegmentReduce(
+            np_x, indices, segment_indices, np_op1, np_op2,
+            num_segments=num_segments)
+        s = tf_op(
+            data=tf_x,
+            indices=indices,
+            segment_ids=segment_indices,
+            num_segments=num_segments)
+        self.assertAllClose(np_ans, s.eval())
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
@@ -228,6 +228,18 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self._testLarge(np.complex64)
     self._testLarge(np.complex128)
 
+  # Tests rows wider than the column blocks of the multi-threaded CPU kernel,
+  # with many nonzeros in each row.
+  def testWideRows(self):
+    np.random.seed(127)  # Repeatable results
+    for np_dtype in [np.float32, np.complex64]:
+      x = _maybe_complex(np.random.rand(40, 300).astype(np_dtype))
+      x[np.abs(x) < 0.5] = 0
+      y = _maybe_complex(np.random.randn(300, 2500).astype(np_dtype))
+      self._testMatmul(x, y)
+      self._testMatmul(x.transpose(), y, adjoint_a=True)
+      self._testMatmul(x, y.transpose(), adjoint_b=True)
+
   # Tests random sized matrices.
   def testFloatRandom(self):
     np.random.seed(127)  # Repeatable results
@@ -148,10 +148,28 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def _testLongRowTopK(self,
+                       dtype,
+                       k,
+                       sorted=True):  # pylint: disable=redefined-builtin
+    # Rows this long with a small k are selected by thresholding.
+    b = 3
+    n = 20000
+    inputs = np.random.permutation(
+        np.linspace(0, 100, b * n, dtype=dtype)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices, sorted=sorted)
+
+  def testLongRowTopK(self):
+    for k in [2, 100, 2500]:
+      self._testLongRowTopK(np.float32, k)
+      self._testLongRowTopK(np.float64, k, sorted=False)
+
   def testStableSort(self):
     b = 5
-    n = 500
-    for k in [1, 5, 50, 500]:
+    for n, k in [(500, 1), (500, 5), (500, 50), (500, 500), (8000, 100),
+                 (8000, 1000)]:
       # Lots of repeated integers taking values in [0, 3]
       inputs = np.random.permutation(
           np.linspace(0, 3, b * n, dtype=np.int32)).reshape(b, n)
@@ -235,6 +253,26 @@ class TopKBenchmark(test.Benchmark):
                 "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
           sys.stdout.flush()
 
+  def benchmarkTopKLongRows(self):
+    for (m, n, k) in itertools.product(
+        [1, 16],
+        [1000000],
+        [10, 100, 1000, 10000, 100000]):
+      name = "m_%d_n_%d_k_%d" % (m, n, k)
+      with ops.Graph().as_default():
+        with ops.device("/cpu:0"):
+          x = random_ops.random_uniform((m, n))
+          v = resource_variable_ops.ResourceVariable(x)
+          op = nn_ops.top_k(v, k)
+        with session.Session() as sess:
+          v.initializer.run()
+          r = self.run_op_benchmark(sess, op, min_iters=20, name=name)
+          gb_processed_input = m * n / 1.0e9
+          throughput = gb_processed_input / r["wall_time"]
+          print("Benchmark: %s \t wall_time: %0.03g s \t "
+                "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
+          sys.stdout.flush()
+
 
 if __name__ == "__main__":
   test.main()
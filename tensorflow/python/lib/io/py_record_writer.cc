@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/c/tf_status_helper.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/platform/env.h"
@@ -29,16 +30,27 @@ PyRecordWriter::PyRecordWriter() {}
 
 PyRecordWriter* PyRecordWriter::New(const string& filename,
                                     const io::RecordWriterOptions& options,
-                                    TF_Status* out_status) {
+                                    bool write_index, TF_Status* out_status) {
   std::unique_ptr<WritableFile> file;
   Status s = Env::Default()->NewWritableFile(filename, &file);
   if (!s.ok()) {
     Set_TF_Status_from_Status(out_status, s);
     return nullptr;
   }
+  std::unique_ptr<WritableFile> index_file;
+  if (write_index) {
+    s = Env::Default()->NewWritableFile(RecordIndex::IndexFileName(filename),
+                                        &index_file);
+    if (!s.ok()) {
+      Set_TF_Status_from_Status(out_status, s);
+      return nullptr;
+    }
+  }
   PyRecordWriter* writer = new PyRecordWriter;
   writer->file_ = std::move(file);
-  writer->writer_.reset(new RecordWriter(writer->file_.get(), options));
+  writer->index_file_ = std::move(index_file);
+  writer->writer_.reset(new RecordWriter(
+      writer->file_.get(), writer->index_file_.get(), options));
   return writer;
 }
 
@@ -46,6 +58,7 @@ PyRecordWriter::~PyRecordWriter() {
   // Writer depends on file during close for zlib flush, so destruct first.
   writer_.reset();
   file_.reset();
+  index_file_.reset();
 }
 
 void PyRecordWriter::WriteRecord(tensorflow::StringPiece record,
@@ -91,6 +104,14 @@ void PyRecordWriter::Close(TF_Status* out_status) {
     }
     file_.reset(nullptr);
   }
+  if (index_file_ != nullptr) {
+    Status s = index_file_->Close();
+    if (!s.ok()) {
+      Set_TF_Status_from_Status(out_status, s);
+      return;
+    }
+    index_file_.reset(nullptr);
+  }
 }
 
 }  // namespace io
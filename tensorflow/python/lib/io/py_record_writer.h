@@ -37,9 +37,11 @@ class RecordWriter;
 // by multiple threads.
 class PyRecordWriter {
  public:
+  // If write_index is true, also writes the index of the records to
+  // RecordIndex::IndexFileName(filename).
   static PyRecordWriter* New(const string& filename,
                              const io::RecordWriterOptions& compression_options,
-                             TF_Status* out_status);
+                             bool write_index, TF_Status* out_status);
   ~PyRecordWriter();
 
   void WriteRecord(tensorflow::StringPiece record, TF_Status* out_status);
@@ -51,6 +53,7 @@ class PyRecordWriter {
 
   std::unique_ptr<io::RecordWriter> writer_;
   std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<WritableFile> index_file_;
   TF_DISALLOW_COPY_AND_ASSIGN(PyRecordWriter);
 };
 
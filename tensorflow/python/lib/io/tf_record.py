@@ -33,6 +33,7 @@ class TFRecordCompressionType(object):
   NONE = 0
   ZLIB = 1
   GZIP = 2
+  SNAPPY = 3
 
 
 @tf_export("io.TFRecordOptions", "python_io.TFRecordOptions")
@@ -42,6 +43,7 @@ class TFRecordOptions(object):
   compression_type_map = {
       TFRecordCompressionType.ZLIB: "ZLIB",
       TFRecordCompressionType.GZIP: "GZIP",
+      TFRecordCompressionType.SNAPPY: "SNAPPY",
       TFRecordCompressionType.NONE: ""
   }
 
@@ -58,7 +60,8 @@ class TFRecordOptions(object):
     # pylint: disable=line-too-long
     """Creates a `TFRecordOptions` instance.
 
-    Options only effect TFRecordWriter when compression_type is not `None`.
+    Options only effect TFRecordWriter when compression_type is not `None`,
+    and only apply to ZLIB and GZIP compression.
     Documentation, details, and defaults can be found in
     [`zlib_compression_options.h`](https://www.tensorflow.org/code/tensorflow/core/lib/io/zlib_compression_options.h)
     and in the [zlib manual](http://www.zlib.net/manual.html).
@@ -189,13 +192,16 @@ class TFRecordWriter(object):
   """
 
   # TODO(josh11b): Support appending?
-  def __init__(self, path, options=None):
+  def __init__(self, path, options=None, write_index=False):
     """Opens file `path` and creates a `TFRecordWriter` writing to it.
 
     Args:
       path: The path to the TFRecords file.
       options: (optional) String specifying compression type,
           `TFRecordCompressionType`, or `TFRecordOptions` object.
+      write_index: (optional) If `True`, also writes an index of the records
+          to `path + ".index"` when the writer is closed, so that the records
+          can be read in any order. Only supported for uncompressed files.
 
     Raises:
       IOError: If `path` cannot be opened for writing.
@@ -207,7 +213,8 @@ class TFRecordWriter(object):
     with errors.raise_exception_on_not_ok_status() as status:
       # pylint: disable=protected-access
       self._writer = pywrap_tensorflow.PyRecordWriter_New(
-          compat.as_bytes(path), options._as_record_writer_options(), status)
+          compat.as_bytes(path), options._as_record_writer_options(),
+          write_index, status)
       # pylint: enable=protected-access
 
   def __enter__(self):
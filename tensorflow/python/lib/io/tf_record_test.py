@@ -403,6 +403,15 @@ class TFRecordIteratorTest(TFCompressionTestCase):
     actual = list(tf_record.tf_record_iterator(gzfn))
     self.assertEqual(actual, original)
 
+  def testWriteSnappyReadLarge(self):
+    # Larger than a snappy block.
+    original = [b"foo", _TEXT * 1024, b"bar"]
+    options = tf_record.TFRecordOptions(TFRecordCompressionType.SNAPPY)
+    fn = self._WriteRecordsToFile(original, "write_snappy_read.tfrecord",
+                                  options)
+    actual = list(tf_record.tf_record_iterator(fn, options))
+    self.assertEqual(actual, original)
+
   def testBadFile(self):
     """Verify that tf_record_iterator throws an exception on bad TFRecords."""
     fn = os.path.join(self.get_temp_dir(), "bad_file")
@@ -481,5 +490,12 @@ class TFRecordWriterCloseAndFlushZlibTests(TFRecordWriterCloseAndFlushTests):
           self).setUp(TFRecordCompressionType.ZLIB)
 
 
+class TFRecordWriterCloseAndFlushSnappyTests(TFRecordWriterCloseAndFlushTests):
+
+  def setUp(self):
+    super(TFRecordWriterCloseAndFlushSnappyTests,
+          self).setUp(TFRecordCompressionType.SNAPPY)
+
+
 if __name__ == "__main__":
   test.main()
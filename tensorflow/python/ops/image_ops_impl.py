@@ -2213,6 +2213,69 @@ def non_max_suppression_with_overlaps(overlaps,
     # pylint: enable=protected-access
 
 
+@tf_export('image.batched_non_max_suppression')
+def batched_non_max_suppression(boxes,
+                                scores,
+                                max_output_size_per_class,
+                                iou_threshold=0.5,
+                                score_threshold=float('-inf'),
+                                soft_nms_sigma=0.0,
+                                name=None):
+  """Greedily selects subsets of bounding boxes for many images and classes.
+
+  Performs the selection of `tf.image.non_max_suppression_padded` with
+  `pad_to_max_output_size=True` independently for every image of a batch and
+  every class, in parallel. For example, with a single image and class:
+    selected_indices, selected_scores, num_valid = (
+        tf.image.batched_non_max_suppression(
+            boxes[None, :, None, :], scores[None, :, None], max_output_size,
+            iou_threshold, score_threshold))
+    selected_boxes = tf.gather(boxes, selected_indices[0, 0, :num_valid[0, 0]])
+
+  If `soft_nms_sigma` is positive, Soft-NMS (Bodla et al,
+  https://arxiv.org/abs/1704.04503) is applied: boxes that overlap a selected
+  box by at most `iou_threshold` are not removed, but their scores decay by
+  `exp(-iou^2 / (2 * soft_nms_sigma))`, and they are removed once their score
+  is no longer above `score_threshold`.
+
+  Args:
+    boxes: A 4-D float `Tensor` of shape `[batch_size, num_boxes, q, 4]`. If
+      `q` is 1, the same boxes are used for all classes, otherwise `q` must be
+      equal to the number of classes.
+    scores: A 3-D float `Tensor` of shape `[batch_size, num_boxes,
+      num_classes]` representing a single score corresponding to each box and
+      class.
+    max_output_size_per_class: A scalar integer `Tensor` representing the
+      maximum number of boxes to be selected for each image and class.
+    iou_threshold: A float representing the threshold for deciding whether boxes
+      overlap too much with respect to IOU.
+    score_threshold: A float representing the threshold for deciding when to
+      remove boxes based on score.
+    soft_nms_sigma: A float representing the sigma parameter of Soft-NMS. If
+      0, overlapping boxes are removed as in `tf.image.non_max_suppression`.
+    name: A name for the operation (optional).
+
+  Returns:
+    selected_indices: A 3-D integer `Tensor` of shape `[batch_size,
+      num_classes, max_output_size_per_class]` representing the indices of the
+      selected boxes, padded with zeros.
+    selected_scores: A 3-D float `Tensor` of the same shape representing the
+      scores of the selected boxes after Soft-NMS decay, padded with zeros.
+    valid_outputs: A 2-D integer `Tensor` of shape `[batch_size, num_classes]`
+      denoting how many elements of `selected_indices` and `selected_scores`
+      are valid. Valid elements occur first, then padding.
+  """
+  with ops.name_scope(name, 'batched_non_max_suppression'):
+    iou_threshold = ops.convert_to_tensor(iou_threshold, name='iou_threshold')
+    score_threshold = ops.convert_to_tensor(
+        score_threshold, name='score_threshold')
+    soft_nms_sigma = ops.convert_to_tensor(
+        soft_nms_sigma, name='soft_nms_sigma')
+    return gen_image_ops.batched_non_max_suppression(
+        boxes, scores, max_output_size_per_class, iou_threshold,
+        score_threshold, soft_nms_sigma)
+
+
 _rgb_to_yiq_kernel = [[0.299, 0.59590059,
                        0.2115], [0.587, -0.27455667, -0.52273617],
                       [0.114, -0.32134392, 0.31119955]]
@@ -3125,6 +3125,47 @@ class JpegTest(test_util.TensorFlowTestCase):
             lambda e: "Invalid JPEG data or crop window" in str(e)):
           sess.run(result)
 
+  def testDecodeAndCropAndResizeJpeg(self):
+    with self.cached_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      # The crop window is decoded at full, half and quarter size.
+      crop_window = [16, 8, 224, 112]
+      for size, max_error in [([200, 100], 0), ([100, 50], 4), ([56, 28], 8)]:
+        # Explicit two stages: decode+crop, then resize.
+        image1 = image_ops.decode_and_crop_jpeg(jpeg0, crop_window)
+        image1 = image_ops.resize_bilinear(
+            array_ops.expand_dims(image1, 0), size)[0]
+
+        # Combined decode+crop+resize.
+        image2 = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, size)
+        self.assertAllEqual(image1.get_shape().as_list(),
+                            image2.get_shape().as_list())
+
+        image1, image2 = sess.run([image1, image2])
+        if max_error == 0:
+          self.assertAllEqual(image1, image2)
+        else:
+          self.assertLess(np.abs(image1 - image2).mean(), max_error)
+
+  def testDecodeAndCropAndResizeJpegWithInvalidCropWindow(self):
+    with self.cached_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      h, w, _ = 256, 128, 3
+      crop_windows = [[-1, 11, 11, 11], [11, 11, 0, 11], [0, 0, h + 1, w],
+                      [0, 0, h, w + 1]]
+      for crop_window in crop_windows:
+        result = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, [8, 8])
+        with self.assertRaisesWithPredicateMatch(
+            errors.InvalidArgumentError,
+            lambda e: "Invalid JPEG data or crop window" in str(e)):
+          sess.run(result)
+
   def testSynthetic(self):
     with self.test_session(use_gpu=True) as sess:
       # Encode it, then decode it, then encode it
@@ -3764,6 +3805,83 @@ class NonMaxSuppressionPaddedTest(test_util.TensorFlowTestCase):
       self.assertEqual(num_valid.eval(), 3)
 
 
+class BatchedNonMaxSuppressionTest(test_util.TensorFlowTestCase):
+
+  def testMatchesNonMaxSuppressionPadded(self):
+    np.random.seed(7)
+    batch_size, num_boxes, num_classes = 3, 40, 4
+    corners = np.random.uniform(0, 10, [batch_size, num_boxes, num_classes, 2])
+    sizes = np.random.uniform(0, 3, [batch_size, num_boxes, num_classes, 2])
+    boxes_np = np.concatenate([corners, corners + sizes], axis=3).astype(
+        np.float32)
+    scores_np = np.random.uniform(
+        size=[batch_size, num_boxes, num_classes]).astype(np.float32)
+    max_output_size = 7
+    selected_indices, selected_scores, num_valid = (
+        image_ops.batched_non_max_suppression(
+            boxes_np, scores_np, max_output_size, iou_threshold=0.3,
+            score_threshold=0.2))
+    self.assertEqual([batch_size, num_classes, max_output_size],
+                     selected_indices.shape.as_list())
+    expected = []
+    for b in range(batch_size):
+      for c in range(num_classes):
+        expected.append(
+            image_ops.non_max_suppression_padded(
+                boxes_np[b, :, c, :], scores_np[b, :, c], max_output_size,
+                iou_threshold=0.3, score_threshold=0.2,
+                pad_to_max_output_size=True))
+    with self.cached_session() as sess:
+      indices, scores, valid, expected = sess.run(
+          [selected_indices, selected_scores, num_valid, expected])
+    for b in range(batch_size):
+      for c in range(num_classes):
+        expected_indices, expected_valid = expected[b * num_classes + c]
+        self.assertEqual(expected_valid, valid[b, c])
+        self.assertAllEqual(expected_indices, indices[b, c])
+        self.assertAllEqual(
+            scores_np[b, expected_indices[:expected_valid], c],
+            scores[b, c, :expected_valid])
+        self.assertAllEqual(
+            np.zeros(max_output_size - expected_valid),
+            scores[b, c, expected_valid:])
+
+  def testSoftNMS(self):
+    # The boxes of both classes are shared.
+    boxes_np = [[[[0, 0, 1, 1]], [[0, 0.1, 1, 1.1]], [[0, 10, 1, 11]],
+                 [[0, 0.5, 1, 1.5]]]]
+    scores_np = [[[0.9, 0.1], [0.8, 0.7], [0.7, 0.6], [0.6, 0.5]]]
+    selected_indices, selected_scores, num_valid = (
+        image_ops.batched_non_max_suppression(
+            boxes_np, scores_np, 4, iou_threshold=0.9, score_threshold=0.05,
+            soft_nms_sigma=0.5))
+    with self.cached_session():
+      # Boxes 1 and 3 overlap box 0 with IOUs of 0.9 / 1.1 and 1 / 3, which
+      # decays their scores by exp(-iou^2) without removing them, so box 3
+      # is selected before box 1. In class 1, box 0 ends up below the score
+      # threshold.
+      self.assertAllEqual([[[0, 2, 3, 1], [1, 2, 3, 0]]],
+                          selected_indices.eval())
+      self.assertAllEqual([[4, 3]], num_valid.eval())
+      scores = selected_scores.eval()
+      self.assertAllClose([0.9, 0.7, 0.6 * np.exp(-1.0 / 9)],
+                          scores[0, 0, :3])
+      self.assertAllClose([0.7, 0.6], scores[0, 1, :2])
+      self.assertEqual(0, scores[0, 1, 3])
+
+  def testInvalidArguments(self):
+    boxes = constant_op.constant([[[[0.0, 0.0, 1.0, 1.0]]]])
+    scores = constant_op.constant([[[0.9, 0.8]]])
+    with self.cached_session():
+      # Boxes are either shared or given for every one of the 2 classes.
+      with self.assertRaises(errors.InvalidArgumentError):
+        image_ops.batched_non_max_suppression(
+            array_ops.tile(boxes, [1, 1, 3, 1]), scores, 3)[0].eval()
+      with self.assertRaises(errors.InvalidArgumentError):
+        image_ops.batched_non_max_suppression(
+            boxes, scores, 3, soft_nms_sigma=-1.0)[0].eval()
+
+
 class VerifyCompatibleImageShapesTest(test_util.TensorFlowTestCase):
   """Tests utility function used by ssim() and psnr()."""
 